@@ -0,0 +1,110 @@
+/*! \file Chanlog_Convert.cpp
+	Split a -c channel log back into the per channel chanXX.dat files matlab/get_chan.m reads, one
+	Channel_M, I[3], Q[3] and P_buff[20] per record as the receiver used to write them. A tic range
+	picks a stretch out of a long log through the index without decoding what comes before it.
+	usage: chanlog-convert [chan.chl] [first tic] [last tic]
+*/
+/************************************************************************************************
+Copyright 2008 Gregory W Heckler
+
+This file is part of the GPS Software Defined Radio (GPS-SDR)
+
+The GPS-SDR is free software; you can redistribute it and/or modify it under the terms of the
+GNU General Public License as published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The GPS-SDR is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with GPS-SDR; if not,
+write to the:
+
+Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+************************************************************************************************/
+
+#define GLOBALS_HERE
+
+#include "includes.h"
+#include "chan_log.h"
+
+int main(int32 argc, char** argv)
+{
+
+	Chan_Log_Reader *rd;
+	Chan_Log_S r;
+	FILE *fp[MAX_CHANNELS];
+	const char *fname;
+	char name[64];
+	uint32 first, last, records[MAX_CHANNELS];
+	int32 lcv, total;
+
+	fname = "chan.chl";
+	first = 0;
+	last = 0xffffffff;
+
+	if(argc > 1)
+		fname = argv[1];
+	if(argc > 2)
+		first = strtoul(argv[2], NULL, 0);
+	if(argc > 3)
+		last = strtoul(argv[3], NULL, 0);
+
+	rd = new Chan_Log_Reader(fname);
+	if(!rd->isOpen())
+	{
+		fprintf(stderr,"Could not open %s, or it was written by a receiver with a different Channel_M\n", fname);
+		delete rd;
+		return(-1);
+	}
+
+	for(lcv = 0; lcv < MAX_CHANNELS; lcv++)
+	{
+		fp[lcv] = NULL;
+		records[lcv] = 0;
+	}
+
+	total = 0;
+	if(rd->Seek(first))
+	{
+		while(rd->Read(&r) && (r.packet.tic <= last))
+		{
+			lcv = r.packet.chan;
+			if((lcv < 0) || (lcv >= MAX_CHANNELS))
+				continue;
+
+			/* Only the channels that logged anything get a file */
+			if(fp[lcv] == NULL)
+			{
+				sprintf(name, "chan%02d.dat", lcv);
+				fp[lcv] = fopen(name, "wb");
+				if(fp[lcv] == NULL)
+				{
+					fprintf(stderr,"Could not create %s\n", name);
+					break;
+				}
+				setvbuf(fp[lcv], NULL, _IOFBF, 1 << 18);
+			}
+
+			fwrite(&r, sizeof(Chan_Log_S), 1, fp[lcv]);
+			records[lcv]++;
+			total++;
+		}
+	}
+
+	for(lcv = 0; lcv < MAX_CHANNELS; lcv++)
+	{
+		if(fp[lcv] == NULL)
+			continue;
+
+		fclose(fp[lcv]);
+		fprintf(stdout,"chan%02d.dat %10u records\n", lcv, records[lcv]);
+	}
+
+	fprintf(stdout,"%d records from %d chunks of %s\n", total, rd->getChunks(), fname);
+
+	delete rd;
+
+	return(0);
+
+}
@@ -0,0 +1,269 @@
+/*! \file Chanlog_Test.cpp
+	Benchmark the -c channel log: what Channel::Export() pays per record with the old four fwrite
+	calls and with Chan_Log::Push(), the delta coder's ratio and speed, and a round trip of every
+	record through Chan_Log/Chan_Log_Reader, raw and coded, including a seek, checked bit for bit.
+	usage: chanlog-test [chan.chl] [seconds]
+*/
+/************************************************************************************************
+Copyright 2008 Gregory W Heckler
+
+This file is part of the GPS Software Defined Radio (GPS-SDR)
+
+The GPS-SDR is free software; you can redistribute it and/or modify it under the terms of the
+GNU General Public License as published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The GPS-SDR is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with GPS-SDR; if not,
+write to the:
+
+Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+************************************************************************************************/
+
+#define GLOBALS_HERE
+
+#include "includes.h"
+#include "chan_log.h"
+
+#define CHL_TEST_FILE "./chanlog-test.chl"
+#define CHL_TEST_DAT "./chanlog-test.dat"
+
+double elapsed(struct timeval *_t0)
+{
+	struct timeval t1;
+
+	gettimeofday(&t1, NULL);
+	return((t1.tv_sec - _t0->tv_sec) + 1e-6*(t1.tv_usec - _t0->tv_usec));
+}
+
+
+//!< Records as MAX_CHANNELS channels tracking at 1 ms would log them
+void synth(Chan_Log_S *_r, int32 _cnt)
+{
+	Chan_Log_S *r;
+	int32 lcv, k, ms, chan;
+
+	memset(_r, 0x0, _cnt*sizeof(Chan_Log_S));
+	srand(1);
+
+	for(lcv = 0; lcv < _cnt; lcv++)
+	{
+		r = &_r[lcv];
+		ms = lcv / MAX_CHANNELS;
+		chan = lcv % MAX_CHANNELS;
+
+		r->packet.tic = ms;
+		r->packet.chan = chan;
+		r->packet.sv = 3*chan + 1;
+		r->packet.state = 3;
+		r->packet.len = 1;
+		r->packet.w = 1500 + 100*chan + ms/50;
+		r->packet.x = r->packet.w + (rand() & 0x3) - 2;
+		r->packet.z = 2*r->packet.w;
+		r->packet.code_nco = 1023000 + (ms & 0xf);
+		r->packet.carrier_nco = 604000 + 100*chan + ms/50;
+		r->packet.cn0 = 40 + (chan & 0x7);
+		r->packet.p_avg = 50000 + (rand() & 0xff);
+		r->packet.bit_lock = 1;
+		r->packet.frame_lock = (ms > 6000);
+		r->packet.navigate = (ms > 30000);
+		r->packet.count = ms;
+		r->packet.subframe = (ms / 6000) % 5 + 1;
+		r->packet.best_epoch = chan % 20;
+
+		for(k = 0; k < 3; k++)
+		{
+			r->I[k] = (((ms / 20) & 0x1) ? 1 : -1)*((k == 1) ? 1200 : 600) + (rand() & 0x7f) - 64;
+			r->Q[k] = (rand() & 0x7f) - 64;
+		}
+
+		for(k = 0; k < 20; k++)
+			r->P_buff[k] = (ms / 20) / 2 + ((k == chan % 20) ? ms / 40 : 0);
+	}
+}
+
+
+//!< Write _cnt records through Chan_Log, read them back, seek to the middle and compare
+int32 run(const char *_name, Chan_Log_S *_r, int32 _cnt)
+{
+	struct timeval t0;
+	Chan_Log_Reader *rd;
+	Chan_Log_S out, *dec;
+	uint8 *coded;
+	double t_enc, t_dec;
+	int32 lcv, blk, n, len, bytes, err, compress, target;
+
+	coded = (uint8 *)malloc(CHL_CHUNK*CHL_RECORD_MAX);
+	dec = (Chan_Log_S *)malloc(CHL_CHUNK*sizeof(Chan_Log_S));
+
+	/* The raw codec, one chunk at a time as the log thread does */
+	bytes = 0;
+	t_enc = t_dec = 0;
+	err = 0;
+	for(blk = 0; blk < _cnt; blk += CHL_CHUNK)
+	{
+		n = (_cnt - blk < CHL_CHUNK) ? _cnt - blk : CHL_CHUNK;
+
+		gettimeofday(&t0, NULL);
+		len = chl_encode(&_r[blk], n, coded);
+		t_enc += elapsed(&t0);
+
+		gettimeofday(&t0, NULL);
+		if(chl_decode(coded, len, dec, n) != n)
+			err++;
+		t_dec += elapsed(&t0);
+
+		if(memcmp(dec, &_r[blk], n*sizeof(Chan_Log_S)))
+			err++;
+
+		bytes += len;
+	}
+
+	/* Through the file format, raw and coded */
+	for(compress = 0; compress < 2; compress++)
+	{
+		pChanLog = new Chan_Log(CHL_TEST_FILE, compress);
+		for(lcv = 0; lcv < _cnt; lcv++)
+		{
+			pChanLog->Push(&_r[lcv].packet, _r[lcv].I, _r[lcv].Q, _r[lcv].P_buff);
+			if((lcv % 1024) == 1023)
+				pChanLog->Import();
+		}
+		if(pChanLog->getDropped())
+			err++;
+		delete pChanLog;
+		pChanLog = NULL;
+
+		rd = new Chan_Log_Reader(CHL_TEST_FILE);
+		for(lcv = 0; lcv < _cnt; lcv++)
+			if(!rd->Read(&out) || memcmp(&out, &_r[lcv], sizeof(Chan_Log_S)))
+				err++;
+		if(rd->Read(&out))
+			err++;
+
+		/* Random access, the first record at or after the tic */
+		target = _r[_cnt/2].packet.tic;
+		for(lcv = 0; _r[lcv].packet.tic < (uint32)target; lcv++)
+			;
+		if(!rd->Seek(target) || !rd->Read(&out) || memcmp(&out, &_r[lcv], sizeof(Chan_Log_S)))
+			err++;
+		delete rd;
+	}
+
+	unlink(CHL_TEST_FILE);
+	free(coded);
+	free(dec);
+
+	fprintf(stdout,"%-12s %8d records %6.2f:1  encode %7.1f MB/s  decode %7.1f MB/s  %s\n", _name, _cnt,
+		(double)_cnt*sizeof(Chan_Log_S)/bytes, 1e-6*_cnt*sizeof(Chan_Log_S)/t_enc,
+		1e-6*_cnt*sizeof(Chan_Log_S)/t_dec, err ? "FAIL" : "lossless");
+
+	return(err);
+}
+
+
+//!< Cost of one record to the tracking, the old way and through the ring
+void cost(Chan_Log_S *_r, int32 _cnt)
+{
+	FILE *fp;
+	uint64 t0, t, max_fw, max_push;
+	double sum_fw, sum_push;
+	int32 lcv, n;
+
+	/* What Export() used to do, straight into the stdio buffer and the disk behind it */
+	fp = fopen(CHL_TEST_DAT, "wb");
+	sum_fw = 0;
+	max_fw = 0;
+	for(lcv = 0; lcv < _cnt; lcv++)
+	{
+		t0 = tsc_now();
+		fwrite(&_r[lcv].packet, sizeof(Channel_M), 1, fp);
+		fwrite(&_r[lcv].I[0], sizeof(int32), 3, fp);
+		fwrite(&_r[lcv].Q[0], sizeof(int32), 3, fp);
+		fwrite(&_r[lcv].P_buff[0], sizeof(int32), 20, fp);
+		t = tsc_now() - t0;
+		sum_fw += t;
+		if(t > max_fw)
+			max_fw = t;
+	}
+	fclose(fp);
+	unlink(CHL_TEST_DAT);
+
+	/* Push, the log thread writes behind it */
+	pChanLog = new Chan_Log(CHL_TEST_FILE, 0);
+	pChanLog->Start();
+	sum_push = 0;
+	max_push = 0;
+	n = 0;
+	for(lcv = 0; lcv < _cnt; lcv++)
+	{
+		t0 = tsc_now();
+		pChanLog->Push(&_r[lcv].packet, _r[lcv].I, _r[lcv].Q, _r[lcv].P_buff);
+		t = tsc_now() - t0;
+		sum_push += t;
+		if(t > max_push)
+			max_push = t;
+
+		/* MAX_CHANNELS records a ms, as the tracking would */
+		if((lcv % MAX_CHANNELS) == (MAX_CHANNELS - 1))
+			usleep(1000);
+	}
+	pChanLog->Stop();
+	n = pChanLog->getDropped();
+	delete pChanLog;
+	pChanLog = NULL;
+	unlink(CHL_TEST_FILE);
+
+	fprintf(stdout,"fwrite x4    mean %8u ns  max %10u ns\n", tsc_ns((uint64)(sum_fw/_cnt)), tsc_ns(max_fw));
+	fprintf(stdout,"Push         mean %8u ns  max %10u ns  %d dropped\n", tsc_ns((uint64)(sum_push/_cnt)), tsc_ns(max_push), n);
+}
+
+
+int main(int32 argc, char** argv)
+{
+
+	Chan_Log_Reader *rd;
+	Chan_Log_S *r;
+	int32 cnt, got, err;
+	double seconds;
+
+	seconds = 30;
+	if(argc > 2)
+		seconds = atof(argv[2]);
+
+	gettimeofday(&starttime, NULL);
+	grun = 0x1;
+
+	cnt = (int32)(seconds*1000)*MAX_CHANNELS;
+	r = (Chan_Log_S *)malloc(cnt*sizeof(Chan_Log_S));
+	err = 0;
+
+	synth(r, cnt);
+	cost(r, (cnt < 10000*MAX_CHANNELS) ? cnt : 10000*MAX_CHANNELS);
+	err += run("synthetic", r, cnt);
+
+	/* A real log */
+	if(argc > 1)
+	{
+		rd = new Chan_Log_Reader(argv[1]);
+		if(rd->isOpen())
+		{
+			for(got = 0; (got < cnt) && rd->Read(&r[got]); got++)
+				;
+			if(got > 0)
+				err += run(argv[1], r, got);
+		}
+		else
+			fprintf(stdout,"Could not open %s\n", argv[1]);
+		delete rd;
+	}
+
+	grun = 0;
+	free(r);
+
+	return(err);
+
+}
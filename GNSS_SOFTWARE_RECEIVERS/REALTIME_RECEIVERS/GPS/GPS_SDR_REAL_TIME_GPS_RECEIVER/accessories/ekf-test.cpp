@@ -0,0 +1,311 @@
+/*! \file EKF_Test.cpp
+	Replay a log of the PVT's epochs (PVT_2_EKF_S records, as gps-sdr -b writes to <file>.pvt)
+	through the EKF twice and check both runs come out bit for bit the same. Without a log one is
+	made up first: a receiver wandering around Colorado with a drifting clock, 8 SVs, raw
+	pseudoranges and rates with the noise the filter is tuned for, and the point solution the PVT
+	would have handed over with them. Then the truth is known, and the filter has to beat the point
+	solution on position and velocity.
+	usage: ekf-test [log.pvt]
+*/
+/************************************************************************************************
+Copyright 2008 Gregory W Heckler
+
+This file is part of the GPS Software Defined Radio (GPS-SDR)
+
+The GPS-SDR is free software; you can redistribute it and/or modify it under the terms of the
+GNU General Public License as published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The GPS-SDR is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with GPS-SDR; if not,
+write to the:
+
+Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+************************************************************************************************/
+
+#define GLOBALS_HERE
+
+#include "includes.h"
+#include "ekf.h"
+#include "wls.h"
+
+#define EPOCHS		(3000)		//!< Length of the made up log
+#define SVS			(8)			//!< SVs in it
+#define SV_RADIUS	(26560e3)	//!< GPS orbit radius
+#define SV_SPEED	(3874.0)	//!< GPS orbital speed
+#define SETTLE		(100)		//!< Epochs left out of the accuracy figures
+
+double truth[EPOCHS][8];		//!< x, y, z, vx, vy, vz, clock bias (m), clock rate (m/s)
+
+//!< The point solution on _e's raw measurements, iterated from _s
+void point(PVT_2_EKF_S *_e, double *_s)
+{
+	WLS wls;
+	SV_Position_M *sv;
+	double H[MAX_CHANNELS][4], w[MAX_CHANNELS], y[MAX_CHANNELS], z[MAX_CHANNELS];
+	double dy[4], dz[4], dx[3], range, relvel;
+	int32 it, lcv, k;
+
+	for(lcv = 0; lcv < SVS; lcv++)
+		w[lcv] = 1.0;
+
+	for(it = 0; it < PVT_ITERATIONS; it++)
+	{
+		for(lcv = 0; lcv < SVS; lcv++)
+		{
+			sv = &_e->sv_positions[lcv];
+			dx[0] = _s[0] - sv->x;
+			dx[1] = _s[1] - sv->y;
+			dx[2] = _s[2] - sv->z;
+			range = sqrt(dx[0]*dx[0] + dx[1]*dx[1] + dx[2]*dx[2]);
+
+			for(k = 0; k < 3; k++)
+				H[lcv][k] = dx[k]/range;
+			H[lcv][3] = 1.0;
+
+			relvel = H[lcv][0]*(_s[3] - sv->vx) + H[lcv][1]*(_s[4] - sv->vy) + H[lcv][2]*(_s[5] - sv->vz);
+			y[lcv] = _e->pseudoranges[lcv].uncorrected - (range + _s[6] - sv->clock_bias*SPEED_OF_LIGHT);
+			z[lcv] = _e->pseudoranges[lcv].meters_rate - (relvel + _s[7] - sv->frequency_bias*SPEED_OF_LIGHT);
+		}
+
+		wls.Factor(H, w, SVS);
+		wls.Solve(H, w, y, z, SVS, dy, dz);
+		for(k = 0; k < 3; k++)
+		{
+			_s[k] += dy[k];
+			_s[3 + k] += dz[k];
+		}
+		_s[6] += dy[3];
+		_s[7] += dz[3];
+	}
+}
+
+
+//!< Make up a log of EPOCHS epochs in _fp, the truth goes in truth[]
+void synth(FILE *_fp)
+{
+	PVT_2_EKF_S e;
+	SV_Position_M *sv;
+	double lat, lon, alt, N, dt, t;
+	double en[3], nn[3], un[3], d[3], r[3], v[3], s[8];
+	double p0[SVS][3], v0[SVS][3], cb[SVS], fb[SVS];
+	double az, el, rd, rho, range, relvel, q;
+	int32 lcv, k, j;
+
+	dt = SECONDS_PER_TICK*MEASUREMENT_MOD;
+
+	/* Somewhere in Colorado, driving, with a clock well off */
+	lat = 40.0*DEG_2_RAD;
+	lon = -105.0*DEG_2_RAD;
+	alt = 1600.0;
+	N = WGS84_MAJOR_AXIS/sqrt(1 - 0.00669438006676*sin(lat)*sin(lat));
+	truth[0][0] = (N + alt)*cos(lat)*cos(lon);
+	truth[0][1] = (N + alt)*cos(lat)*sin(lon);
+	truth[0][2] = (N*(1 - 0.00669438006676) + alt)*sin(lat);
+	truth[0][3] = 12.0; truth[0][4] = -7.0; truth[0][5] = 3.0;
+	truth[0][6] = 3e4;
+	truth[0][7] = 60.0;
+
+	/* The truth walks the way the filter thinks it does */
+	for(lcv = 1; lcv < EPOCHS; lcv++)
+	{
+		for(k = 0; k < 3; k++)
+		{
+			truth[lcv][3 + k] = truth[lcv - 1][3 + k] + sqrt(EKF_ACCEL_PSD*dt)*gauss();
+			truth[lcv][k] = truth[lcv - 1][k] + 0.5*(truth[lcv - 1][3 + k] + truth[lcv][3 + k])*dt;
+		}
+		truth[lcv][7] = truth[lcv - 1][7] + sqrt(EKF_RATE_PSD*dt)*gauss();
+		truth[lcv][6] = truth[lcv - 1][6] + 0.5*(truth[lcv - 1][7] + truth[lcv][7])*dt + sqrt(EKF_BIAS_PSD*dt)*gauss();
+	}
+
+	/* SVs anywhere above 10 degrees, flying straight for the length of the log */
+	en[0] = -sin(lon);			en[1] = cos(lon);			en[2] = 0;
+	nn[0] = -sin(lat)*cos(lon);	nn[1] = -sin(lat)*sin(lon);	nn[2] = cos(lat);
+	un[0] = cos(lat)*cos(lon);	un[1] = cos(lat)*sin(lon);	un[2] = sin(lat);
+	for(j = 0; j < SVS; j++)
+	{
+		az = 2*M_PI*uniform();
+		el = asin(sin(10.0*DEG_2_RAD) + (1 - sin(10.0*DEG_2_RAD))*uniform());
+		for(k = 0; k < 3; k++)
+			d[k] = cos(el)*sin(az)*en[k] + cos(el)*cos(az)*nn[k] + sin(el)*un[k];
+
+		rd = truth[0][0]*d[0] + truth[0][1]*d[1] + truth[0][2]*d[2];
+		rho = -rd + sqrt(rd*rd - (truth[0][0]*truth[0][0] + truth[0][1]*truth[0][1] + truth[0][2]*truth[0][2]) + SV_RADIUS*SV_RADIUS);
+		for(k = 0; k < 3; k++)
+		{
+			p0[j][k] = truth[0][k] + rho*d[k];
+			r[k] = gauss();
+		}
+
+		q = (r[0]*p0[j][0] + r[1]*p0[j][1] + r[2]*p0[j][2])/(SV_RADIUS*SV_RADIUS);
+		for(k = 0; k < 3; k++)
+			v[k] = r[k] - q*p0[j][k];
+		q = SV_SPEED/sqrt(v[0]*v[0] + v[1]*v[1] + v[2]*v[2]);
+		for(k = 0; k < 3; k++)
+			v0[j][k] = v[k]*q;
+
+		cb[j] = 1e-4*gauss();
+		fb[j] = 1e-11*gauss();
+	}
+
+	memset(&e, 0x0, sizeof(PVT_2_EKF_S));
+	memcpy(s, truth[0], sizeof(s));
+	for(lcv = 0; lcv < EPOCHS; lcv++)
+	{
+		t = lcv*dt;
+
+		for(j = 0; j < SVS; j++)
+		{
+			sv = &e.sv_positions[j];
+			sv->x = p0[j][0] + v0[j][0]*t;
+			sv->y = p0[j][1] + v0[j][1]*t;
+			sv->z = p0[j][2] + v0[j][2]*t;
+			sv->vx = v0[j][0];
+			sv->vy = v0[j][1];
+			sv->vz = v0[j][2];
+			sv->clock_bias = cb[j] + fb[j]*t;
+			sv->frequency_bias = fb[j];
+			sv->sv = sv->chan = j;
+
+			r[0] = truth[lcv][0] - sv->x;
+			r[1] = truth[lcv][1] - sv->y;
+			r[2] = truth[lcv][2] - sv->z;
+			range = sqrt(r[0]*r[0] + r[1]*r[1] + r[2]*r[2]);
+			relvel = (r[0]*(truth[lcv][3] - sv->vx) + r[1]*(truth[lcv][4] - sv->vy) + r[2]*(truth[lcv][5] - sv->vz))/range;
+
+			e.pseudoranges[j].uncorrected = range + truth[lcv][6] - sv->clock_bias*SPEED_OF_LIGHT + EKF_SIGMA_PR*gauss();
+			e.pseudoranges[j].meters_rate = relvel + truth[lcv][7] - sv->frequency_bias*SPEED_OF_LIGHT + EKF_SIGMA_PRR*gauss();
+			e.sps.chanmap[j] = j;
+		}
+
+		/* What the PVT would have sent along */
+		point(&e, s);
+		e.sps.x = s[0]; e.sps.y = s[1]; e.sps.z = s[2];
+		e.sps.vx = s[3]; e.sps.vy = s[4]; e.sps.vz = s[5];
+		e.sps.clock_rate = s[7];
+		e.sps.nsvs = (0x1 << SVS) - 1;
+		e.sps.converged = true;
+		e.sps.stale_ticks = 0;
+		e.sps.tic = lcv;
+		e.clock.bias = s[6]*INVERSE_SPEED_OF_LIGHT;
+		e.clock.receiver_time = t + dt;
+		e.clock.time = 100000.0 + t;
+		e.clock.week = 1500;
+
+		fwrite(&e, sizeof(PVT_2_EKF_S), 1, _fp);
+	}
+}
+
+
+int main(int32 argc, char** argv)
+{
+
+	EKF *ekf[2];
+	PVT_2_EKF_S in;
+	EKF_2_TLM_S out[2];
+	FILE *fp;
+	double x_ekf[6], x_pvt[6];
+	double se_pos_ekf, se_pos_pvt, se_vel_ekf, se_vel_pvt;
+	uint64 t0, t, t_max;
+	int32 epochs, diff, scored, converged, resets, err;
+	uint32 last_ticks;
+
+	TSC_Calibrate();
+	gopt.meas_int = 1000/MEASUREMENT_RATE;
+
+	if(argc > 1)
+	{
+		fp = fopen(argv[1], "rb");
+		if(fp == NULL)
+		{
+			fprintf(stderr,"Could not open %s\n", argv[1]);
+			return(1);
+		}
+	}
+	else
+	{
+		srand(1);
+		fp = tmpfile();
+		synth(fp);
+		rewind(fp);
+	}
+
+	ekf[0] = new EKF();
+	ekf[1] = new EKF();
+
+	epochs = diff = scored = converged = resets = 0;
+	last_ticks = 0;
+	se_pos_ekf = se_pos_pvt = se_vel_ekf = se_vel_pvt = 0;
+	t = t_max = 0;
+	while(fread(&in, sizeof(PVT_2_EKF_S), 1, fp) == 1)
+	{
+		t0 = tsc_now();
+		ekf[0]->Filter(&in, &out[0]);
+		t0 = tsc_now() - t0;
+		t += t0;
+		t_max = t0 > t_max ? t0 : t_max;
+
+		ekf[1]->Filter(&in, &out[1]);
+
+		/* Everything but the time it took */
+		out[0].state.period = out[1].state.period = 0;
+		if(memcmp(&out[0], &out[1], sizeof(EKF_2_TLM_S)))
+			diff++;
+
+		if(out[0].state.ekf_ticks < last_ticks)
+			resets++;
+		last_ticks = out[0].state.ekf_ticks;
+
+		if(out[0].state.status & (0x1 << EKF_STATE_CONVERGED))
+			converged++;
+
+		/* The point solution is there to compare with, the truth only when it was made up here */
+		if((argc == 1) && (epochs >= SETTLE))
+		{
+			x_ekf[0] = out[0].state.x;  x_ekf[1] = out[0].state.y;  x_ekf[2] = out[0].state.z;
+			x_ekf[3] = out[0].state.vx; x_ekf[4] = out[0].state.vy; x_ekf[5] = out[0].state.vz;
+			x_pvt[0] = in.sps.x;  x_pvt[1] = in.sps.y;  x_pvt[2] = in.sps.z;
+			x_pvt[3] = in.sps.vx; x_pvt[4] = in.sps.vy; x_pvt[5] = in.sps.vz;
+
+			se_pos_ekf += error3d(x_ekf, truth[epochs])*error3d(x_ekf, truth[epochs]);
+			se_pos_pvt += error3d(x_pvt, truth[epochs])*error3d(x_pvt, truth[epochs]);
+			se_vel_ekf += error3d(&x_ekf[3], &truth[epochs][3])*error3d(&x_ekf[3], &truth[epochs][3]);
+			se_vel_pvt += error3d(&x_pvt[3], &truth[epochs][3])*error3d(&x_pvt[3], &truth[epochs][3]);
+			scored++;
+		}
+
+		epochs++;
+	}
+
+	fclose(fp);
+
+	fprintf(stdout,"Replay    %d epochs, %d converged, %d resets, %d differ between runs\n",
+		epochs, converged, resets, diff);
+	if(epochs)
+		fprintf(stdout,"CPU       %.2f us per epoch, %.2f us max\n",
+			tsc_ns(t/epochs)/1000.0, tsc_ns(t_max)/1000.0);
+
+	err = 0;
+	if(diff || (epochs == 0))
+		err++;
+
+	if(scored)
+	{
+		fprintf(stdout,"Position  3D RMS %6.2f m point solution, %6.2f m EKF\n",
+			sqrt(se_pos_pvt/scored), sqrt(se_pos_ekf/scored));
+		fprintf(stdout,"Velocity  3D RMS %6.3f m/s point solution, %6.3f m/s EKF\n",
+			sqrt(se_vel_pvt/scored), sqrt(se_vel_ekf/scored));
+
+		if((se_pos_ekf > se_pos_pvt) || (se_vel_ekf > se_vel_pvt) || resets || (converged < epochs - SETTLE))
+			err++;
+	}
+
+	delete ekf[0];
+	delete ekf[1];
+
+	return(err);
+
+}
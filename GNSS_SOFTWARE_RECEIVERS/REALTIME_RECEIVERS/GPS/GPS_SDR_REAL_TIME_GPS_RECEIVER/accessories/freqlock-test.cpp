@@ -0,0 +1,147 @@
+/*! \file Freqlock_Test.cpp
+	Benchmark the channels' frequency search: the cost of one search with Freq_Lock::Full() and
+	with Freq_Lock::Zoom(), and how often each lands within a bin of the true offset, over the C/N0
+	a channel leaves the acquisition with and carrier errors spread over the span the search covers.
+	The strong acquisition hands over at 1 ms from 40 dB-Hz up, the medium and weak at 20 ms.
+	usage: freqlock-test [trials per C/N0]
+*/
+/************************************************************************************************
+Copyright 2008 Gregory W Heckler
+
+This file is part of the GPS Software Defined Radio (GPS-SDR)
+
+The GPS-SDR is free software; you can redistribute it and/or modify it under the terms of the
+GNU General Public License as published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The GPS-SDR is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with GPS-SDR; if not,
+write to the:
+
+Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+************************************************************************************************/
+
+#define GLOBALS_HERE
+
+#include "includes.h"
+#include "freq_lock.h"
+
+//!< Fill _x as Channel::FrequencyLock() would, _len ms prompts at _cn0 dB-Hz, _df Hz off, returns the phase difference
+void synth(CPX *_x, int32 _len, double _cn0, double _df, int64 *_re, int64 *_im)
+{
+	double amp, sigma, ph;
+	int32 lcv, it, qt, bit;
+
+	/* Prompt amplitude after the >>3, noise sigma of each of I and Q over _len ms */
+	amp = 64;
+	sigma = amp/sqrt(2*pow(10, _cn0/10)*_len*1e-3);
+
+	*_re = *_im = 0;
+	bit = 1;
+	ph = 2*M_PI*(rand()/(RAND_MAX + 1.0));
+	for(lcv = 0; lcv < FREQ_LOCK_POINTS; lcv++)
+	{
+		if((lcv % (20/_len)) == 0)
+			bit = (rand() & 0x1) ? 1 : -1;
+
+		it = (int32)floor(0.5 + bit*amp*cos(ph) + sigma*gauss());
+		qt = (int32)floor(0.5 + bit*amp*sin(ph) + sigma*gauss());
+		ph += 2*M_PI*_df*_len*1e-3;
+
+		/* Keep the squares inside the int16 the channel stores them in */
+		it = (it > 127) ? 127 : ((it < -127) ? -127 : it);
+		qt = (qt > 127) ? 127 : ((qt < -127) ? -127 : qt);
+
+		_x[lcv].i = (int16)(it*it - qt*qt);
+		_x[lcv].q = (int16)(2*it*qt);
+
+		if(lcv)
+		{
+			*_re += (int64)_x[lcv].i*_x[lcv-1].i + (int64)_x[lcv].q*_x[lcv-1].q;
+			*_im += (int64)_x[lcv].q*_x[lcv-1].i - (int64)_x[lcv].i*_x[lcv-1].q;
+		}
+	}
+}
+
+
+int main(int32 argc, char** argv)
+{
+
+	Freq_Lock *fl;
+	CPX x[FREQ_LOCK_POINTS], work[FREQ_LOCK_POINTS];
+	int64 re, im;
+	uint64 t0, t_full, t_zoom;
+	double cn0, df, bin, truth;
+	int32 lcv, trials, len, full, zoom, ok_full, ok_zoom, agree, err;
+
+	trials = 200;
+	if(argc > 1)
+		trials = atoi(argv[1]);
+
+	fl = new Freq_Lock();
+	srand(1);
+	err = 0;
+
+	TSC_Calibrate();
+
+	for(len = 1; len <= 20; len += 19)
+	{
+		fprintf(stdout,"%2d ms     %8s %8s %8s\n", len, "full", "zoom", "agree");
+
+		for(cn0 = 30; cn0 <= 50; cn0 += 5)
+		{
+			ok_full = ok_zoom = agree = 0;
+			for(lcv = 0; lcv < trials; lcv++)
+			{
+				/* Anywhere in the middle half of what the search can tell apart */
+				df = 1000.0/(8.0*len)*(2*(rand()/(RAND_MAX + 1.0)) - 1);
+				synth(x, len, cn0, df, &re, &im);
+
+				/* The bin the squared signal falls in */
+				bin = 1000.0/(2.0*len*FREQ_LOCK_POINTS);
+				truth = df/bin;
+
+				memcpy(work, x, sizeof(x));
+				full = fl->Full(work);
+				zoom = fl->Zoom(x, re, im);
+
+				ok_full += (fabs(full - truth) <= 1);
+				ok_zoom += (fabs(zoom - truth) <= 1);
+				agree += (full == zoom);
+			}
+
+			fprintf(stdout,"%2.0f dB-Hz  %7.1f%% %7.1f%% %7.1f%%\n", cn0, 100.0*ok_full/trials,
+				100.0*ok_zoom/trials, 100.0*agree/trials);
+
+			/* Anything a channel is handed at this len should lock either way */
+			if(((len > 1) || (cn0 >= 40)) && (ok_zoom < ok_full))
+				err++;
+		}
+	}
+
+	/* Cost of a search, what the tracking pays the ms a channel's buffer fills */
+	synth(x, 1, 45, 37.0, &re, &im);
+	t_full = t_zoom = 0;
+	for(lcv = 0; lcv < 1000; lcv++)
+	{
+		memcpy(work, x, sizeof(x));
+		t0 = tsc_now();
+		fl->Full(work);
+		t_full += tsc_now() - t0;
+
+		t0 = tsc_now();
+		fl->Zoom(x, re, im);
+		t_zoom += tsc_now() - t0;
+	}
+
+	fprintf(stdout,"Full  %8u ns per search\n", tsc_ns(t_full/1000));
+	fprintf(stdout,"Zoom  %8u ns per search, %.1fx\n", tsc_ns(t_zoom/1000), (double)t_full/t_zoom);
+
+	delete fl;
+
+	return(err);
+
+}
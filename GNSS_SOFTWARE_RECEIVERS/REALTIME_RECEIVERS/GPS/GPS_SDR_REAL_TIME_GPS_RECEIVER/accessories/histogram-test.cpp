@@ -0,0 +1,151 @@
+/*! \file Histogram_Test.cpp
+	Check the log-linear latency histogram against exact percentiles and measure what the
+	Threaded_Object instrumentation costs per sample, e.g. histogram-test 1000000
+*/
+/************************************************************************************************
+Copyright 2008 Gregory W Heckler
+
+This file is part of the GPS Software Defined Radio (GPS-SDR)
+
+The GPS-SDR is free software; you can redistribute it and/or modify it under the terms of the
+GNU General Public License as published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The GPS-SDR is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with GPS-SDR; if not,
+write to the: 
+
+Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+************************************************************************************************/
+
+#define GLOBALS_HERE
+
+#include "includes.h"
+
+#define HIST_TEST_BUDGET	(50.0)		//!< ns per sample
+
+/*! A task that does nothing but get timed */
+class Bench : public Threaded_Object
+{
+	public:
+		Bench():Threaded_Object("BNCTASK"){}
+};
+
+int compare(const void *_a, const void *_b)
+{
+	uint32 a = *(uint32 *)_a;
+	uint32 b = *(uint32 *)_b;
+	return((a > b) - (a < b));
+}
+
+int main(int32 argc, char** argv)
+{
+
+	Histogram hist;
+	SPSC_Queue<int32, 4> wq;
+	Bench *bench;
+	uint32 *exact;
+	uint64 t0;
+	double p[4] = {0.5, 0.99, 0.999, 1.0};
+	struct timeval tv;
+	double err, worst, per, clk;
+	int32 want;
+	uint32 got;
+	int32 lcv, count, err_count;
+
+	count = 1000000;
+	if(argc > 1)
+		count = atoi(argv[1]);
+
+	gettimeofday(&starttime, NULL);
+	srand(1);
+
+	fprintf(stdout,"TSC: %.4f ns/tick\n", tsc_mult/65536.0);
+
+	/* Log-uniform intervals from 100 ns to 100 ms, fed in as TSC ticks */
+	exact = new uint32[count];
+	for(lcv = 0; lcv < count; lcv++)
+	{
+		exact[lcv] = (uint32)(100.0*pow(10.0, 6.0*rand()/RAND_MAX));
+		hist.Add(((uint64)exact[lcv] << 16) / tsc_mult);
+		exact[lcv] = tsc_ns(((uint64)exact[lcv] << 16) / tsc_mult);
+	}
+	qsort(exact, count, sizeof(uint32), compare);
+
+	worst = 0; err_count = 0;
+	for(lcv = 0; lcv < 4; lcv++)
+	{
+		want = exact[(int32)ceil(p[lcv]*count) - 1];
+		got = (p[lcv] < 1.0) ? hist.getPercentile(p[lcv]) : hist.getMax();
+		err = fabs((double)got - want)/want;
+		worst = err > worst ? err : worst;
+		fprintf(stdout,"p%-5g exact %10u ns  histogram %10u ns  error %5.2f%%\n", 100*p[lcv], want, got, 100*err);
+	}
+	if(worst > 1.0/HIST_SUB)
+	{
+		fprintf(stdout,"FAIL: percentile error over %.2f%%\n", 100.0/HIST_SUB);
+		err_count++;
+	}
+
+	/* Cost of the instrumentation, one start/stop pair is one run sample */
+	bench = new Bench;
+	t0 = tsc_now();
+	for(lcv = 0; lcv < count; lcv++)
+	{
+		bench->IncStartTic();
+		bench->IncStopTic();
+	}
+	per = tsc_ns(tsc_now() - t0)/(double)count;
+	fprintf(stdout,"IncStartTic+IncStopTic: %.1f ns per sample\n", per);
+
+	/* The two clock reads are the floor, the rest is the histogram and tic bookkeeping */
+	t0 = tsc_now();
+	for(lcv = 0; lcv < count; lcv++)
+		queue_stamp += tsc_now();
+	clk = tsc_ns(tsc_now() - t0)/(double)count;
+	queue_stamp = 0;
+	fprintf(stdout,"tsc_now: %.1f ns\n", clk);
+
+	t0 = tsc_now();
+	for(lcv = 0; lcv < count; lcv++)
+		gettimeofday(&tv, NULL);
+	fprintf(stdout,"gettimeofday: %.1f ns (the old tics)\n", tsc_ns(tsc_now() - t0)/(double)count);
+
+	t0 = tsc_now();
+	for(lcv = 0; lcv < count; lcv++)
+		hist.Add(lcv);
+	fprintf(stdout,"Histogram::Add: %.1f ns\n", tsc_ns(tsc_now() - t0)/(double)count);
+
+	per -= 2*clk;
+	fprintf(stdout,"Overhead beyond the clock reads: %.1f ns per sample\n", per);
+	if(per > HIST_TEST_BUDGET)
+	{
+		fprintf(stdout,"FAIL: over the %.0f ns budget\n", HIST_TEST_BUDGET);
+		err_count++;
+	}
+
+	/* A blocking receive should leave a wake up sample */
+	for(lcv = 0; lcv < 1000; lcv++)
+	{
+		wq.Send(&lcv);
+		wq.Receive(&want);
+		bench->IncStartTic();
+		bench->IncStopTic();
+	}
+	if(bench->getWakeHist()->getSamples() != 1000)
+	{
+		fprintf(stdout,"FAIL: %u wake up samples\n", bench->getWakeHist()->getSamples());
+		err_count++;
+	}
+
+	bench->PrintLatency(stdout);
+
+	delete bench;
+	delete [] exact;
+
+	return(err_count);
+
+}
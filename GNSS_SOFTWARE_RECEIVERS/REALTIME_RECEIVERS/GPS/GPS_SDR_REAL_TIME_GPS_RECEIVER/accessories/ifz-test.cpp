@@ -0,0 +1,167 @@
+/*! \file IFZ_Test.cpp
+	Benchmark the .ifz codec: compression ratio, encode and decode Msps on synthetic USRP (post
+	AGC) and GN3S (post resampler) data, and on a raw recording if one is given. Every file is
+	round tripped through IF_Writer/IF_Reader, including a seek, and checked bit for bit.
+	usage: ifz-test [data.dba] [seconds]
+*/
+/************************************************************************************************
+Copyright 2008 Gregory W Heckler
+
+This file is part of the GPS Software Defined Radio (GPS-SDR)
+
+The GPS-SDR is free software; you can redistribute it and/or modify it under the terms of the
+GNU General Public License as published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The GPS-SDR is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with GPS-SDR; if not,
+write to the: 
+
+Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+************************************************************************************************/
+
+#define GLOBALS_HERE
+
+#include "includes.h"
+#include "if_file.h"
+#include "resampler.h"
+
+#define IFZ_TEST_FILE "./ifz-test.ifz"
+
+double elapsed(struct timeval *_t0)
+{
+	struct timeval t1;
+
+	gettimeofday(&t1, NULL);
+	return((t1.tv_sec - _t0->tv_sec) + 1e-6*(t1.tv_usec - _t0->tv_usec));
+}
+
+
+//!< Compress _ms ms of data, decompress it, seek to the middle and compare
+int32 run(const char *_name, CPX *_data, int32 _ms)
+{
+	struct timeval t0;
+	IF_Writer *w;
+	IF_Reader *r;
+	CPX out[SAMPS_MS];
+	uint8 *frame;
+	double t_enc, t_dec, ratio;
+	int32 lcv, bytes, err;
+
+	/* The raw codec */
+	frame = (uint8 *)malloc(IFZ_FRAME_MAX + 8);
+	memset(frame, 0x0, IFZ_FRAME_MAX + 8);
+
+	bytes = 0;
+	gettimeofday(&t0, NULL);
+	for(lcv = 0; lcv < _ms; lcv++)
+		bytes += ifz_encode((int16 *)&_data[lcv*SAMPS_MS], 2*SAMPS_MS, frame);
+	t_enc = elapsed(&t0);
+
+	ratio = (double)_ms*SAMPS_MS*sizeof(CPX)/bytes;
+
+	err = 0;
+	gettimeofday(&t0, NULL);
+	for(lcv = 0; lcv < _ms; lcv++)
+		ifz_decode(frame, (int16 *)out, 2*SAMPS_MS);
+	t_dec = elapsed(&t0);
+
+	/* Through the file format */
+	w = new IF_Writer(IFZ_TEST_FILE, 1);
+	for(lcv = 0; lcv < _ms; lcv++)
+		w->Write(&_data[lcv*SAMPS_MS], NULL);
+	delete w;
+
+	r = new IF_Reader(IFZ_TEST_FILE);
+	for(lcv = 0; lcv < _ms; lcv++)
+	{
+		if(!r->Read(out, NULL) || memcmp(out, &_data[lcv*SAMPS_MS], SAMPS_MS*sizeof(CPX)))
+			err++;
+	}
+	if(r->Read(out, NULL))
+		err++;
+
+	/* Random access */
+	if(!r->Seek(_ms/2) || !r->Read(out, NULL) || memcmp(out, &_data[(_ms/2)*SAMPS_MS], SAMPS_MS*sizeof(CPX)))
+		err++;
+	delete r;
+
+	unlink(IFZ_TEST_FILE);
+	free(frame);
+
+	fprintf(stdout,"%-12s %6d ms %6.2f:1  encode %7.1f Msps  decode %7.1f Msps  %s\n", _name, _ms, ratio,
+		1e-6*_ms*SAMPS_MS/t_enc, 1e-6*_ms*SAMPS_MS/t_dec, err ? "FAIL" : "lossless");
+
+	return(err);
+}
+
+
+int main(int32 argc, char** argv)
+{
+
+	FILE *fp;
+	CPX *data;
+	int8 *bytes;
+	double u1, u2;
+	uint32 phase;
+	int32 lcv, ms, err, got;
+
+	ms = 5000;
+	if(argc > 2)
+		ms = atoi(argv[2]);
+
+	data = (CPX *)malloc(ms*SAMPS_MS*sizeof(CPX));
+	err = 0;
+
+	/* USRP after the AGC, Gaussian noise kept to AGC_BITS */
+	srand(1);
+	for(lcv = 0; lcv < ms*SAMPS_MS; lcv++)
+	{
+		u1 = (rand() + 1.0)/(RAND_MAX + 2.0);
+		u2 = (rand() + 1.0)/(RAND_MAX + 2.0);
+		data[lcv].i = (int16)floor(0.5 + 8*sqrt(-2*log(u1))*cos(2*M_PI*u2));
+		data[lcv].q = (int16)floor(0.5 + 8*sqrt(-2*log(u1))*sin(2*M_PI*u2));
+	}
+	err += run("USRP AGC", data, ms);
+
+	/* GN3S through the mixer and resampler */
+	{
+		Resampler rs(SAMPS_MS, 4000, 14, 20000);
+		CPX mixed[20000];
+
+		bytes = (int8 *)malloc(20000);
+		phase = 0;
+		for(lcv = 0; lcv < ms/5; lcv++)
+		{
+			for(got = 0; got < 20000; got++)
+				bytes[got] = (int8)rand();
+			x86_mix_2bit(bytes, mixed, 20000, &phase, 2557223528u);
+			rs.Run(mixed, &data[lcv*5*SAMPS_MS], 20000);
+		}
+		free(bytes);
+		err += run("GN3S", data, (ms/5)*5);
+	}
+
+	/* A real recording */
+	if(argc > 1)
+	{
+		fp = fopen(argv[1], "rb");
+		if(fp != NULL)
+		{
+			got = fread(data, SAMPS_MS*sizeof(CPX), ms, fp);
+			fclose(fp);
+			if(got > 0)
+				err += run(argv[1], data, got);
+		}
+		else
+			fprintf(stdout,"Could not open %s\n", argv[1]);
+	}
+
+	free(data);
+
+	return(err);
+
+}
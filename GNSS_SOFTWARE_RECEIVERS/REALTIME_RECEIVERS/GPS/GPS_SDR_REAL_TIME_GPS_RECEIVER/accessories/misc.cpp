@@ -170,34 +170,6 @@ void wipeoff_gen(MIX *_dest, double _f, double _fs, int32 _samps)
 /*----------------------------------------------------------------------------------------------*/
 
 
-/*----------------------------------------------------------------------------------------------*/
-void downsample(CPX *_dest, CPX *_source, double _fdest, double _fsource, int32 _samps)
-{
-
-	int32 lcv, k;
-	uint32 phase_step;
-	uint32 lphase, phase;
-
-	phase_step = (uint32)floor((double)4294967296.0*_fdest/_fsource);
-
-	k = lphase = phase = 0;
-
-	for(lcv = 0; lcv < _samps; lcv++)
-	{
-		if(phase <= lphase)
-		{
-			_dest[k] = _source[lcv];
-			k++;
-		}
-
-		lphase = phase;
-		phase += phase_step;
-	}
-
-}
-/*----------------------------------------------------------------------------------------------*/
-
-
 /*----------------------------------------------------------------------------------------------*/
 /*!
  * round_2, round a value to the next LOWEST value of 2^N
@@ -215,47 +187,6 @@ int32 round_2(int32 _N)
 
 
 
-}
-/*----------------------------------------------------------------------------------------------*/
-
-
-/*----------------------------------------------------------------------------------------------*/
-/*!
- * Gather statistics and run AGC
- * */
-int32 run_agc(CPX *_buff, int32 _samps, int32 _bits, int32 _scale)
-{
-	int32 lcv, num;
-	int16 max, *p;
-	int16 val;
-
-	p = (int16 *)&_buff[0];
-
-	val = (1 << _scale - 1);
-	max = 1 << _bits;
-	num = 0;
-
-	if(_scale)
-	{
-		for(lcv = 0; lcv < 2*_samps; lcv++)
-		{
-			p[lcv] += val;
-			p[lcv] >>= _scale;
-			if(abs(p[lcv]) > max)
-				num++;
-		}
-	}
-	else
-	{
-		for(lcv = 0; lcv < 2*_samps; lcv++)
-		{
-			if(abs(p[lcv]) > max)
-				num++;
-		}
-	}
-
-	return(num);
-
 }
 /*----------------------------------------------------------------------------------------------*/
 
@@ -580,3 +511,342 @@ uint32 adler(uint8 *data, int32 len)
 }
 /*----------------------------------------------------------------------------------------------*/
 
+
+
+/*----------------------------------------------------------------------------------------------*/
+/*!
+ * SV_Ephemeris, position, velocity and clock of the SV at time of transmission _t (seconds of
+ * week) off the broadcast ephemeris. Kepler's equation is started from M + _dE, pass back what
+ * the last call returned (E - M) to get there in a step, or 0 to start cold.
+ * */
+double SV_Ephemeris(Ephemeris_M *_e, double _t, double _dE, SV_Position_M *_s)
+{
+
+	int32 iter;
+	double dtemp, M, E, cE, sE, dEdM, P, U, R, I, cU, sU, Xp, Yp, L, sI, cI, sL, cL, ecc, s2P, c2P, toc;
+	double Edot, Pdot, Udot, Rdot, sUdot, cUdot, Xpdot, Ypdot, Idot, Ldot;
+	double Mdot, sqrt1mee;
+	double tk;
+
+	tk = _t - _e->toe;
+
+	if (tk > HALF_OF_SECONDS_IN_WEEK)
+		tk -= SECONDS_IN_WEEK;
+	else if (tk < (-HALF_OF_SECONDS_IN_WEEK))
+		tk += SECONDS_IN_WEEK;
+
+	//Mean anomaly, M (rads).
+	Mdot = _e->n0 + _e->deltan;
+	M = _e->m0 + Mdot * tk;
+
+	// Obtain eccentric anomaly E by solving Kepler's equation.
+	ecc = _e->ecc;
+
+	sqrt1mee = sqrt (1.0 - ecc * ecc);
+	E = M + _dE;
+	for (iter = 0; iter < 20; iter++)
+	{
+		sE = sin(E); cE = cos(E);
+		dEdM = 1.0 / (1.0 - ecc * cE);
+		if (fabs (dtemp = (M - E + ecc * sE) * dEdM) < 1.0E-14)
+			break;
+		E += dtemp;
+	}
+
+	/* Compute the relativistic correction term (seconds). */
+	_e->relativistic = (double)(-4.442807633E-10) * ecc * _e->sqrta * sE;
+
+	Edot = dEdM * Mdot;
+
+	/* Compute the argument of latitude, P. */
+	P = atan2 (sqrt1mee * sE, cE - ecc) + _e->argp;
+	Pdot = sqrt1mee * dEdM * Edot;
+
+	/* Generate harmonic correction terms for P and R. */
+	s2P = sin (2.0 * P);
+	c2P = cos (2.0 * P);
+
+	/* Compute the corrected argument of latitude, U. */
+	U = P + (_e->cus * s2P + _e->cuc * c2P);
+	sU = sin (U);
+	cU = cos (U);
+	Udot = Pdot * (1.0 + 2.0 * (_e->cus * c2P - _e->cuc * s2P));
+	sUdot = cU * Udot;
+	cUdot = -sU * Udot;
+
+	/* Compute the corrected radius, R. */
+	R = _e->a * (1.0 - ecc * cE) + (_e->crs * s2P +
+		_e->crc * c2P);
+	Rdot = _e->a * ecc * sE * Edot + 2.0 * Pdot
+		* (_e->crs * c2P - _e->crc * s2P);
+
+	/* Compute the corrected orbital inclination, I. */
+	I = _e->in0 + _e->idot * tk
+	+ (_e->cis * s2P + _e->cic * c2P);
+	sI = sin (I);
+	cI = cos (I);
+	Idot = _e->idot + 2.0 * Pdot * (_e->cis * c2P - _e->cic * s2P);
+
+	/* Compute the satellite's position in its orbital plane, (Xp,Yp). */
+	Xp = R * cU;
+	Yp = R * sU;
+	Xpdot = Rdot * cU + R * cUdot;
+	Ypdot = Rdot * sU + R * sUdot;
+
+	/* Compute the longitude of the ascending node, L. */
+	L = _e->om0 + tk * (_e->omd - (double)WGS84OE) - (double)WGS84OE * _e->toe;
+	Ldot = _e->omd - (double)WGS84OE;
+	sL = sin (L);
+	cL = cos (L);
+
+	/* Compute the satellite's position in space, (x,y,z). */
+	_s->x = Xp * cL - Yp * cI * sL;
+	_s->y = Xp * sL + Yp * cI * cL;
+	_s->z = Yp * sI;
+
+	/* Compute SV clock correction */
+	_s->time = tk;
+	toc = _e->toc;
+
+	_s->clock_bias = _e->af0 +
+					(_e->af1 *(_t - toc)) +
+					(_e->af2 *(_t - toc)*(_t - toc)) +
+					_e->relativistic;
+
+	_s->clock_bias -= _e->tgd;
+
+	_s->frequency_bias = _e->af1 + (_e->af2 *(_t - toc)*2.0);
+
+	/* Satellite's velocity, (vx,vy,vz). */
+	_s->vx = -Ldot * (_s->y)
+	+ Xpdot * cL
+	- Ypdot * cI * sL
+	+ Yp * sI * Idot * sL;
+
+	_s->vy = Ldot * (_s->x)
+	+ Xpdot * sL
+	+ Ypdot * cI * cL
+	- Yp * sI * Idot * cL;
+
+	_s->vz = +Yp * cI * Idot
+	+ Ypdot * sI;
+
+	return(E - M);
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+/*!
+ * SV_Almanac, position, velocity and clock of the SV at _t (seconds of week) off the almanac.
+ * There are no harmonic corrections and no inclination rate, close enough to aim the acquisition.
+ * */
+void SV_Almanac(Almanac_M *_a, double _t, SV_Position_M *_s)
+{
+
+	int32 iter;
+	double a, n0, M, E, P, R, I, L;
+	double sE, cE, sI, cI, sL, cL, sP, cP;
+	double dEdM, ecc, sqrt1mee, dtemp, Xp, Yp;
+	double Edot, Pdot, Rdot, Xpdot, Ypdot, Ldot, sPdot, cPdot;
+	double tk;
+
+	/* Time to calculate position */
+	tk = _t - _a->toa;
+
+	if (tk > HALF_OF_SECONDS_IN_WEEK)
+		tk -= SECONDS_IN_WEEK;
+	else if (tk < (-HALF_OF_SECONDS_IN_WEEK))
+		tk += SECONDS_IN_WEEK;
+
+	/* Mean motion */
+	a = _a->sqrta * _a->sqrta;
+	n0 = sqrt(GRAVITY_CONSTANT/(a*a*a));
+
+	/* Mean anomaly, M (rads). */
+	M = _a->m0 + n0 * tk;
+	M = fmod(M, TWO_PI);
+
+	/* Obtain eccentric anomaly E by solving Kepler's equation. */
+	ecc = _a->ecc;
+
+	sqrt1mee = sqrt (1.0 - ecc * ecc);
+
+	E = M;
+
+	for(iter = 0; iter < 20; iter++)
+	{
+		sE = sin(E);
+		cE = cos(E);
+		dEdM = 1.0 / (1.0 - ecc * cE);
+		if (fabs(dtemp = (M - E + ecc * sE) * dEdM) < 1.0E-14)
+			break;
+		E += dtemp;
+	}
+
+	Edot = dEdM * n0;
+
+	/* Compute the argument of latitude, P. */
+	P = atan2 (sqrt1mee * sE, cE - ecc) + _a->argp;
+	Pdot = sqrt1mee * dEdM * Edot;
+	sP = sin(P);
+	cP = cos(P);
+	sPdot = cP*Pdot;
+	cPdot = -sP*Pdot;
+
+	/* Compute the corrected radius, R. */
+	R = a * (1.0 - ecc * cE);
+	Rdot = a * ecc * sE * Edot;
+
+	/* Compute the corrected orbital inclination, I. */
+	I = _a->in0;
+	sI = sin (I); cI = cos (I);
+
+	/* Compute the satellite's position in its orbital plane, (Xp,Yp) */
+	Xp = R * cP;
+	Yp = R * sP;
+
+	/* Compute the longitude of the ascending node, L. */
+	L = _a->om0 + tk * (_a->omd - (double)WGS84OE) - (double)WGS84OE * _a->toa;
+	Ldot = _a->omd - (double)WGS84OE;
+	sL = sin (L); cL = cos (L);
+
+	/* Compute the satellite's position in space, (x,y,z). */
+	_s->x = Xp * cL - Yp * cI * sL;
+	_s->y = Xp * sL + Yp * cI * cL;
+	_s->z = Yp * sI;
+
+	/* Compute the satellite's velocity in its orbital plane, (Xpdot,Ypdot) */
+	Xpdot = Rdot * cP + R * cPdot;
+	Ypdot = Rdot * sP + R * sPdot;
+
+	/* Satellite's velocity, (vx,vy,vz). */
+	_s->vx = -Ldot * (_s->y)
+	+ Xpdot * cL
+	- Ypdot * cI * sL;
+
+	_s->vy = Ldot * (_s->x)
+	+ Xpdot * sL
+	+ Ypdot * cI * cL;
+
+	_s->vz = Ypdot * sI;
+
+	 /* Compute SV clock correction */
+	_s->time = tk;
+	_s->clock_bias = _a->af0 + tk * _a->af1;
+	_s->frequency_bias = _a->af1;
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+/*!
+ * gauss, a zero mean unit variance normal deviate (Box-Muller) off rand(), for the synthetic tests
+ * */
+double gauss()
+{
+
+	double u1, u2;
+
+	u1 = (rand() + 1.0)/(RAND_MAX + 2.0);
+	u2 = (rand() + 1.0)/(RAND_MAX + 2.0);
+
+	return(sqrt(-2*log(u1))*cos(2*M_PI*u2));
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+/*!
+ * uniform, a deviate in [0, 1) off rand()
+ * */
+double uniform()
+{
+	return(rand()/(RAND_MAX + 1.0));
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+/*!
+ * error3d, distance between the first three elements of _a and _b
+ * */
+double error3d(double *_a, double *_b)
+{
+	return(sqrt((_a[0] - _b[0])*(_a[0] - _b[0]) + (_a[1] - _b[1])*(_a[1] - _b[1]) + (_a[2] - _b[2])*(_a[2] - _b[2])));
+}
+/*----------------------------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------------------------------*/
+/*!
+ * constellation_gen, a GPS like constellation of _planes*_slots SVs with toe = toa = _toe, slightly
+ * eccentric, semi-major axes spread a little across the slots and all the harmonics and clock terms
+ * in. SV p*_slots + s goes in _e[] and, if _a is not NULL, its almanac in _a[]
+ * */
+void constellation_gen(Ephemeris_M *_e, Almanac_M *_a, int32 _planes, int32 _slots, double _toe)
+{
+
+	Ephemeris_M *e;
+	Almanac_M *a;
+	int32 p, s, sv;
+
+	for(p = 0; p < _planes; p++)
+	{
+		for(s = 0; s < _slots; s++)
+		{
+			sv = p*_slots + s;
+			e = &_e[sv];
+			memset(e, 0x0, sizeof(Ephemeris_M));
+
+			e->sv = sv;
+			e->valid = 1;
+			e->iode = 1;
+			e->week_number = 500;
+			e->toe = e->toc = _toe;
+
+			e->sqrta = sqrt(26560e3 + 20e3*(s - _slots/2));
+			e->a = e->sqrta*e->sqrta;
+			e->n0 = sqrt(GRAVITY_CONSTANT/(e->a*e->a*e->a));
+			e->deltan = 4e-9;
+			e->ecc = 0.004 + 0.004*s;
+			e->in0 = 55.0*DEG_2_RAD;
+			e->idot = 1e-10;
+			e->om0 = (p*360.0/_planes + 10.0)*DEG_2_RAD;
+			e->omd = -8e-9;
+			e->argp = 0.3*p;
+			e->m0 = (s*360.0/_slots + p*15.0)*DEG_2_RAD - e->argp;
+			e->crs = 20.0; e->crc = 200.0;
+			e->cus = 5e-6; e->cuc = 1e-6;
+			e->cis = 1e-7; e->cic = -1e-7;
+
+			e->af0 = 1e-5*(sv % 7 - 3);
+			e->af1 = 1e-12*(sv % 5 - 2);
+			e->af2 = 1e-19;
+			e->tgd = 5e-9;
+
+			if(_a == NULL)
+				continue;
+
+			a = &_a[sv];
+			memset(a, 0x0, sizeof(Almanac_M));
+			a->sv = sv;
+			a->valid = 1;
+			a->week = 500;
+			a->toa = _toe;
+			a->ecc = e->ecc;
+			a->sqrta = e->sqrta;
+			a->in0 = e->in0;
+			a->om0 = e->om0;
+			a->omd = e->omd;
+			a->argp = e->argp;
+			a->m0 = e->m0;
+			a->af0 = e->af0;
+			a->af1 = e->af1;
+		}
+	}
+
+}
+/*----------------------------------------------------------------------------------------------*/
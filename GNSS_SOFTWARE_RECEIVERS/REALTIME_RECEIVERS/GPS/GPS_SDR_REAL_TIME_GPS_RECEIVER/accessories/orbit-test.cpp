@@ -0,0 +1,186 @@
+/*! \file Orbit_Test.cpp
+	Check the orbit cache against the exact path and time both. A made up constellation, with
+	eccentricity, harmonics and clock terms, is evaluated at random times over the fit interval
+	through SV_Ephemeris()/SV_Almanac() and through Orbit::Position(), and the worst position,
+	velocity and clock differences have to stay under ORBIT_POS_TOL etc. Then 8 SVs are walked
+	through an hour of 100 Hz epochs the way the PVT does it, Kepler started cold, Kepler started
+	from the last epoch and out of the cache, and a new IODE has to drop the nodes.
+	usage: orbit-test [samples]
+*/
+/************************************************************************************************
+Copyright 2008 Gregory W Heckler
+
+This file is part of the GPS Software Defined Radio (GPS-SDR)
+
+The GPS-SDR is free software; you can redistribute it and/or modify it under the terms of the
+GNU General Public License as published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The GPS-SDR is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with GPS-SDR; if not,
+write to the:
+
+Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+************************************************************************************************/
+
+#define GLOBALS_HERE
+
+#include "includes.h"
+#include "orbit.h"
+
+#define PLANES			(6)			//!< Orbit planes in the made up constellation
+#define SLOTS			(5)			//!< SVs in each
+#define SVS				(8)			//!< SVs walked through the PVT like run
+#define TOE				(345600.0)	//!< Ephemeris reference time
+#define FIT				(7200.0)	//!< Seconds either side of toe that get checked
+#define RATE			(100)		//!< Epochs per second of the PVT like run
+#define RUN				(3600)		//!< Seconds of it
+#define ORBIT_POS_TOL	(1e-3)		//!< Worst ephemeris position error allowed (meters)
+#define ORBIT_VEL_TOL	(1e-3)		//!< Worst ephemeris velocity error allowed (meters/sec)
+#define ORBIT_CLK_TOL	(1e-3)		//!< Worst ephemeris clock error allowed (meters)
+#define ALMANAC_POS_TOL	(1.0)		//!< Worst almanac position error allowed (meters)
+
+Ephemeris_M eph[PLANES*SLOTS];		//!< The constellation
+Almanac_M alm[PLANES*SLOTS];		//!< Its almanac
+
+//!< TSC ticks to ns, tsc_ns() saturates at 4.29 s
+double ns(uint64 _ticks)
+{
+	return(_ticks*(tsc_mult/65536.0));
+}
+
+
+double diff3(double _x, double _y, double _z, double _a, double _b, double _c)
+{
+	return(sqrt((_x - _a)*(_x - _a) + (_y - _b)*(_y - _b) + (_z - _c)*(_z - _c)));
+}
+
+
+int main(int32 argc, char** argv)
+{
+
+	Orbit *orbits;
+	SV_Position_M exact, cached;
+	double t, d, dE[SVS], dp, dv, dc, dpa, dva;
+	uint64 t0, t_cold, t_warm, t_cache;
+	int32 lcv, sv, samples, epochs, err;
+	uint32 evals;
+
+	TSC_Calibrate();
+
+	samples = 200000;
+	if(argc > 1)
+		samples = atoi(argv[1]);
+
+	constellation_gen(eph, alm, PLANES, SLOTS, TOE);
+	orbits = new Orbit[PLANES*SLOTS*2];
+
+	/* Random times, every SV, against the exact path */
+	dp = dv = dc = dpa = dva = 0;
+	for(lcv = 0; lcv < samples; lcv++)
+	{
+		sv = rand() % (PLANES*SLOTS);
+		t = TOE - FIT + 2*FIT*uniform();
+
+		SV_Ephemeris(&eph[sv], t, 0, &exact);
+		orbits[sv].Set(&eph[sv]);
+		orbits[sv].Position(t, &cached);
+
+		d = diff3(exact.x, exact.y, exact.z, cached.x, cached.y, cached.z);
+		dp = d > dp ? d : dp;
+		d = diff3(exact.vx, exact.vy, exact.vz, cached.vx, cached.vy, cached.vz);
+		dv = d > dv ? d : dv;
+		d = fabs(exact.clock_bias - cached.clock_bias)*SPEED_OF_LIGHT;
+		d += fabs(exact.frequency_bias - cached.frequency_bias)*SPEED_OF_LIGHT;
+		d += fabs(exact.time - cached.time);
+		dc = d > dc ? d : dc;
+
+		SV_Almanac(&alm[sv], t, &exact);
+		orbits[PLANES*SLOTS + sv].Set(&alm[sv]);
+		orbits[PLANES*SLOTS + sv].Position(t, &cached);
+
+		d = diff3(exact.x, exact.y, exact.z, cached.x, cached.y, cached.z);
+		dpa = d > dpa ? d : dpa;
+		d = diff3(exact.vx, exact.vy, exact.vz, cached.vx, cached.vy, cached.vz);
+		dva = d > dva ? d : dva;
+	}
+
+	fprintf(stdout,"Ephemeris %d samples, %.0f s nodes: worst %.4f mm position, %.4f mm/s velocity, %.6f mm clock\n",
+		samples, ORBIT_NODE_EPHEMERIS, dp*1e3, dv*1e3, dc*1e3);
+	fprintf(stdout,"Almanac   %d samples, %.0f s nodes: worst %.4f m position, %.4f m/s velocity\n",
+		samples, ORBIT_NODE_ALMANAC, dpa, dva);
+
+	err = 0;
+	if((dp > ORBIT_POS_TOL) || (dv > ORBIT_VEL_TOL) || (dc > ORBIT_CLK_TOL) || (dpa > ALMANAC_POS_TOL))
+		err++;
+
+	/* What the PVT does, SVS channels at RATE for RUN seconds */
+	for(lcv = 0; lcv < SVS; lcv++)
+	{
+		dE[lcv] = 0;
+		orbits[lcv].Flush();
+		orbits[lcv].Set(&eph[lcv]);
+	}
+	evals = 0;
+	for(lcv = 0; lcv < SVS; lcv++)
+		evals -= orbits[lcv].getEvals();
+
+	t_cold = t_warm = t_cache = 0;
+	epochs = RATE*RUN;
+	for(lcv = 0; lcv < epochs; lcv++)
+	{
+		t = TOE + (double)lcv/RATE;
+
+		t0 = tsc_now();
+		for(sv = 0; sv < SVS; sv++)
+			SV_Ephemeris(&eph[sv], t, 0, &exact);
+		t_cold += tsc_now() - t0;
+
+		t0 = tsc_now();
+		for(sv = 0; sv < SVS; sv++)
+			dE[sv] = SV_Ephemeris(&eph[sv], t, dE[sv], &exact);
+		t_warm += tsc_now() - t0;
+
+		t0 = tsc_now();
+		for(sv = 0; sv < SVS; sv++)
+			orbits[sv].Position(t, &cached);
+		t_cache += tsc_now() - t0;
+	}
+
+	for(lcv = 0; lcv < SVS; lcv++)
+		evals += orbits[lcv].getEvals();
+
+	fprintf(stdout,"%d SVs at %d Hz for %d s, ns per position (positions/s on one core):\n", SVS, RATE, RUN);
+	fprintf(stdout,"  Kepler cold     %7.1f ns (%10.0f)\n", ns(t_cold)/(epochs*SVS), 1e9*epochs*SVS/ns(t_cold));
+	fprintf(stdout,"  Kepler warm     %7.1f ns (%10.0f)\n", ns(t_warm)/(epochs*SVS), 1e9*epochs*SVS/ns(t_warm));
+	fprintf(stdout,"  Cached          %7.1f ns (%10.0f), %u exact evaluations for %d positions\n",
+		ns(t_cache)/(epochs*SVS), 1e9*epochs*SVS/ns(t_cache), evals, epochs*SVS);
+
+	if(t_cache > t_warm)
+		err++;
+
+	/* Same ephemeris keeps the nodes, a new IODE drops them */
+	if(orbits[0].Set(&eph[0]))
+		err++;
+
+	eph[0].iode++;
+	eph[0].m0 += 0.001;
+	if(!orbits[0].Set(&eph[0]))
+		err++;
+
+	t = TOE + RUN - 10.0;
+	SV_Ephemeris(&eph[0], t, 0, &exact);
+	orbits[0].Position(t, &cached);
+	d = diff3(exact.x, exact.y, exact.z, cached.x, cached.y, cached.z);
+	fprintf(stdout,"New IODE  %.4f mm off the new ephemeris\n", d*1e3);
+	if(d > ORBIT_POS_TOL)
+		err++;
+
+	delete [] orbits;
+
+	return(err);
+
+}
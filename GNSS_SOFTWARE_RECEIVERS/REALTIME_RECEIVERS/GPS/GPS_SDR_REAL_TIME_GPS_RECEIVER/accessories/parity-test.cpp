@@ -0,0 +1,416 @@
+/*! \file Parity_Test.cpp
+	Check x86_parity() and sse_parity() against the rotate and mask parity check the channels
+	used one word at a time, then run bit streams through the frame sync and subframe check both
+	ways, bit by bit as Channel::BitStuff() feeds them, and compare every lock and subframe.
+	The streams are synthetic subframes with cycle slips and bit errors, plus any files given,
+	one byte per bit (0 or 1) as a channel decided them.
+	usage: parity-test [bits.bin ...]
+*/
+/************************************************************************************************
+Copyright 2008 Gregory W Heckler
+
+This file is part of the GPS Software Defined Radio (GPS-SDR)
+
+The GPS-SDR is free software; you can redistribute it and/or modify it under the terms of the
+GNU General Public License as published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The GPS-SDR is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with GPS-SDR; if not,
+write to the:
+
+Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+************************************************************************************************/
+
+#define GLOBALS_HERE
+
+#include "includes.h"
+
+uint32 rotl(uint32 _x, int32 _n)
+{
+	return(_n ? ((_x << _n) | (_x >> (32 - _n))) : _x);
+}
+
+
+//!< The check the channels ran before, one word at a time
+bool ref_parity(uint32 gpsword)
+{
+	uint32 d1, d2, d3, d4, d5, d6, d7, t, parity;
+
+	d1 = gpsword & 0xFBFFBF00;
+	d2 = rotl(gpsword,1) & 0x07FFBF01;
+	d3 = rotl(gpsword,2) & 0xFC0F8100;
+	d4 = rotl(gpsword,3) & 0xF81FFE02;
+	d5 = rotl(gpsword,4) & 0xFC00000E;
+	d6 = rotl(gpsword,5) & 0x07F00001;
+	d7 = rotl(gpsword,6) & 0x00003000;
+
+	t = d1 ^ d2 ^ d3 ^ d4 ^ d5 ^ d6 ^ d7;
+
+	parity = t ^ rotl(t,6) ^ rotl(t,12) ^ rotl(t,18) ^ rotl(t,24);
+
+	return((parity & 0x3F) == (gpsword & 0x3F));
+}
+
+
+//!< Preamble, subframe ID and zero bits of a TLM/HOW pair, data bits righted in place
+bool tlm_how(uint32 *_w)
+{
+	uint32 preamble, sid, zerobits;
+
+	preamble = (_w[0] >> 22) & 0xFF;
+	zerobits = _w[1] & 0x3;
+	sid = (_w[1] >> 8) & 0x7;
+
+	if(_w[0] & 0x40000000)
+	{
+		preamble ^= 0xFF;
+		zerobits ^= 0x3;
+	}
+	if(_w[1] & 0x40000000)
+		sid ^= 0x7;
+
+	if((preamble != PREAMBLE) || (sid < 1) || (sid > 5) || (zerobits != 0))
+		return(false);
+
+	if(_w[0] & 0x40000000)
+		_w[0] ^= 0x3FFFFFC0;
+	if(_w[1] & 0x40000000)
+		_w[1] ^= 0x3FFFFFC0;
+
+	return(true);
+}
+
+
+//!< Channel::FrameSync() and ValidFrameFormat(), the old check when _ref
+bool frame_sync(uint32 *_wb, bool _ref)
+{
+	uint32 w[2];
+
+	w[0] = _wb[FRAME_SIZE_PLUS_2-2];
+	w[1] = _wb[FRAME_SIZE_PLUS_2-1];
+
+	if(!tlm_how(&w[0]))
+		return(false);
+
+	if(_ref)
+		return(ref_parity(w[0]) && ref_parity(w[1]));
+	else
+		return(x86_parity(&w[0], 2) == 0);
+}
+
+
+bool valid_frame(uint32 *_sf, bool _ref)
+{
+	uint32 w[4], sid, next_sid;
+	int32 lcv, errors;
+
+	w[0] = _sf[0];
+	w[1] = _sf[1];
+	w[2] = _sf[FRAME_SIZE_PLUS_2-2];
+	w[3] = _sf[FRAME_SIZE_PLUS_2-1];
+
+	if(!tlm_how(&w[0]) || !tlm_how(&w[2]))
+		return(false);
+
+	sid = (w[1] >> 8) & 0x7;
+	next_sid = (w[3] >> 8) & 0x7;
+	if(((next_sid - sid) != 1) && ((next_sid - sid) != (uint32)-4))
+		return(false);
+
+	for(lcv = 0; lcv < FRAME_SIZE_PLUS_2; lcv++)
+		if(_sf[lcv] & 0x40000000)
+			_sf[lcv] ^= 0x3FFFFFC0;
+
+	if(_ref)
+	{
+		errors = 0;
+		for(lcv = 0; lcv < FRAME_SIZE_PLUS_2; lcv++)
+			if(!ref_parity(_sf[lcv]))
+				errors++;
+		return(errors == 0);
+	}
+	else
+		return(sse_parity(_sf, FRAME_SIZE_PLUS_2) == 0);
+}
+
+
+//!< What ProcessDataBit() keeps between bits
+typedef struct Sync_S
+{
+	uint32 word_buff[FRAME_SIZE_PLUS_2];
+	bool frame_lock;
+	int32 bit_number;
+	int32 locks;
+	int32 subframes;
+} Sync_S;
+
+
+//!< BitStuff() and ProcessDataBit() for one bit, returns 1 on a frame lock, 2 on a good subframe, 3 on a bad one
+int32 feed(Sync_S *_s, uint32 _bit, bool _ref, uint32 *_sf)
+{
+	int32 lcv, ret;
+
+	for(lcv = 0; lcv <= (FRAME_SIZE_PLUS_2-2); lcv++)
+		_s->word_buff[lcv] = (_s->word_buff[lcv] << 1) + ((_s->word_buff[lcv+1] >> 29) & 0x1);
+	_s->word_buff[FRAME_SIZE_PLUS_2-1] = (_s->word_buff[FRAME_SIZE_PLUS_2-1] << 1) + _bit;
+
+	ret = 0;
+	if(!_s->frame_lock && frame_sync(_s->word_buff, _ref))
+	{
+		_s->frame_lock = true;
+		_s->bit_number = 299;
+		_s->locks++;
+		ret = 1;
+	}
+
+	if(_s->frame_lock)
+	{
+		_s->bit_number = (_s->bit_number + 1) % 300;
+		if(_s->bit_number == 0)
+		{
+			memcpy(_sf, _s->word_buff, sizeof(_s->word_buff));
+			if(valid_frame(_sf, _ref))
+			{
+				_s->subframes++;
+				ret = 2;
+			}
+			else
+			{
+				_s->frame_lock = false;
+				ret = 3;
+			}
+		}
+	}
+
+	return(ret);
+}
+
+
+//!< Run _cnt bits through both, returns the number of bits they disagree on
+int32 replay(const char *_name, uint8 *_bits, int32 _cnt)
+{
+	Sync_S ref, fast;
+	uint32 sf_ref[FRAME_SIZE_PLUS_2], sf_fast[FRAME_SIZE_PLUS_2];
+	uint64 t0, t_ref, t_fast;
+	int32 lcv, a, b, err;
+
+	memset(&ref, 0x0, sizeof(Sync_S));
+	memset(&fast, 0x0, sizeof(Sync_S));
+
+	err = 0;
+	for(lcv = 0; lcv < _cnt; lcv++)
+	{
+		a = feed(&ref, _bits[lcv], true, sf_ref);
+		b = feed(&fast, _bits[lcv], false, sf_fast);
+
+		if((a != b) || ((a == 2) && memcmp(sf_ref, sf_fast, sizeof(sf_ref))))
+			err++;
+	}
+
+	/* Again for the time, the whole stream each way */
+	memset(&fast, 0x0, sizeof(Sync_S));
+	t0 = tsc_now();
+	for(lcv = 0; lcv < _cnt; lcv++)
+		feed(&fast, _bits[lcv], false, sf_fast);
+	t_fast = tsc_now() - t0;
+
+	a = ref.locks;
+	b = ref.subframes;
+	memset(&ref, 0x0, sizeof(Sync_S));
+	t0 = tsc_now();
+	for(lcv = 0; lcv < _cnt; lcv++)
+		feed(&ref, _bits[lcv], true, sf_ref);
+	t_ref = tsc_now() - t0;
+
+	fprintf(stdout,"%-16s %8d bits %5d locks %6d subframes  %6.1f/%6.1f ns per bit  %s\n", _name, _cnt,
+		a, b, (double)tsc_ns(t_ref)/_cnt, (double)tsc_ns(t_fast)/_cnt,
+		err ? "FAIL" : "match");
+
+	return(err);
+}
+
+
+//!< A 30 bit word as the SV sends it, _d the 24 data bits, _prev the 2 bits before it
+uint32 encode(uint32 _d, uint32 _prev)
+{
+	uint32 w, parity;
+	int32 bit;
+
+	w = (_prev << 30) | ((_d & 0xFFFFFF) << 6);
+	parity = 0;
+	for(bit = 0; bit < 6; bit++)
+		parity |= (uint32)__builtin_parity(w & x86_parity_mask[bit]) << bit;
+
+	if(_prev & 0x1)
+		_d ^= 0xFFFFFF;
+
+	return(((_d & 0xFFFFFF) << 6) | parity);
+}
+
+
+//!< Solve the last 2 data bits for D29 = D30 = 0, as the HOW and word 10 are sent
+uint32 encode_zero(uint32 _d, uint32 _prev)
+{
+	uint32 t, w;
+
+	for(t = 0; t < 4; t++)
+	{
+		w = encode((_d & ~0x3) | t, _prev);
+		if((w & 0x3) == 0)
+			return(w);
+	}
+
+	return(w);
+}
+
+
+//!< _frames subframes after some noise, with the sign flipping and bits wrong now and then
+int32 synth(uint8 *_bits, int32 _frames, double _ber, int32 _slips)
+{
+	uint32 word, prev, d;
+	int32 cnt, lcv, k, bit, sid, tow, sign, slip;
+
+	cnt = 0;
+	for(lcv = 0; lcv < 137; lcv++)
+		_bits[cnt++] = rand() & 0x1;
+
+	prev = 0;
+	sign = rand() & 0x1;
+	sid = 1 + rand() % 5;
+	tow = rand() % 100000;
+	slip = _slips ? (_frames*300)/_slips : 0;
+
+	for(lcv = 0; lcv < _frames; lcv++)
+	{
+		for(k = 0; k < 10; k++)
+		{
+			d = ((rand() & 0xFFF) << 12) | (rand() & 0xFFF);
+			if(k == 0)
+				word = encode((PREAMBLE << 16) | (d & 0xFFFF), prev);
+			else if(k == 1)
+				word = encode_zero((tow << 7) | (sid << 2), prev);
+			else if(k == 9)
+				word = encode_zero(d, prev);
+			else
+				word = encode(d, prev);
+
+			for(bit = 29; bit >= 0; bit--)
+			{
+				if(slip && ((rand() % slip) == 0))
+					sign ^= 1;
+				_bits[cnt] = ((word >> bit) & 0x1) ^ sign;
+				if((rand()/(RAND_MAX + 1.0)) < _ber)
+					_bits[cnt] ^= 1;
+				cnt++;
+			}
+			prev = word & 0x3;
+		}
+		sid = (sid % 5) + 1;
+		tow++;
+	}
+
+	return(cnt);
+}
+
+
+int main(int32 argc, char** argv)
+{
+
+	FILE *fp;
+	uint8 *bits;
+	uint32 words[32], fail, expect;
+	uint64 t0, t_ref, t_x86, t_sse;
+	int32 lcv, k, cnt, err;
+
+	TSC_Calibrate();
+	srand(1);
+	err = 0;
+
+	/* Word by word, random and every single bit set on top of a good word */
+	for(lcv = 0; lcv < 200000; lcv++)
+	{
+		cnt = 1 + (lcv % 32);
+		for(k = 0; k < cnt; k++)
+		{
+			words[k] = ((uint32)rand() << 16) ^ (uint32)rand();
+			if(rand() & 0x1)
+				words[k] = (words[k] & 0xC0000000) | encode(words[k] >> 6, words[k] >> 30);
+			if(rand() & 0x1)
+				words[k] ^= 1 << (rand() & 0x1F);
+		}
+
+		expect = 0;
+		for(k = 0; k < cnt; k++)
+			if(!ref_parity(words[k]))
+				expect |= 1 << k;
+
+		fail = x86_parity(words, cnt);
+		if(fail != expect)
+			err++;
+		fail = sse_parity(words, cnt);
+		if(fail != expect)
+			err++;
+	}
+	fprintf(stdout,"x86_parity/sse_parity against the rotate and mask check  %s\n", err ? "FAIL" : "match");
+
+	/* A subframe's worth, the check ValidFrameFormat() makes */
+	for(k = 0; k < FRAME_SIZE_PLUS_2; k++)
+		words[k] = encode(rand(), k & 0x3);
+
+	t_ref = t_x86 = t_sse = 0;
+	fail = 0;
+	for(lcv = 0; lcv < 100000; lcv++)
+	{
+		t0 = tsc_now();
+		for(k = 0; k < FRAME_SIZE_PLUS_2; k++)
+			fail += ref_parity(words[k]);
+		t_ref += tsc_now() - t0;
+
+		t0 = tsc_now();
+		fail += x86_parity(words, FRAME_SIZE_PLUS_2);
+		t_x86 += tsc_now() - t0;
+
+		t0 = tsc_now();
+		fail += sse_parity(words, FRAME_SIZE_PLUS_2);
+		t_sse += tsc_now() - t0;
+	}
+	fprintf(stdout,"12 words  rotate %6.1f ns  x86_parity %6.1f ns  sse_parity %6.1f ns  (%u)\n",
+		tsc_ns(t_ref)/1e5, tsc_ns(t_x86)/1e5, tsc_ns(t_sse)/1e5, fail);
+
+	/* Bit streams */
+	bits = (uint8 *)malloc(1 << 24);
+
+	cnt = synth(bits, 1000, 0, 0);
+	err += replay("clean", bits, cnt);
+	cnt = synth(bits, 1000, 0, 20);
+	err += replay("cycle slips", bits, cnt);
+	cnt = synth(bits, 1000, 1e-3, 20);
+	err += replay("slips, 1e-3 BER", bits, cnt);
+	cnt = synth(bits, 1000, 2e-2, 0);
+	err += replay("2e-2 BER", bits, cnt);
+
+	for(lcv = 1; lcv < argc; lcv++)
+	{
+		fp = fopen(argv[lcv], "rb");
+		if(fp == NULL)
+		{
+			fprintf(stdout,"Could not open %s\n", argv[lcv]);
+			continue;
+		}
+		cnt = fread(bits, 1, 1 << 24, fp);
+		fclose(fp);
+
+		for(k = 0; k < cnt; k++)
+			bits[k] &= 0x1;
+		err += replay(argv[lcv], bits, cnt);
+	}
+
+	free(bits);
+
+	return(err);
+
+}
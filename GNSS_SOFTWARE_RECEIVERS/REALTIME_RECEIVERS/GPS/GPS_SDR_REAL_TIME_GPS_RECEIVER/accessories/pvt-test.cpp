@@ -0,0 +1,457 @@
+/*! \file PVT_Test.cpp
+	Check and time the point solution. Epochs of pseudoranges and rates are made up around a fixed
+	receiver, each SV's noise drawn from the C/N0 and elevation model -W weights by. Every epoch is
+	solved the way PVT_Estimation() used to (A'A, Invert4x4(), the pseudo inverse) and with the WLS
+	factor the way it does now, iterating from a previous fix and from the center of the Earth.
+	The two unweighted answers and GDOPs must agree, weighting must not lose accuracy, and RAIM must
+	pull a faulted SV out without throwing out good ones.
+	usage: pvt-test [epochs]
+*/
+/************************************************************************************************
+Copyright 2008 Gregory W Heckler
+
+This file is part of the GPS Software Defined Radio (GPS-SDR)
+
+The GPS-SDR is free software; you can redistribute it and/or modify it under the terms of the
+GNU General Public License as published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The GPS-SDR is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with GPS-SDR; if not,
+write to the:
+
+Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+************************************************************************************************/
+
+#define GLOBALS_HERE
+
+#include "includes.h"
+#include "wls.h"
+
+#define SV_RADIUS	(26560e3)	//!< GPS orbit radius
+#define SV_SPEED	(3874.0)	//!< GPS orbital speed
+#define FAULT		(20.0)		//!< Pseudorange fault RAIM has to find, in sigmas of the SV it lands on
+
+typedef struct Epoch
+{
+	int32 n;
+	double sv[MAX_CHANNELS][3];
+	double sv_v[MAX_CHANNELS][3];
+	double pr[MAX_CHANNELS];
+	double prr[MAX_CHANNELS];
+	double cn0[MAX_CHANNELS];
+	double elev[MAX_CHANNELS];
+	int32 fault;
+} Epoch;
+
+double truth[8];				//!< x, y, z, clock bias, vx, vy, vz, clock rate
+
+//!< An epoch of _n SVs seen from truth, with _fault sigmas on one of them if _fault is non zero
+void synth(Epoch *_e, int32 _n, double _fault)
+{
+	double lat, lon, e[3], n[3], u[3], d[3], r[3], v[3];
+	double az, el, rd, rho, sigma, s;
+	int32 lcv, k;
+
+	lat = 40.0*DEG_2_RAD;
+	lon = -105.0*DEG_2_RAD;
+	e[0] = -sin(lon);			e[1] = cos(lon);			e[2] = 0;
+	n[0] = -sin(lat)*cos(lon);	n[1] = -sin(lat)*sin(lon);	n[2] = cos(lat);
+	u[0] = cos(lat)*cos(lon);	u[1] = cos(lat)*sin(lon);	u[2] = sin(lat);
+
+	_e->n = _n;
+	_e->fault = _fault != 0 ? rand() % _n : -1;
+
+	for(lcv = 0; lcv < _n; lcv++)
+	{
+		/* Anywhere above the mask, uniform on the sky */
+		az = 2*M_PI*uniform();
+		el = asin(sin(PVT_ELEV_MIN*DEG_2_RAD) + (1 - sin(PVT_ELEV_MIN*DEG_2_RAD))*uniform());
+		for(k = 0; k < 3; k++)
+			d[k] = cos(el)*sin(az)*e[k] + cos(el)*cos(az)*n[k] + sin(el)*u[k];
+
+		/* Out along the line of sight to the orbit */
+		rd = truth[0]*d[0] + truth[1]*d[1] + truth[2]*d[2];
+		rho = -rd + sqrt(rd*rd - (truth[0]*truth[0] + truth[1]*truth[1] + truth[2]*truth[2]) + SV_RADIUS*SV_RADIUS);
+		for(k = 0; k < 3; k++)
+			_e->sv[lcv][k] = truth[k] + rho*d[k];
+
+		/* Orbital velocity, any direction square to the radius */
+		for(k = 0; k < 3; k++)
+			r[k] = gauss();
+		s = (r[0]*_e->sv[lcv][0] + r[1]*_e->sv[lcv][1] + r[2]*_e->sv[lcv][2])/(SV_RADIUS*SV_RADIUS);
+		for(k = 0; k < 3; k++)
+			v[k] = r[k] - s*_e->sv[lcv][k];
+		s = SV_SPEED/sqrt(v[0]*v[0] + v[1]*v[1] + v[2]*v[2]);
+		for(k = 0; k < 3; k++)
+			_e->sv_v[lcv][k] = v[k]*s;
+
+		/* Stronger overhead, with some spread */
+		_e->cn0[lcv] = 36 + 10*sin(el) + 2*gauss();
+		_e->cn0[lcv] = _e->cn0[lcv] > 50 ? 50 : (_e->cn0[lcv] < 30 ? 30 : _e->cn0[lcv]);
+		_e->elev[lcv] = el;
+		sigma = PVT_SIGMA/sqrt(WLS::Weight(_e->cn0[lcv], el));
+
+		_e->pr[lcv] = rho + truth[3] + sigma*gauss();
+		_e->prr[lcv] = (d[0]*(_e->sv_v[lcv][0] - truth[4]) + d[1]*(_e->sv_v[lcv][1] - truth[5]) +
+			d[2]*(_e->sv_v[lcv][2] - truth[6])) + truth[7] + 0.01*sigma*gauss();
+
+		if(lcv == _e->fault)
+			_e->pr[lcv] += _fault*sigma;
+	}
+}
+
+
+//!< What FormModel() does, dircos and both residuals at _s
+void model(Epoch *_e, double *_s, double _H[][4], double *_L, double *_D)
+{
+	double range, relvel;
+	int32 lcv;
+
+	for(lcv = 0; lcv < _e->n; lcv++)
+	{
+		range = sqrt((_s[0] - _e->sv[lcv][0])*(_s[0] - _e->sv[lcv][0]) +
+			(_s[1] - _e->sv[lcv][1])*(_s[1] - _e->sv[lcv][1]) +
+			(_s[2] - _e->sv[lcv][2])*(_s[2] - _e->sv[lcv][2]));
+
+		_L[lcv] = _e->pr[lcv] - (range + _s[3]);
+
+		range = 1.0/range;
+		_H[lcv][0] = (_s[0] - _e->sv[lcv][0])*range;
+		_H[lcv][1] = (_s[1] - _e->sv[lcv][1])*range;
+		_H[lcv][2] = (_s[2] - _e->sv[lcv][2])*range;
+		_H[lcv][3] = 1.0;
+
+		relvel = _H[lcv][0]*(_s[4] - _e->sv_v[lcv][0]) + _H[lcv][1]*(_s[5] - _e->sv_v[lcv][1]) +
+			_H[lcv][2]*(_s[6] - _e->sv_v[lcv][2]);
+		_D[lcv] = _e->prr[lcv] - (relvel + _s[7]);
+	}
+}
+
+
+//!< The solve as it was, returns the GDOP
+double solve_ref(Epoch *_e, double *_s, int32 _warm)
+{
+	double H[MAX_CHANNELS][4], L[MAX_CHANNELS], D[MAX_CHANNELS];
+	double A2[4][4], Ai[4][4], P[4][MAX_CHANNELS], dr[4];
+	double sum, gdop;
+	int32 it, lcv, lcv2, lcv3;
+
+	for(it = 0; it < PVT_ITERATIONS; it++)
+	{
+		model(_e, _s, H, L, D);
+
+		for(lcv = 0; lcv < 4; lcv++)
+			for(lcv2 = 0; lcv2 < 4; lcv2++)
+			{
+				sum = 0;
+				for(lcv3 = 0; lcv3 < _e->n; lcv3++)
+					sum += H[lcv3][lcv]*H[lcv3][lcv2];
+				A2[lcv][lcv2] = sum;
+			}
+
+		Invert4x4(A2, Ai);
+
+		for(lcv = 0; lcv < 4; lcv++)
+			for(lcv2 = 0; lcv2 < _e->n; lcv2++)
+			{
+				sum = 0;
+				for(lcv3 = 0; lcv3 < 4; lcv3++)
+					sum += Ai[lcv][lcv3]*H[lcv2][lcv3];
+				P[lcv][lcv2] = sum;
+			}
+
+		for(lcv = 0; lcv < 4; lcv++)
+		{
+			sum = 0;
+			for(lcv2 = 0; lcv2 < _e->n; lcv2++)
+				sum += P[lcv][lcv2]*L[lcv2];
+			dr[lcv] = sum;
+		}
+		for(lcv = 0; lcv < 4; lcv++)
+			_s[lcv] += dr[lcv];
+
+		for(lcv = 0; lcv < 4; lcv++)
+		{
+			sum = 0;
+			for(lcv2 = 0; lcv2 < _e->n; lcv2++)
+				sum += P[lcv][lcv2]*D[lcv2];
+			_s[4 + lcv] += sum;
+		}
+
+		if(_warm && (fabs(dr[3]) < 1e-4))
+			break;
+	}
+
+	gdop = 0;
+	for(lcv = 0; lcv < 4; lcv++)
+		for(lcv2 = 0; lcv2 < _e->n; lcv2++)
+			gdop += P[lcv][lcv2]*P[lcv][lcv2];
+
+	return(sqrt(gdop));
+}
+
+
+//!< The solve as PointSolution() does it, leaves the covariance in _wls, returns the GDOP
+double solve_wls(WLS *_wls, Epoch *_e, double *_s, double *_w, int32 _warm)
+{
+	double H[MAX_CHANNELS][4], L[MAX_CHANNELS], D[MAX_CHANNELS];
+	double dr[4], dv[4], at[3], dx, dy, dz;
+	int32 it, lcv, factored;
+
+	factored = false;
+	for(it = 0; it < PVT_ITERATIONS; it++)
+	{
+		model(_e, _s, H, L, D);
+
+		dx = _s[0] - at[0];
+		dy = _s[1] - at[1];
+		dz = _s[2] - at[2];
+		if(!factored || ((dx*dx + dy*dy + dz*dz) > PVT_REFACTOR*PVT_REFACTOR))
+		{
+			factored = _wls->Factor(H, _w, _e->n);
+			if(!factored)
+				return(-1);
+			at[0] = _s[0]; at[1] = _s[1]; at[2] = _s[2];
+		}
+
+		_wls->Solve(H, _w, L, D, _e->n, dr, dv);
+		for(lcv = 0; lcv < 4; lcv++)
+		{
+			_s[lcv] += dr[lcv];
+			_s[4 + lcv] += dv[lcv];
+		}
+
+		if(_warm && (fabs(dr[3]) < 1e-4))
+			break;
+	}
+
+	_wls->Covariance();
+
+	return(sqrt(_wls->Trace(0, 4)));
+}
+
+
+//!< Weights as Weights() makes them, returns the scale they were divided by
+double weights(Epoch *_e, double *_w)
+{
+	double sum;
+	int32 lcv;
+
+	sum = 0;
+	for(lcv = 0; lcv < _e->n; lcv++)
+	{
+		_w[lcv] = WLS::Weight(_e->cn0[lcv], _e->elev[lcv]);
+		sum += _w[lcv];
+	}
+
+	for(lcv = 0; lcv < _e->n; lcv++)
+		_w[lcv] /= sum/_e->n;
+
+	return(sum/_e->n);
+}
+
+
+//!< The test RAIM() runs, returns the SV to exclude or -1
+int32 raim(WLS *_wls, Epoch *_e, double *_s, double *_w, double _scale)
+{
+	double H[MAX_CHANNELS][4], L[MAX_CHANNELS], D[MAX_CHANNELS];
+	double red, test, max;
+	int32 lcv, worst;
+
+	if(_e->n < PVT_RAIM_CHANNELS)
+		return(-1);
+
+	model(_e, _s, H, L, D);
+
+	worst = -1;
+	max = PVT_RAIM_THRESHOLD;
+	for(lcv = 0; lcv < _e->n; lcv++)
+	{
+		red = _wls->Redundancy(H[lcv], _w[lcv]);
+		if(red < 1e-6)
+			continue;
+
+		test = fabs(L[lcv])*sqrt(_w[lcv]*_scale)/(PVT_SIGMA*sqrt(red));
+		if(test > max)
+		{
+			max = test;
+			worst = lcv;
+		}
+	}
+
+	return(worst);
+}
+
+
+//!< Take SV _k out of the epoch
+void drop(Epoch *_e, int32 _k)
+{
+	int32 lcv;
+
+	for(lcv = _k; lcv < _e->n - 1; lcv++)
+	{
+		memcpy(_e->sv[lcv], _e->sv[lcv + 1], sizeof(_e->sv[0]));
+		memcpy(_e->sv_v[lcv], _e->sv_v[lcv + 1], sizeof(_e->sv_v[0]));
+		_e->pr[lcv] = _e->pr[lcv + 1];
+		_e->prr[lcv] = _e->prr[lcv + 1];
+		_e->cn0[lcv] = _e->cn0[lcv + 1];
+		_e->elev[lcv] = _e->elev[lcv + 1];
+	}
+	_e->n--;
+}
+
+
+int main(int32 argc, char** argv)
+{
+
+	WLS wls;
+	Epoch e;
+	double s_ref[8], s_wls[8], start[8], ones[MAX_CHANNELS], w[MAX_CHANNELS];
+	double lat, lon, alt, N, g_ref, g_wls, dpos, dgdop, scale;
+	double se_unw, se_w, se_raim, se_none;
+	uint64 t0, t_ref[2], t_wls[2];
+	int32 lcv, k, epochs, warm, n, bad, caught, missed, wrong, false_alarm, err;
+
+	epochs = 2000;
+	if(argc > 1)
+		epochs = atoi(argv[1]);
+
+	/* Somewhere in Colorado, driving, with a clock well off */
+	lat = 40.0*DEG_2_RAD;
+	lon = -105.0*DEG_2_RAD;
+	alt = 1600.0;
+	N = WGS84_MAJOR_AXIS/sqrt(1 - 0.00669438006676*sin(lat)*sin(lat));
+	truth[0] = (N + alt)*cos(lat)*cos(lon);
+	truth[1] = (N + alt)*cos(lat)*sin(lon);
+	truth[2] = (N*(1 - 0.00669438006676) + alt)*sin(lat);
+	truth[3] = 3e4;
+	truth[4] = 12.0; truth[5] = -7.0; truth[6] = 3.0;
+	truth[7] = 60.0;
+
+	for(lcv = 0; lcv < MAX_CHANNELS; lcv++)
+		ones[lcv] = 1.0;
+
+	srand(1);
+	err = 0;
+
+	TSC_Calibrate();
+
+	/* Golden, the unweighted solve must land where the old one did */
+	dpos = dgdop = 0;
+	bad = 0;
+	t_ref[0] = t_ref[1] = t_wls[0] = t_wls[1] = 0;
+	for(lcv = 0; lcv < epochs; lcv++)
+	{
+		n = 5 + (lcv % (MAX_CHANNELS - 4));
+		synth(&e, n, 0);
+
+		for(warm = 0; warm < 2; warm++)
+		{
+			/* A tenth of a second on from the last fix, or nowhere at all */
+			memset(start, 0x0, sizeof(start));
+			if(warm)
+				for(k = 0; k < 8; k++)
+					start[k] = truth[k] + ((k & 3) == 3 ? 5.0 : 1.0)*gauss();
+
+			memcpy(s_ref, start, sizeof(start));
+			t0 = tsc_now();
+			g_ref = solve_ref(&e, s_ref, warm);
+			t_ref[warm] += tsc_now() - t0;
+
+			memcpy(s_wls, start, sizeof(start));
+			t0 = tsc_now();
+			g_wls = solve_wls(&wls, &e, s_wls, ones, warm);
+			t_wls[warm] += tsc_now() - t0;
+
+			for(k = 0; k < 8; k++)
+				if(fabs(s_wls[k] - s_ref[k]) > 1e-3)
+					bad++;
+
+			dpos = fabs(s_wls[0] - s_ref[0]) > dpos ? fabs(s_wls[0] - s_ref[0]) : dpos;
+			dgdop = fabs(g_wls - g_ref) > dgdop ? fabs(g_wls - g_ref) : dgdop;
+		}
+	}
+
+	fprintf(stdout,"Golden    %d epochs, %d states off by > 1 mm, max |dx| %.2e m, max |dGDOP| %.2e\n",
+		epochs, bad, dpos, dgdop);
+	fprintf(stdout,"Warm      Invert4x4 %7.2f us   WLS %7.2f us per solve, %.1fx\n",
+		tsc_ns(t_ref[1]/epochs)/1000.0, tsc_ns(t_wls[1]/epochs)/1000.0, (double)t_ref[1]/t_wls[1]);
+	fprintf(stdout,"Cold      Invert4x4 %7.2f us   WLS %7.2f us per solve, %.1fx\n",
+		tsc_ns(t_ref[0]/epochs)/1000.0, tsc_ns(t_wls[0]/epochs)/1000.0, (double)t_ref[0]/t_wls[0]);
+
+	/* The covariance comes off a factor formed up to PVT_REFACTOR from the fix */
+	if(bad || (dgdop > 1e-3))
+		err++;
+
+	/* Weighting and RAIM, 8 SVs, every other epoch with a fault on one of them */
+	se_unw = se_w = se_raim = se_none = 0;
+	caught = missed = wrong = false_alarm = 0;
+	for(lcv = 0; lcv < epochs; lcv++)
+	{
+		synth(&e, 8, (lcv & 1) ? FAULT : 0);
+
+		for(k = 0; k < 8; k++)
+			start[k] = truth[k];
+
+		/* Fault free epochs, with and without the weights */
+		if(e.fault < 0)
+		{
+			memcpy(s_ref, start, sizeof(start));
+			solve_wls(&wls, &e, s_ref, ones, true);
+			se_unw += error3d(s_ref, truth)*error3d(s_ref, truth);
+		}
+
+		scale = weights(&e, w);
+		memcpy(s_wls, start, sizeof(start));
+		solve_wls(&wls, &e, s_wls, w, true);
+
+		if(e.fault < 0)
+			se_w += error3d(s_wls, truth)*error3d(s_wls, truth);
+		else
+			se_none += error3d(s_wls, truth)*error3d(s_wls, truth);
+
+		k = raim(&wls, &e, s_wls, w, scale);
+		if(e.fault < 0)
+		{
+			false_alarm += (k >= 0);
+			continue;
+		}
+
+		if(k < 0)
+			missed++;
+		else if(k == e.fault)
+			caught++;
+		else
+			wrong++;
+
+		/* Solve again without it, as Navigate() does */
+		if(k >= 0)
+		{
+			drop(&e, k);
+			weights(&e, w);
+			solve_wls(&wls, &e, s_wls, w, true);
+		}
+		se_raim += error3d(s_wls, truth)*error3d(s_wls, truth);
+	}
+
+	n = epochs/2;
+	fprintf(stdout,"Weighting 3D RMS %6.2f m unweighted, %6.2f m weighted\n",
+		sqrt(se_unw/(epochs - n)), sqrt(se_w/(epochs - n)));
+	fprintf(stdout,"RAIM      %.0f sigma fault: %d caught, %d missed, %d wrong SV, %d false alarms in %d clean epochs\n",
+		FAULT, caught, missed, wrong, false_alarm, epochs - n);
+	fprintf(stdout,"          3D RMS %6.2f m with the fault in, %6.2f m after exclusion\n",
+		sqrt(se_none/n), sqrt(se_raim/n));
+
+	if(se_w > se_unw)
+		err++;
+
+	if((caught < 0.9*n) || (false_alarm > 0.01*(epochs - n)))
+		err++;
+
+	return(err);
+
+}
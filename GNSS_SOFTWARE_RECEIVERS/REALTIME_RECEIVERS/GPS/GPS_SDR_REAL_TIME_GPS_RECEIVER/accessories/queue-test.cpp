@@ -0,0 +1,168 @@
+/*! \file Queue_Test.cpp
+	Benchmark the message queues against the anonymous pipes they replaced. Two threads pass
+	128 byte messages, first flat out to get messages/second, then paced to get the one way
+	latency distribution, e.g. queue-test 1000000 100000
+*/
+/************************************************************************************************
+Copyright 2008 Gregory W Heckler
+
+This file is part of the GPS Software Defined Radio (GPS-SDR)
+
+The GPS-SDR is free software; you can redistribute it and/or modify it under the terms of the
+GNU General Public License as published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The GPS-SDR is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with GPS-SDR; if not,
+write to the: 
+
+Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+************************************************************************************************/
+
+#define GLOBALS_HERE
+
+#include "includes.h"
+
+#define QTEST_PACE	(20000)		//!< ns between messages in the latency test
+
+typedef struct Bench_S
+{
+	int64 stamp;				//!< ns, CLOCK_MONOTONIC
+	uint32 seq;
+	uint8 body[116];
+} Bench_S;
+
+int32 use_queue;
+int32 count;
+int32 paced;
+int32 bench_p[2];
+SPSC_Queue<Bench_S, 64> *bench_q;
+int64 *lat;
+
+int64 now_ns()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return((int64)ts.tv_sec*1000000000 + ts.tv_nsec);
+}
+
+void *Producer(void *_arg)
+{
+	Bench_S msg;
+	int64 next;
+	int32 lcv;
+
+	memset(&msg, 0x0, sizeof(Bench_S));
+	next = now_ns();
+
+	for(lcv = 0; lcv < count; lcv++)
+	{
+		if(paced)
+		{
+			next += QTEST_PACE;
+			while(now_ns() < next)
+				;
+		}
+
+		msg.seq = lcv;
+		msg.stamp = now_ns();
+
+		if(use_queue)
+			bench_q->Send(&msg);
+		else
+			write(bench_p[WRITE], &msg, sizeof(Bench_S));
+	}
+
+	return(NULL);
+}
+
+void *Consumer(void *_arg)
+{
+	Bench_S msg;
+	int32 lcv;
+
+	for(lcv = 0; lcv < count; lcv++)
+	{
+		if(use_queue)
+			bench_q->Receive(&msg);
+		else
+			read(bench_p[READ], &msg, sizeof(Bench_S));
+
+		if(msg.seq != (uint32)lcv)
+			fprintf(stdout,"Out of order %d,%d\n", msg.seq, lcv);
+
+		lat[lcv] = now_ns() - msg.stamp;
+	}
+
+	return(NULL);
+}
+
+int compare(const void *_a, const void *_b)
+{
+	int64 a = *(int64 *)_a;
+	int64 b = *(int64 *)_b;
+	return((a > b) - (a < b));
+}
+
+double Run(int32 _queue, int32 _paced, int32 _count)
+{
+	pthread_t prod, cons;
+	int64 t0;
+
+	use_queue = _queue;
+	paced = _paced;
+	count = _count;
+
+	t0 = now_ns();
+	pthread_create(&cons, NULL, Consumer, NULL);
+	pthread_create(&prod, NULL, Producer, NULL);
+	pthread_join(prod, NULL);
+	pthread_join(cons, NULL);
+
+	return(1e-9*(now_ns() - t0));
+}
+
+int main(int32 argc, char** argv)
+{
+
+	int32 blast, pace, lcv;
+	double t;
+
+	blast = 1000000;
+	pace = 100000;
+
+	if(argc > 1)
+		blast = atoi(argv[1]);
+	if(argc > 2)
+		pace = atoi(argv[2]);
+
+	pipe((int *)bench_p);
+	bench_q = new SPSC_Queue<Bench_S, 64>;
+	lat = new int64[blast > pace ? blast : pace];
+
+	fprintf(stdout,"%d byte messages\n", (int32)sizeof(Bench_S));
+	fprintf(stdout,"%-6s %12s %10s %10s %10s %10s\n","","msgs/s","p50 ns","p99 ns","p99.9 ns","max ns");
+
+	for(lcv = 0; lcv < 2; lcv++)
+	{
+		t = Run(lcv, false, blast);
+
+		Run(lcv, true, pace);
+		qsort(lat, pace, sizeof(int64), compare);
+
+		fprintf(stdout,"%-6s %12.0f %10lld %10lld %10lld %10lld\n", lcv ? "queue" : "pipe", blast/t,
+			(long long)lat[pace/2], (long long)lat[(int32)(pace*0.99)],
+			(long long)lat[(int32)(pace*0.999)], (long long)lat[pace-1]);
+	}
+
+	close(bench_p[READ]);
+	close(bench_p[WRITE]);
+	delete bench_q;
+	delete [] lat;
+
+	return(0);
+
+}
@@ -0,0 +1,303 @@
+/*! \file Rate_Test.cpp
+	Run the PVT and the EKF at 10, 50 and 100 Hz (-R) on measurements made up from a set of
+	broadcast ephemerides, a receiver sitting still in Colorado and a perfect clock. Each epoch is
+	what the correlator would have handed over: subframe second, 20 ms and 1 ms epochs, code phase
+	and the carrier phase count over the ICP interval. Reports the CPU time of an epoch (Import,
+	Navigate, Export and the EKF), the rate that could be sustained on one core, the share of a
+	core each rate takes and how often the telemetry is fed, then checks both solutions land on
+	the truth. The fastest rate is run again with epochs lost on the way to the PVT, as the
+	correlator drops them when the PVT's queue is full. Receiver time has to keep pace with the
+	epochs' true times throughout, and once settled the EKF may not reset, at any rate. It
+	also times Kepler's equation started cold and from the last epoch.
+	usage: rate-test [seconds]
+*/
+/************************************************************************************************
+Copyright 2008 Gregory W Heckler
+
+This file is part of the GPS Software Defined Radio (GPS-SDR)
+
+The GPS-SDR is free software; you can redistribute it and/or modify it under the terms of the
+GNU General Public License as published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The GPS-SDR is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with GPS-SDR; if not,
+write to the:
+
+Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+************************************************************************************************/
+
+#define GLOBALS_HERE
+
+#include "includes.h"
+#include "pvt.h"
+#include "ekf.h"
+#include "ephemeris.h"
+#include "channel.h"
+
+#define SVS			(8)			//!< Most SVs tracked
+#define PLANES		(6)			//!< Orbit planes in the made up constellation
+#define SLOTS		(5)			//!< SVs in each
+#define ELEV_MASK	(15.0)		//!< Degrees an SV has to be up to be tracked
+#define TOE			(345600.0)	//!< Ephemeris reference time, and roughly when the run starts
+#define SETTLE		(5.0)		//!< Seconds left out of the accuracy figures
+#define POS_TOL		(10.0)		//!< Meters either solution has to be within once settled
+#define TIME_TOL	(1e-6)		//!< Seconds receiver time may wander from the epochs' true times
+#define DROP_EVERY	(25)		//!< In the drop run, every DROP_EVERY epochs...
+#define DROP_RUN	(3)			//!< ...this many in a row never reach the PVT
+
+Ephemeris_M eph[PLANES*SLOTS];	//!< The constellation
+int32 svs[SVS];					//!< Which of them are tracked
+int32 nsvs;
+double rx[3];					//!< The receiver, ECEF
+
+//!< Pseudorange (meters) of _e seen at GPS time _T, *_tag is the transmit time by the SV's clock
+double transmit(Ephemeris_M *_e, double _T, double *_tag)
+{
+	SV_Position_M s;
+	double tau, cw, sw, x, y, r;
+	int32 lcv;
+
+	tau = _T - 0.075;
+	for(lcv = 0; lcv < 4; lcv++)
+	{
+		SV_Ephemeris(_e, tau, 0, &s);
+
+		/* Into the ECEF frame at reception, as SV_Correct() does it */
+		cw = cos(WGS84OE*(_T - tau));
+		sw = sin(WGS84OE*(_T - tau));
+		x = cw*s.x + sw*s.y;
+		y = -sw*s.x + cw*s.y;
+
+		r = sqrt((x - rx[0])*(x - rx[0]) + (y - rx[1])*(y - rx[1]) + (s.z - rx[2])*(s.z - rx[2]));
+		tau = _T - r*INVERSE_SPEED_OF_LIGHT;
+	}
+
+	SV_Ephemeris(_e, tau, 0, &s);
+	*_tag = tau + s.clock_bias;
+
+	return((_T - *_tag)*SPEED_OF_LIGHT);
+}
+
+
+//!< What the correlator would hand the PVT for _e on _chan at _T, _dtc is the ICP interval
+void measure(Measurement_M *_m, Ephemeris_M *_e, int32 _chan, double _T, double _dtc)
+{
+	double tag, tag2, rem, chips, cycles, pr_a, pr_b;
+
+	transmit(_e, _T, &tag);
+	pr_a = transmit(_e, _T - 0.5*_dtc, &tag2);
+	pr_b = transmit(_e, _T + 0.5*_dtc, &tag2);
+
+	_m->navigate = true;
+	_m->sv = _e->sv;
+	_m->chan = _chan;
+
+	/* Subframe second, then 20 ms, 1 ms and chips into the code */
+	_m->subframe_sec = 6*(int32)floor(tag/6.0);
+	rem = tag - _m->subframe_sec;
+	_m->_20ms_epoch = (int32)floor(rem/.02);
+	rem -= _m->_20ms_epoch*.02;
+	_m->_1ms_epoch = (int32)floor(rem/.001);
+	rem -= _m->_1ms_epoch*.001;
+	chips = rem*CODE_RATE;
+	_m->code_phase = (uint32)floor(chips);
+	_m->frac_code_phase = (uint32)((chips - floor(chips))/TWO_N31);
+
+	/* The carrier NCO runs at IF less the range rate over the ICP interval */
+	cycles = ZERO_DOPPLER_RATE*_dtc - (pr_b - pr_a)/C_OVER_L1;
+	_m->carrier_phase_prev = 0;
+	_m->frac_carrier_phase_prev = 0;
+	_m->carrier_phase = (uint32)floor(cycles);
+	_m->frac_carrier_phase = (uint32)((cycles - floor(cycles))/TWO_N32);
+}
+
+
+//!< Run _secs of receiver time at _hz, 0 if everything came out right. With _drop set some epochs are lost
+int32 run(int32 _hz, double _secs, int32 _drop)
+{
+	ISR_2_PVT_S isr;
+	PVT_2_EKF_S ekf_in;
+	EKF_2_TLM_S ekf_out;
+	double T, dt, dtc, x[3], se_pvt, se_ekf, max_pvt, max_ekf, e, t_off, max_t;
+	uint64 t0, t, t_max;
+	int32 lcv, j, epochs, sent, reports, scored, converged, resets;
+	uint32 last_ticks;
+
+	gopt.meas_int = 1000/_hz;
+	pPVT = new PVT();
+	pEKF = new EKF();
+
+	dt = SECONDS_PER_TICK;
+	dtc = 2*ICP_TICS*dt;
+	epochs = (int32)(_secs*MEASUREMENTS_PER_SECOND);
+
+	t = t_max = 0;
+	sent = reports = scored = converged = resets = 0;
+	last_ticks = 0;
+	t_off = max_t = 0;
+	se_pvt = se_ekf = max_pvt = max_ekf = 0;
+	for(lcv = 0; lcv < epochs; lcv++)
+	{
+		T = TOE + 10.0 + lcv*dt;
+
+		if(_drop && ((lcv % DROP_EVERY) >= (DROP_EVERY - DROP_RUN)))
+			continue;
+		sent++;
+
+		memset(&isr, 0x0, sizeof(ISR_2_PVT_S));
+		isr.preamble.tic_measurement = lcv + 1;
+		for(j = 0; j < nsvs; j++)
+			measure(&isr.measurements[j], &eph[svs[j]], j, T, dtc);
+		ISRM_2_PVT_P->Send(&isr);
+
+		/* Everything the receiver does with an epoch once the correlator is done with it */
+		t0 = tsc_now();
+		pPVT->Import();
+		pPVT->Navigate();
+		pPVT->Export();
+		PVT_2_EKF_P->Receive(&ekf_in);
+		pEKF->Filter(&ekf_in, &ekf_out);
+		t0 = tsc_now() - t0;
+		t += t0;
+		t_max = t0 > t_max ? t0 : t_max;
+
+		reports += PVT_2_TLM_P->getCount();
+		PVT_2_TLM_P->Flush();
+		PVT_2_SVS_P->Flush();
+
+		if(lcv*dt < SETTLE)
+			continue;
+
+		/* Receiver time only moves with the epochs, whatever arrives */
+		if(scored == 0)
+			t_off = ekf_in.clock.receiver_time - lcv*dt;
+		e = fabs(ekf_in.clock.receiver_time - lcv*dt - t_off);
+		max_t = e > max_t ? e : max_t;
+
+		if(ekf_out.state.ekf_ticks < last_ticks)
+			resets++;
+		last_ticks = ekf_out.state.ekf_ticks;
+
+		if(ekf_in.sps.converged)
+			converged++;
+
+		x[0] = ekf_in.sps.x; x[1] = ekf_in.sps.y; x[2] = ekf_in.sps.z;
+		e = error3d(x, rx);
+		se_pvt += e*e;
+		max_pvt = e > max_pvt ? e : max_pvt;
+
+		x[0] = ekf_out.state.x; x[1] = ekf_out.state.y; x[2] = ekf_out.state.z;
+		e = error3d(x, rx);
+		se_ekf += e*e;
+		max_ekf = e > max_ekf ? e : max_ekf;
+
+		scored++;
+	}
+
+	delete pPVT;
+	delete pEKF;
+
+	fprintf(stdout,"%3d Hz  %6d epochs  %6.2f us per epoch, %7.2f max  %8.0f epochs/s on one core  %6.3f%% of a core  %4.1f reports/s%s\n",
+		_hz, sent, tsc_ns(t/sent)/1000.0, tsc_ns(t_max)/1000.0, 1e9*sent/tsc_ns(t),
+		tsc_ns(t/sent)*_hz*1e-7, reports/_secs, _drop ? "  (dropping)" : "");
+	fprintf(stdout,"        %6d converged of %6d, 3D RMS %6.2f m (%6.2f max) point solution, %6.2f m (%6.2f max) EKF\n",
+		converged, scored, sqrt(se_pvt/scored), max_pvt, sqrt(se_ekf/scored), max_ekf);
+	fprintf(stdout,"        receiver time within %.2e s, %d EKF resets\n", max_t, resets);
+
+	if((converged < scored) || (max_pvt > POS_TOL) || (max_ekf > POS_TOL) || (max_t > TIME_TOL) || resets)
+		return(1);
+
+	/* The telemetry and SV select have to stay at REPORT_RATE, less whatever was dropped */
+	if(!_drop && fabs(reports/_secs - (_hz < REPORT_RATE ? _hz : REPORT_RATE)) > 1.0)
+		return(1);
+
+	return(0);
+}
+
+
+int main(int32 argc, char** argv)
+{
+
+	SV_Position_M s;
+	double lat, lon, alt, N, T, dE, d[3], u[3], r, el, secs;
+	uint64 t0, t_cold, t_warm;
+	int32 lcv, sv, err;
+
+	TSC_Calibrate();
+
+	secs = 60.0;
+	if(argc > 1)
+		secs = atof(argv[1]);
+	if(secs <= SETTLE)
+		secs = SETTLE + 1.0;
+
+	/* Somewhere in Colorado, standing still */
+	lat = 40.0*DEG_2_RAD;
+	lon = -105.0*DEG_2_RAD;
+	alt = 1600.0;
+	N = WGS84_MAJOR_AXIS/sqrt(1 - 0.00669438006676*sin(lat)*sin(lat));
+	rx[0] = (N + alt)*cos(lat)*cos(lon);
+	rx[1] = (N + alt)*cos(lat)*sin(lon);
+	rx[2] = (N*(1 - 0.00669438006676) + alt)*sin(lat);
+	u[0] = cos(lat)*cos(lon); u[1] = cos(lat)*sin(lon); u[2] = sin(lat);
+
+	/* Track the first SVS that are up */
+	constellation_gen(eph, NULL, PLANES, SLOTS, TOE);
+	nsvs = 0;
+	for(sv = 0; (sv < PLANES*SLOTS) && (nsvs < SVS); sv++)
+	{
+		SV_Ephemeris(&eph[sv], TOE, 0, &s);
+		d[0] = s.x - rx[0]; d[1] = s.y - rx[1]; d[2] = s.z - rx[2];
+		r = sqrt(d[0]*d[0] + d[1]*d[1] + d[2]*d[2]);
+		el = asin((d[0]*u[0] + d[1]*u[1] + d[2]*u[2])/r);
+		if(el > ELEV_MASK*DEG_2_RAD)
+			svs[nsvs++] = sv;
+	}
+
+	fprintf(stdout,"Tracking %d SVs over %.0f s at each rate\n", nsvs, secs);
+	if(nsvs < 5)
+		return(1);
+
+	/* What the PVT needs around it */
+	Pipes_Init();
+	pEphemeris = new Ephemeris;
+	for(lcv = 0; lcv < PLANES*SLOTS; lcv++)
+		pEphemeris->setEphemeris(&eph[lcv]);
+	for(lcv = 0; lcv < MAX_CHANNELS; lcv++)
+		pChannels[lcv] = new Channel(lcv);
+
+	/* Kepler's equation from M, and from where it ended one 100 Hz epoch earlier */
+	t_cold = t_warm = 0;
+	dE = 0;
+	for(lcv = 0; lcv < 100000; lcv++)
+	{
+		T = TOE + lcv*.01;
+
+		t0 = tsc_now();
+		SV_Ephemeris(&eph[svs[0]], T, 0, &s);
+		t_cold += tsc_now() - t0;
+
+		t0 = tsc_now();
+		dE = SV_Ephemeris(&eph[svs[0]], T, dE, &s);
+		t_warm += tsc_now() - t0;
+	}
+	fprintf(stdout,"SV position %.1f ns started cold, %.1f ns from the last epoch\n",
+		tsc_ns(t_cold)/100000.0, tsc_ns(t_warm)/100000.0);
+
+	err = 0;
+	err += run(10, secs, false);
+	err += run(50, secs, false);
+	err += run(MEASUREMENT_RATE_MAX, secs, false);
+	err += run(MEASUREMENT_RATE_MAX, secs, true);
+
+	for(lcv = 0; lcv < MAX_CHANNELS; lcv++)
+		delete pChannels[lcv];
+	delete pEphemeris;
+
+	return(err);
+
+}
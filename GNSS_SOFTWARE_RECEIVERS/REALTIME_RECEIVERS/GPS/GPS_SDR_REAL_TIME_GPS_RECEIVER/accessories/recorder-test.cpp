@@ -0,0 +1,93 @@
+/*! \file Recorder_Test.cpp
+	Push packets through the Recorder at a multiple of real time and report the sustained
+	write rate and the dropped/stale/late counts. Point it at a tmpfs or a loop device mount
+	to separate the recorder from the disk, e.g. recorder-test /mnt/loop 10 4
+*/
+/************************************************************************************************
+Copyright 2008 Gregory W Heckler
+
+This file is part of the GPS Software Defined Radio (GPS-SDR)
+
+The GPS-SDR is free software; you can redistribute it and/or modify it under the terms of the
+GNU General Public License as published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The GPS-SDR is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with GPS-SDR; if not,
+write to the: 
+
+Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+************************************************************************************************/
+
+#define GLOBALS_HERE
+
+#include "includes.h"
+#include "fifo.h"
+#include "recorder.h"
+
+int main(int32 argc, char** argv)
+{
+
+	struct timeval t0, t1;
+	ms_packet *buff;
+	const char *path;
+	double seconds, speed, t, mb;
+	int32 lcv, ms, total;
+
+	path = ".";
+	seconds = 10;
+	speed = 1;
+
+	if(argc > 1)
+		path = argv[1];
+	if(argc > 2)
+		seconds = atof(argv[2]);
+	if(argc > 3)
+		speed = atof(argv[3]);
+
+	/* Stand in for the FIFO */
+	buff = new ms_packet[FIFO_DEPTH];
+	for(lcv = 0; lcv < FIFO_DEPTH; lcv++)
+		memset(buff[lcv].data, lcv, sizeof(buff[lcv].data));
+
+	gettimeofday(&starttime, NULL);
+	grun = 0x1;
+
+	pRecorder = new Recorder(path, 2, 0);
+	pRecorder->Start();
+
+	total = (int32)(seconds*1000);
+
+	gettimeofday(&t0, NULL);
+
+	/* Produce 1 ms packets at speed x real time, like GPS_Source::Read */
+	for(ms = 0; ms < total; ms++)
+	{
+		buff[ms % FIFO_DEPTH].count = ms;
+		pRecorder->Push(&buff[ms % FIFO_DEPTH]);
+
+		gettimeofday(&t1, NULL);
+		t = 1e3*(t1.tv_sec - t0.tv_sec) + 1e-3*(t1.tv_usec - t0.tv_usec);
+		if(t < (ms+1)/speed)
+			usleep((int32)(1e3*((ms+1)/speed - t)));
+	}
+
+	grun = 0;
+	pRecorder->Stop();
+	delete pRecorder;
+
+	gettimeofday(&t1, NULL);
+	t = (t1.tv_sec - t0.tv_sec) + 1e-6*(t1.tv_usec - t0.tv_usec);
+	mb = (double)total*2*SAMPS_MS*sizeof(CPX)/1048576.0;
+
+	fprintf(stdout,"%d ms x 2 antennas at %.1fx real time: %.1f MB in %.2f s, %.1f MB/s\n",
+		total, speed, mb, t, mb/t);
+
+	delete [] buff;
+
+	return(0);
+
+}
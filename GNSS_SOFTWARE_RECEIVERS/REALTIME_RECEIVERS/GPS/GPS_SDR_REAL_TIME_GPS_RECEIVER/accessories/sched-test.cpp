@@ -0,0 +1,241 @@
+/*! \file Sched_Test.cpp
+	Replay a recorded IF file through a correlator sized load once a millisecond, first with the
+	thread floating and then pinned (and SCHED_FIFO if allowed), while other threads thrash the
+	caches. Compares the run time and deadline lateness of both,
+	e.g. sched-test data.dba <cpu> <ms> <loaders>
+*/
+/************************************************************************************************
+Copyright 2008 Gregory W Heckler
+
+This file is part of the GPS Software Defined Radio (GPS-SDR)
+
+The GPS-SDR is free software; you can redistribute it and/or modify it under the terms of the
+GNU General Public License as published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The GPS-SDR is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with GPS-SDR; if not,
+write to the:
+
+Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+************************************************************************************************/
+
+#define GLOBALS_HERE
+
+#include "includes.h"
+
+#define SCHED_TEST_PRIORITY	(80)				//!< SCHED_FIFO priority of the pinned run
+#define SCHED_TEST_LOAD		(4*1024*1024)		//!< Bytes each loader thread streams through
+
+/*! Correlate every channel against each 1 ms of the file, paced by the clock */
+class Jitter : public Threaded_Object
+{
+	public:
+
+		CPX *data;			//!< The recording
+		int32 ms;			//!< Length of the recording
+		CPX *sine;			//!< Per channel carrier
+		MIX *code;			//!< Per channel code
+		CPX *scratch;		//!< Wiped off data
+		int32 done;			//!< Set when the last ms is processed
+
+		Jitter(CPX *_data, int32 _ms);
+		~Jitter();
+		void Start();
+		void Run();
+};
+
+void *Jitter_Thread(void *_arg)
+{
+	((Jitter *)_arg)->Run();
+	pthread_exit(0);
+}
+
+Jitter::Jitter(CPX *_data, int32 _ms):Threaded_Object("JITTASK")
+{
+	int32 lcv, chan;
+
+	data = _data;
+	ms = _ms;
+	done = 0;
+
+	sine = new CPX[MAX_CHANNELS*SAMPS_MS];
+	code = new MIX[MAX_CHANNELS*SAMPS_MS];
+	scratch = new CPX[SAMPS_MS];
+
+	for(chan = 0; chan < MAX_CHANNELS; chan++)
+	{
+		for(lcv = 0; lcv < SAMPS_MS; lcv++)
+		{
+			sine[chan*SAMPS_MS + lcv].i = (int16)(8192*cos(TWO_PI*(1000.0*chan + IF_FREQUENCY)*lcv/SAMPS_MS/1000.0));
+			sine[chan*SAMPS_MS + lcv].q = (int16)(8192*sin(TWO_PI*(1000.0*chan + IF_FREQUENCY)*lcv/SAMPS_MS/1000.0));
+			code[chan*SAMPS_MS + lcv].i = code[chan*SAMPS_MS + lcv].q = (rand() & 1) ? 1 : -1;
+			code[chan*SAMPS_MS + lcv].ni = code[chan*SAMPS_MS + lcv].nq = -code[chan*SAMPS_MS + lcv].i;
+		}
+	}
+}
+
+Jitter::~Jitter()
+{
+	delete [] sine;
+	delete [] code;
+	delete [] scratch;
+}
+
+void Jitter::Start()
+{
+	Start_Thread(Jitter_Thread, this);
+}
+
+void Jitter::Run()
+{
+	CPX_ACCUM EPL[3];
+	struct timespec deadline;
+	uint64 t0, per_ms;
+	int32 lcv, chan;
+
+	per_ms = (1000000ULL << 16) / tsc_mult;
+
+	clock_gettime(CLOCK_MONOTONIC, &deadline);
+	t0 = tsc_now();
+
+	for(lcv = 0; lcv < ms; lcv++)
+	{
+		deadline.tv_nsec += 1000000;
+		if(deadline.tv_nsec >= 1000000000)
+		{
+			deadline.tv_nsec -= 1000000000;
+			deadline.tv_sec++;
+		}
+		clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL);
+
+		/* The "message" was the 1 ms deadline, so the wake histogram is the lateness */
+		queue_stamp = t0 + (lcv + 1)*per_ms;
+		IncStartTic();
+
+		for(chan = 0; chan < MAX_CHANNELS; chan++)
+		{
+			sse_cmulsc(&data[lcv*SAMPS_MS], &sine[chan*SAMPS_MS], scratch, SAMPS_MS, 14);
+			sse_prn_accum_new(scratch, &code[chan*SAMPS_MS], &code[chan*SAMPS_MS], &code[chan*SAMPS_MS], SAMPS_MS, &EPL[0]);
+		}
+
+		IncStopTic();
+		IncExecTic();
+	}
+
+	done = 1;
+}
+
+/*! Something else on the box wanting the cpus and the cache */
+void *Loader_Thread(void *_arg)
+{
+	char *buff;
+	int32 lcv;
+
+	buff = new char[SCHED_TEST_LOAD];
+
+	for(lcv = 0; *(volatile int32 *)_arg; lcv++)
+		memset(buff, lcv, SCHED_TEST_LOAD);
+
+	delete [] buff;
+	pthread_exit(0);
+}
+
+/*! One pass, returns the p99.9 lateness */
+uint32 Pass(CPX *_data, int32 _ms, const char *_name)
+{
+	Jitter *jitter;
+	uint32 late;
+
+	fprintf(stdout,"\n%s:\n", _name);
+
+	jitter = new Jitter(_data, _ms);
+	jitter->Start();
+	while(!jitter->done)
+		usleep(100000);
+	jitter->Stop();
+
+	jitter->PrintLatency(stdout);
+	late = jitter->getWakeHist()->getPercentile(0.999);
+
+	delete jitter;
+
+	return(late);
+}
+
+int main(int32 argc, char** argv)
+{
+
+	FILE *fp;
+	CPX *data;
+	pthread_t *loaders;
+	int32 cpu, ms, num_loaders, run, got, lcv;
+	uint32 unpinned, pinned;
+
+	if(argc < 2)
+	{
+		fprintf(stdout,"usage: sched-test <file> [cpu] [ms] [loaders]\n");
+		return(-1);
+	}
+
+	cpu = (argc > 2) ? atoi(argv[2]) : 0;
+	ms = (argc > 3) ? atoi(argv[3]) : 5000;
+	num_loaders = (argc > 4) ? atoi(argv[4]) : sysconf(_SC_NPROCESSORS_ONLN);
+
+	gettimeofday(&starttime, NULL);
+	memset(&gopt, 0x0, sizeof(Options_S));
+	srand(1);
+
+	/* Pull the whole recording in up front, repeating it if it is short */
+	fp = fopen(argv[1], "rb");
+	if(fp == NULL)
+	{
+		fprintf(stdout,"Could not open %s\n", argv[1]);
+		return(-1);
+	}
+
+	data = new CPX[ms*SAMPS_MS];
+	got = fread(data, sizeof(CPX)*SAMPS_MS, ms, fp);
+	fclose(fp);
+	if(got <= 0)
+	{
+		fprintf(stdout,"%s is shorter than 1 ms\n", argv[1]);
+		return(-1);
+	}
+	for(lcv = got; lcv < ms; lcv++)
+		memcpy(&data[lcv*SAMPS_MS], &data[(lcv % got)*SAMPS_MS], sizeof(CPX)*SAMPS_MS);
+
+	fprintf(stdout,"%d ms of %s, %d channels, %d loader threads\n", ms, argv[1], MAX_CHANNELS, num_loaders);
+
+	run = 1;
+	loaders = new pthread_t[num_loaders];
+	for(lcv = 0; lcv < num_loaders; lcv++)
+		pthread_create(&loaders[lcv], NULL, Loader_Thread, &run);
+
+	unpinned = Pass(data, ms, "Unpinned");
+
+	/* Same thing through the -a path the receiver uses */
+	strcpy(gopt.sched[0].task_name, "JIT");
+	gopt.sched[0].cpus = 1 << cpu;
+	gopt.sched[0].policy = SCHED_FIFO;
+	gopt.sched[0].priority = SCHED_TEST_PRIORITY;
+	gopt.num_sched = 1;
+
+	pinned = Pass(data, ms, "Pinned");
+
+	run = 0;
+	for(lcv = 0; lcv < num_loaders; lcv++)
+		pthread_join(loaders[lcv], NULL);
+
+	fprintf(stdout,"\np99.9 lateness: unpinned %.1f us, pinned %.1f us\n", unpinned/1000.0, pinned/1000.0);
+
+	delete [] loaders;
+	delete [] data;
+
+	return(0);
+
+}
+/*----------------------------------------------------------------------------------------------*/
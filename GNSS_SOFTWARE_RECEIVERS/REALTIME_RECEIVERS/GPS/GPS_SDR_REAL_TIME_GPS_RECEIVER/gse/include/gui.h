@@ -32,6 +32,8 @@ Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1
 #include "commands.h"			//!< RS422 commands
 #include <termios.h>			//!< Serial stuff
 #include <signal.h>				//!< Pipe stuff
+#include <poll.h>				//!< Sleep on the pipe
+#include <errno.h>
 /*----------------------------------------------------------------------------------------------*/
 
 /* wxWidgets headers */
@@ -26,6 +26,8 @@ Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1
 #include "gui.h"
 
 #define COMMAND_BUFFER_DEPTH	(256)
+#define GUI_READ_TIMEOUT		(500)		//!< ms Read() waits on the receiver before dropping the pipe
+#define GUI_OPEN_RETRY			(100000)	//!< us between attempts to open the pipe
 
 /*! \ingroup CLASSES
  *
@@ -53,6 +53,7 @@ GUI_Messages::GUI_Messages():iGUI_Messages(NULL, wxID_ANY, wxT("Messages"), wxDe
 	mname[EPHEMERIS_STATUS_M_ID] = wxT("Ephemeris Status   ");
 	mname[SV_SELECT_STATUS_M_ID] = wxT("SV Select Status   ");
 	mname[SV_PREDICTION_M_ID]    = wxT("SV Prediction      ");
+	mname[BUDGET_M_ID]           = wxT("Budget             ");
 	mname[BOARD_HEALTH_M_ID]     = wxT("Board Health       ");
 	mname[EEPROM_M_ID]           = wxT("EEPROM             ");
 	mname[EEPROM_CHKSUM_M_ID]    = wxT("EEPROM Checksum    ");
@@ -66,6 +66,7 @@ static uint32 SIZEOF_M[LAST_M_ID + 1] =
 	sizeof(Measurement_M),
 	sizeof(Pseudorange_M),
 	sizeof(SV_Prediction_M),
+	sizeof(Budget_M),
 	0,
 	sizeof(EKF_State_M),
 	sizeof(EKF_Covariance_M),
@@ -316,6 +317,10 @@ void GUI_Serial::Import()
 			openSerial();
 		else
 			openPipe();
+
+		/* Receiver not there yet, do not spin on it */
+		if(npipe_open == false)
+			usleep(GUI_OPEN_RETRY);
 	}
 
 	execution_tic++;
@@ -401,30 +406,38 @@ void endian_swap(void *_b, int32 _bytes, int32 _flag)
 int GUI_Serial::Read(void *_b, int32 _bytes)
 {
 
-	int32 nbytes, bread, k;
+	int32 nbytes, bread, ready;
+	struct pollfd pfd;
 	uint8 *buff;
 
-	k = 0; nbytes = 0; bread = 0;
+	nbytes = 0; bread = 0;
 	buff = (uint8 *)_b;
 
 	while((nbytes < _bytes) && grun && npipe_open)
 	{
-		bread = read(npipe[READ], buff, _bytes - nbytes);
+		/* Sleep until the receiver writes something, rather than polling the read */
+		pfd.fd = npipe[READ];
+		pfd.events = POLLIN;
+		pfd.revents = 0;
+		ready = poll(&pfd, 1, GUI_READ_TIMEOUT);
 
-		if(bread > -1)
-		{
-			nbytes += bread;
-			buff += bread;
-		}
+		if((ready < 0) && (errno == EINTR))
+			continue;
 
-		if(k++ > 5000)
+		/* Nothing for GUI_READ_TIMEOUT, or the receiver went away */
+		if((ready <= 0) || ((pfd.revents & (POLLHUP | POLLERR)) && !(pfd.revents & POLLIN)))
 		{
 			closePipe();
 			return(0);
 		}
 
-		usleep(100);
+		bread = read(npipe[READ], buff, _bytes - nbytes);
 
+		if(bread > 0)
+		{
+			nbytes += bread;
+			buff += bread;
+		}
 	}
 
 	//endian_swap(_b, _bytes, _bytes <= 6);
@@ -696,6 +709,10 @@ void GUI_Serial::readGPS()
 					packet_count[LAST_M_ID]++;
 				}
 				break;
+			case BUDGET_M_ID:
+				FixDoubles((void *)&src->budget, 1);
+				memcpy(&dst->budget, &src->budget, sizeof(Budget_M));
+				break;
 			case COMMAND_ACK_M_ID:
 				memcpy(&dst->command_ack, &src->command_ack, sizeof(Command_Ack_M));
 				command_ack = 1;
@@ -1402,10 +1419,16 @@ void GUI_Serial::printTask()
 		for(lcv = 0; lcv < MAX_TASKS; lcv++)
 			fprintf(lfile,"%d,",pTask->start_tic[lcv]);
 
-		for(lcv = 0; lcv < MAX_TASKS-1; lcv++)
+		for(lcv = 0; lcv < MAX_TASKS; lcv++)
 			fprintf(lfile,"%d,",pTask->stop_tic[lcv]);
 
-		fprintf(lfile,"%d\n",pTask->stop_tic[lcv]);
+		for(lcv = 0; lcv < MAX_TASKS; lcv++)
+			fprintf(lfile,"%u,%u,%u,%u,",pTask->run_p50[lcv],pTask->run_p99[lcv],pTask->run_p999[lcv],pTask->run_max[lcv]);
+
+		for(lcv = 0; lcv < MAX_TASKS-1; lcv++)
+			fprintf(lfile,"%u,%u,%u,%u,",pTask->wake_p50[lcv],pTask->wake_p99[lcv],pTask->wake_p999[lcv],pTask->wake_max[lcv]);
+
+		fprintf(lfile,"%u,%u,%u,%u\n",pTask->wake_p50[lcv],pTask->wake_p99[lcv],pTask->wake_p999[lcv],pTask->wake_max[lcv]);
 	}
 }
 /*----------------------------------------------------------------------------------------------*/
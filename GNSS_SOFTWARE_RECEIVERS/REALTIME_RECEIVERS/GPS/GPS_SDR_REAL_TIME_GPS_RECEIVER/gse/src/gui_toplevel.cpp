@@ -455,6 +455,7 @@ void GUI_Toplevel::renderTask()
 {
 	int32 lcv;
 	Task_Health_M *pTask;
+	Budget_M *pBudget;
 
 	wxString str;
 	wxString names[MAX_TASKS];
@@ -475,33 +476,52 @@ void GUI_Toplevel::renderTask()
 
 	pTask = &messages.task_health;
 
-	str = wxT("Task        Execution Tic   Delta     Start Tic    Stop Tic\n");
+	str = wxT("Task        Execution Tic   Delta     Start Tic    Stop Tic  Run p99 us  Wake p99 us\n");
 	tTask->AppendText(str);
-	str = wxT("-----------------------------------------------------------\n");
+	str = wxT("-------------------------------------------------------------------------------------\n");
 	tTask->AppendText(str);
 
 	for(lcv = 0; lcv < MAX_TASKS-1; lcv++)
 	{
 		if(names[lcv].Len())
 		{
-			str.Printf(wxT("%s   %10u %7d    %10u  %10u\n"),
+			str.Printf(wxT("%s   %10u %7d    %10u  %10u  %10.1f  %11.1f\n"),
 				names[lcv].c_str(),
 				pTask->execution_tic[lcv],
 				pTask->stop_tic[lcv]-pTask->start_tic[lcv],
 				pTask->start_tic[lcv],
-				pTask->stop_tic[lcv]);
+				pTask->stop_tic[lcv],
+				pTask->run_p99[lcv]/1e3,
+				pTask->wake_p99[lcv]/1e3);
 			tTask->AppendText(str);
 		}
 	}
 
 	if(names[lcv].Len())
 	{
-		str.Printf(wxT("%s   %10u %7d    %10u  %10u\n"),
+		str.Printf(wxT("%s   %10u %7d    %10u  %10u  %10.1f  %11.1f\n"),
 			names[lcv].c_str(),
 			pTask->execution_tic[lcv],
 			pTask->stop_tic[lcv]-pTask->start_tic[lcv],
 			pTask->start_tic[lcv],
-			pTask->stop_tic[lcv]);
+			pTask->stop_tic[lcv],
+			pTask->run_p99[lcv]/1e3,
+			pTask->wake_p99[lcv]/1e3);
+		tTask->AppendText(str);
+	}
+
+	/* Correlator real-time budget, cycles are TSC ticks per 1 ms */
+	pBudget = &messages.budget;
+	if(pBudget->tsc_khz)
+	{
+		str.Printf(wxT("\nCorrelator: %7.1f us/ms mean  %7.1f us peak  %5.1fx real time  %u ms over\n"),
+			pBudget->correlate_cycles*1e3/pBudget->tsc_khz,
+			pBudget->correlate_peak*1e3/pBudget->tsc_khz,
+			pBudget->headroom,
+			pBudget->overruns);
+		tTask->AppendText(str);
+
+		str.Printf(wxT("FIFO:       %7u ms mean  %7u ms peak\n"), pBudget->fifo_depth, pBudget->fifo_peak);
 		tTask->AppendText(str);
 	}
 
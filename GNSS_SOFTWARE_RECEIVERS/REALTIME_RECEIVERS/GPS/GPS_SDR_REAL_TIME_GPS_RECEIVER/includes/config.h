@@ -42,8 +42,12 @@
 #define MAX_CHANNELS			(12)						//!< Number of channel objects
 #define CPU_CORES				(2)							//!< 1 for a single core, 2 for a dual core system, etc
 #define CORR_PER_CPU			(MAX_CHANNELS/CPU_CORES)	//!< Distribute them up evenly (this should be an INTEGER!)
+#define LOOP_BANKS				((MAX_CHANNELS+3)/4)		//!< The tracking loops are swept 4 channels at a time
 #define MAX_ANTENNAS			(2)							//!< The number of antennas
 #define TASK_STACK_SIZE			(2048)						//!< For Nucleus/Linux compatibility
+#define MAX_SCHED_OPTIONS		(16)						//!< Number of -a task scheduling options
+#define PREFAULT_STACK_SIZE		(64*1024)					//!< Stack touched by each thread when memory is locked
+#define THREAD_STOP_KICK		(1000)						//!< us between wake up signals to a thread that has not stopped
 /*----------------------------------------------------------------------------------------------*/
 
 
@@ -66,6 +70,8 @@
 #define MAX_DOPPLER_MEDIUM		(15000)			//!< Cold Doppler search space for strong signal
 #define MAX_DOPPLER_WEAK		(15000)			//!< Cold Doppler search space for weak signal
 #define MAX_DOPPLER_WARM		(1000)			//!< Search this much Doppler space if state information is available
+#define PREDICT_PERIOD			(1000)			//!< ms between sweeps of the whole constellation's Doppler/visibility prediction
+#define PREDICT_BANKS			((MAX_SV+3)/4)	//!< The prediction is swept 4 SVs at a time
 #define ACQ_OPERATION_STRONG	(ACQ_OPERATION_COLD)	//!< Acq strong mode (2 = cold & warm)
 #define ACQ_OPERATION_MEDIUM	(ACQ_OPERATION_DISABLED)//!< Acq strong mode (2 = cold & warm)
 #define ACQ_OPERATION_WEAK		(ACQ_OPERATION_DISABLED)//!< Acq weak mode (2 = warm only)
@@ -86,13 +92,46 @@
 
 /* Measurement/PVT Defines */
 /*----------------------------------------------------------------------------------------------*/
-#define MEASUREMENT_INT			(100)		//!< Packets of ~1ms data
+#define MEASUREMENT_RATE		(10)		//!< Default measurements per second, -R sets it at startup
+#define MEASUREMENT_RATE_MAX	(100)		//!< Fastest -R, it has to divide 1000
+#define MEASUREMENT_INT			(gopt.meas_int)	//!< Packets of ~1ms data, from -R
 #define ICP_TICS				(1)			//!< Number of measurement ints (plus-minus) to calculate ICP,
 											//!< this cannot exceed TICS_PER_SECOND/2 !!!!
-#define MEASUREMENTS_PER_SECOND	(10)
-#define SECONDS_PER_TICK		(.1)
+#define MEASUREMENT_DEPTH		(2*ICP_TICS + 1)	//!< Measurements the correlator holds back for the ICP
+#define MEASUREMENTS_PER_SECOND	(1000/gopt.meas_int)
+#define SECONDS_PER_TICK		(gopt.meas_int*.001)
+#define REPORT_RATE				(10)		//!< Telemetry, SV select and GUI updates per second at any -R
+#define REPORT_DECIMATION		((MEASUREMENTS_PER_SECOND > REPORT_RATE) ? MEASUREMENTS_PER_SECOND/REPORT_RATE : 1)
 #define PVT_ITERATIONS			(10)		//!< Max number of PVT iterations
+#define PVT_REFACTOR			(100.0)		//!< Meters the solution may move before the geometry is factored again
+#define PVT_CN0_REF				(40.0)		//!< C/N0 (dB-Hz) of a zenith SV that gets a weight of 1 with -W
+#define PVT_ELEV_MIN			(10.0)		//!< Elevations (degrees) below this are weighted as this with -W
+#define PVT_SIGMA				(3.0)		//!< Pseudorange noise (meters) of a weight of 1, for the RAIM test
+#define PVT_RAIM_THRESHOLD		(5.0)		//!< Normalized residual that gets an SV excluded with -W
+#define PVT_RAIM_CHANNELS		(6)			//!< SVs needed to exclude one and still check the rest
 #define MEASUREMENT_MOD			(1)			//!< Slow down measurement transmission to the PVT
+#define ORBIT_NODE_EPHEMERIS	(30.0)		//!< Seconds between exact ephemeris evaluations the orbit cache interpolates
+#define ORBIT_NODE_ALMANAC		(300.0)		//!< Same for the almanac, which is only good to a few km anyway
+/*----------------------------------------------------------------------------------------------*/
+
+
+/* EKF Defines */
+/*----------------------------------------------------------------------------------------------*/
+#define EKF_SIGMA_PR			(5.0)			//!< Pseudorange noise (meters)
+#define EKF_SIGMA_PRR			(0.1)		//!< Pseudorange rate noise (meters/sec)
+#define EKF_ACCEL_PSD			(1.0)		//!< White acceleration per axis ((meters/sec^2)^2/Hz)
+#define EKF_BIAS_PSD			(0.1)		//!< Clock phase noise (meters^2/sec)
+#define EKF_RATE_PSD			(0.5)		//!< Clock frequency noise ((meters/sec)^2/sec)
+#define EKF_INIT_POS			(100.0)		//!< Position sigma (meters) off the point solution
+#define EKF_INIT_VEL			(5.0)		//!< Velocity sigma (meters/sec) off the point solution
+#define EKF_INIT_BIAS			(100.0)		//!< Clock bias sigma (meters) off the point solution
+#define EKF_INIT_RATE			(10.0)		//!< Clock rate sigma (meters/sec) off the point solution
+#define EKF_GATE				(5.0)		//!< Innovations beyond this many sigmas are rejected
+#define EKF_CONVERGED_POS		(30.0)		//!< Position sigma (meters) under which the filter is converged
+#define EKF_MAX_POS				(1000.0)	//!< Position sigma (meters) that starts the filter over
+#define EKF_MAX_VEL				(100.0)		//!< Velocity sigma (meters/sec) that starts the filter over
+#define EKF_MAX_REJECTS			(10)		//!< Epochs in a row with every measurement rejected that start it over
+#define EKF_MAX_DT				(10.0)		//!< Gap (seconds) between epochs that starts it over
 /*----------------------------------------------------------------------------------------------*/
 
 
@@ -103,6 +142,8 @@
 //#define OVERFLOW_HIGH			(1024)		//!< Overflow high
 #define OVERFLOW_LOW			(64)		//!< Overflow low
 #define OVERFLOW_HIGH			(512)		//!< Overflow high
+#define AGC_SHIFT				(6)			//!< Nominal requantizer shift for the USRP, the DBS-RX gain is steered to hold it
+#define AGC_PERIOD				(256)		//!< ms between AGC updates, power of 2
 /*----------------------------------------------------------------------------------------------*/
 
 
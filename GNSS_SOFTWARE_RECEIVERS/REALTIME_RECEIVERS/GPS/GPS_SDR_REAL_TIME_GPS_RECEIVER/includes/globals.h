@@ -39,15 +39,22 @@
 EXTERN class Keyboard		*pKeyboard;						//!< Handle user input
 EXTERN class FIFO			*pFIFO;							//!< Get data and pass it into the receiver
 EXTERN class PVT			*pPVT;							//!< Do the PVT solution
+EXTERN class EKF			*pEKF;							//!< Filter the PVT's measurements
 EXTERN class Ephemeris		*pEphemeris;					//!< Extract the ephemeris
 EXTERN class Acquisition	*pAcquisition;					//!< Perform acquisitions
 EXTERN class Correlator		*pCorrelator;					//!< Correlator
 EXTERN class Channel		*pChannels[MAX_CHANNELS];		//!< Channels (uses correlations to close the loops)
+EXTERN class Tracking		*pTracking;						//!< Runs the channels' loops off the correlator thread
 EXTERN class SV_Select		*pSV_Select;					//!< Contains the channels and drives the channel objects
+EXTERN class Predictor		*pPredictor;					//!< Predicts the whole constellation for SV_Select
 EXTERN class Telemetry		*pTelemetry;					//!< Simple ncurses interface
 EXTERN class Commando		*pCommando;						//!< Process and execute commands
 EXTERN class GPS_Source		*pSource;						//!< Get the GPS data from somewhere
 EXTERN class Patience		*pPatience;						//!< Watchdog for GPS Source
+EXTERN class Recorder		*pRecorder;						//!< Write the IF data to disk (NULL when not recording)
+EXTERN class Metrics		*pMetrics;						//!< Serve the counters to monitoring (NULL without -M)
+EXTERN class Chan_Log		*pChanLog;						//!< Write the -c channel log (NULL without -c)
+EXTERN class Freq_Lock		*pFreqLock;						//!< The channels' frequency search, shared read-only
 /*----------------------------------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------------------------------*/
@@ -57,28 +64,31 @@ EXTERN struct timeval starttime;					//!< Get receiver start time
 /*----------------------------------------------------------------------------------------------*/
 
 
-/* Part 3, Pipes */
+/* Part 3, Queues (historically pipes, hence the _P) */
 /*----------------------------------------------------------------------------------------------*/
 /* Interplay between acquisition and tracking */
-EXTERN int32 SVS_2_COR_P[2];						//!< \ingroup PIPES Send an acquisition result to the correlator to start a channel
-EXTERN int32 CHN_2_EPH_P[2];						//!< \ingroup PIPES Output raw subframes to Ephemeris
-EXTERN int32 PVT_2_TLM_P[2];						//!< \ingroup PIPES Output PVT state to Telemetry
-EXTERN int32 SVS_2_TLM_P[2];						//!< \ingroup PIPES Output predicted SV states to Telemetry
-EXTERN int32 EKF_2_TLM_P[2];						//!< \ingroup PIPES Output EKF state to Telemetry
-EXTERN int32 CMD_2_TLM_P[2];						//!< \ingroup PIPES Output results of commands to Telemetry
-EXTERN int32 ACQ_2_SVS_P[2];						//!< \ingroup PIPES Request an acquisition because some of the channels are empty
-EXTERN int32 EKF_2_SVS_P[2];						//!< \ingroup PIPES Output EKF state to SV Select
-EXTERN int32 PVT_2_SVS_P[2];						//!< \ingroup PIPES Output PVT state to SV Select
-EXTERN int32 TLM_2_CMD_P[2];						//!< \ingroup PIPES Output received commands to Commando
-EXTERN int32 SVS_2_ACQ_P[2];						//!< \ingroup PIPES Request an acquisition because some of the channels are empty
-EXTERN int32 COR_2_ACQ_P[2];						//!< \ingroup PIPES Output packets of IF data to the Acquisition
-EXTERN int32 ISRP_2_PVT_P[2];						//!< \ingroup PIPES Output measurement preamble to PVT
-EXTERN int32 ISRM_2_PVT_P[2];						//!< \ingroup PIPES Output measurements to PVT
+EXTERN SPSC_Queue<Acq_Command_S, 16> *SVS_2_COR_P;			//!< \ingroup PIPES Send an acquisition result to the correlator to start a channel
+EXTERN MPSC_Queue<Channel_2_Ephemeris_S, 64> *CHN_2_EPH_P;	//!< \ingroup PIPES Output raw subframes to Ephemeris
+EXTERN SPSC_Queue<PVT_2_TLM_S, 4> *PVT_2_TLM_P;				//!< \ingroup PIPES Output PVT state to Telemetry
+EXTERN SPSC_Queue<PVT_2_EKF_S, 4> *PVT_2_EKF_P;				//!< \ingroup PIPES Output PVT measurements to the EKF
+EXTERN SPSC_Queue<SVS_2_TLM_S, 64> *SVS_2_TLM_P;			//!< \ingroup PIPES Output predicted SV states to Telemetry
+EXTERN SPSC_Queue<EKF_2_TLM_S, 4> *EKF_2_TLM_P;				//!< \ingroup PIPES Output EKF state to Telemetry
+EXTERN SPSC_Queue<Message_Packet_S, 16> *CMD_2_TLM_P;		//!< \ingroup PIPES Output results of commands to Telemetry
+EXTERN SPSC_Queue<Acq_Command_S, 16> *ACQ_2_SVS_P;			//!< \ingroup PIPES Return acquisition results to SV Select
+EXTERN SPSC_Queue<EKF_2_SVS_S, 4> *EKF_2_SVS_P;				//!< \ingroup PIPES Output EKF state to SV Select
+EXTERN SPSC_Queue<PVT_2_SVS_S, 4> *PVT_2_SVS_P;				//!< \ingroup PIPES Output PVT state to SV Select
+EXTERN SPSC_Queue<Command_Packet_S, 16> *TLM_2_CMD_P;		//!< \ingroup PIPES Output received commands to Commando
+EXTERN SPSC_Queue<Acq_Command_S, 16> *SVS_2_ACQ_P;			//!< \ingroup PIPES Request an acquisition because some of the channels are empty
+EXTERN SPSC_Queue<ms_packet, 16> *COR_2_ACQ_P;				//!< \ingroup PIPES Output packets of IF data to the Acquisition
+EXTERN SPSC_Queue<ISR_2_PVT_S, 4> *ISRM_2_PVT_P;			//!< \ingroup PIPES Output measurement preamble and measurements to PVT
+EXTERN SPSC_Queue<Dump_S, 32> *COR_2_TRK_P[MAX_CHANNELS];	//!< \ingroup PIPES Correlations from the correlator to each channel's loops
+EXTERN SPSC_Queue<NCO_Command_S, 32> *TRK_2_COR_P[MAX_CHANNELS];	//!< \ingroup PIPES NCO feedback from each channel's loops to the correlator
 /*----------------------------------------------------------------------------------------------*/
 
 
 /* Part 4, Anything else */
 /*----------------------------------------------------------------------------------------------*/
+EXTERN Loop_Bank_S gloops[LOOP_BANKS];				//!< Every channel's loop filter and CN0 state, only the tracking thread touches it
 
 
 /*----------------------------------------------------------------------------------------------*/
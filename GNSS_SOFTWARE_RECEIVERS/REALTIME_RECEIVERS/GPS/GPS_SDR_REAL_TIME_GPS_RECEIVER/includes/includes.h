@@ -43,6 +43,10 @@
 #include <pthread.h>
 #include <semaphore.h>
 #include <limits.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
 /*----------------------------------------------------------------------------------------------*/
 
 
@@ -58,6 +62,11 @@
 #include "sdr_structs.h"		//!< Structs used for interprocess communication
 #include "protos.h"				//!< Functions & thread prototypes
 #include "simd.h"				//!< Include the SIMD functionality
+#include "histogram.h"			//!< Latency histograms and the TSC clock
+#include "event.h"				//!< Sleep on several queues and files at once
+#include "queue.h"				//!< Message queues between the threads
+#include "seqlock.h"			//!< Publish one thread's state to the others without a mutex
 #include "globals.h"			//!< Global objects live here
+#include "profiler.h"			//!< Sampling profiler, make PROFILE=1
 #include "threaded_object.h"	//!< Base class for threaded object
 /*----------------------------------------------------------------------------------------------*/
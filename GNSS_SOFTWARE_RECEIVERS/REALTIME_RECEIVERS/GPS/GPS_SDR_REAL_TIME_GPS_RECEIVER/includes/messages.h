@@ -47,6 +47,7 @@ enum CCSDS_MESSAGES_IDS
 	MEASUREMENT_M_ID,
 	PSEUDORANGE_M_ID,
 	SV_PREDICTION_M_ID,
+	BUDGET_M_ID,
 	LAST_PERIODIC_M_ID,
 	EKF_STATE_M_ID,
 	EKF_COVARIANCE_M_ID,
@@ -109,12 +110,12 @@ typedef struct Board_Health_M
 	uint32 acq_version;		//!< Acquisition FPGA version
 	uint32 fft_version;		//!< FFT FPGA version
 	uint32 sft_version;		//!< Software version;
-	uint32 dsa0;			//!< Current state of DSA 0
-	uint32 dsa1;			//!< Current state of DSA 1
-	uint32 dsa2;			//!< Current state of DSA 2
-	uint32 dsa3;			//!< Current state of DSA 3
-	uint32 ovrflw0;			//!< Overflow counter on A/D 0
-	uint32 ovrflw1;			//!< Overflow counter on A/D 1
+	uint32 dsa0;			//!< Current state of DSA 0 (DBS-RX A attenuation, 0.5 dB steps)
+	uint32 dsa1;			//!< Current state of DSA 1 (DBS-RX B attenuation, 0.5 dB steps)
+	uint32 dsa2;			//!< Current state of DSA 2 (requantizer shift, antenna A)
+	uint32 dsa3;			//!< Current state of DSA 3 (requantizer shift, antenna B)
+	uint32 ovrflw0;			//!< Overflow counter on A/D 0 (antenna A, last AGC period)
+	uint32 ovrflw1;			//!< Overflow counter on A/D 1 (antenna B, last AGC period)
 	uint32 ovrflw2;			//!< Overflow counter on A/D 2
 	uint32 ovrflw3;			//!< Overflow counter on A/D 3
 	uint32 lo_locked;		//!< Is the LO locked to the synthesizer
@@ -135,6 +136,14 @@ typedef struct Task_Health_M
 	uint32 execution_tic[MAX_TASKS];	//!< Execution counters
 	uint32 start_tic[MAX_TASKS];		//!< Nucleus tic at function entry
 	uint32 stop_tic[MAX_TASKS];			//!< Nucleus tic at function exit
+	uint32 run_p50[MAX_TASKS];			//!< Run time percentiles (ns)
+	uint32 run_p99[MAX_TASKS];
+	uint32 run_p999[MAX_TASKS];
+	uint32 run_max[MAX_TASKS];
+	uint32 wake_p50[MAX_TASKS];			//!< Wake up latency percentiles (ns)
+	uint32 wake_p99[MAX_TASKS];
+	uint32 wake_p999[MAX_TASKS];
+	uint32 wake_max[MAX_TASKS];
 	uint32 missed_interrupts;			//!< Missed interrupts
 	uint32 tic_fpu_mul;					//!< FPU multiplies
 	uint32 tic_fpu_div;					//!< FPU divides
@@ -142,6 +151,24 @@ typedef struct Task_Health_M
 } Task_Health_M;
 
 
+/*! @ingroup MESSAGES
+ *  @brief Real-time budget of the correlator over the last second. Cycles are TSC ticks per 1 ms
+ *  packet, so they include any time the correlator lost the CPU */
+typedef struct Budget_M
+{
+	double headroom;					//!< Multiple of real time the correlator could sustain
+	uint32 chan_cycles[MAX_CHANNELS];	//!< Mean cycles per ms spent on each channel (while active)
+	uint32 chan_peak[MAX_CHANNELS];		//!< Worst ms for each channel (cycles)
+	uint32 correlate_cycles;			//!< Mean cycles per ms for the whole correlator
+	uint32 correlate_peak;				//!< Worst ms for the whole correlator (cycles)
+	uint32 overruns;					//!< ms that took longer than 1 ms to correlate
+	uint32 fifo_depth;					//!< Mean ms of IF data waiting in the FIFO
+	uint32 fifo_peak;					//!< Most ms of IF data waiting in the FIFO
+	uint32 tsc_khz;						//!< TSC rate, cycles/1e3 per second
+	uint32 tic;							//!< Corresponds to this receiver tic
+} Budget_M;
+
+
 /*! @ingroup MESSAGES
  *  @brief Packet that contains the tracking status and health of each channel
  */
@@ -300,7 +327,7 @@ typedef struct EKF_State_M
 	double vz;			//!< ECEF x velocity (meters/sec)
 	double solar;		//!< Solar radiation pressure
 	double drag;		//!< Atmospheric drag
-	double clock_bias;	//!< clock bias in seconds
+	double clock_bias;	//!< clock bias in meters
 	double clock_rate;  //!< clock rate in meters/second
 
 	/* These are tags, not covariances */
@@ -589,6 +616,7 @@ typedef struct Message_Struct
 	/* Data gets stored here! */
 	Board_Health_M 		board_health;					//!< Board health message
 	Task_Health_M		task_health;					//!< Task health message
+	Budget_M			budget;							//!< Correlator real-time budget
 	SPS_M				sps;							//!< SPS message
 	TOT_M				tot;							//!< UTC information
 	PPS_M				pps;							//!< PPS status
@@ -619,6 +647,7 @@ typedef union Message_Union
 {
 	Board_Health_M		board_health;
 	Task_Health_M		task_health;
+	Budget_M			budget;
 	SPS_M				sps;
 	TOT_M				tot;
 	PPS_M				pps;
@@ -31,12 +31,14 @@
 void Parse_Arguments(int32 _argc, char* _argv[]);	//!< Parse command line arguments to setup functionality
 int32 Hardware_Init(void);							//!< Initialize any hardware (for realtime mode)
 int32 Object_Init(void);								//!< Initialize all threaded objects and global variables
-int32 Pipes_Init(void);								//!< Initialize all pipes
+int32 Pipes_Init(void);								//!< Create all the message queues
 int32 Thread_Init(void);								//!< Finally start up the threads
 void Thread_Shutdown(void);							//!< First step to shutdown, stopping the threads
-void Pipes_Shutdown(void);							//!< Close all the pipes
+void Pipes_Shutdown(void);							//!< Delete all the message queues
+void Pipes_Close(void);								//!< Wake every thread blocked on a message queue
 void Object_Shutdown(void);							//!< Delete/free all objects
 void Hardware_Shutdown(void);						//!< Shutdown any hardware
+int32 Batch_Process(void);							//!< Run the -b files through a single threaded receiver
 /*----------------------------------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------------------------------*/
@@ -49,14 +51,18 @@ int32 code_gen(CPX *_dest, int32 _prn);
 void sine_gen(CPX *_dest, double _f, double _fs, int32 _samps);
 void sine_gen(CPX *_dest, double _f, double _fs, int32 _samps, double _p);
 void wipeoff_gen(MIX *_dest, double _f, double _fs, int32 _samps);
-void downsample(CPX *_dest, CPX *_source, double _fdest, double _fsource, int32 _samps);
 void init_agc(CPX *_buff, int32 _samps, int32 bits, int32 *scale);
-int32 run_agc(CPX *_buff, int32 _samps, int32 bits, int32 scale);
 int32 AtanApprox(int32 y, int32 x);
 int32 Atan2Approx(int32 y, int32 x);
 int32 Invert4x4(double A[4][4], double B[4][4]);
 void FormCCSDSPacketHeader(CCSDS_Packet_Header *_p, uint32 _apid, uint32 _sf, uint32 _pl, uint32 _cm, uint32 _tic);
 void DecodeCCSDSPacketHeader(CCSDS_Decoded_Header *_d, CCSDS_Packet_Header *_p);
 uint32 adler(uint8 *data, int32 len);
+double SV_Ephemeris(Ephemeris_M *_e, double _t, double _dE, SV_Position_M *_s);
+void SV_Almanac(Almanac_M *_a, double _t, SV_Position_M *_s);
+double gauss();
+double uniform();
+double error3d(double *_a, double *_b);
+void constellation_gen(Ephemeris_M *_e, Almanac_M *_a, int32 _planes, int32 _slots, double _toe);
 /*----------------------------------------------------------------------------------------------*/
 
@@ -61,6 +61,22 @@ typedef struct MIX {
 /*----------------------------------------------------------------------------------------------*/
 
 
+/*----------------------------------------------------------------------------------------------*/
+/*! \ingroup STRUCTS
+ * @brief Scheduling applied to a task's thread when it is started (-a) */
+typedef struct _Sched_Option_S
+{
+
+	char	task_name[8];	//!< Prefix of the task name, "ALL" matches every task
+	uint32	cpus;			//!< Affinity mask, 0 leaves the thread floating
+	int32	policy;			//!< SCHED_FIFO or SCHED_OTHER
+	int32	priority;		//!< SCHED_FIFO priority
+	int32	nice;			//!< Niceness
+
+} Sched_Option_S;
+/*----------------------------------------------------------------------------------------------*/
+
+
 /*----------------------------------------------------------------------------------------------*/
 /*! \ingroup STRUCTS
  * @brief Options parsed from command line to start the receiver */
@@ -83,6 +99,18 @@ typedef struct _Options_S
 	double 	gr;				//!< RF gain
 	double	f_sample;		//!< Sample rate (depending on the clock)
 	int32 	recorder;	
+	int32	compress;		//!< Record to a compressed .ifz file
+	int32	start_minute;	//!< Start replaying an .ifz file at this minute
+	int32	lock_memory;	//!< mlockall() and prefault each thread's stack
+	int32	profile;		//!< Profiler sample rate in Hz per thread, 0 is off (-P)
+	char	metrics[108];	//!< Metrics endpoint, a unix socket path or a loopback TCP port, empty is off (-M)
+	int32	batch;			//!< Number of files to run through in batch mode (-b)
+	char	**batch_files;	//!< The files, straight out of argv
+	int32	num_sched;		//!< Number of entries in sched
+	int32	freq_zoom;		//!< Frequency lock with Freq_Lock::Zoom() instead of the full FFT (-F)
+	int32	pvt_weight;		//!< Weight the PVT by C/N0 and elevation and exclude faults (-W)
+	int32	meas_int;		//!< ms between measurement epochs, 1000 over the -R rate
+	Sched_Option_S sched[MAX_SCHED_OPTIONS];	//!< Per task affinity/priority, later entries win
 	char	file_name_1[1000];
 	char	file_name_2[1000]; // max out file name at 1000 chars.
 
@@ -121,6 +149,10 @@ typedef struct _NCO_Command
 	uint32 z_count;		//!< Actual value
 	uint32 length;		//!< Integrate for this many ms
 	uint32 navigate;		//!< Use this correlator to navigate
+	uint32 generation;		//!< Copied from the Dump_S this answers
+	uint32 dump_1ms_epoch;	//!< Correlator's epochs at that dump, the resets above are relative to them
+	uint32 dump_20ms_epoch;
+	uint32 dump_z_count;
 
 } NCO_Command_S;
 
@@ -136,6 +168,24 @@ typedef struct _Correlation_S
 } Correlation_S;
 
 
+/*! \ingroup STRUCTS
+ * @brief One dump from the correlator to a channel's tracking loops, or the command to start it */
+typedef struct _Dump_S
+{
+
+	Correlation_S	corr;			//!< Phase corrected correlations
+	Acq_Command_S	result;			//!< Acquisition to start the channel with
+	uint32			start;			//!< Start the channel with result instead of tracking corr
+	uint32			generation;		//!< Bumped by the correlator each time it starts the channel
+	uint32			_1ms_epoch;		//!< Correlator's epochs at the dump, handed back with the feedback
+	uint32			_20ms_epoch;
+	uint32			_z_count;
+	uint32			tic;			//!< Correlator's packet count at the dump, stamps the -c log
+	int32			count;			//!< Dumps of this generation before this one, lost ones included
+
+} Dump_S;
+
+
 /*! \ingroup STRUCTS
  * @brief Hold state information of the correlator */
 typedef struct _Correlator_State_S
@@ -169,7 +219,7 @@ typedef struct _Correlator_State_S
 
 
 /*! \ingroup STRUCTS
- * @brief State of phase lock loop */
+ * @brief Parameters of phase lock loop, the filter state is in the channel's Loop_Bank_S lane */
 typedef struct _Phase_lock_loop {
 
 	float PLLBW;				//!< PLL Bandwidth (Hz)
@@ -183,9 +233,6 @@ typedef struct _Phase_lock_loop {
 	float w0f;
 	float w0f2;
 	float gain;
-	float w;					//!< Acceleration accumulator
-	float x;					//!< Velocity accumulator
-	float z;					//!< P feedback
 	float pll_lock;				//!< PLL Lock Indicator
 	float fll_lock;				//!< FLL lock indicator
 	float t;					//!< Integration length (ms)
@@ -208,6 +255,142 @@ typedef struct _Delay_lock_loop
 	float t;					//!< Integration length
 
 } Delay_lock_loop;
+
+
+/*! \ingroup STRUCTS
+ * @brief Four channels' loops side by side, channel n is lane n%4 of gloops[n/4]. Every row is a
+ * float[4] so sse_track() gets a field of all four lanes with one load, the kernel hard codes the
+ * row offsets so keep the order and the size (288 bytes) in step with it */
+typedef struct _Loop_Bank_S
+{
+
+	/* Filled in by the channels that dumped this ms */
+	float	ip[4];				//!< Prompt I
+	float	qp[4];				//!< Prompt Q
+	float	pe[4];				//!< Early power
+	float	pl[4];				//!< Late power
+	float	nbp[4];				//!< Narrowband power over the last 20 ms
+	float	wbp[4];				//!< Wideband power over the last 20 ms
+
+	/* Gains, from Channel::PLL_W() */
+	float	kw[4];				//!< t*w0p^3
+	float	kx[4];				//!< t*a3*w0p^2
+	float	kh[4];				//!< t/2
+	float	kz[4];				//!< b3*w0p
+
+	/* State, the 3rd order PLL and the CN0 */
+	float	w[4];				//!< Acceleration accumulator
+	float	x[4];				//!< Velocity accumulator
+	float	z[4];				//!< P feedback
+	float	cn0[4];				//!< CN0 estimate (dB-Hz)
+
+	/* All ones in the lanes the sweep should touch */
+	uint32	pll[4];				//!< Close the PLL
+	uint32	est[4];				//!< Update the CN0
+
+	/* Out */
+	float	dp[4];				//!< Phase discriminator (cycles)
+	float	code_err[4];		//!< Normalized early minus late
+
+} Loop_Bank_S __attribute__ ((aligned (16)));
+
+
+/*! \ingroup STRUCTS
+ * @brief Four SVs' line of sight side by side, SV n is lane n%4 of bank n/4. Every row is a float[4]
+ * for sse_predict(), which hard codes the row offsets, so keep the order and the size (272 bytes)
+ * in step with it. The vectors are SV minus receiver, formed in double before they get here */
+typedef struct _Predict_Bank_S
+{
+
+	/* In, ECEF */
+	float	dx[4];				//!< Relative position (meters)
+	float	dy[4];
+	float	dz[4];
+	float	dvx[4];				//!< Relative velocity (meters/sec)
+	float	dvy[4];
+	float	dvz[4];
+	float	dax[4];				//!< Relative acceleration (meters/sec^2)
+	float	day[4];
+	float	daz[4];
+	float	clock[4];			//!< SV clock bias (seconds)
+	float	drift[4];			//!< Receiver clock rate plus SV frequency bias (meters/sec)
+
+	/* Out */
+	float	delay[4];			//!< Time of flight less the SV clock (seconds)
+	float	doppler[4];			//!< Hz
+	float	doppler_rate[4];	//!< Hz/sec
+	float	elev[4];			//!< Elevation (rad)
+	float	azim[4];			//!< Azimuth from north (rad), -pi to pi
+	uint32	visible[4];			//!< All ones if above the mask
+
+} Predict_Bank_S __attribute__ ((aligned (16)));
+
+
+/*! \ingroup STRUCTS
+ * @brief The receiver's local frame for sse_predict(), each row the same in all 4 lanes (208 bytes) */
+typedef struct _Predict_Frame_S
+{
+
+	float	ex[4];				//!< East unit vector
+	float	ey[4];
+	float	ez[4];
+	float	nx[4];				//!< North
+	float	ny[4];
+	float	nz[4];
+	float	ux[4];				//!< Up, geodetic
+	float	uy[4];
+	float	uz[4];
+	float	gx[4];				//!< Up, geocentric, what the mask angle is measured from
+	float	gy[4];
+	float	gz[4];
+	float	mask[4];			//!< -cos(mask angle)
+
+} Predict_Frame_S __attribute__ ((aligned (16)));
+
+
+/*! \ingroup STRUCTS
+ * @brief What the rest of the receiver may see of a channel, published by the correlator each ms */
+typedef struct _Channel_Status_S
+{
+
+	int32	chan;				//!< The channel number
+	int32	sv;					//!< SV being tracked
+	int32	state;				//!< Channel_State
+	int32	antenna;			//!< Antenna channel is tracking off of
+	int32	len;				//!< Accumulation length (1 or 20 ms)
+	int32	count;				//!< Number of accumulations processed
+	int32	subframe;			//!< Current subframe number
+	int32	best_epoch;			//!< Best estimate of bit edge position
+	int32	bit_lock;			//!< Bit lock?
+	int32	frame_lock;			//!< Frame lock?
+	int32	navigate;			//!< Navigate on this channel flag
+	float	cn0;				//!< CN0 estimate (dB-Hz)
+	float	p_avg;				//!< Filtered version of I^2+Q^2
+	float	w;					//!< 3rd order PLL state
+	float	x;					//!< 3rd order PLL state
+	float	z;					//!< 3rd order PLL state
+	double	code_nco;			//!< Code NCO (Hz)
+	double	carrier_nco;		//!< Carrier NCO (Hz)
+
+} Channel_Status_S;
+
+
+/*! \ingroup STRUCTS
+ * @brief Correlator real-time budget, TSC ticks accumulated over a period */
+typedef struct _Budget_S
+{
+
+	uint64 chan[MAX_CHANNELS];			//!< Ticks spent on each channel
+	uint32 chan_peak[MAX_CHANNELS];		//!< Worst 1 ms for each channel
+	uint32 chan_ms[MAX_CHANNELS];		//!< ms each channel was active
+	uint64 correlate;					//!< Ticks spent in Correlate()
+	uint32 correlate_peak;				//!< Worst 1 ms for Correlate()
+	uint32 ms;							//!< Packets in this period
+	uint32 overruns;					//!< Packets that took longer than 1 ms
+	uint64 fifo;						//!< Sum of the FIFO depth (ms) seen by each packet
+	uint32 fifo_peak;					//!< Deepest FIFO (ms)
+
+} Budget_S;
 /*----------------------------------------------------------------------------------------------*/
 
 #endif
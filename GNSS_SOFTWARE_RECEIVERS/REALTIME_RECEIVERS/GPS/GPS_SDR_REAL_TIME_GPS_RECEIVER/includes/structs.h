@@ -55,6 +55,15 @@ typedef struct Preamble_2_PVT_S
 typedef Measurement_M Measurement_2_PVT_S;
 
 
+/*! @ingroup STRUCTS
+ *  @brief One interrupt's worth of measurements, sent from the correlator to the PVT */
+typedef struct ISR_2_PVT_S
+{
+	Preamble_2_PVT_S preamble;
+	Measurement_M measurements[MAX_CHANNELS];
+} ISR_2_PVT_S;
+
+
 /*! @ingroup STRUCTS
  *  @brief Raw subframes sent from channel to ephemeris object */
 typedef struct Channel_2_Ephemeris_S {
@@ -203,6 +212,32 @@ typedef struct PVT_2_SVS_S
  } PVT_2_SVS_S;
 
 
+/*! @ingroup STRUCTS
+ *  @brief The receiver state SV select is working from, for the predictor */
+typedef struct SVS_2_PRE_S
+{
+	SPS_M 	sps;
+	Clock_M clock;
+	float	mask_angle;				//!< Elevation mask angle
+	int32	mode;					//!< SV_SELECT_MODE, no prediction when cold
+	uint64	tsc;					//!< When SV select handed it over
+} SVS_2_PRE_S;
+
+
+/*! @ingroup STRUCTS
+ *  @brief One sweep of the predictor, every SV */
+typedef struct PRE_2_SVS_S
+{
+	SV_Prediction_M sv[MAX_SV];		//!< Predictions, tracked is left for SV select
+	double	time;					//!< GPS time they are for
+	int32	mode;					//!< SV_SELECT_MODE of the state they came from
+	uint32	sweeps;					//!< Sweeps so far
+	uint32	visible;				//!< SVs predicted visible
+	uint64	tsc;					//!< When the sweep finished
+	uint64	input_tsc;				//!< When the state it used was handed over
+} PRE_2_SVS_S;
+
+
  /*! @ingroup STRUCTS
   *  @brief Dump info from the PVT to the PPS */
 typedef struct PVT_2_PPS_S
@@ -220,6 +255,7 @@ typedef struct PVT_2_EKF_S
 	Clock_M clock;
 	Pseudorange_M pseudoranges[MAX_CHANNELS];
 	Measurement_M measurements[MAX_CHANNELS];
+	SV_Position_M sv_positions[MAX_CHANNELS];	//!< Where the SVs were at transmit time
 } PVT_2_EKF_S;
 
 
@@ -261,4 +297,22 @@ typedef PPS_M PPS_2_TLM_S;
 typedef SV_Prediction_M SVS_2_TLM_S;
 
 
+/*! @ingroup STRUCTS
+ *  @brief A command from the telemetry to commando, header and body in one message */
+typedef struct Command_Packet_S
+{
+	CCSDS_Packet_Header header;
+	Command_Union body;
+} Command_Packet_S;
+
+
+/*! @ingroup STRUCTS
+ *  @brief A command result from commando to the telemetry, header and body in one message */
+typedef struct Message_Packet_S
+{
+	CCSDS_Packet_Header header;
+	Message_Union body;
+} Message_Packet_S;
+
+
 #endif /* STRUCTS_H_ */
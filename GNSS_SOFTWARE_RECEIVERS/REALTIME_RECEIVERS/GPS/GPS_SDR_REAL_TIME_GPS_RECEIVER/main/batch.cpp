@@ -0,0 +1,270 @@
+/*----------------------------------------------------------------------------------------------*/
+/*! \file batch.cpp
+//
+// FILENAME: batch.cpp
+//
+// DESCRIPTION: Process recorded IF files start to end from a single thread, for regression and
+//				throughput runs
+//
+// DEVELOPERS: Gregory W. Heckler (2003-2009)
+//
+// LICENSE TERMS: Copyright (c) Gregory W. Heckler 2009
+//
+// This file is part of the GPS Software Defined Radio (GPS-SDR)
+//
+// The GPS-SDR is free software; you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation; either version 2 of
+// the License, or (at your option) any later version. The GPS-SDR is distributed in the hope that
+// it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// Note:  Comments within this file follow a syntax that is compatible with
+//        DOXYGEN and are utilized for automated document extraction
+//
+// Reference:
+*/
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+#include "includes.h"
+#include "fifo.h"				//!< Circular buffer for Importing IF data
+#include "channel.h"			//!< Tracking channels
+#include "correlator.h"			//!< Correlator
+#include "tracking.h"			//!< Runs the channels' loops
+#include "acquisition.h"		//!< Acquisition
+#include "pvt.h"				//!< PVT solution
+#include "ekf.h"				//!< Navigation filter
+#include "ephemeris.h"			//!< Ephemeris decode
+#include "sv_select.h"			//!< Drives acquisition/reacquisition process
+#include "predictor.h"			//!< Constellation prediction for the SV select
+#include "chan_log.h"			//!< High rate channel log
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*! Write one PVT epoch, the nav solution to .nav and every channel to .chn */
+/*----------------------------------------------------------------------------------------------*/
+void Batch_Nav(FILE *_nav, FILE *_chn, SPS_M *_sps, Pseudorange_M *_pr)
+{
+	SPS_M *nav;
+	Channel_M chan;
+	int32 lcv, nsvs;
+
+	nav = _sps;
+
+	nsvs = 0;
+	for(lcv = 0; lcv < MAX_CHANNELS; lcv++)
+		if((nav->nsvs >> lcv) & 0x1)
+			nsvs++;
+
+	fprintf(_nav,"%10u %16.6f %2d 0x%03x %1u %16.3f %16.3f %16.3f %10.3f %10.3f %10.3f %14.9f %14.9f %10.3f %16.9e %12.3f %8.3f\n",
+		nav->tic, nav->time, nsvs, nav->nsvs, nav->converged,
+		nav->x, nav->y, nav->z, nav->vx, nav->vy, nav->vz,
+		nav->latitude*RAD_2_DEG, nav->longitude*RAD_2_DEG, nav->altitude,
+		nav->clock_bias, nav->clock_rate, nav->gdop);
+
+	for(lcv = 0; lcv < MAX_CHANNELS; lcv++)
+	{
+		if(pChannels[lcv]->getState() == CHANNEL_EMPTY)
+			continue;
+
+		chan = pChannels[lcv]->getPacket();
+
+		fprintf(_chn,"%10u %2d %2d %1d %3d %1d %1d %1d %16.3f %12.3f %10.3f\n",
+			nav->tic, lcv, chan.sv + 1, chan.state, chan.cn0, chan.bit_lock, chan.frame_lock,
+			(nav->nsvs >> lcv) & 0x1, _pr[lcv].meters, _pr[lcv].meters_rate, _pr[lcv].residual);
+	}
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*! Write one EKF epoch to .ekf */
+/*----------------------------------------------------------------------------------------------*/
+void Batch_EKF(FILE *_ekf, EKF_2_TLM_S *_tlm)
+{
+	EKF_State_M *s;
+	EKF_Covariance_M *c;
+
+	s = &_tlm->state;
+	c = &_tlm->covariance;
+
+	fprintf(_ekf,"%10u %16.6f %2u 0x%03x 0x%02x %16.3f %16.3f %16.3f %10.3f %10.3f %10.3f %16.3f %12.3f %10.3f %10.3f %10.3f\n",
+		s->tic, s->time, s->status >> 16, s->nsvs, s->status & 0xffff,
+		s->x, s->y, s->z, s->vx, s->vy, s->vz, s->clock_bias, s->clock_rate,
+		c->x, c->y, c->z);
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*! Run one file through the receiver, lock-step on the 1 ms packets */
+/*----------------------------------------------------------------------------------------------*/
+int32 Batch_File(const char *_fname)
+{
+	FILE *fp, *fp_nav, *fp_chn, *fp_acq, *fp_ekf, *fp_pvt;
+	PVT_2_EKF_S ekf_in;
+	EKF_2_TLM_S ekf_out;
+	Acq_Command_S acq;
+	char name[1100];
+	const char *base;
+	struct timeval t0, t1;
+	uint32 ms;
+	double secs;
+
+	fp = fopen(_fname, "rb");
+	if(fp == NULL)
+	{
+		fprintf(stderr,"Could not open %s\n", _fname);
+		return(false);
+	}
+	fclose(fp);
+
+	/* Outputs go in the working directory, named after the input */
+	base = strrchr(_fname, '/');
+	base = (base != NULL) ? base + 1 : _fname;
+
+	sprintf(name, "%s.nav", base);
+	fp_nav = fopen(name, "wt");
+	sprintf(name, "%s.chn", base);
+	fp_chn = fopen(name, "wt");
+	sprintf(name, "%s.acq", base);
+	fp_acq = fopen(name, "wt");
+	sprintf(name, "%s.ekf", base);
+	fp_ekf = fopen(name, "wt");
+	sprintf(name, "%s.pvt", base);
+	fp_pvt = fopen(name, "wb");
+	if((fp_nav == NULL) || (fp_chn == NULL) || (fp_acq == NULL) || (fp_ekf == NULL) || (fp_pvt == NULL))
+	{
+		fprintf(stderr,"Could not create the outputs for %s\n", base);
+		if(fp_nav != NULL) fclose(fp_nav);
+		if(fp_chn != NULL) fclose(fp_chn);
+		if(fp_acq != NULL) fclose(fp_acq);
+		if(fp_ekf != NULL) fclose(fp_ekf);
+		if(fp_pvt != NULL) fclose(fp_pvt);
+		return(false);
+	}
+
+	fprintf(fp_nav,"%% tic gps_time nsvs mask converged x y z vx vy vz lat lon alt clock_bias clock_rate gdop\n");
+	fprintf(fp_chn,"%% tic chan prn state cn0 bit_lock frame_lock navigate pseudorange pseudorange_rate residual\n");
+	fprintf(fp_acq,"%% ms prn chan type success doppler code_phase magnitude\n");
+	fprintf(fp_ekf,"%% tic gps_time nsvs mask status x y z vx vy vz clock_bias clock_rate sigma_x sigma_y sigma_z\n");
+
+	/* A fresh receiver for every file */
+	strcpy(gopt.file_name_1, _fname);
+	Pipes_Init();
+	Object_Init();
+
+	grun = 0x1;
+	gettimeofday(&t0, NULL);
+
+	for(ms = 0; grun; ms++)
+	{
+		/* Read, AGC, and offer the packet to the acquisition */
+		pFIFO->Import();
+		pFIFO->IncExecTic();
+		if(pFIFO->getEOF())
+			break;
+
+		/* Correlate, every MEASUREMENT_INT ms this also hands the measurements to the PVT */
+		pCorrelator->Import();
+		pCorrelator->Correlate();
+		pCorrelator->IncExecTic();
+
+		/* Close the loops, the correlator applies the feedback at the next dump as it does live */
+		pTracking->Step();
+		pTracking->IncExecTic();
+
+		/* Write out the -c log as it fills, there is no log thread either */
+		if(pChanLog != NULL)
+			pChanLog->Import();
+
+		/* Subframes the channels decoded this ms */
+		while(CHN_2_EPH_P->getCount())
+			pEphemeris->Import();
+
+		/* Navigate, standing in for the telemetry on the way out */
+		while(ISRM_2_PVT_P->getCount())
+		{
+			pPVT->Import();
+			pPVT->Navigate();
+			pPVT->Export();
+
+			/* Every epoch goes to the EKF, the telemetry only gets every REPORT_DECIMATION'th */
+			PVT_2_TLM_P->Flush();
+			PVT_2_EKF_P->Receive(&ekf_in);
+			Batch_Nav(fp_nav, fp_chn, &ekf_in.sps, &ekf_in.pseudoranges[0]);
+
+			/* Filter the same epoch, keeping what went in so ekf-test can replay it */
+			fwrite(&ekf_in, sizeof(PVT_2_EKF_S), 1, fp_pvt);
+			pEKF->Filter(&ekf_in, &ekf_out);
+			pEKF->IncExecTic();
+			if((ekf_out.state.tic % REPORT_DECIMATION) == 0)
+				EKF_2_SVS_P->TrySend(&ekf_out);
+			Batch_EKF(fp_ekf, &ekf_out);
+		}
+
+		/* Pick the next SV, this only queues the request */
+		while(PVT_2_SVS_P->getCount())
+			pSV_Select->Import();
+		SVS_2_TLM_P->Flush();
+
+		/* The predictor sweeps on file time rather than its own thread's */
+		if((ms % PREDICT_PERIOD) == 0)
+		{
+			pPredictor->Sweep();
+			pPredictor->IncExecTic();
+		}
+
+		/* The acquisition runs as soon as it has its data, the correlator starts the channel next ms */
+		if(pAcquisition->Step() && pSV_Select->CheckAcquisition())
+		{
+			acq = pSV_Select->getCommand();
+			fprintf(fp_acq,"%10d %2d %2d %1d %1d %6d %5d %10u\n", acq.count, acq.sv + 1, acq.chan,
+				acq.type, acq.success, acq.doppler, acq.code_phase, acq.magnitude);
+		}
+	}
+
+	gettimeofday(&t1, NULL);
+	grun = 0x0;
+
+	secs = (t1.tv_sec - t0.tv_sec) + (t1.tv_usec - t0.tv_usec)*1e-6;
+	fprintf(stdout,"%s: %u ms in %.2f s, %.1fx realtime\n", _fname, ms, secs, ms/(1000.0*secs));
+	pCorrelator->PrintBudget(stdout);
+	fflush(stdout);
+
+	Object_Shutdown();
+	Pipes_Shutdown();
+
+	fclose(fp_nav);
+	fclose(fp_chn);
+	fclose(fp_acq);
+	fclose(fp_ekf);
+	fclose(fp_pvt);
+
+	return(true);
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*! Process every file given with -b, returns the number that failed */
+/*----------------------------------------------------------------------------------------------*/
+int32 Batch_Process(void)
+{
+	int32 lcv, failed;
+
+#ifdef PROFILE
+	Profile_Start_Thread("BATCH");
+#endif
+
+	failed = 0;
+	for(lcv = 0; lcv < gopt.batch; lcv++)
+		if(!Batch_File(gopt.batch_files[lcv]))
+			failed++;
+
+#ifdef PROFILE
+	Profile_Dump(PROFILE_FILE);
+#endif
+
+	return(failed);
+}
+/*----------------------------------------------------------------------------------------------*/
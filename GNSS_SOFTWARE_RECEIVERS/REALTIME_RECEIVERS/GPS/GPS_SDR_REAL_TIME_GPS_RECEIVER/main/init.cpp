@@ -32,14 +32,21 @@
 #include "keyboard.h"			//!< Handle user input via keyboard
 #include "channel.h"			//!< Tracking channels
 #include "correlator.h"			//!< Correlator
+#include "tracking.h"			//!< Runs the channels' loops
 #include "acquisition.h"		//!< Acquisition
 #include "pvt.h"				//!< PVT solution
+#include "ekf.h"				//!< Navigation filter
 #include "ephemeris.h"			//!< Ephemeris decode
 #include "telemetry.h"			//!< Serial/GUI telemetry
 #include "commando.h"			//!< Command interface
 #include "sv_select.h"			//!< Drives acquisition/reacquisition process
+#include "predictor.h"			//!< Constellation prediction for the SV select
 #include "gps_source.h"			//!< Get GPS IF data from where?
 #include "patience.h"
+#include "recorder.h"			//!< Record IF data to disk
+#include "metrics.h"			//!< Counters for monitoring
+#include "chan_log.h"			//!< High rate channel log
+#include "freq_lock.h"			//!< Shared frequency search
 /*----------------------------------------------------------------------------------------------*/
 
 
@@ -50,7 +57,7 @@ void usage(char *_str)
 	fprintf(stdout,"\n");
 	//fprintf(stdout,"usage: [-c] [-v] [-gr] [-gi] [-d] [-l] [-w] [-x] [-s]\n");
 	fprintf(stdout,"usage: [-c] [-v] [-gr] [-gi] [-w] [-x] [-s] [-gn3s]\n");
-	fprintf(stdout,"[-c] log high rate channel data\n");
+	fprintf(stdout,"[-c] log high rate channel data to chan.chl\n");
 	fprintf(stdout,"[-v] be verbose \n");
 	fprintf(stdout,"[-gr] <gain> set rf gain in dB (DBSRX only)\n");
 	fprintf(stdout,"[-gi] <gain> set if gain in dB (DBSRX only)\n");
@@ -63,17 +70,103 @@ void usage(char *_str)
 	fprintf(stdout,"[-p] <file1> use data files as 1 sampling devices\n"); 	
 	fprintf(stdout,"[-f] <file1> <file2> use data files as 2 sampling devices\n"); 
 	fprintf(stdout,"[-r] record sampled data as well as tracking\n");
+	fprintf(stdout,"[-z] record to a compressed data.ifz instead (with -r), delta code chan.chl (with -c)\n");
+	fprintf(stdout,"[-t] <minute> start replaying an .ifz file at this minute\n");
+	fprintf(stdout,"[-a] <task>:<cpus>[:fifo:<priority>|:other:<nice>] pin and prioritize a task,\n");
+	fprintf(stdout,"     e.g. -a COR:2:fifo:80 -a ACQ:0,1:other:10, task ALL matches every task\n");
+	fprintf(stdout,"[-F] frequency lock with a zoomed DFT around a phase difference estimate instead of the full FFT\n");
+	fprintf(stdout,"[-W] weight the PVT by C/N0 and elevation and exclude the worst SV on a failed residual test\n");
+	fprintf(stdout,"[-R] <hz> measurement and PVT rate, %d to %d dividing 1000 (default %d)\n", 1, MEASUREMENT_RATE_MAX, MEASUREMENT_RATE);
+	fprintf(stdout,"[-m] lock all memory and prefault each thread's stack\n");
+	fprintf(stdout,"[-M] <path>|<port> serve counters on a unix socket, or on 127.0.0.1:<port>\n");
+	fprintf(stdout,"[-P] <hz> sample every thread at <hz> and write %s at exit (make PROFILE=1)\n", PROFILE_FILE);
+	fprintf(stdout,"[-b] <file> [<file> ...] batch process the files as fast as possible, writing\n");
+	fprintf(stdout,"     <file>.nav, <file>.chn, <file>.acq and <file>.ekf to the working directory, and\n");
+	fprintf(stdout,"     the EKF's input to <file>.pvt for ekf-test\n");
 	fflush(stdout);
 	exit(1);
 }
 /*----------------------------------------------------------------------------------------------*/
 
 
+/*! Parse one -a <task>:<cpus>[:fifo:<priority>|:other:<nice>] option */
+/*----------------------------------------------------------------------------------------------*/
+void Parse_Sched(char *_str, char *_exe)
+{
+	Sched_Option_S *s;
+	char *field, *cpu, *save, *parse;
+	int32 lcv;
+
+	if(gopt.num_sched >= MAX_SCHED_OPTIONS)
+		usage(_exe);
+
+	s = &gopt.sched[gopt.num_sched];
+	memset(s, 0x0, sizeof(Sched_Option_S));
+	s->policy = SCHED_OTHER;
+
+	/* Task name */
+	field = strtok_r(_str, ":", &save);
+	if((field == NULL) || (strlen(field) > 7))
+		usage(_exe);
+	for(lcv = 0; field[lcv]; lcv++)
+		s->task_name[lcv] = toupper(field[lcv]);
+
+	/* Comma separated cpus, "-" leaves it floating */
+	field = strtok_r(NULL, ":", &save);
+	if(field == NULL)
+		usage(_exe);
+	if(strcmp(field, "-") != 0)
+	{
+		for(cpu = field; *cpu; cpu = parse)
+		{
+			lcv = strtol(cpu, &parse, 10);
+			if((parse == cpu) || (lcv < 0) || (lcv > 31))
+				usage(_exe);
+			s->cpus |= 1 << lcv;
+			if(*parse == ',')
+				parse++;
+		}
+	}
+
+	/* Policy and its priority or niceness */
+	field = strtok_r(NULL, ":", &save);
+	if(field != NULL)
+	{
+		if(strcmp(field, "fifo") == 0)
+			s->policy = SCHED_FIFO;
+		else if(strcmp(field, "other") != 0)
+			usage(_exe);
+
+		field = strtok_r(NULL, ":", &save);
+		if(field == NULL)
+			usage(_exe);
+
+		if(s->policy == SCHED_FIFO)
+		{
+			s->priority = strtol(field, &parse, 10);
+			if((*parse) || (s->priority < sched_get_priority_min(SCHED_FIFO)) || (s->priority > sched_get_priority_max(SCHED_FIFO)))
+				usage(_exe);
+		}
+		else
+		{
+			s->nice = strtol(field, &parse, 10);
+			if((*parse) || (s->nice < -20) || (s->nice > 19))
+				usage(_exe);
+		}
+	}
+
+	gopt.num_sched++;
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
 /*! Print out command arguments to std_out */
 /*----------------------------------------------------------------------------------------------*/
 void echo_options()
 {
 	FILE *fp;
+	int32 lcv;
 
 	if(gopt.verbose)
 	{
@@ -91,6 +184,15 @@ void echo_options()
 			fprintf(stdout,"IF Gain:          %13.2f\n",gopt.gi);
 			fprintf(stdout,"DBSRX Bandwidth:  %13.2f\n",gopt.bandwidth);
 		}
+		fprintf(stdout,"Measurement Hz:   %13d\n",MEASUREMENTS_PER_SECOND);
+		fprintf(stdout,"Lock memory:      %13d\n",gopt.lock_memory);
+		fprintf(stdout,"Profile Hz:       %13d\n",gopt.profile);
+		if(gopt.metrics[0])
+			fprintf(stdout,"Metrics:          %13s\n",gopt.metrics);
+		for(lcv = 0; lcv < gopt.num_sched; lcv++)
+			fprintf(stdout,"Schedule %-7.7s:   cpus 0x%08x %s %d\n",gopt.sched[lcv].task_name,gopt.sched[lcv].cpus,
+				gopt.sched[lcv].policy == SCHED_FIFO ? "fifo" : "other",
+				gopt.sched[lcv].policy == SCHED_FIFO ? gopt.sched[lcv].priority : gopt.sched[lcv].nice);
 		fprintf(stdout,"\n");
 		fflush(stdout);
 	}
@@ -105,7 +207,7 @@ void Parse_Arguments(int32 argc, char* argv[])
 {
 
 	char *parse;
-	int32 lcv;
+	int32 lcv, lcv2;
 
 
 	/* Set default options */
@@ -125,6 +227,17 @@ void Parse_Arguments(int32 argc, char* argv[])
 	gopt.realtime		= 1;
 	gopt.source			= SOURCE_USRP_V1;
 	gopt.recorder = 0;
+	gopt.compress = 0;
+	gopt.start_minute = 0;
+	gopt.lock_memory = 0;
+	gopt.profile = 0;
+	gopt.metrics[0] = '\0';
+	gopt.batch = 0;
+	gopt.batch_files = NULL;
+	gopt.num_sched = 0;
+	gopt.freq_zoom = 0;
+	gopt.pvt_weight = 0;
+	gopt.meas_int = 1000/MEASUREMENT_RATE;
 
 	for(lcv = 1; lcv < argc; lcv++)
 	{
@@ -212,6 +325,85 @@ void Parse_Arguments(int32 argc, char* argv[])
 			case 'r':
 				gopt.recorder=1;
 				break;
+			case 'z':
+				gopt.compress = 1;
+				break;
+			case 't':
+				if(++lcv >= argc)
+					usage (argv[0]);
+
+				if(isdigit(argv[lcv][0]))
+					gopt.start_minute = atoi(argv[lcv]);
+				else
+					usage (argv[0]);
+				break;
+			case 'a':
+				if(++lcv >= argc)
+					usage (argv[0]);
+
+				Parse_Sched(argv[lcv], argv[0]);
+				break;
+			case 'm':
+				gopt.lock_memory = 1;
+				break;
+			case 'F':
+				gopt.freq_zoom = 1;
+				break;
+			case 'W':
+				gopt.pvt_weight = 1;
+				break;
+			case 'R':
+				if(++lcv >= argc)
+					usage (argv[0]);
+
+				if(!isdigit(argv[lcv][0]))
+					usage (argv[0]);
+
+				/* A whole number of ms between epochs */
+				lcv2 = atoi(argv[lcv]);
+				if((lcv2 < 1) || (lcv2 > MEASUREMENT_RATE_MAX) || (1000 % lcv2))
+					usage (argv[0]);
+
+				gopt.meas_int = 1000/lcv2;
+				break;
+			case 'M':
+				if(++lcv >= argc)
+					usage (argv[0]);
+
+				if(strlen(argv[lcv]) >= sizeof(gopt.metrics))
+					usage (argv[0]);
+
+				strcpy(gopt.metrics, argv[lcv]);
+				break;
+			case 'P':
+				if(++lcv >= argc)
+					usage (argv[0]);
+
+				if(isdigit(argv[lcv][0]))
+					gopt.profile = atoi(argv[lcv]);
+				else
+					usage (argv[0]);
+
+				if((gopt.profile < 0) || (gopt.profile > 10000))
+					usage (argv[0]);
+#ifndef PROFILE
+				if(gopt.profile)
+					fprintf(stderr,"Built without the profiler, rebuild with make PROFILE=1 to use -P\n");
+				gopt.profile = 0;
+#endif
+				break;
+			case 'b':
+				/* Everything up to the next option is a file */
+				gopt.batch_files = &argv[lcv+1];
+				while((lcv+1 < argc) && (argv[lcv+1][0] != '-'))
+				{
+					gopt.batch++;
+					lcv++;
+				}
+
+				if(gopt.batch == 0)
+					usage (argv[0]);
+				break;
 
 
 			default:
@@ -219,6 +411,15 @@ void Parse_Arguments(int32 argc, char* argv[])
 		}
 	}
 
+	/* Batch mode runs from files, on file time, with nobody watching */
+	if(gopt.batch)
+	{
+		gopt.source = SOURCE_FILE;
+		gopt.realtime = 0;
+		gopt.mode = 0;
+		gopt.recorder = 0;
+	}
+
 	echo_options();
 
 }
@@ -293,8 +494,15 @@ int32 Object_Init(void)
 	/* Get start of receiver */
 	gettimeofday(&starttime, NULL);
 
+	/* Batch mode drives the receiver itself and has no user, front end or GUI to look after */
+	pKeyboard = NULL;
+	pTelemetry = NULL;
+	pCommando = NULL;
+	pPatience = NULL;
+
 	/* Create Keyboard object to handle user input */
-	pKeyboard = new Keyboard();
+	if(!gopt.batch)
+		pKeyboard = new Keyboard();
 
 	/* Now do the hard work? */
 	pAcquisition = new Acquisition(IF_SAMPLE_FREQUENCY, IF_FREQUENCY);
@@ -305,27 +513,58 @@ int32 Object_Init(void)
 	/* Drive the acquisition process */
 	pSV_Select = new SV_Select;
 
-	/* Output info to the GUI */
-	pTelemetry = new Telemetry();
+	/* And predict the constellation for it */
+	pPredictor = new Predictor;
+
+	if(!gopt.batch)
+	{
+		/* Output info to the GUI */
+		pTelemetry = new Telemetry();
 
-	/* Serial or named pipe */
-	pTelemetry->SetType(gopt.tlm_type);
+		/* Serial or named pipe */
+		pTelemetry->SetType(gopt.tlm_type);
 
-	/* execute user commands */
-	pCommando = new Commando();
+		/* execute user commands */
+		pCommando = new Commando();
+	}
 
 	/* Form a nav solution */
 	pPVT = new PVT();
 
+	/* And filter its measurements */
+	pEKF = new EKF();
+
+	/* Log the channels from its own thread */
+	pChanLog = NULL;
+	if(gopt.log_channel)
+		pChanLog = new Chan_Log("chan.chl", gopt.compress);
+
+	/* One frequency search plan for all the channels */
+	pFreqLock = new Freq_Lock();
+
 	/* Create the tracking channels */
 	for(lcv = 0; lcv < MAX_CHANNELS; lcv++)
 		pChannels[lcv] = new Channel(lcv);
 
+	/* And the thread that closes their loops */
+	pTracking = new Tracking();
+
+	/* Record the IF data from its own thread */
+	pRecorder = NULL;
+	if(gopt.recorder && (gopt.source != SOURCE_FILE))
+		pRecorder = new Recorder(".", gopt.mode ? 2 : 1, gopt.compress);
+
 	/* Get data from either the USRP/GN3S/disk */
 	pFIFO = new FIFO;
 
 	/* Startup Watchdog */
-	pPatience = new Patience;
+	if(!gopt.batch)
+		pPatience = new Patience;
+
+	/* Counters for monitoring */
+	pMetrics = NULL;
+	if(!gopt.batch && gopt.metrics[0])
+		pMetrics = new Metrics;
 
 	pCorrelator = new Correlator();
 
@@ -347,34 +586,27 @@ int32 Pipes_Init(void)
 {
 	int32 lcv;
 
-	/* Create all of the pipes */
-	pipe((int *)SVS_2_COR_P);
-	pipe((int *)CHN_2_EPH_P);
-	pipe((int *)PVT_2_TLM_P);
-	pipe((int *)SVS_2_TLM_P);
-	pipe((int *)EKF_2_TLM_P);
-	pipe((int *)CMD_2_TLM_P);
-	pipe((int *)ACQ_2_SVS_P);
-	pipe((int *)EKF_2_SVS_P);
-	pipe((int *)PVT_2_SVS_P);
-	pipe((int *)TLM_2_CMD_P);
-	pipe((int *)SVS_2_ACQ_P);
-	pipe((int *)COR_2_ACQ_P);
-	pipe((int *)ISRP_2_PVT_P);
-	pipe((int *)ISRM_2_PVT_P);
-
-	/* Setup some of the non-blocking pipes */
-	fcntl(COR_2_ACQ_P[WRITE], F_SETFL, O_NONBLOCK);
-	fcntl(EKF_2_SVS_P[WRITE], F_SETFL, O_NONBLOCK);
-	fcntl(SVS_2_TLM_P[WRITE], F_SETFL, O_NONBLOCK);
-	fcntl(PVT_2_SVS_P[WRITE], F_SETFL, O_NONBLOCK);
-	fcntl(EKF_2_SVS_P[READ],  F_SETFL, O_NONBLOCK);
-	fcntl(SVS_2_COR_P[READ],  F_SETFL, O_NONBLOCK);
-	fcntl(SVS_2_TLM_P[READ],  F_SETFL, O_NONBLOCK);
-	fcntl(PVT_2_TLM_P[READ],  F_SETFL, O_NONBLOCK);
-	fcntl(SVS_2_TLM_P[READ],  F_SETFL, O_NONBLOCK);
-	fcntl(EKF_2_TLM_P[READ],  F_SETFL, O_NONBLOCK);
-	fcntl(CMD_2_TLM_P[READ],  F_SETFL, O_NONBLOCK);
+	/* Create all of the queues */
+	SVS_2_COR_P = new SPSC_Queue<Acq_Command_S, 16>;
+	CHN_2_EPH_P = new MPSC_Queue<Channel_2_Ephemeris_S, 64>;
+	PVT_2_TLM_P = new SPSC_Queue<PVT_2_TLM_S, 4>;
+	PVT_2_EKF_P = new SPSC_Queue<PVT_2_EKF_S, 4>;
+	SVS_2_TLM_P = new SPSC_Queue<SVS_2_TLM_S, 64>;
+	EKF_2_TLM_P = new SPSC_Queue<EKF_2_TLM_S, 4>;
+	CMD_2_TLM_P = new SPSC_Queue<Message_Packet_S, 16>;
+	ACQ_2_SVS_P = new SPSC_Queue<Acq_Command_S, 16>;
+	EKF_2_SVS_P = new SPSC_Queue<EKF_2_SVS_S, 4>;
+	PVT_2_SVS_P = new SPSC_Queue<PVT_2_SVS_S, 4>;
+	TLM_2_CMD_P = new SPSC_Queue<Command_Packet_S, 16>;
+	SVS_2_ACQ_P = new SPSC_Queue<Acq_Command_S, 16>;
+	COR_2_ACQ_P = new SPSC_Queue<ms_packet, 16>;
+	ISRM_2_PVT_P = new SPSC_Queue<ISR_2_PVT_S, 4>;
+
+	for(lcv = 0; lcv < MAX_CHANNELS; lcv++)
+	{
+		COR_2_TRK_P[lcv] = new SPSC_Queue<Dump_S, 32>;
+		TRK_2_COR_P[lcv] = new SPSC_Queue<NCO_Command_S, 32>;
+	}
 
 	if(gopt.verbose)
 	{
@@ -397,13 +629,30 @@ int32 Thread_Init(void)
 	/* Set the global run flag to true */
 	grun = 0x1;
 
+	/* Keep the objects and everything the threads allocate from here on resident */
+	if(gopt.lock_memory)
+	{
+		if(mlockall(MCL_CURRENT | MCL_FUTURE) == 0)
+			fprintf(stdout,"Locked memory\n");
+		else
+			fprintf(stdout,"Could not lock memory (%s), check ulimit -l\n", strerror(errno));
+	}
+
 	/* Start the keyboard thread to handle user input from stdio */
 	pKeyboard->Start();
 
+	/* The EKF first, so it is waiting on the PVT's first epoch */
+	pEKF->Start();
+
 	/* Startup the PVT sltn */
 	pPVT->Start();
 
-	/* Start up the correlators */
+	/* The channel log has to be draining before the channels dump */
+	if(pChanLog != NULL)
+		pChanLog->Start();
+
+	/* Start up the tracking loops, then the correlators that feed them */
+	pTracking->Start();
 	pCorrelator->Start();
 
 	/* Start up the acquistion */
@@ -415,12 +664,21 @@ int32 Thread_Init(void)
 	/* Start up the command interface */
 	pCommando->Start();
 
-	/* Start the SV select thread */
+	/* Start the SV select thread, and the predictor it works from */
+	pPredictor->Start();
 	pSV_Select->Start();
 
 	/* Last thing to do */
 	pTelemetry->Start();
 
+	/* Serve the counters */
+	if(pMetrics != NULL)
+		pMetrics->Start();
+
+	/* Start the recorder before anything gets pushed to it */
+	if(pRecorder != NULL)
+		pRecorder->Start();
+
 	/* Start up the FIFO */
 	pFIFO->Start();
 
@@ -48,6 +48,14 @@ int main(int argc, char* argv[])
 		return(-1);
 	}
 
+	/* Regression and throughput runs over recorded files, no threads */
+	if(gopt.batch)
+	{
+		success = (Batch_Process() == 0);
+		Hardware_Shutdown();
+		return(success ? 1 : -1);
+	}
+
 	if(success)
 	{
 		success = Pipes_Init();
@@ -32,40 +32,93 @@
 #include "keyboard.h"			//!< Handle user input via keyboard
 #include "channel.h"			//!< Tracking channels
 #include "correlator.h"			//!< Correlator
+#include "tracking.h"			//!< Runs the channels' loops
 #include "acquisition.h"		//!< Acquisition
 #include "pvt.h"				//!< PVT solution
+#include "ekf.h"				//!< Navigation filter
 #include "ephemeris.h"			//!< Ephemeris decode
 #include "telemetry.h"			//!< Telemetry
 #include "commando.h"			//!< Command interface
 #include "sv_select.h"			//!< Drives acquisition/reacquisition process
+#include "predictor.h"			//!< Constellation prediction for the SV select
 #include "gps_source.h"			//!< Get GPS data
 #include "patience.h"
+#include "recorder.h"			//!< Record IF data to disk
+#include "metrics.h"			//!< Counters for monitoring
+#include "chan_log.h"			//!< High rate channel log
+#include "freq_lock.h"			//!< Shared frequency search
 /*----------------------------------------------------------------------------------------------*/
 
 
 /*----------------------------------------------------------------------------------------------*/
-/*! First stop all threads */
+/*! First stop all threads. Every thread is asked to stop and woken up before any is joined, so
+ *  the whole thing takes about as long as the slowest one rather than the sum of them. */
 void Thread_Shutdown(void)
 {
+	uint64 t0;
 
-	/* Start the keyboard thread to handle user input from stdio */
-	pKeyboard->Stop();
+	t0 = tsc_now();
 
-	/* Stop the WatchDog */
+	/* Stop the WatchDog first, it must not restart the FIFO under us */
 	pPatience->Stop();
 
+	/* Nothing sleeps on a queue or the FIFO from here on */
+	grun = 0x0;
+	Pipes_Close();
+	pFIFO->Close();
+
+	pKeyboard->RequestStop();
+	pFIFO->RequestStop();
+	if(pRecorder != NULL)
+		pRecorder->RequestStop();
+	if(pMetrics != NULL)
+		pMetrics->RequestStop();
+	if(pChanLog != NULL)
+		pChanLog->RequestStop();
+	pTelemetry->RequestStop();
+	pPVT->RequestStop();
+	pEKF->RequestStop();
+	pCorrelator->RequestStop();
+	pTracking->RequestStop();
+	pAcquisition->RequestStop();
+	pEphemeris->RequestStop();
+	pCommando->RequestStop();
+	pSV_Select->RequestStop();
+	pPredictor->RequestStop();
+
+	/* Start the keyboard thread to handle user input from stdio */
+	pKeyboard->Stop();
+
 	/* Stop the FIFO */
 	pFIFO->Stop();
 
+	/* Stop the recorder, it gets drained when deleted */
+	if(pRecorder != NULL)
+		pRecorder->Stop();
+
+	/* Stop the metrics */
+	if(pMetrics != NULL)
+		pMetrics->Stop();
+
 	/* Stop the telemetry */
 	pTelemetry->Stop();
 
 	/* Uh-oh */
 	pPVT->Stop();
 
+	/* And the filter behind it */
+	pEKF->Stop();
+
 	/* Stop the correlator */
 	pCorrelator->Stop();
 
+	/* And the loops it was feeding */
+	pTracking->Stop();
+
+	/* Then the channel log they were feeding, it gets drained when deleted */
+	if(pChanLog != NULL)
+		pChanLog->Stop();
+
 	/* Stop the acquistion */
 	pAcquisition->Stop();
 
@@ -78,6 +131,70 @@ void Thread_Shutdown(void)
 	/* Stop the tracking */
 	pSV_Select->Stop();
 
+	/* And its predictor */
+	pPredictor->Stop();
+
+	fprintf(stdout,"\nAll threads stopped in %.1f ms\n", tsc_ns(tsc_now() - t0)/1e6);
+
+	/* Dump the task latencies */
+	fprintf(stdout,"\n%-14s %10s %10s %10s %10s %10s %10s\n","Task latency","samples","mean us","p50 us","p99 us","p99.9 us","max us");
+	pFIFO->PrintLatency(stdout);
+	pCorrelator->PrintLatency(stdout);
+	pTracking->PrintLatency(stdout);
+	pAcquisition->PrintLatency(stdout);
+	pSV_Select->PrintLatency(stdout);
+	pPredictor->PrintLatency(stdout);
+	pEphemeris->PrintLatency(stdout);
+	pPVT->PrintLatency(stdout);
+	pEKF->PrintLatency(stdout);
+	pTelemetry->PrintLatency(stdout);
+	pCommando->PrintLatency(stdout);
+	if(pRecorder != NULL)
+		pRecorder->PrintLatency(stdout);
+	if(pMetrics != NULL)
+		pMetrics->PrintLatency(stdout);
+	if(pChanLog != NULL)
+		pChanLog->PrintLatency(stdout);
+
+	/* And how close the correlator came to falling behind */
+	pCorrelator->PrintBudget(stdout);
+
+#ifdef PROFILE
+	/* Every sampled thread has been joined, so the tables can be read without a lock */
+	Profile_Dump(PROFILE_FILE);
+#endif
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+/*! Close all pipes, anything blocked in a Send/Receive returns false */
+void Pipes_Close(void)
+{
+	int32 lcv;
+
+	SVS_2_COR_P->Close();
+	CHN_2_EPH_P->Close();
+	PVT_2_TLM_P->Close();
+	PVT_2_EKF_P->Close();
+	SVS_2_TLM_P->Close();
+	EKF_2_TLM_P->Close();
+	CMD_2_TLM_P->Close();
+	ACQ_2_SVS_P->Close();
+	EKF_2_SVS_P->Close();
+	PVT_2_SVS_P->Close();
+	TLM_2_CMD_P->Close();
+	SVS_2_ACQ_P->Close();
+	COR_2_ACQ_P->Close();
+	ISRM_2_PVT_P->Close();
+
+	for(lcv = 0; lcv < MAX_CHANNELS; lcv++)
+	{
+		COR_2_TRK_P[lcv]->Close();
+		TRK_2_COR_P[lcv]->Close();
+	}
+
 }
 /*----------------------------------------------------------------------------------------------*/
 
@@ -86,36 +203,28 @@ void Thread_Shutdown(void)
 /*! Shutdown all pipes */
 void Pipes_Shutdown(void)
 {
+	int32 lcv;
+
+	delete SVS_2_COR_P;
+	delete CHN_2_EPH_P;
+	delete PVT_2_TLM_P;
+	delete PVT_2_EKF_P;
+	delete SVS_2_TLM_P;
+	delete EKF_2_TLM_P;
+	delete CMD_2_TLM_P;
+	delete ACQ_2_SVS_P;
+	delete EKF_2_SVS_P;
+	delete PVT_2_SVS_P;
+	delete TLM_2_CMD_P;
+	delete SVS_2_ACQ_P;
+	delete COR_2_ACQ_P;
+	delete ISRM_2_PVT_P;
 
-	close(SVS_2_COR_P[READ]);
-	close(CHN_2_EPH_P[READ]);
-	close(PVT_2_TLM_P[READ]);
-	close(SVS_2_TLM_P[READ]);
-	close(EKF_2_TLM_P[READ]);
-	close(CMD_2_TLM_P[READ]);
-	close(ACQ_2_SVS_P[READ]);
-	close(EKF_2_SVS_P[READ]);
-	close(PVT_2_SVS_P[READ]);
-	close(TLM_2_CMD_P[READ]);
-	close(SVS_2_ACQ_P[READ]);
-	close(COR_2_ACQ_P[READ]);
-	close(ISRP_2_PVT_P[READ]);
-	close(ISRM_2_PVT_P[READ]);
-
-	close(SVS_2_COR_P[WRITE]);
-	close(CHN_2_EPH_P[WRITE]);
-	close(PVT_2_TLM_P[WRITE]);
-	close(SVS_2_TLM_P[WRITE]);
-	close(EKF_2_TLM_P[WRITE]);
-	close(CMD_2_TLM_P[WRITE]);
-	close(ACQ_2_SVS_P[WRITE]);
-	close(EKF_2_SVS_P[WRITE]);
-	close(PVT_2_SVS_P[WRITE]);
-	close(TLM_2_CMD_P[WRITE]);
-	close(SVS_2_ACQ_P[WRITE]);
-	close(COR_2_ACQ_P[WRITE]);
-	close(ISRP_2_PVT_P[WRITE]);
-	close(ISRM_2_PVT_P[WRITE]);
+	for(lcv = 0; lcv < MAX_CHANNELS; lcv++)
+	{
+		delete COR_2_TRK_P[lcv];
+		delete TRK_2_COR_P[lcv];
+	}
 
 }
 /*----------------------------------------------------------------------------------------------*/
@@ -128,20 +237,36 @@ void Object_Shutdown(void)
 	int32 lcv;
 
 	delete pCorrelator;
+	delete pTracking;
 
 	for(lcv = 0; lcv < MAX_CHANNELS; lcv++)
 		delete pChannels[lcv];
+	delete pFreqLock;
+
+	/* Nothing pushes to the log any more, write out the rest and the index */
+	if(pChanLog != NULL)
+		delete pChanLog;
+
+	/* Flush the recorder while the FIFO packets are still around */
+	if(pRecorder != NULL)
+		delete pRecorder;
 
 	delete pKeyboard;
 	delete pAcquisition;
 	delete pEphemeris;
 	delete pFIFO;
 	delete pSV_Select;
+	delete pPredictor;
 	delete pTelemetry;
 	delete pPVT;
+	delete pEKF;
 	delete pCommando;
 	delete pPatience;
 
+	/* Unlinks the socket */
+	if(pMetrics != NULL)
+		delete pMetrics;
+
 }
 /*----------------------------------------------------------------------------------------------*/
 
@@ -19,9 +19,12 @@ function [A] = get_chan(chan)
 % int32 count;		//!< Number of accumulations that have been processed
 % int32 subframe;		//!< Current subframe number
 % int32 best_epoch;	//!< Best estimate of bit edge position
+% int32 l2_*;			//!< 7 L2 fields
+% int32 I[3], Q[3], P_buff[20]
+%
+% The receiver logs to chan.chl, run chanlog-convert in the receiver directory first
 
-
-pts = 19+6+20;
+pts = 26+6+20;
 
 fp = fopen(sprintf('../chan%02d.dat',chan),'rb');
 A(:,1) = fread(fp,inf,'int32'); 
@@ -36,9 +36,11 @@ void *Acquisition_Thread(void *_arg)
 
 	Acquisition *aAcquisition = pAcquisition;
 
-	while(grun)
+	while(aAcquisition->Running())
 	{
 		aAcquisition->Import();
+		if(!aAcquisition->Running())
+			break;
 		aAcquisition->Acquire();
 		aAcquisition->Export(NULL);
 		aAcquisition->IncExecTic();
@@ -77,6 +79,7 @@ Acquisition::Acquisition(float _fsample, float _fif):Threaded_Object("ACQTASK")
 	/* Acq state */
 	sv = 0;
 	state = ACQ_TYPE_STRONG;
+	ms = ms_per_read = lastcount = 0;
 
 	/* Grab some constants */
 	fif = _fif;
@@ -194,6 +197,8 @@ void Acquisition::doPrepIF(int32 _type, CPX *_buff)
 	int32 lcv, ms;
 	CPX *p;
 
+	PROFILE_SCOPE("Acquisition::doPrepIF");
+
 	switch(_type)
 	{
 		case 0:
@@ -258,8 +263,9 @@ Acq_Command_S Acquisition::doAcqStrong(int32 _sv, int32 _doppmin, int32 _doppmax
 		for(lcv2 = 0; lcv2 < 4; lcv2 ++)
 		{
 
-			if(gopt.realtime)
-				usleep(1000);
+			/* Give the CPU back, and bail out if the receiver is stopping */
+			if(gopt.realtime && !Pause(1000))
+				return(results[_sv]);
 
 			/* Multiply in frequency domain, shifting appropriately */
 			sse_cmulsc(&baseband_rows[lcv2][100+lcv], fft_codes[_sv], msbuff, resamps_ms, 10);
@@ -331,8 +337,8 @@ Acq_Command_S Acquisition::doAcqMedium(int32 _sv, int32 _doppmin, int32 _doppmax
 			k = 0;
 			{
 
-				if(gopt.realtime)
-					usleep(1000);
+				if(gopt.realtime && !Pause(1000))
+					return(results[_sv]);
 
 				/* Do the 10 ms of coherent integration */
 				for(lcv3 = 0; lcv3 < 10; lcv3++)
@@ -466,8 +472,8 @@ Acq_Command_S Acquisition::doAcqWeak(int32 _sv, int32 _doppmin, int32 _doppmax)
 				for(i = 0; i < 15; i++)
 				{
 
-					if(gopt.realtime)
-						usleep(1000);
+					if(gopt.realtime && !Pause(1000))
+						return(results[_sv]);
 
 					/* Do the 10 ms of coherent integration */
 					for(lcv3 = 0; lcv3 < 10; lcv3++)
@@ -579,7 +585,7 @@ void Acquisition::Acquire()
 {
 	int32 lcv;
 
-	IncStopTic();
+	IncStartTic();
 
 	switch(request.type)
 	{
@@ -599,7 +605,7 @@ void Acquisition::Acquire()
 			doAcqStrong(request.sv, request.mindopp, request.maxdopp);
 	}
 
-	IncStartTic();
+	IncStopTic();
 }
 /*----------------------------------------------------------------------------------------------*/
 
@@ -610,19 +616,32 @@ void Acquisition::Acquire()
  * */
 void Acquisition::Import()
 {
-	int32 last;
-	int32 bread;
-	int32 lastcount;
-	int32 ms;
-	int32 ms_per_read;
-	int32 lcv;
-	timespec ret;
-
-	ret.tv_sec = 0;
-	ret.tv_nsec = 100000;
 
 	/* First wait for a request */
-	bread = read(SVS_2_ACQ_P[READ], &request, sizeof(Acq_Command_S));
+	if(!SVS_2_ACQ_P->Receive(&request))
+		return;
+	Request();
+
+	/* Collect necessary data */
+	while(ms < ms_per_read)
+	{
+		/* Read a packet in */
+		if(!COR_2_ACQ_P->Receive(&packet))
+			return;
+		Collect();
+	}
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+/*!
+ * Request:
+ * */
+void Acquisition::Request()
+{
+
 	memcpy(&results[request.sv],&request,sizeof(Acq_Command_S));
 
 	switch(request.type)
@@ -640,39 +659,71 @@ void Acquisition::Import()
 			ms_per_read = 310;
 	}
 
-	/* Flush the pipe */
-	for(lcv = 0; lcv < 10; lcv++)
-		read(COR_2_ACQ_P[READ], &packet, sizeof(ms_packet));
+	/* Flush the queue, only want fresh data */
+	COR_2_ACQ_P->Flush();
 
-	/* Collect necessary data */
 	lastcount = 0; ms = 0;
-	while((ms < ms_per_read) && grun)
-	{
-		/* Get the tail */
-		last = packet.count;
 
-		/* Read a packet in */
-		read(COR_2_ACQ_P[READ], &packet, sizeof(ms_packet));
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+/*!
+ * Collect:
+ * */
+void Acquisition::Collect()
+{
 
-		memcpy(&buff[SAMPS_MS*ms], &packet.data, SAMPS_MS*sizeof(CPX));
+	memcpy(&buff[SAMPS_MS*ms], &packet.data, SAMPS_MS*sizeof(CPX));
 
-		/* Detect broken packets */
-		if(ms > 0)
+	/* Detect broken packets */
+	if(ms > 0)
+	{
+		if((packet.count - lastcount) != 1)
 		{
-			if((packet.count - lastcount) != 1)
-			{
-				fprintf(stdout,"Broken GPS stream %d,%d\n",packet.count,lastcount);
-				ms = 0; /* Recollect data */
-			}
+			fprintf(stdout,"Broken GPS stream %d,%d\n",packet.count,lastcount);
+			ms = 0; /* Recollect data */
 		}
-		else
-			request.count = packet.count;
+	}
+	else
+		request.count = packet.count;
 
-		ms++;
-		lastcount = packet.count;
+	ms++;
+	lastcount = packet.count;
 
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+/*!
+ * Step: The batch mode version of the thread, takes whatever the FIFO has passed on so far and
+ * returns true once it has acquired and exported a result
+ * */
+int32 Acquisition::Step()
+{
+
+	if(ms_per_read == 0)
+	{
+		if(!SVS_2_ACQ_P->TryReceive(&request))
+			return(false);
+		Request();
 	}
 
+	while((ms < ms_per_read) && COR_2_ACQ_P->TryReceive(&packet))
+		Collect();
+
+	if(ms < ms_per_read)
+		return(false);
+
+	Acquire();
+	Export(NULL);
+	IncExecTic();
+	ms_per_read = 0;
+
+	return(true);
+
 }
 /*----------------------------------------------------------------------------------------------*/
 
@@ -712,7 +763,7 @@ void Acquisition::Export(char * _fname)
 
 	/* Write result to the tracking task */
 	results[request.sv].count = request.count;
-	write(ACQ_2_SVS_P[WRITE], &results[request.sv], sizeof(Acq_Command_S));
+	ACQ_2_SVS_P->Send(&results[request.sv]);
 
 }
 /*----------------------------------------------------------------------------------------------*/
@@ -74,6 +74,9 @@ class Acquisition : public Threaded_Object
 		int32 corr;								//!< This correlator requested an acquisition
 		Acq_Command_S request;					//!< Acquisition transaction
 		Acq_Command_S results[MAX_SV];			//!< Where to store the results
+		int32 ms;								//!< ms of data collected for the request
+		int32 ms_per_read;						//!< ms of data the request needs, 0 when idle
+		int32 lastcount;						//!< Packet count of the last ms collected
 
 	public:
 
@@ -85,6 +88,9 @@ class Acquisition : public Threaded_Object
 		void doPrepIF(int32 _type, CPX *_buff);												//!< Prep the IF (done once if detecting multiple SVs in same data set)
 		void doDFT(CPX *in);
 		void Import();																		//!< Get a chuck of data to operate on
+		void Request();																		//!< Set up to collect data for a new request
+		void Collect();																		//!< Add the packet to the data collected
+		int32 Step();																		//!< Batch mode, acquire once enough data has come through, never blocks
 		void Export(char *_fname);															//!< Dump results
 		void Acquire();																		//!< Acquire with respect to current state
 		void Start();
@@ -0,0 +1,576 @@
+/*----------------------------------------------------------------------------------------------*/
+/*! \file chan_log.cpp
+//
+// FILENAME: chan_log.cpp
+//
+// DESCRIPTION: Implements member functions of the Chan_Log and Chan_Log_Reader classes.
+//
+// DEVELOPERS: Gregory W. Heckler (2003-2009)
+//
+// LICENSE TERMS: Copyright (c) Gregory W. Heckler 2009
+//
+// This file is part of the GPS Software Defined Radio (GPS-SDR)
+//
+// The GPS-SDR is free software; you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation; either version 2 of
+// the License, or (at your option) any later version. The GPS-SDR is distributed in the hope that
+// it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// Note:  Comments within this file follow a syntax that is compatible with
+//        DOXYGEN and are utilized for automated document extraction
+//
+// Reference:
+*/
+/*----------------------------------------------------------------------------------------------*/
+
+#define _FILE_OFFSET_BITS 64	//!< An hour of -c on every channel is over 8 GB raw
+
+#include "chan_log.h"
+
+/*----------------------------------------------------------------------------------------------*/
+/*! Delta code _cnt records against the previous record of the same channel, returns the bytes */
+int32 chl_encode(Chan_Log_S *_in, int32 _cnt, uint8 *_out)
+{
+	int32 prev[MAX_CHANNELS][CHL_WORDS];
+	uint8 *p, *mask;
+	int32 *w;
+	uint32 z;
+	int32 lcv, k, chan;
+
+	memset(prev, 0x0, sizeof(prev));
+	p = _out;
+
+	for(lcv = 0; lcv < _cnt; lcv++)
+	{
+		w = (int32 *)&_in[lcv];
+		chan = _in[lcv].packet.chan;
+		if((chan < 0) || (chan >= MAX_CHANNELS))
+			chan = 0;
+
+		*p++ = chan;
+		mask = p;
+		memset(mask, 0x0, (CHL_WORDS+7)/8);
+		p += (CHL_WORDS+7)/8;
+
+		for(k = 0; k < (int32)CHL_WORDS; k++)
+		{
+			if(w[k] == prev[chan][k])
+				continue;
+
+			mask[k >> 3] |= 1 << (k & 7);
+
+			/* Zigzag so small negative steps stay short, then LEB128 */
+			z = (uint32)(w[k] - prev[chan][k]);
+			z = (z << 1) ^ (uint32)((int32)z >> 31);
+			while(z >= 0x80)
+			{
+				*p++ = (z & 0x7f) | 0x80;
+				z >>= 7;
+			}
+			*p++ = z;
+
+			prev[chan][k] = w[k];
+		}
+	}
+
+	return(p - _out);
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+/*! Undo chl_encode(), returns the records decoded, fewer than _cnt if _in is short or corrupt */
+int32 chl_decode(uint8 *_in, int32 _bytes, Chan_Log_S *_out, int32 _cnt)
+{
+	int32 prev[MAX_CHANNELS][CHL_WORDS];
+	uint8 *p, *end, *mask;
+	int32 *w;
+	uint32 z;
+	int32 lcv, k, chan, shift;
+
+	memset(prev, 0x0, sizeof(prev));
+	p = _in;
+	end = _in + _bytes;
+
+	for(lcv = 0; lcv < _cnt; lcv++)
+	{
+		if(end - p < (int32)(1 + (CHL_WORDS+7)/8))
+			break;
+
+		chan = *p++;
+		if(chan >= MAX_CHANNELS)
+			break;
+
+		mask = p;
+		p += (CHL_WORDS+7)/8;
+
+		for(k = 0; k < (int32)CHL_WORDS; k++)
+		{
+			if(mask[k >> 3] & (1 << (k & 7)))
+			{
+				z = 0;
+				shift = 0;
+				do
+				{
+					if((p == end) || (shift > 28))
+						return(lcv);
+					z |= (uint32)(*p & 0x7f) << shift;
+					shift += 7;
+				} while(*p++ & 0x80);
+
+				prev[chan][k] += (int32)((z >> 1) ^ -(z & 1));
+			}
+		}
+
+		w = (int32 *)&_out[lcv];
+		memcpy(w, prev[chan], sizeof(Chan_Log_S));
+	}
+
+	return(lcv);
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void *Chan_Log_Thread(void *_arg)
+{
+
+	Chan_Log *aChan_Log = pChanLog;
+
+	while(aChan_Log->Running())
+	{
+		aChan_Log->Import();
+		aChan_Log->IncExecTic();
+		aChan_Log->Pause(10000);
+	}
+
+	pthread_exit(0);
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void Chan_Log::Start()
+{
+
+	Start_Thread(Chan_Log_Thread, NULL);
+
+	if(gopt.verbose)
+		fprintf(stdout,"Channel log thread started\n");
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+Chan_Log::Chan_Log(const char *_fname, int32 _compress):Threaded_Object("LOGTASK")
+{
+	CHL_Header hdr;
+
+	object_mem = this;
+	size = sizeof(Chan_Log);
+
+	compress = _compress;
+	head = tail = 0;
+	chunk_records = chunks = 0;
+	records = dropped = errors = 0;
+	raw_bytes = out_bytes = 0;
+	max_write = 0;
+
+	/* Fault the ring in now rather than on the tracking thread */
+	memset(queue, 0x0, sizeof(queue));
+
+	chunk = (Chan_Log_S *)malloc(CHL_CHUNK*sizeof(Chan_Log_S));
+	coded = (uint8 *)malloc(CHL_CHUNK*CHL_RECORD_MAX);
+	index_size = 1024;
+	index = (int64 *)malloc(index_size*sizeof(int64));
+
+	fp = fopen(_fname, "wb");
+	if(fp != NULL)
+	{
+		setvbuf(fp, NULL, _IOFBF, 1 << 20);
+
+		hdr.magic = CHL_MAGIC;
+		hdr.record_bytes = sizeof(Chan_Log_S);
+		hdr.channels = MAX_CHANNELS;
+		hdr.chunk = CHL_CHUNK;
+		fwrite(&hdr, sizeof(CHL_Header), 1, fp);
+
+		fprintf(stdout,"%s opened%s\n", _fname, compress ? " (delta coded)" : "");
+	}
+	else
+		fprintf(stdout,"Could not open %s for the channel log\n", _fname);
+
+	fflush(stdout);
+
+	if(gopt.verbose)
+		fprintf(stdout,"Creating Chan_Log\n");
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+Chan_Log::~Chan_Log()
+{
+	CHL_Trailer trailer;
+
+	/* The tracking is stopped, get whatever is left */
+	Import();
+	if(chunk_records)
+		Write();
+
+	if(fp != NULL)
+	{
+		trailer.magic = CHL_INDEX;
+		trailer.chunks = chunks;
+		trailer.index = ftello(fp);
+		fwrite(index, sizeof(int64), chunks, fp);
+		fwrite(&trailer, sizeof(CHL_Trailer), 1, fp);
+		fclose(fp);
+	}
+
+	fprintf(stdout,"Chan_Log: %u records in %d chunks, %u dropped, %u errors, %.1f ms max write, %.2f:1\n",
+		records, chunks, dropped, errors, max_write, getRatio());
+	fflush(stdout);
+
+	free(chunk);
+	free(coded);
+	free(index);
+
+	if(gopt.verbose)
+		fprintf(stdout,"Destructing Chan_Log\n");
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void Chan_Log::Push(Channel_M *_packet, int32 *_I, int32 *_Q, int32 *_P_buff)
+{
+	Chan_Log_S *r;
+
+	if((tail - head) >= CHL_QUEUE)
+	{
+		dropped++;
+		return;
+	}
+
+	r = &queue[tail & (CHL_QUEUE-1)];
+	memcpy(&r->packet, _packet, sizeof(Channel_M));
+	memcpy(r->I, _I, 3*sizeof(int32));
+	memcpy(r->Q, _Q, 3*sizeof(int32));
+	memcpy(r->P_buff, _P_buff, 20*sizeof(int32));
+
+	__sync_synchronize();
+	tail = tail + 1;
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void Chan_Log::Import()
+{
+	uint32 avail, n;
+
+	IncStartTic();
+
+	while(head != tail)
+	{
+		__sync_synchronize();
+
+		/* Copy out as much as fits in the chunk in one go */
+		avail = tail - head;
+		n = CHL_QUEUE - (head & (CHL_QUEUE-1));
+		if(n > avail)
+			n = avail;
+		if(n > (uint32)(CHL_CHUNK - chunk_records))
+			n = CHL_CHUNK - chunk_records;
+
+		memcpy(&chunk[chunk_records], &queue[head & (CHL_QUEUE-1)], n*sizeof(Chan_Log_S));
+		chunk_records += n;
+
+		__sync_synchronize();
+		head = head + n;
+
+		if(chunk_records == CHL_CHUNK)
+			Write();
+	}
+
+	IncStopTic();
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void Chan_Log::Write()
+{
+	struct timeval t0, t1;
+	CHL_Chunk chdr;
+	uint8 *out;
+	double ms;
+
+	gettimeofday(&t0, NULL);
+
+	chdr.magic = CHL_CHUNK_ID;
+	chdr.first_tic = chunk[0].packet.tic;
+	chdr.records = chunk_records;
+	chdr.bytes = chunk_records*sizeof(Chan_Log_S);
+	chdr.coded = 0;
+	out = (uint8 *)chunk;
+
+	/* Keep the raw records if coding does not pay */
+	if(compress)
+	{
+		chdr.bytes = chl_encode(chunk, chunk_records, coded);
+		chdr.coded = 1;
+		out = coded;
+		if(chdr.bytes >= (int32)(chunk_records*sizeof(Chan_Log_S)))
+		{
+			chdr.bytes = chunk_records*sizeof(Chan_Log_S);
+			chdr.coded = 0;
+			out = (uint8 *)chunk;
+		}
+	}
+
+	if(fp != NULL)
+	{
+		if(chunks == index_size)
+		{
+			index_size *= 2;
+			index = (int64 *)realloc(index, index_size*sizeof(int64));
+		}
+		index[chunks] = ftello(fp);
+
+		if((fwrite(&chdr, sizeof(CHL_Chunk), 1, fp) != 1) ||
+			(fwrite(out, 1, chdr.bytes, fp) != (size_t)chdr.bytes))
+		{
+			fprintf(stdout,"Chan_Log write failed: %s\n", strerror(errno));
+			fclose(fp);
+			fp = NULL;
+			errors++;
+		}
+		else
+		{
+			chunks++;
+			records += chunk_records;
+			raw_bytes += chunk_records*sizeof(Chan_Log_S);
+			out_bytes += sizeof(CHL_Chunk) + chdr.bytes;
+		}
+	}
+
+	gettimeofday(&t1, NULL);
+
+	ms = 1e3*(t1.tv_sec - t0.tv_sec) + 1e-3*(t1.tv_usec - t0.tv_usec);
+	if(ms > max_write)
+		max_write = ms;
+
+	chunk_records = 0;
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+Chan_Log_Reader::Chan_Log_Reader(const char *_fname)
+{
+	CHL_Trailer trailer;
+
+	index = NULL;
+	buff = NULL;
+	buff_size = 0;
+	chunks = 0;
+	loaded = -1;
+	chunk_records = record = 0;
+	chunk = (Chan_Log_S *)malloc(CHL_CHUNK*sizeof(Chan_Log_S));
+
+	fp = fopen(_fname, "rb");
+	if(fp == NULL)
+		return;
+
+	/* The records are only comparable with a receiver built with the same messages.h */
+	if((fread(&hdr, sizeof(CHL_Header), 1, fp) != 1) || (hdr.magic != CHL_MAGIC) ||
+		(hdr.record_bytes != sizeof(Chan_Log_S)) || (hdr.channels > MAX_CHANNELS) ||
+		(hdr.chunk > CHL_CHUNK))
+	{
+		fclose(fp);
+		fp = NULL;
+		return;
+	}
+
+	/* Use the index if the file was closed cleanly */
+	fseeko(fp, -(int64)sizeof(CHL_Trailer), SEEK_END);
+	if((fread(&trailer, sizeof(CHL_Trailer), 1, fp) == 1) && (trailer.magic == CHL_INDEX))
+	{
+		chunks = trailer.chunks;
+		index = (int64 *)malloc((chunks+1)*sizeof(int64));
+		fseeko(fp, trailer.index, SEEK_SET);
+		if(fread(index, sizeof(int64), chunks, fp) != (size_t)chunks)
+			Scan();
+	}
+	else
+		Scan();
+
+	Seek(0);
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+Chan_Log_Reader::~Chan_Log_Reader()
+{
+	if(fp != NULL)
+		fclose(fp);
+
+	free(index);
+	free(buff);
+	free(chunk);
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void Chan_Log_Reader::Scan()
+{
+	CHL_Chunk chdr;
+	int64 offset, end;
+	int32 size;
+
+	free(index);
+	size = 1024;
+	index = (int64 *)malloc(size*sizeof(int64));
+	chunks = 0;
+
+	fseeko(fp, 0, SEEK_END);
+	end = ftello(fp);
+
+	offset = sizeof(CHL_Header);
+	fseeko(fp, offset, SEEK_SET);
+
+	/* A chunk cut short means the receiver died while writing it */
+	while((fread(&chdr, sizeof(CHL_Chunk), 1, fp) == 1) && (chdr.magic == CHL_CHUNK_ID) &&
+		(offset + (int64)sizeof(CHL_Chunk) + chdr.bytes <= end))
+	{
+		if(chunks == size)
+		{
+			size *= 2;
+			index = (int64 *)realloc(index, size*sizeof(int64));
+		}
+		index[chunks++] = offset;
+		offset += sizeof(CHL_Chunk) + chdr.bytes;
+		fseeko(fp, offset, SEEK_SET);
+	}
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+uint32 Chan_Log_Reader::FirstTic(int32 _chunk)
+{
+	CHL_Chunk chdr;
+
+	fseeko(fp, index[_chunk], SEEK_SET);
+	if(fread(&chdr, sizeof(CHL_Chunk), 1, fp) != 1)
+		return(0);
+
+	return(chdr.first_tic);
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+int32 Chan_Log_Reader::Load(int32 _chunk)
+{
+	CHL_Chunk chdr;
+
+	if((_chunk < 0) || (_chunk >= chunks))
+		return(0);
+
+	fseeko(fp, index[_chunk], SEEK_SET);
+	if((fread(&chdr, sizeof(CHL_Chunk), 1, fp) != 1) || (chdr.magic != CHL_CHUNK_ID) ||
+		(chdr.records < 0) || (chdr.records > CHL_CHUNK) || (chdr.bytes < 0))
+		return(0);
+
+	if(chdr.bytes > buff_size)
+	{
+		buff_size = chdr.bytes;
+		buff = (uint8 *)realloc(buff, buff_size);
+	}
+
+	if(fread(buff, 1, chdr.bytes, fp) != (size_t)chdr.bytes)
+		return(0);
+
+	if(chdr.coded)
+		chunk_records = chl_decode(buff, chdr.bytes, chunk, chdr.records);
+	else
+	{
+		chunk_records = chdr.bytes / sizeof(Chan_Log_S);
+		if(chunk_records > chdr.records)
+			chunk_records = chdr.records;
+		memcpy(chunk, buff, chunk_records*sizeof(Chan_Log_S));
+	}
+
+	loaded = _chunk;
+	record = 0;
+
+	return(1);
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+int32 Chan_Log_Reader::Seek(uint32 _tic)
+{
+	int32 lo, hi, mid;
+
+	if((fp == NULL) || (chunks == 0))
+		return(0);
+
+	/* Last chunk that starts at or before _tic */
+	lo = 0;
+	hi = chunks - 1;
+	while(lo < hi)
+	{
+		mid = (lo + hi + 1) / 2;
+		if(FirstTic(mid) <= _tic)
+			lo = mid;
+		else
+			hi = mid - 1;
+	}
+
+	if(!Load(lo))
+		return(0);
+
+	/* Then skip the records before _tic */
+	while(1)
+	{
+		for(; record < chunk_records; record++)
+			if(chunk[record].packet.tic >= _tic)
+				return(1);
+
+		if(!Load(loaded + 1))
+			return(0);
+	}
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+int32 Chan_Log_Reader::Read(Chan_Log_S *_r)
+{
+	if(fp == NULL)
+		return(0);
+
+	while(record >= chunk_records)
+		if(!Load(loaded + 1))
+			return(0);
+
+	memcpy(_r, &chunk[record++], sizeof(Chan_Log_S));
+
+	return(1);
+}
+/*----------------------------------------------------------------------------------------------*/
@@ -0,0 +1,181 @@
+/*----------------------------------------------------------------------------------------------*/
+/*! \file chan_log.h
+//
+// FILENAME: chan_log.h
+//
+// DESCRIPTION: Defines the Chan_Log class and the .chl channel log format.
+//
+// DEVELOPERS: Gregory W. Heckler (2003-2009)
+//
+// LICENSE TERMS: Copyright (c) Gregory W. Heckler 2009
+//
+// This file is part of the GPS Software Defined Radio (GPS-SDR)
+//
+// The GPS-SDR is free software; you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation; either version 2 of
+// the License, or (at your option) any later version. The GPS-SDR is distributed in the hope that
+// it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// Note:  Comments within this file follow a syntax that is compatible with
+//        DOXYGEN and are utilized for automated document extraction
+//
+// Reference:
+*/
+/*----------------------------------------------------------------------------------------------*/
+
+#ifndef CHAN_LOG_H_
+#define CHAN_LOG_H_
+
+#include "includes.h"
+
+/*! @file
+ *	The .chl format holds the -c channel records of every channel in one file, in the order the
+ *	channels dumped. Records are grouped into chunks of up to CHL_CHUNK. A chunk is either stored
+ *	raw or delta coded: every record starts with its channel number and a bitmap of the words
+ *	that differ from that channel's previous record in the chunk, followed by the zigzag LEB128
+ *	varint of each of those differences. Each chunk starts from zero, so chunks decode on their
+ *	own. An index of chunk offsets at the end of the file allows seeking by tic; if the index is
+ *	missing (the receiver died) the chunk headers are walked instead.
+ *
+ *	File:	CHL_Header, CHL_Chunk + records, ..., CHL_Chunk + records, index[chunks], CHL_Trailer
+ */
+
+#define CHL_MAGIC		(0x314C4843)	//!< "CHL1"
+#define CHL_CHUNK_ID	(0x434C4843)	//!< "CHLC"
+#define CHL_INDEX		(0x494C4843)	//!< "CHLI"
+#define CHL_CHUNK		(4096)			//!< Records per chunk
+#define CHL_QUEUE		(8192)			//!< Records in flight between the tracking and the writer, a power of 2
+#define CHL_WORDS		(sizeof(Chan_Log_S)/sizeof(int32))	//!< int32 words in a record
+#define CHL_RECORD_MAX	(1 + (CHL_WORDS+7)/8 + 5*CHL_WORDS)	//!< Worst case coded record bytes
+
+/*! \ingroup STRUCTS
+ *	@brief One -c record, laid out as the old chanXX.dat files so get_chan.m reads them */
+typedef struct Chan_Log_S
+{
+	Channel_M	packet;			//!< Channel state at the dump
+	int32		I[3];			//!< Early, prompt, late I
+	int32		Q[3];			//!< Early, prompt, late Q
+	int32		P_buff[20];		//!< Bit transition counts of the last 20 ms
+} Chan_Log_S;
+
+/*! \ingroup STRUCTS
+ *	@brief Start of a .chl file */
+typedef struct CHL_Header
+{
+	uint32	magic;			//!< CHL_MAGIC
+	int32	record_bytes;	//!< sizeof(Chan_Log_S) of the receiver that wrote it
+	int32	channels;		//!< MAX_CHANNELS of the receiver that wrote it
+	int32	chunk;			//!< Records per chunk
+} CHL_Header;
+
+/*! \ingroup STRUCTS
+ *	@brief Start of every chunk */
+typedef struct CHL_Chunk
+{
+	uint32	magic;			//!< CHL_CHUNK_ID
+	uint32	first_tic;		//!< Tic of the first record
+	int32	records;		//!< Records in the chunk
+	int32	bytes;			//!< Bytes that follow
+	int32	coded;			//!< Delta coded, else raw Chan_Log_S
+} CHL_Chunk;
+
+/*! \ingroup STRUCTS
+ *	@brief End of a cleanly closed file */
+typedef struct CHL_Trailer
+{
+	uint32	magic;			//!< CHL_INDEX
+	int32	chunks;			//!< Entries in the index
+	int64	index;			//!< File offset of the index
+} CHL_Trailer;
+
+
+/*! \ingroup CLASSES
+ *	@brief Write the -c channel log from its own thread. Channel::Export() copies its record into a
+ *	single producer/single consumer ring and goes on, no locks, no syscalls; this thread drains
+ *	the ring into a chunk, codes it if asked to (-z) and writes it to chan.chl with one fwrite.
+ *	A full ring drops the record and counts it rather than stall the tracking.
+ */
+class Chan_Log : public Threaded_Object
+{
+
+	private:
+
+		FILE *fp;					//!< Output file
+		int32 compress;				//!< Delta code the chunks
+
+		Chan_Log_S queue[CHL_QUEUE];	//!< The ring
+		volatile uint32 head;		//!< Written by the log thread only
+		volatile uint32 tail;		//!< Written by the tracking only
+
+		Chan_Log_S *chunk;			//!< Records of the open chunk
+		int32 chunk_records;		//!< How many
+		uint8 *coded;				//!< Coded chunk
+		int64 *index;				//!< Chunk offsets
+		int32 index_size;			//!< Allocated entries in index
+		int32 chunks;				//!< Chunks written
+
+		/* Stats */
+		uint32 records;				//!< Records written
+		uint32 dropped;				//!< Records dropped because the ring was full
+		uint32 errors;				//!< Failed writes
+		int64 raw_bytes;			//!< Uncompressed bytes in
+		int64 out_bytes;			//!< Bytes written
+		double max_write;			//!< Longest chunk write (ms)
+
+		void Write();				//!< Code and write the open chunk
+
+	public:
+
+		Chan_Log(const char *_fname, int32 _compress);	//!< Create the file
+		~Chan_Log();				//!< Drain the ring, write the last chunk and the index
+		void Start();				//!< Start the thread
+		void Import();				//!< Move the ring into the chunk, write full chunks
+		void Push(Channel_M *_packet, int32 *_I, int32 *_Q, int32 *_P_buff);	//!< Called by the tracking, never blocks
+
+		uint32 getRecords(){return(records);}
+		uint32 getDropped(){return(dropped);}
+		uint32 getErrors(){return(errors);}
+		double getRatio(){return(out_bytes ? (double)raw_bytes/out_bytes : 0);}
+};
+
+
+/*! \ingroup CLASSES
+ *	@brief Read the records back from a .chl file
+ */
+class Chan_Log_Reader
+{
+
+	private:
+
+		FILE *fp;					//!< Input file
+		CHL_Header hdr;				//!< File header
+		int64 *index;				//!< Chunk offsets
+		int32 chunks;				//!< Chunks in the file
+		Chan_Log_S *chunk;			//!< Decoded records of the loaded chunk
+		int32 chunk_records;		//!< How many
+		int32 record;				//!< Next one to hand out
+		int32 loaded;				//!< Chunk that is loaded
+		uint8 *buff;				//!< Coded chunk
+		int32 buff_size;			//!< Allocated bytes in buff
+
+		uint32 FirstTic(int32 _chunk);	//!< Tic of the first record in a chunk
+		int32 Load(int32 _chunk);	//!< Read and decode a chunk
+		void Scan();				//!< Rebuild the index from the chunk headers
+
+	public:
+
+		Chan_Log_Reader(const char *_fname);	//!< Open the file and load the index
+		~Chan_Log_Reader();
+		int32 isOpen(){return(fp != NULL);}
+		int32 getChunks(){return(chunks);}
+		int32 Seek(uint32 _tic);		//!< Position at the first record at or after _tic, 0 if past the end
+		int32 Read(Chan_Log_S *_r);		//!< Next record, returns 0 at the end of the file
+};
+
+/* Record codec, exposed for the benchmark */
+int32 chl_encode(Chan_Log_S *_in, int32 _cnt, uint8 *_out);		//!< Returns bytes written
+int32 chl_decode(uint8 *_in, int32 _bytes, Chan_Log_S *_out, int32 _cnt);	//!< Returns records decoded
+
+#endif /* CHAN_LOG_H_ */
@@ -26,26 +26,26 @@
 /*----------------------------------------------------------------------------------------------*/
 
 #include "channel.h"
+#include "chan_log.h"
 
 /*----------------------------------------------------------------------------------------------*/
 Channel::Channel(int32 _chan):Threaded_Object("CHNTASK")
 {
-	char fname[1024];
 
 	chan = _chan;
 
 	if(gopt.verbose)
 		fprintf(stdout,"Creating Channel %d\n",chan);
 
-	if(gopt.log_channel)
-	{
-		sprintf(fname,"chan%02d.dat",chan);
-		fp = fopen(fname, "wb");
-	}
+	antenna = 0;
+	code_nco = carrier_nco = 0;
+	kill_pending = false;
 
-	pFFT = new FFT(FREQ_LOCK_POINTS);
+	loop = &gloops[chan/4];
+	lane = chan % 4;
 
 	Clear();
+	Publish();
 
 }
 /*----------------------------------------------------------------------------------------------*/
@@ -55,11 +55,6 @@ Channel::Channel(int32 _chan):Threaded_Object("CHNTASK")
 Channel::~Channel()
 {
 
-	delete pFFT;
-
-	if(gopt.log_channel)
-		fclose(fp);
-
 	if(gopt.verbose)
 		fprintf(stdout,"Destructing Channel %d\n",chan);
 
@@ -80,6 +75,10 @@ void Channel::Clear()
 	/* Loop data */
 	memset(&aPLL, 0x0, sizeof(Phase_lock_loop));
 	memset(&aDLL, 0x0, sizeof(Delay_lock_loop));
+	loop->kw[lane] = loop->kx[lane] = loop->kh[lane] = loop->kz[lane] = 0;
+	loop->w[lane] = loop->x[lane] = loop->z[lane] = 0;
+	loop->pll[lane] = loop->est[lane] = 0;
+	dumped = false;
 
 	/* Correlations */
 	I[0] = I[1] = I[2] = 1;
@@ -89,7 +88,7 @@ void Channel::Clear()
 	I_avg = 1;
 	Q_var = 1;
 	P_avg = 8e4;
-	cn0 = 40.0;
+	loop->cn0[lane] = 40.0;
 
 	/* Bit lock stuff */
 	bit_lock = false;
@@ -122,6 +121,7 @@ void Channel::Clear()
 	/* FFT and buffer for FFT estimate of frequency after initial lock */
 	freq_lock_ticks = 0;
 	freq_lock = false;
+	freq_re = freq_im = 0;
 	memset(&fft_buff[0], 0x0, FREQ_LOCK_POINTS*sizeof(CPX));
 
 
@@ -142,9 +142,9 @@ void Channel::Start(int32 _sv, Acq_Command_S result, int32 _corr_len)
 
 	aDLL.x		= 2.0*result.doppler*CODE_RATE/L1;
 
-	aPLL.w		= 0;
-	aPLL.x 		= 2.0*result.doppler;
-	aPLL.z 		= result.doppler;
+	loop->w[lane]	= 0;
+	loop->x[lane]	= 2.0*result.doppler;
+	loop->z[lane]	= result.doppler;
 
 	switch(_corr_len)
 	{
@@ -165,6 +165,9 @@ void Channel::Start(int32 _sv, Acq_Command_S result, int32 _corr_len)
 	DLL_W(1.0);
 
 	state = CHANNEL_NORMAL;
+	kill_pending = false;
+
+	Publish();
 
 }
 /*----------------------------------------------------------------------------------------------*/
@@ -179,9 +182,24 @@ Channel_M Channel::getPacket()
 
 
 /*----------------------------------------------------------------------------------------------*/
-void Channel::Accum(Correlation_S *corr, NCO_Command_S *_feedback)
+void Channel::Accum(Correlation_S *corr, uint32 _tic, int32 _count)
 {
 
+	/* The correlator's tic at the dump, for the -c log */
+	packet.tic = _tic;
+
+	/* Dumps that found the queue full, their ms went by all the same. Catch the epochs up so they
+	   stay in step with the correlator's */
+	while(count < _count)
+		Skip();
+
+	/* Somebody else wants this channel gone, the state below then shuts the correlator off */
+	if(kill_pending)
+	{
+		kill_pending = false;
+		Kill();
+	}
+
 	corr->I[0] >>= 2;
 	corr->I[1] >>= 2;
 	corr->I[2] >>= 2;
@@ -221,8 +239,39 @@ void Channel::Accum(Correlation_S *corr, NCO_Command_S *_feedback)
 		DumpAccum();
 	}
 
-	/* These functions must be called every ms */
 	EstCN0();
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void Channel::Close(NCO_Command_S *_feedback)
+{
+
+	/* Pick up what the sweep did with the dump */
+	if(dumped)
+	{
+		PLL();
+		DLL();
+
+		/* Dump pertinent data */
+		Error();
+
+		/* Save Previous Correlations for Loops */
+		I_prev = I[1];
+		Q_prev = Q[1];
+
+		/* Zero out the correlations */
+		I[0] = I[1] = I[2] = 0;
+		Q[0] = Q[1] = Q[2] = 0;
+
+		dumped = false;
+	}
+
+	loop->pll[lane] = loop->est[lane] = 0;
+
+	/* These functions must be called every ms */
 	BitLock();
 	BitStuff();
 	Epoch();
@@ -274,6 +323,8 @@ void Channel::Accum(Correlation_S *corr, NCO_Command_S *_feedback)
 		_feedback->navigate = navigate;
 	}
 
+	Publish();
+
 }
 /*----------------------------------------------------------------------------------------------*/
 
@@ -291,28 +342,23 @@ void Channel::DumpAccum()
 	Q_var += ((float)Q[1]*(float)Q[1] - Q_var) * .02;
 	P_avg += ((float)P[1]/len - P_avg) * .02;
 
-	/* First do estimate of frequency offset via FFT */
+	/* First do estimate of frequency offset via FFT, the PLL is only closed after that */
 	if(freq_lock == false)
 	{
 		FrequencyLock();
 	}
 	else
 	{
-		PLL();
+		loop->pll[lane] = 0xffffffff;
 	}
 
-	DLL();
+	/* The discriminators run in the sweep */
+	loop->ip[lane] = I[1];
+	loop->qp[lane] = Q[1];
+	loop->pe[lane] = P[0];
+	loop->pl[lane] = P[2];
 
-	/* Dump pertinent data */
-	Error();
-
-	/* Save Previous Correlations for Loops */
-	I_prev = I[1];
-	Q_prev = Q[1];
-
-	/* Zero out the correlations */
-	I[0] = I[1] = I[2] = 0;
-	Q[0] = Q[1] = Q[2] = 0;
+	dumped = true;
 
 }
 /*----------------------------------------------------------------------------------------------*/
@@ -322,12 +368,11 @@ void Channel::DumpAccum()
 void Channel::EstCN0()
 {
 	int32 lcv;
-	float NP;
 	float NBP;
 	float WBP;
-	float ncn0;
 
-	/* Try out new cn0 estimate, PG 393 of Global Positioning System, Theory and Applications */
+	/* Try out new cn0 estimate, PG 393 of Global Positioning System, Theory and Applications,
+	 * the sweep takes it from here: NP = NBP/WBP, cn0 += (10*log10((NP-1)/(20-NP)) + 30.25 - cn0)*.02 */
 	if((_1ms_epoch == 19) && bit_lock)
 	{
 		NBP = I_sum20*I_sum20 + Q_sum20*Q_sum20;
@@ -336,19 +381,9 @@ void Channel::EstCN0()
 		for(lcv = 0; lcv < 20; lcv++)
 			WBP += I_buff[lcv]*I_buff[lcv] + Q_buff[lcv]*Q_buff[lcv];
 
-		if(WBP > 0.0)
-			NP = NBP/WBP;
-
-		if((NP - 1.0)/(20.0 - NP) > 0.0)
-		{
-			ncn0 = 10*log10((NP - 1.0)/(20.0 - NP)) + 30.0 + .25;
-			cn0 += (ncn0 - cn0)*.02;
-		}
-
-		if(cn0 < 15.0)
-		{
-			cn0 = 15.0;
-		}
+		loop->nbp[lane] = NBP;
+		loop->wbp[lane] = WBP;
+		loop->est[lane] = 0xffffffff;
 	}
 
 }
@@ -360,9 +395,9 @@ void Channel::FrequencyLock()
 {
 
 	int32 it, qt;
-	int32 max, mind, lcv;
+	int32 mind;
 	float df;
-	int32 *p;
+	CPX *s;
 
 	it = I[1] >> 3;
 	qt = Q[1] >> 3;
@@ -370,36 +405,28 @@ void Channel::FrequencyLock()
 	/* First frequency double to remove data bits */
 	if(count > 1000)
 	{
-		fft_buff[freq_lock_ticks].i = (int16)(it*it - qt*qt);
-		fft_buff[freq_lock_ticks].q = (int16)(2*it*qt);
+		s = &fft_buff[freq_lock_ticks];
+		s->i = (int16)(it*it - qt*qt);
+		s->q = (int16)(2*it*qt);
+
+		/* The zoom's estimate, s times the conjugate of the sample before it */
+		if(gopt.freq_zoom && freq_lock_ticks)
+		{
+			freq_re += (int64)s->i*s[-1].i + (int64)s->q*s[-1].q;
+			freq_im += (int64)s->q*s[-1].i - (int64)s->i*s[-1].q;
+		}
+
 		freq_lock_ticks++;
 	}
 
 	if(freq_lock_ticks >= FREQ_LOCK_POINTS)
 	{
 
-		p = (int32 *)&fft_buff[0];
-
-		/* Now do the FFT */
-		pFFT->doFFT(&fft_buff[0], true);
-
-		/* Convert to power */
-		x86_cmag(&fft_buff[0], FREQ_LOCK_POINTS);
-
-		/* Get peak */
-		max = mind = 0;
-		for(lcv = 0; lcv < FREQ_LOCK_POINTS; lcv++)
-		{
-			if(p[lcv] > max)
-			{
-				max = p[lcv];
-				mind = lcv;
-			}
-		}
-
-		/* Positive and negative frequency adjustment */
-		if(mind >= (FREQ_LOCK_POINTS/2))
-			mind -= FREQ_LOCK_POINTS;
+		/* Search the bins off the shared plan */
+		if(gopt.freq_zoom)
+			mind = pFreqLock->Zoom(&fft_buff[0], freq_re, freq_im);
+		else
+			mind = pFreqLock->Full(&fft_buff[0]);
 
 		/* Convert to frequency correction */
 		df = 1000.0/((float)2.0*len);	// Bandwidth of FFT
@@ -408,10 +435,11 @@ void Channel::FrequencyLock()
 
 		/* Update the loop filters */
 		aDLL.x += 2.0*df*CODE_RATE/L1;
-		aPLL.x += 2.0*df;
+		loop->x[lane] += 2.0*df;
 
 		freq_lock = true;
 		freq_lock_ticks = 0;
+		freq_re = freq_im = 0;
 	}
 }
 /*----------------------------------------------------------------------------------------------*/
@@ -422,27 +450,19 @@ void Channel::FrequencyLock()
 void Channel::DLL()
 {
 
-	double code_err;
-	double ep, lp, sp;
-
-	ep = sqrt(double(P[0]));
-	lp = sqrt(double(P[2]));
-	sp = sqrt(double(P[2] + P[0]));
-
-	code_err  = (ep - lp) / sp;
-
 	/* Not working too well right now, debug some later */
 //	aDLL.x += aDLL.t*(code_err*aDLL.w02);
 //	aDLL.z = 0.5*aDLL.x + aDLL.a*aDLL.w02*code_err;
 //	code_nco = CODE_RATE + (0.5*aPLL.x*CODE_RATE*INVERSE_L1) + aDLL.z;
 
+	/* The sweep leaves (sqrt(E) - sqrt(L))/sqrt(E + L) in code_err */
 	if((count < 1000) && (P_avg < 8e4))
 	{
-		code_nco = CODE_RATE + (0.5 * aPLL.x * CODE_RATE * INVERSE_L1) - 5.0;
+		code_nco = CODE_RATE + (0.5 * loop->x[lane] * CODE_RATE * INVERSE_L1) - 5.0;
 	}
 	else
 	{
-		code_nco = CODE_RATE + (0.5 * aPLL.x * CODE_RATE * INVERSE_L1) + code_err;
+		code_nco = CODE_RATE + (0.5 * loop->x[lane] * CODE_RATE * INVERSE_L1) + loop->code_err[lane];
 	}
 }
 /*----------------------------------------------------------------------------------------------*/
@@ -452,47 +472,15 @@ void Channel::DLL()
 void Channel::PLL()
 {
 
-	double df;
-	double dp;
-	double dot;
-	double cross;
-	int32 I1, I2, Q1, Q2, lcv;
-
-	df = dp = 0;
-
-//	if(bit_lock)
-//	{
-//		/* FLL discriminator */
-//		dot = 	  I_prev*I[1] + Q_prev*Q[1];
-//		cross =   I_prev*Q[1] - Q_prev*I[1];
-//
-//		/* No FLL for now */
-//		if((dot != 0.0) && (cross != 0.0))
-//		{
-//			df = atan2(cross, dot);
-//			df /= (TWO_PI * aPLL.t);
-//		}
-//	}
-
-//	df = 0;
-
-	/* PLL discriminator */
-	if(I[1] != 0)
+	/* The sweep ran the discriminator, atan(Q/I)/2pi, and the 3rd order filter. The FLL assist
+	 * was never switched on (df = 0), so the bank only carries the PLL gains */
+	if(loop->pll[lane])
 	{
-		dp = atan((double)Q[1]/(double)I[1])/TWO_PI;
-	}
+		/* Lock indicator */
+		aPLL.pll_lock = loop->dp[lane];
 
-	/* Lock indicators */
-	aPLL.pll_lock += (dp - aPLL.pll_lock) * .1;
-	aPLL.pll_lock = dp;
-	aPLL.fll_lock += (cross/P_avg - aPLL.fll_lock) * .1;
-
-	/* 3rd order PLL wioth 2nd order FLL assist */
-	aPLL.w += aPLL.t * (aPLL.w0p3 * dp + aPLL.w0f2 * df);
-	aPLL.x += aPLL.t * (0.5*aPLL.w + aPLL.a2 * aPLL.w0f * df + aPLL.a3 * aPLL.w0p2 * dp);
-	aPLL.z  = 0.5*aPLL.x + aPLL.b3 * aPLL.w0p * dp;
-
-	carrier_nco = IF_FREQUENCY + aPLL.z;
+		carrier_nco = IF_FREQUENCY + loop->z[lane];
+	}
 
 }
 /*----------------------------------------------------------------------------------------------*/
@@ -520,6 +508,22 @@ void Channel::Epoch()
 /*----------------------------------------------------------------------------------------------*/
 
 
+/*----------------------------------------------------------------------------------------------*/
+void Channel::Skip()
+{
+
+	/* The ms' correlations are gone, out of the 20 ms sums too */
+	I_sum20 -= I_buff[_1ms_epoch];
+	Q_sum20 -= Q_buff[_1ms_epoch];
+	I_buff[_1ms_epoch] = 0;
+	Q_buff[_1ms_epoch] = 0;
+
+	Epoch();
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
 /*----------------------------------------------------------------------------------------------*/
 void Channel::BitLock()
 {
@@ -693,7 +697,7 @@ void Channel::ProcessDataBit()
 					ephem_packet.subframe = subframe;
 					ephem_packet.sv = sv;
 
-					write(CHN_2_EPH_P[WRITE], &ephem_packet, sizeof(Channel_2_Ephemeris_S));
+					CHN_2_EPH_P->Send(&ephem_packet);
 
 					if(!z_lock)
 					{
@@ -730,6 +734,7 @@ void Channel::ProcessDataBit()
 /*----------------------------------------------------------------------------------------------*/
 bool Channel::FrameSync(uint32 word0, uint32 word1)
 {
+    uint32 words[2];                        /* TLM and HOW, data bits righted. */
     uint32 preamble;           /* The TLM word preamble sequence 10001011. */
     uint32 sid;                               /* The subframe ID (1 to 5). */
     uint32 zerobits;         /* The zero bits (the last 2 bits of word 2). */
@@ -772,7 +777,10 @@ bool Channel::FrameSync(uint32 word0, uint32 word1)
     if(word1 & 0x40000000)
         word1 ^= 0x3FFFFFC0;
 
-    if(!this->ParityCheck(word0) || !this->ParityCheck(word1))
+    words[0] = word0;
+    words[1] = word1;
+
+    if(x86_parity(&words[0], 2))
         return false;
 
     return true;
@@ -780,40 +788,6 @@ bool Channel::FrameSync(uint32 word0, uint32 word1)
 /*----------------------------------------------------------------------------------------------*/
 
 
-/*----------------------------------------------------------------------------------------------*/
-bool Channel::ParityCheck(uint32 gpsword)
-{
-
-    uint32 d1,d2,d3,d4,d5,d6,d7,t,parity;
-
-    /* XOR as many bits in parallel as possible.  The magic constants pick
-       up bits which are to be XOR'ed together to implement the GPS parity
-       check algorithm described in ICD-GPS-200.  This avoids lengthy shift-
-       and-xor loops. */
-
-    d1 = gpsword & 0xFBFFBF00;
-    d2 = _lrotl(gpsword,1) & 0x07FFBF01;
-    d3 = _lrotl(gpsword,2) & 0xFC0F8100;
-    d4 = _lrotl(gpsword,3) & 0xF81FFE02;
-    d5 = _lrotl(gpsword,4) & 0xFC00000E;
-    d6 = _lrotl(gpsword,5) & 0x07F00001;
-    d7 = _lrotl(gpsword,6) & 0x00003000;
-
-    t = d1 ^ d2 ^ d3 ^ d4 ^ d5 ^ d6 ^ d7;
-
-    // Now XOR the 5 6-bit fields together to produce the 6-bit final result.
-
-    parity = t ^ _lrotl(t,6) ^ _lrotl(t,12) ^ _lrotl(t,18) ^ _lrotl(t,24);
-    parity = parity & 0x3F;
-    if (parity == (gpsword&0x3F))
-        return(true);
-    else
-        return(false);
-
-}
-/*----------------------------------------------------------------------------------------------*/
-
-
 /*----------------------------------------------------------------------------------------------*/
 bool Channel::ValidFrameFormat(uint32 *subframe)
 {
@@ -821,7 +795,6 @@ bool Channel::ValidFrameFormat(uint32 *subframe)
     uint32 zerobits,next_zerobits;
     uint32 sid,next_sid;
     uint32 wordcounter;
-    uint32 parity_errors;
 
     /* Extract the preamble. */
     preamble = (subframe[0] >> 22) & 0x000000FF;
@@ -887,17 +860,12 @@ bool Channel::ValidFrameFormat(uint32 *subframe)
 
     /* Check that all 12 words have correct parity. Have to first
        invert the data bits according to bit 30 of the previous word. */
-    parity_errors = 0;
-
 	for(wordcounter = 0; wordcounter < FRAME_SIZE_PLUS_2; wordcounter++)
 		if (subframe[wordcounter] & 0x40000000)
 			subframe[wordcounter] ^= 0x3FFFFFC0;
 
-    for(wordcounter = 0; wordcounter < FRAME_SIZE_PLUS_2; wordcounter++)
-		if (!this->ParityCheck(subframe[wordcounter]))
-			parity_errors++;
-
-    if(parity_errors != 0)
+    /* All 12 in one pass */
+    if(sse_parity(subframe, FRAME_SIZE_PLUS_2) != 0)
         return(false);
 
     return(true);
@@ -923,6 +891,12 @@ void Channel::PLL_W(float _bwpll)
 	aPLL.gain = 1.0;
 	aPLL.t = .001*(float)len;
 
+	/* What the sweep runs the filter with */
+	loop->kw[lane] = aPLL.t*aPLL.w0p3;
+	loop->kx[lane] = aPLL.t*aPLL.a3*aPLL.w0p2;
+	loop->kh[lane] = 0.5*aPLL.t;
+	loop->kz[lane] = aPLL.b3*aPLL.w0p;
+
 }
 /*----------------------------------------------------------------------------------------------*/
 
@@ -967,13 +941,13 @@ void Channel::Error()
 	/* Adjust integration length based on cn0 */
 	if(bit_lock)
 	{
-		if((cn0 > 39.0) && (len != 1))
+		if((loop->cn0[lane] > 39.0) && (len != 1))
 		{
 			len = 1;
 			PLL_W(18.0);
 		}
 
-		if((cn0 < 37.0) && (len != 20))
+		if((loop->cn0[lane] < 37.0) && (len != 20))
 		{
 			len = 20;
 			PLL_W(18.0);
@@ -993,6 +967,36 @@ void Channel::Kill()
 /*----------------------------------------------------------------------------------------------*/
 
 
+/*----------------------------------------------------------------------------------------------*/
+void Channel::Publish()
+{
+
+	Channel_Status_S s;
+
+	s.chan			= chan;
+	s.sv			= sv;
+	s.state			= state;
+	s.antenna		= antenna;
+	s.len			= len;
+	s.count			= count;
+	s.subframe		= subframe;
+	s.best_epoch	= best_epoch;
+	s.bit_lock		= bit_lock;
+	s.frame_lock	= frame_lock;
+	s.navigate		= navigate;
+	s.cn0			= loop->cn0[lane];
+	s.p_avg			= P_avg;
+	s.w				= loop->w[lane];
+	s.x				= loop->x[lane];
+	s.z				= loop->z[lane];
+	s.code_nco		= code_nco;
+	s.carrier_nco	= carrier_nco;
+
+	status.Write(&s);
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
 /*----------------------------------------------------------------------------------------------*/
 void Channel::Export()
 {
@@ -1004,10 +1008,10 @@ void Channel::Export()
 	packet.sv 			= sv;
 	packet.antenna		= antenna;
 	packet.len 			= len;
-	packet.w			= aPLL.w;
-	packet.x 			= aPLL.x;
-	packet.z 			= aPLL.z;
-	packet.cn0 			= cn0;
+	packet.w			= loop->w[lane];
+	packet.x 			= loop->x[lane];
+	packet.z 			= loop->z[lane];
+	packet.cn0 			= loop->cn0[lane];
 	packet.p_avg 		= P_avg;
 	packet.bit_lock 	= bit_lock;
 	packet.frame_lock 	= frame_lock;
@@ -1018,14 +1022,9 @@ void Channel::Export()
 	packet.code_nco 	= code_nco;
 	packet.carrier_nco 	= carrier_nco;
 
-	/* Dump the extra info */
-	if(gopt.log_channel && (fp != NULL))
-	{
-		fwrite(&packet, sizeof(Channel_M), 1,  fp);
-		fwrite(&I[0], sizeof(int32), 3,  fp);
-		fwrite(&Q[0], sizeof(int32), 3,  fp);
-		fwrite(&P_buff[0], sizeof(int32), 20,  fp);
-	}
+	/* Dump the extra info, the log thread does the writing */
+	if(pChanLog != NULL)
+		pChanLog->Push(&packet, &I[0], &Q[0], &P_buff[0]);
 }
 /*----------------------------------------------------------------------------------------------*/
 
@@ -29,7 +29,7 @@
 #define OBJECT_H
 
 #include "includes.h"
-#include "fft.h"
+#include "freq_lock.h"
 
 enum Channel_State
 {
@@ -39,22 +39,16 @@ enum Channel_State
 	CHANNEL_NORMAL			//!< Channel is tracking normally (post bit lock)
 };
 
-#define FREQ_LOCK_POINTS (512)
-
 /*! \ingroup CLASSES
  *
  */
 class Channel : public Threaded_Object
 {
 
-	friend class SV_Select;
-	friend class Telemetry;
-
 	private:
 
 		/* Status info */
 		/*----------------------------------------------------------------------------------------------*/
-		FILE *fp;
 		int32 len;				//!< accumulation length
 		int32 count;			//!< number of accumulations processed
 		int32 active;			//!< is this channel active
@@ -70,6 +64,9 @@ class Channel : public Threaded_Object
 		/*----------------------------------------------------------------------------------------------*/
 		Phase_lock_loop aPLL;
 		Delay_lock_loop	aDLL;
+		Loop_Bank_S *loop;		//!< The bank holding this channel's loop filter and CN0 state
+		int32 lane;				//!< Which of its 4 lanes
+		bool dumped;			//!< The correlations were dumped into the bank this ms
 		double carrier_nco;		//!< Local carrier_nco
 		double code_nco;		//!< Local code_nco
 		bool frequency_lock;
@@ -86,7 +83,6 @@ class Channel : public Threaded_Object
 		float I_avg;			//!< Moving average of I
 		float Q_var;			//!< Variance of Q
 		float P_avg;			//!< Moving average of P
-		float cn0;				//!< Current CN0 estimate
 		/*----------------------------------------------------------------------------------------------*/
 
 		/* Bit lock stuff */
@@ -129,7 +125,13 @@ class Channel : public Threaded_Object
 		bool freq_lock;				//!< Has the FFT estimate of frequency been completed?
 		int32 freq_lock_ticks;
 		CPX fft_buff[FREQ_LOCK_POINTS];	//!< Buffer for the 4 ms accumulations
-		FFT *pFFT;					//!< This is where the actual FFT lives
+		int64 freq_re, freq_im;		//!< Phase difference of consecutive samples in fft_buff, for the zoom (-F)
+		/*----------------------------------------------------------------------------------------------*/
+
+		/* Everything above belongs to the tracking thread, other threads go through these */
+		/*----------------------------------------------------------------------------------------------*/
+		Seqlock<Channel_Status_S> status;	//!< Copy of the status, republished after every Accum()
+		volatile int32 kill_pending;		//!< Set by RequestKill(), acted on by the next Accum()
 		/*----------------------------------------------------------------------------------------------*/
 
 	public:
@@ -139,25 +141,32 @@ class Channel : public Threaded_Object
 		void Start(int32 sv, Acq_Command_S result, int32 _corr_len);
 		void Clear();
 		void Kill();									//!< Shutdown the channel
-		void DumpAccum();								//!< Dump the accumulation and do rest of processing
+		void DumpAccum();								//!< Dump the accumulation into the bank for the sweep
 		void FrequencyLock();							//!< Use FFT to pull in the PLL
 		void PLL_W(float _bw);							//!< Change the PLL bandwidth
 		void DLL_W(float _bw);							//!< Change the DLL bandwidth
-		void PLL();										//!< Perform the phase lock loop
-		void DLL();										//!< Do the DLL
-		void EstCN0();									//!< Estimate the cn0
+		void PLL();										//!< Take the carrier NCO from the swept PLL
+		void DLL();										//!< Take the code NCO from the swept DLL discriminator
+		void EstCN0();									//!< Hand the cn0 estimator its powers
 		void Epoch();									//!< Increase _1ms_epoch, _20ms_epoch
+		void Skip();									//!< Let a ms the correlator could not hand over go by
 		void BitLock();									//!< Declare the bit lock?
 		void BitStuff();								//!< Get data bits from I_Sum20 and stuff them into data_buff
-		void ProcessDataBit();							//!< Process the data bits, how fun!, calls the following 3 functions
+		void ProcessDataBit();							//!< Process the data bits, how fun!, calls the following 2 functions
 			bool FrameSync(uint32 word0, uint32 word1); //!< frame synch?
-			bool ParityCheck(uint32 gpsword);			//!< parity check
-			bool ValidFrameFormat(uint32 *subframe);	//!< valid frame
+			bool ValidFrameFormat(uint32 *subframe);	//!< valid frame, parity of all 12 words in one sse_parity() pass
 		void Error();									//!< look for errors in tracking, killing channel if necessary
 		void Export();									//!< Return NCO command to correlator
 		Channel_M getPacket();
-		void Accum(Correlation_S *corr, NCO_Command_S *_feedback);	//!< Process an accumulation
-		float getCN0(){return(cn0);};
+		void Accum(Correlation_S *corr, uint32 _tic, int32 _count);	//!< Process an accumulation up to the loops, which sse_track() then closes
+		void Close(NCO_Command_S *_feedback);			//!< After the sweep, do the rest of the ms and fill in the NCO command
+		void Publish();									//!< Copy the status out for the other threads
+		void RequestKill(){kill_pending = true;};		//!< Kill from any thread, takes effect on the next ms
+		void getStatus(Channel_Status_S *_s){status.Read(_s);};	//!< Consistent status from any thread, never blocks the tracking
+		uint32 getRetries(){return(status.getRetries());};		//!< Reads of the status that raced an update
+
+		/* Only from the thread running Accum(), i.e. the tracking or the batch loop */
+		float getCN0(){return(loop->cn0[lane]);};
 		float getNCO(){return(carrier_nco);};
 		int32 getState(){return(state);};
 		void setActive(int32 _active){active = _active;};
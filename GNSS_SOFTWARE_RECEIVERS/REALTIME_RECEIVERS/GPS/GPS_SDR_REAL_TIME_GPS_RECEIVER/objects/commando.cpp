@@ -31,7 +31,7 @@
 void *Commando_Thread(void *_arg)
 {
 
-	while(grun)
+	while(pCommando->Running())
 	{
 		pCommando->Import();
 	}
@@ -104,16 +104,16 @@ Commando::~Commando()
 void Commando::Import()
 {
 
-	uint32 bread;
-
-	/* Wait for data from the serial port */
-	read(TLM_2_CMD_P[READ], &packet_header, sizeof(CCSDS_Packet_Header));
+	/* Wait for a command from the serial port */
+	if(!TLM_2_CMD_P->Receive(&command_packet))
+		return;
+	packet_header = command_packet.header;
 
 	/* Decode the header */
 	DecodeCCSDSPacketHeader(&decoded_header, &packet_header);
 
 	/* Get the body */
-	read(TLM_2_CMD_P[READ], &command_body, decoded_header.length);
+	memcpy(&command_body, &command_packet.body, decoded_header.length);
 
 	/* Get the start of execution */
 	IncStartTic();
@@ -229,11 +229,11 @@ void Commando::resetPVT()
 /*----------------------------------------------------------------------------------------------*/
 void Commando::resetEKF()
 {
-//
-//	pEKF->Lock();
-//	pEKF->Reset();
-//	pEKF->Unlock();
-//
+
+	pEKF->Lock();
+	pEKF->Reset();
+	pEKF->Unlock();
+
 	message_body.command_ack.command_status = SUCCESS_A_ID;
 }
 /*----------------------------------------------------------------------------------------------*/
@@ -263,18 +263,12 @@ void Commando::resetChannel()
 
 	if((chan >= 0) && (chan < MAX_CHANNELS))
 	{
-		pChannels[chan]->Lock();
-		pChannels[chan]->Kill();
-		pChannels[chan]->Unlock();
+		pChannels[chan]->RequestKill();
 	}
 	else
 	{
 		for(lcv = 0; lcv < MAX_CHANNELS; lcv++)
-		{
-			pChannels[lcv]->Lock();
-			pChannels[lcv]->Kill();
-			pChannels[lcv]->Unlock();
-		}
+			pChannels[lcv]->RequestKill();
 	}
 
 	message_body.command_ack.command_status = SUCCESS_A_ID;
@@ -585,8 +579,9 @@ void Commando::getMemoryChksum()
 /*----------------------------------------------------------------------------------------------*/
 void Commando::EmitCCSDSPacket(void *_buff, uint32 _len)
 {
-	write(CMD_2_TLM_P[WRITE], &packet_header, sizeof(CCSDS_Packet_Header));
-	write(CMD_2_TLM_P[WRITE], _buff, _len);
+	message_packet.header = packet_header;
+	memcpy(&message_packet.body, _buff, _len);
+	CMD_2_TLM_P->Send(&message_packet);
 }
 /*----------------------------------------------------------------------------------------------*/
 
@@ -30,7 +30,7 @@
 #define COMMANDO_H_
 
 #include "includes.h"
-//#include "ekf.h"			//!< The EKF driver
+#include "ekf.h"			//!< The EKF driver
 #include "telemetry.h"		//!< Handle the 422 telemetry
 #include "ephemeris.h"		//!< Decode almanac/ephemeris/utc
 #include "sv_select.h"		//!< Maintain state of GPS constellation using almanac data
@@ -50,6 +50,8 @@ class Commando : public Threaded_Object
 		CCSDS_Decoded_Header decoded_header;		//!< Decoded header
 		Command_Union command_body;						//!< Body of a command
 		Message_Union message_body;						//!< Body of a message
+		Command_Packet_S command_packet;				//!< Command from the Telemetry
+		Message_Packet_S message_packet;				//!< Result to the Telemetry
 		uint32 command_tic;							//!< Count the number of executed commands
 
 		void (Commando::*cmd_handlers[LAST_C_ID+1])(void);	//!< Function pointers for command handlers
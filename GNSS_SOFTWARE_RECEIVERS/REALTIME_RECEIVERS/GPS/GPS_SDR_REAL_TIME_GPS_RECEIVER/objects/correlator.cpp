@@ -33,9 +33,11 @@ void *Correlator_Thread(void *_arg)
 
 	Correlator *aCorrelator = pCorrelator;
 
-	while(grun)
+	while(aCorrelator->Running())
 	{
 		aCorrelator->Import();
+		if(!aCorrelator->Running())
+			break;
 		aCorrelator->Correlate();
 		aCorrelator->IncExecTic();
 	}
@@ -73,6 +75,22 @@ Correlator::Correlator():Threaded_Object("CORTASK")
 	for(lcv = 0; lcv < MAX_CHANNELS; lcv++)
 		states[lcv].active = 0;
 
+	memset(&period, 0x0, sizeof(Budget_S));
+	memset(&total, 0x0, sizeof(Budget_S));
+	hot_waits = 0;
+	loop_misses = 0;
+	dumps = 0;
+
+	start_waits = 0;
+	epoch_drops = 0;
+
+	for(lcv = 0; lcv < MAX_CHANNELS; lcv++)
+	{
+		generation[lcv] = 0;
+		dump_drops[lcv] = 0;
+		start_pending[lcv] = false;
+	}
+
 	/* Hold the pre computed tables */
 	main_sine_table = new CPX[(2*CARRIER_BINS+1)*2*SAMPS_MS];
 	main_sine_rows = new CPX*[2*CARRIER_BINS+1];
@@ -119,35 +137,34 @@ Correlator::~Correlator()
 void Correlator::Import()
 {
 	int32 chan;
-	int32 bread;
 	int32 lcv;
+	uint32 depth;
 	Acq_Command_S temp;
 
-	/* Wait for a command to start a new channel */
-	bread = read(SVS_2_COR_P[READ], &result, sizeof(Acq_Command_S));
-	if(bread == sizeof(Acq_Command_S))
+	/* Check for a command to start a new channel. Its last life ends here, anything still coming
+	   back from it carries the old generation and is ignored */
+	if(SVS_2_COR_P->TryReceive(&temp))
 	{
-		chan = result.chan;
-		states[chan].chan = chan;
-		InitCorrelator(&states[chan]);
-		pChannels[chan]->Lock();
-		switch(result.type)
-		{
-			case ACQ_TYPE_STRONG:
-				pChannels[chan]->Start(result.sv, result, 1);
-				break;
-			case ACQ_TYPE_MEDIUM:
-				pChannels[chan]->Start(result.sv, result, 10);
-				break;
-			case ACQ_TYPE_WEAK:
-				pChannels[chan]->Start(result.sv, result, 10);
-				break;
-		}
-		pChannels[chan]->Unlock();
+		chan = temp.chan;
+		states[chan].active = 0;
+		generation[chan]++;
+		starts[chan] = temp;
+		start_pending[chan] = true;
 	}
 
+	for(lcv = 0; lcv < MAX_CHANNELS; lcv++)
+		if(start_pending[lcv])
+			StartChannel(lcv);
+
 	/* This call should block until new data is available */
-	pFIFO->Dequeue(&packet);
+	if(!pFIFO->Dequeue(&packet))
+		return;
+
+	/* How far behind the source are we */
+	depth = pFIFO->getDepth();
+	period.fifo += depth;
+	if(depth > period.fifo_peak)
+		period.fifo_peak = depth;
 
 	/* We have a new packet! */
 	packet_count++;
@@ -165,6 +182,8 @@ void Correlator::Correlate()
 	NCO_Command_S *f;
 	Correlation_S *c;
 	Correlator_State_S *s;
+	uint64 t0, t1;
+	int32 busy;
 
 	IncStartTic();
 
@@ -173,10 +192,20 @@ void Correlator::Correlate()
 		TakeMeasurements();
 	}
 
+	busy = -1;
+	t0 = 0;
+
 	for(lcv = 0; lcv < MAX_CHANNELS; lcv++)
 	{
 		if(states[lcv].active)
 		{
+			/* Time from here to the next active channel is charged to this one */
+			t1 = tsc_now();
+			if(busy >= 0)
+				ChargeChannel(busy, t1 - t0);
+			t0 = t1;
+			busy = lcv;
+
 			s = &states[lcv];
 			c = &correlations[lcv];
 			f = &feedback[lcv];
@@ -253,12 +282,207 @@ void Correlator::Correlate()
 		} //!< end if active
 	} //!< end for
 
+	t1 = tsc_now();
+	if(busy >= 0)
+		ChargeChannel(busy, t1 - t0);
+	UpdateBudget(t1 - run_start);
+
+	/* One wake up for all of this ms' dumps */
+	if(dumps)
+	{
+		pTracking->Signal();
+		dumps = 0;
+	}
+
 	IncStopTic();
 
 }
 /*----------------------------------------------------------------------------------------------*/
 
 
+/*----------------------------------------------------------------------------------------------*/
+void Correlator::ChargeChannel(int32 _chan, uint64 _ticks)
+{
+	period.chan[_chan] += _ticks;
+	period.chan_ms[_chan]++;
+	if(_ticks > period.chan_peak[_chan])
+		period.chan_peak[_chan] = (uint32)_ticks;
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void Correlator::UpdateBudget(uint64 _ticks)
+{
+	int32 lcv;
+	double ns;
+	Budget_M b;
+
+	period.correlate += _ticks;
+	period.ms++;
+	if(_ticks > period.correlate_peak)
+		period.correlate_peak = (uint32)_ticks;
+	if(tsc_ns(_ticks) > 1000000)
+		period.overruns++;
+
+	/* Should stay at zero, anything else means a mutex crept back onto this thread */
+	hot_waits = lock_waits;
+
+	if(period.ms < 1000)
+		return;
+
+	/* A second is up, publish it and fold it into the totals */
+	ns = tsc_ns(period.correlate)/(double)period.ms;
+
+	for(lcv = 0; lcv < MAX_CHANNELS; lcv++)
+	{
+		b.chan_cycles[lcv] = period.chan_ms[lcv] ? (uint32)(period.chan[lcv]/period.chan_ms[lcv]) : 0;
+		b.chan_peak[lcv] = period.chan_peak[lcv];
+	}
+	b.correlate_cycles = (uint32)(period.correlate/period.ms);
+	b.correlate_peak = period.correlate_peak;
+	b.overruns = period.overruns;
+	b.fifo_depth = (uint32)(period.fifo/period.ms);
+	b.fifo_peak = period.fifo_peak;
+	b.tsc_khz = (uint32)(65536.0e6/tsc_mult);
+	b.headroom = ns > 0 ? 1e6/ns : 0;
+	b.tic = packet_count;
+
+	budget.Write(&b);
+
+	for(lcv = 0; lcv < MAX_CHANNELS; lcv++)
+	{
+		total.chan[lcv] += period.chan[lcv];
+		total.chan_ms[lcv] += period.chan_ms[lcv];
+		if(period.chan_peak[lcv] > total.chan_peak[lcv])
+			total.chan_peak[lcv] = period.chan_peak[lcv];
+	}
+	total.correlate += period.correlate;
+	total.ms += period.ms;
+	total.overruns += period.overruns;
+	total.fifo += period.fifo;
+	if(period.correlate_peak > total.correlate_peak)
+		total.correlate_peak = period.correlate_peak;
+	if(period.fifo_peak > total.fifo_peak)
+		total.fifo_peak = period.fifo_peak;
+
+	memset(&period, 0x0, sizeof(Budget_S));
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void Correlator::getBudget(Budget_M *_b)
+{
+	budget.Read(_b);
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+/*! The channel starts on the tracking thread, ahead of the first dump. A dump lost on the way costs
+	the loops an integration, a lost start leaves the correlator running against a Channel that never
+	started. So the start is not dropped, it waits for room and is tried again next ms, and the
+	correlator only switches the channel on once it is in the queue. */
+void Correlator::StartChannel(int32 _chan)
+{
+	Dump_S dump;
+
+	memset(&dump, 0x0, sizeof(Dump_S));
+	dump.result = starts[_chan];
+	dump.start = true;
+	dump.generation = generation[_chan];
+	if(!COR_2_TRK_P[_chan]->TrySend(&dump))
+	{
+		start_waits++;
+		return;
+	}
+	dumps++;
+
+	result = starts[_chan];
+	states[_chan].chan = _chan;
+	InitCorrelator(&states[_chan]);
+	start_pending[_chan] = false;
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+uint32 Correlator::getDumpDrops()
+{
+	int32 lcv;
+	uint32 drops;
+
+	drops = 0;
+	for(lcv = 0; lcv < MAX_CHANNELS; lcv++)
+		drops += dump_drops[lcv];
+
+	return(drops);
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+uint32 Correlator::getRetries()
+{
+	int32 lcv;
+	uint32 retries;
+
+	retries = 0;
+	for(lcv = 0; lcv < MAX_CHANNELS; lcv++)
+		retries += pChannels[lcv]->getRetries();
+
+	return(retries);
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void Correlator::PrintBudget(FILE *_fp)
+{
+	int32 lcv, active, room;
+	double us, sum;
+
+	if(total.ms == 0)
+		return;
+
+	fprintf(_fp,"\nCorrelator budget over %u ms, TSC %.1f MHz\n", total.ms, 65536.0e3/tsc_mult);
+	fprintf(_fp,"%-10s %10s %10s %10s\n","Channel","active ms","mean us","peak us");
+
+	active = 0; sum = 0;
+	for(lcv = 0; lcv < MAX_CHANNELS; lcv++)
+	{
+		if(total.chan_ms[lcv] == 0)
+			continue;
+
+		us = tsc_ns(total.chan[lcv]/total.chan_ms[lcv])/1e3;
+		sum += us;
+		active++;
+		fprintf(_fp,"%-10d %10u %10.1f %10.1f\n", lcv, total.chan_ms[lcv], us, tsc_ns(total.chan_peak[lcv])/1e3);
+	}
+
+	us = tsc_ns(total.correlate/total.ms)/1e3;
+	fprintf(_fp,"Correlate: mean %.1f us, peak %.1f us, %u ms over budget\n", us, tsc_ns(total.correlate_peak)/1e3, total.overruns);
+	fprintf(_fp,"FIFO: mean %.1f ms, peak %u ms of %d\n", (double)total.fifo/total.ms, total.fifo_peak, FIFO_DEPTH);
+	fprintf(_fp,"Headroom: %.1fx real time", us > 0 ? 1e3/us : 0);
+	if(active)
+	{
+		/* The fixed cost per ms is whatever was not spent on a channel */
+		room = (int32)((1e3 - (us - sum))/(sum/active));
+		fprintf(_fp,", room for ~%d channels at %.1f us each", room > 0 ? room : 0, sum/active);
+	}
+	fprintf(_fp,"\n");
+	fprintf(_fp,"Hot path: %u waits for a lock, %u channel status reads retried\n", hot_waits, getRetries());
+	fprintf(_fp,"PVT: %u measurement epochs dropped\n", epoch_drops);
+	fprintf(_fp,"Tracking: %u dumps without fresh feedback, %u commands dropped, %u dumps dropped, %u ms of starts held back\n",
+		loop_misses, pTracking->getDropped(), getDumpDrops(), start_waits);
+	for(lcv = 0; lcv < MAX_CHANNELS; lcv++)
+		if(dump_drops[lcv])
+			fprintf(_fp,"  channel %d: %u dumps dropped\n", lcv, dump_drops[lcv]);
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
 /*----------------------------------------------------------------------------------------------*/
 void Correlator::TakeMeasurements()
 {
@@ -276,16 +500,16 @@ void Correlator::TakeMeasurements()
 	measurement_tic++;
 
 	/* Current, previous, and double previous */
-	index_dp = (measurement_tic - 2*ICP_TICS + MEASUREMENTS_PER_SECOND) % MEASUREMENTS_PER_SECOND;
-	index_p = (measurement_tic - ICP_TICS + MEASUREMENTS_PER_SECOND) % MEASUREMENTS_PER_SECOND;
-	index_c = measurement_tic % MEASUREMENTS_PER_SECOND;
+	index_dp = (measurement_tic - 2*ICP_TICS + MEASUREMENT_DEPTH) % MEASUREMENT_DEPTH;
+	index_p = (measurement_tic - ICP_TICS + MEASUREMENT_DEPTH) % MEASUREMENT_DEPTH;
+	index_c = measurement_tic % MEASUREMENT_DEPTH;
 
 	for(lcv = 0; lcv < MAX_CHANNELS; lcv++)
 	{
 		s = &states[lcv];
 
 		/* Pointer to transmitted measurement */
-		sMeasurement = &measurements[lcv];
+		sMeasurement = &isr_s.measurements[lcv];
 
 		/* Pointer to current measurement in buffer */
 		aMeasurement = &measurements_buff[lcv][index_c];
@@ -342,12 +566,37 @@ void Correlator::TakeMeasurements()
 
 	}
 
-	/* Write the preamble, then the measurements */
+	/* Send the preamble and the measurements as one message. The queue is only a few epochs deep
+	   at the top rate, a PVT that falls that far behind loses epochs rather than stall the correlator */
 	if((measurement_tic % MEASUREMENT_MOD) == 0)
 	{
-		write(ISRM_2_PVT_P[WRITE], &measurements, MAX_CHANNELS*sizeof(Measurement_M));
-		preamble.tic_measurement = measurement_tic;
-		write(ISRP_2_PVT_P[WRITE], &preamble, sizeof(Preamble_2_PVT_S));
+		isr_s.preamble.tic_measurement = measurement_tic;
+		if(!ISRM_2_PVT_P->TrySend(&isr_s))
+			epoch_drops++;
+	}
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void Correlator::AdvanceEpoch(Correlator_State_S *s, int32 _ms)
+{
+
+	s->_1ms_epoch += _ms;
+	while(s->_1ms_epoch >= 20)
+	{
+		s->_1ms_epoch -= 20;
+		s->_20ms_epoch++;
+
+		if(s->_20ms_epoch >= 300)
+		{
+			s->_20ms_epoch = 0;
+			s->_z_count += 6;
+
+			if(s->_z_count > SECONDS_IN_WEEK)
+				s->_z_count = 0;
+		}
 	}
 
 }
@@ -368,41 +617,9 @@ void Correlator::UpdateState(Correlator_State_S *s, int32 samps)
 
 	/* A double rollover MIGHT occur? */
 	if(s->code_phase_mod >= 2.0*(double)CODE_CHIPS)
-	{
-		s->_1ms_epoch += 2;
-		if(s->_1ms_epoch >= 20)
-		{
-			s->_1ms_epoch %= 20;
-			s->_20ms_epoch++;
-
-			if(s->_20ms_epoch >= 300)
-			{
-				s->_20ms_epoch = 0;
-				s->_z_count += 6;
-
-				if(s->_z_count > SECONDS_IN_WEEK)
-					s->_z_count = 0;
-			}
-		}
-	} /* If the C/A code rolls over then the 1ms and 20ms counters need incremented */
-	else if(s->code_phase_mod >= (double)CODE_CHIPS)
-	{
-		s->_1ms_epoch++;
-		if(s->_1ms_epoch >= 20)
-		{
-			s->_1ms_epoch %= 20;
-			s->_20ms_epoch++;
-
-			if(s->_20ms_epoch >= 300)
-			{
-				s->_20ms_epoch = 0;
-				s->_z_count += 6;
-
-				if(s->_z_count > SECONDS_IN_WEEK)
-					s->_z_count = 0;
-			}
-		}
-	}
+		AdvanceEpoch(s, 2);
+	else if(s->code_phase_mod >= (double)CODE_CHIPS) /* If the C/A code rolls over then the 1ms and 20ms counters need incremented */
+		AdvanceEpoch(s, 1);
 
 	/* Update partial phase states */
 	s->carrier_phase_mod  	 = fmod(s->carrier_phase_mod, 1.0);
@@ -427,6 +644,8 @@ void Correlator::Accum(Correlator_State_S *s, Correlation_S *c, CPX *data, int32
 
 	CPX_ACCUM EPL[3];
 
+	PROFILE_SCOPE("Correlator::Accum");
+
 	//SineGen(samps);
 	//state.psine = main_sine_rows[chan];
 
@@ -456,6 +675,10 @@ void Correlator::DumpAccum(Correlator_State_S *s, Correlation_S *c,  NCO_Command
 	double sang, cang, tI, tQ;
 	double code_phase;
 	int32 bin, offset, lcv, bread;
+	int32 fresh;
+	Dump_S dump;
+
+	PROFILE_SCOPE("Correlator::DumpAccum");
 
 	/* First rotate correlation based on nco frequency and actually frequency used for correlation */
 	f1 = ((s->sbin - CARRIER_BINS) * CARRIER_SPACING) + IF_FREQUENCY;
@@ -479,13 +702,34 @@ void Correlator::DumpAccum(Correlator_State_S *s, Correlation_S *c,  NCO_Command
 	c->I[2] = (int32)floor(cang*tI - sang*tQ);
 	c->Q[2] = (int32)floor(sang*tI + cang*tQ);
 
-	/* Get the f */
-	pChannels[_chan]->Lock();
-	pChannels[_chan]->Accum(c, f);
-	pChannels[_chan]->Unlock();
+	/* Hand the correlations to the channel's loops on the tracking thread */
+	dump.corr = *c;
+	dump.start = false;
+	dump.generation = generation[_chan];
+	dump._1ms_epoch = s->_1ms_epoch;
+	dump._20ms_epoch = s->_20ms_epoch;
+	dump._z_count = s->_z_count;
+	dump.tic = packet_count;
+	dump.count = s->count;
+	if(COR_2_TRK_P[_chan]->TrySend(&dump))
+		dumps++;
+	else
+		dump_drops[_chan]++;
+
+	/* Apply the f they made of the previous dump, one integration period ago */
+	fresh = false;
+	while(s->active && TRK_2_COR_P[_chan]->TryReceive(f))
+	{
+		if(f->generation != generation[_chan])
+			continue;
 
-	 /* Apply f */
-	ProcessFeedback(s, f);
+		ProcessFeedback(s, f);
+		fresh = true;
+	}
+
+	/* Not back in time, keep the NCOs as they are and pick it up at the next dump */
+	if(!fresh && (s->count > 0))
+		loop_misses++;
 
 	/* Is this needed? */
 	s->count++;
@@ -531,20 +775,35 @@ void Correlator::DumpAccum(Correlator_State_S *s, Correlation_S *c,  NCO_Command
 void Correlator::ProcessFeedback(Correlator_State_S *s, NCO_Command_S *f)
 {
 
-	int32 chan;
+	int32 chan, since;
 
 	s->carrier_nco  = f->carrier_nco;
 	s->code_nco 	= f->code_nco;
 	s->navigate		= f->navigate;
 
-	if(f->reset_1ms)
-		s->_1ms_epoch = 0;
+	/* The resets were for the epochs at the dump f answers, the ms since then go back on top */
+	if(f->reset_1ms || f->reset_20ms || f->set_z_count)
+	{
+		since = (int32)(s->_1ms_epoch - f->dump_1ms_epoch) + 20*(int32)(s->_20ms_epoch - f->dump_20ms_epoch)
+			+ 1000*(int32)(s->_z_count - f->dump_z_count);
+
+		s->_1ms_epoch = f->dump_1ms_epoch;
+		s->_20ms_epoch = f->dump_20ms_epoch;
+		s->_z_count = f->dump_z_count;
+
+		if(f->reset_1ms)
+			s->_1ms_epoch = 0;
 
-	if(f->reset_20ms)
-		s->_20ms_epoch = 60;
+		if(f->reset_20ms)
+			s->_20ms_epoch = 60;
 
-	if(f->set_z_count)
-		s->_z_count = f->z_count;
+		if(f->set_z_count)
+			s->_z_count = f->z_count;
+
+		/* Negative across the end of the week, nothing to replay then */
+		if(since > 0)
+			AdvanceEpoch(s, since);
+	}
 
 	/* Update correlator state */
 	if(f->kill)
@@ -654,8 +913,7 @@ void Correlator::InitCorrelator(Correlator_State_S *s)
 	s->carrier_nco			= IF_FREQUENCY + result.doppler;
 	s->_1ms_epoch 			= 0;
 	s->_20ms_epoch			= 0;
-	s->rollover 			= (int32) ceil(((double)CODE_CHIPS - code_phase)*SAMPLE_FREQUENCY/s->code_nco); /* Calculate rollover point */
-	/* Get row pointers to pre-generated code */
+	s->rollover 			= (int32) ceil(((double)CODE_CHIPS - code_phase)*SAMPLE_FREQUENCY/s->code_nco); /* Calculate rollover point */	/* Get row pointers to pre-generated code */
 
 	GetPRN(s);
 
@@ -31,6 +31,7 @@
 #include "includes.h"
 #include "sv_select.h"
 #include "channel.h"
+#include "tracking.h"
 #include "fifo.h"
 
 /*! \ingroup CLASSES
@@ -45,9 +46,8 @@ class Correlator : public Threaded_Object
 		NCO_Command_S  		feedback[MAX_CHANNELS];				//!< NCO feedback commands
 		Correlation_S  		correlations[MAX_CHANNELS];			//!< Resulting correlation
 		Correlator_State_S	states[MAX_CHANNELS];				//!< Correlator states
-		Measurement_M		measurements[MAX_CHANNELS];			//!< Measurements to dump
-		Measurement_M		measurements_buff[MAX_CHANNELS][MEASUREMENTS_PER_SECOND];	//!< Measurements to dump
-		Preamble_2_PVT_S	preamble;
+		Measurement_M		measurements_buff[MAX_CHANNELS][MEASUREMENT_DEPTH];	//!< Measurements to dump
+		ISR_2_PVT_S			isr_s;								//!< Preamble and measurements to dump
 
 		/* These variables are shared among all the channels */
 		Acq_Command_S 		result; 							//!< An acquisition result has been returned!
@@ -61,6 +61,20 @@ class Correlator : public Threaded_Object
 		CPX					scratch[2*SAMPS_MS];				//!< Scratch data
 		CPX					lookup[SAMPS_MS];					//!< Hold the sine lookup
 
+		/* Real-time budget */
+		Budget_S			period;								//!< Accumulating over the current second
+		Budget_S			total;								//!< Accumulated since startup
+		Seqlock<Budget_M>	budget;								//!< Last complete second, for the telemetry
+		uint32				hot_waits;							//!< Times this thread blocked on a mutex
+		uint32				generation[MAX_CHANNELS];			//!< Starts of each channel, tags the dumps and feedback
+		uint32				dumps;								//!< Sent to the tracking this ms
+		uint32				loop_misses;						//!< Dumps the previous dump's feedback was not back for
+		uint32				dump_drops[MAX_CHANNELS];			//!< Dumps that found the channel's queue full
+		Acq_Command_S		starts[MAX_CHANNELS];				//!< Acquisition result each channel is to start on
+		int32				start_pending[MAX_CHANNELS];		//!< The start message has not got through yet
+		uint32				start_waits;						//!< ms a start message waited on a full queue
+		uint32				epoch_drops;						//!< Measurement epochs the PVT's queue had no room for
+
 	public:
 
 		Correlator();
@@ -72,12 +86,27 @@ class Correlator : public Threaded_Object
 		void SamplePRN();																	//!< Sample all 32 PRN codes and put it into the code table
 		void GetPRN(Correlator_State_S *s);													//!< Get row pointers to specific PRN
 		void InitCorrelator(Correlator_State_S *s);											//!< Initialize a correlator/channel with an acquisition result
+		void StartChannel(int32 _chan);														//!< Send the start message, switch the channel on once it is through
 		void UpdateState(Correlator_State_S *s, int32 samps);								//!< Update correlator state
+		void AdvanceEpoch(Correlator_State_S *s, int32 _ms);								//!< Count ms into the 1 ms/20 ms/z count epochs
 		void ProcessFeedback(Correlator_State_S *s, NCO_Command_S *f);						//!< Process the feedback
 		void DumpAccum(Correlator_State_S *s, Correlation_S *c, NCO_Command_S *f, int32 _chan);	//!< Dump accumulation to channel for processing
 		void TakeMeasurements();																//!< Take some measurements
 		void Accum(Correlator_State_S *s, Correlation_S *c, CPX *data, int32 samps);		//!< Do the actual accumulation
 		void SineGen(int32 samps);															//!< Dynamic wipeoff generation
+		void ChargeChannel(int32 _chan, uint64 _ticks);										//!< Add to a channel's budget
+		void UpdateBudget(uint64 _ticks);													//!< Close out the budget for a 1 ms packet
+		void getBudget(Budget_M *_b);														//!< Copy out the last second's budget
+		void PrintBudget(FILE *_fp);														//!< Summarize the budget since startup
+		uint32 getLate(){return(total.overruns + period.overruns);}							//!< ms over budget since startup, no lock
+		uint32 getLockWaits(){return(hot_waits);}											//!< Times the correlator thread blocked on a mutex, no lock
+		uint32 getLoopMisses(){return(loop_misses);}										//!< Dumps that went without fresh feedback, no lock
+		uint32 getDumpDrops(int32 _chan){return(dump_drops[_chan]);}						//!< Dumps a channel lost to a full queue, no lock
+		uint32 getDumpDrops();																//!< Summed over the channels
+		uint32 getStartWaits(){return(start_waits);}										//!< ms start messages were held back, no lock
+		uint32 getEpochDrops(){return(epoch_drops);}										//!< Measurement epochs the PVT missed, no lock
+		uint32 getRetries();																//!< Channel status reads that raced the correlator
+		uint32 getFIFOPeak(){return(total.fifo_peak > period.fifo_peak ? total.fifo_peak : period.fifo_peak);}	//!< Deepest the FIFO got, no lock
 };
 
 #endif /* CORRELATOR_H_ */
@@ -0,0 +1,553 @@
+/*----------------------------------------------------------------------------------------------*/
+/*! \file ekf.cpp
+//
+// FILENAME: ekf.cpp
+//
+// DESCRIPTION: Implements member functions of the EKF class.
+//
+// DEVELOPERS: Gregory W. Heckler (2003-2009)
+//
+// LICENSE TERMS: Copyright (c) Gregory W. Heckler 2009
+//
+// This file is part of the GPS Software Defined Radio (GPS-SDR)
+//
+// The GPS-SDR is free software; you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation; either version 2 of
+// the License, or (at your option) any later version. The GPS-SDR is distributed in the hope that
+// it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// Note:  Comments within this file follow a syntax that is compatible with
+//        DOXYGEN and are utilized for automated document extraction
+//
+// Reference:
+*/
+/*----------------------------------------------------------------------------------------------*/
+
+#include "ekf.h"
+
+/*----------------------------------------------------------------------------------------------*/
+void *EKF_Thread(void *_arg)
+{
+
+	while(pEKF->Running())
+	{
+		/* Nothing came, nothing is locked either */
+		if(!pEKF->Import())
+			continue;
+		pEKF->Update();
+		pEKF->Export();
+	}
+
+	pthread_exit(0);
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void EKF::Start()
+{
+
+	Start_Thread(EKF_Thread, NULL);
+
+	if(gopt.verbose)
+		fprintf(stdout,"EKF thread started\n");
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+EKF::EKF():Threaded_Object("EKFTASK")
+{
+
+	object_mem = this;
+	size = sizeof(EKF);
+
+	memset(&input, 0x0, sizeof(PVT_2_EKF_S));
+	memset(&output, 0x0, sizeof(EKF_2_TLM_S));
+
+	Reset();
+
+	if(gopt.verbose)
+		fprintf(stdout,"Creating EKF\n");
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+EKF::~EKF()
+{
+	if(gopt.verbose)
+		fprintf(stdout,"Destructing EKF\n");
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+int32 EKF::Import()
+{
+
+	/* Wait for the PVT's next epoch */
+	if(!PVT_2_EKF_P->Receive(&input))
+		return(false);
+
+	Lock();
+
+	IncStartTic();
+
+	return(true);
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void EKF::Export()
+{
+
+	/* Neither may hold up the filter, and both only want REPORT_RATE */
+	if((output.state.tic % REPORT_DECIMATION) == 0)
+	{
+		EKF_2_TLM_P->TrySend(&output);
+		EKF_2_SVS_P->TrySend(&output);
+	}
+
+	Unlock();
+
+	IncStopTic();
+
+	IncExecTic();
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void EKF::Reset()
+{
+
+	memset(X, 0x0, sizeof(X));
+	memset(U, 0x0, sizeof(U));
+	memset(D, 0x0, sizeof(D));
+
+	q_dt = 0;
+	last_time = 0;
+	status = 0;
+	ticks = 0;
+	rejects = 0;
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void EKF::Filter(PVT_2_EKF_S *_in, EKF_2_TLM_S *_out)
+{
+
+	memcpy(&input, _in, sizeof(PVT_2_EKF_S));
+	Update();
+	memcpy(_out, &output, sizeof(EKF_2_TLM_S));
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void EKF::Init()
+{
+
+	int32 lcv;
+
+	/* The raw pseudoranges carry all of the clock the PVT has steered out so far */
+	X[0] = input.sps.x;
+	X[1] = input.sps.y;
+	X[2] = input.sps.z;
+	X[3] = input.sps.vx;
+	X[4] = input.sps.vy;
+	X[5] = input.sps.vz;
+	X[6] = input.clock.bias*SPEED_OF_LIGHT;
+	X[7] = input.sps.clock_rate;
+
+	memset(U, 0x0, sizeof(U));
+	for(lcv = 0; lcv < EKF_STATES; lcv++)
+		U[lcv][lcv] = 1.0;
+
+	D[0] = D[1] = D[2] = EKF_INIT_POS*EKF_INIT_POS;
+	D[3] = D[4] = D[5] = EKF_INIT_VEL*EKF_INIT_VEL;
+	D[6] = EKF_INIT_BIAS*EKF_INIT_BIAS;
+	D[7] = EKF_INIT_RATE*EKF_INIT_RATE;
+
+	q_dt = 0;
+	ticks = 0;
+	rejects = 0;
+	status = (0x1 << EKF_STATE_INITIALIZED);
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void EKF::Predict(double _dt)
+{
+
+	double W[EKF_STATES][2*EKF_STATES];
+	double Dw[2*EKF_STATES];
+	double DW[2*EKF_STATES];
+	double s, t;
+	int32 lcv, lcv2, k;
+
+	/* Q = G diag(Dq) G', each position/velocity pair and the clock pair factored on their own,
+	 * the epochs come at a fixed rate so this is only done when that changes */
+	if(_dt != q_dt)
+	{
+		memset(G, 0x0, sizeof(G));
+		for(lcv = 0; lcv < EKF_STATES; lcv++)
+			G[lcv][lcv] = 1.0;
+
+		for(lcv = 0; lcv < 3; lcv++)
+		{
+			G[lcv][lcv + 3] = 0.5*_dt;
+			Dq[lcv] = EKF_ACCEL_PSD*_dt*_dt*_dt/12.0;
+			Dq[lcv + 3] = EKF_ACCEL_PSD*_dt;
+		}
+
+		G[6][7] = 0.5*_dt;
+		Dq[6] = EKF_BIAS_PSD*_dt + EKF_RATE_PSD*_dt*_dt*_dt/12.0;
+		Dq[7] = EKF_RATE_PSD*_dt;
+
+		q_dt = _dt;
+	}
+
+	/* The state, position off velocity and bias off rate */
+	X[0] += X[3]*_dt;
+	X[1] += X[4]*_dt;
+	X[2] += X[5]*_dt;
+	X[6] += X[7]*_dt;
+
+	/* W = [Phi*U G], weighted by diag(D, Dq) */
+	for(lcv = 0; lcv < EKF_STATES; lcv++)
+	{
+		for(lcv2 = 0; lcv2 < EKF_STATES; lcv2++)
+		{
+			W[lcv][lcv2] = U[lcv][lcv2];
+			W[lcv][lcv2 + EKF_STATES] = G[lcv][lcv2];
+		}
+		Dw[lcv] = D[lcv];
+		Dw[lcv + EKF_STATES] = Dq[lcv];
+	}
+
+	for(lcv2 = 0; lcv2 < EKF_STATES; lcv2++)
+	{
+		W[0][lcv2] += U[3][lcv2]*_dt;
+		W[1][lcv2] += U[4][lcv2]*_dt;
+		W[2][lcv2] += U[5][lcv2]*_dt;
+		W[6][lcv2] += U[7][lcv2]*_dt;
+	}
+
+	/* Modified weighted Gram-Schmidt, from the last row up, gives the new U and D */
+	for(k = EKF_STATES - 1; k >= 0; k--)
+	{
+		s = 0;
+		for(lcv2 = 0; lcv2 < 2*EKF_STATES; lcv2++)
+		{
+			DW[lcv2] = Dw[lcv2]*W[k][lcv2];
+			s += W[k][lcv2]*DW[lcv2];
+		}
+
+		D[k] = s;
+		if(!(s > 0))
+		{
+			status |= (0x1 << EKF_STATE_COVARIANCE_OVERFLOW_ERR);
+			return;
+		}
+
+		s = 1.0/s;
+		for(lcv = 0; lcv < k; lcv++)
+		{
+			t = 0;
+			for(lcv2 = 0; lcv2 < 2*EKF_STATES; lcv2++)
+				t += W[lcv][lcv2]*DW[lcv2];
+			t *= s;
+
+			U[lcv][k] = t;
+			for(lcv2 = 0; lcv2 < 2*EKF_STATES; lcv2++)
+				W[lcv][lcv2] -= t*W[k][lcv2];
+		}
+	}
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+int32 EKF::Scalar(double *_h, double _r, double _innov)
+{
+
+	double f[EKF_STATES];
+	double v[EKF_STATES];
+	double b[EKF_STATES];
+	double a, a_next, p, t;
+	int32 lcv, lcv2;
+
+	/* f = U'h, v = Df, and the innovation variance h'Ph + r */
+	a = _r;
+	for(lcv = 0; lcv < EKF_STATES; lcv++)
+	{
+		f[lcv] = _h[lcv];
+		for(lcv2 = 0; lcv2 < lcv; lcv2++)
+			f[lcv] += U[lcv2][lcv]*_h[lcv2];
+		v[lcv] = D[lcv]*f[lcv];
+		a += f[lcv]*v[lcv];
+	}
+
+	/* Gate before anything is touched */
+	if(_innov*_innov > EKF_GATE*EKF_GATE*a)
+		return(false);
+
+	/* Bierman, updates U and D in place and leaves the unscaled gain in b */
+	a = _r;
+	for(lcv = 0; lcv < EKF_STATES; lcv++)
+	{
+		a_next = a + f[lcv]*v[lcv];
+		D[lcv] *= a/a_next;
+		b[lcv] = v[lcv];
+		p = -f[lcv]/a;
+
+		for(lcv2 = 0; lcv2 < lcv; lcv2++)
+		{
+			t = U[lcv2][lcv];
+			U[lcv2][lcv] = t + b[lcv2]*p;
+			b[lcv2] += t*v[lcv];
+		}
+
+		a = a_next;
+	}
+
+	t = _innov/a;
+	for(lcv = 0; lcv < EKF_STATES; lcv++)
+		X[lcv] += b[lcv]*t;
+
+	return(true);
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void EKF::Update()
+{
+
+	SV_Position_M *sv;
+	Pseudorange_M *pr;
+	double h[EKF_STATES];
+	double dt, dx, dy, dz, range, relvel, innov;
+	int32 lcv, tried, used;
+	uint32 mask;
+	uint64 t0;
+
+	t0 = tsc_now();
+
+	memset(&output.residual, 0x0, sizeof(EKF_Residual_M));
+	status &= (0x1 << EKF_STATE_INITIALIZED);
+	mask = 0;
+
+	/* Nothing to go on until the point solution converges */
+	if(!status)
+	{
+		if(input.sps.converged && (input.sps.stale_ticks == 0))
+			Init();
+
+		last_time = input.clock.receiver_time;
+		Output(t0, mask);
+		return;
+	}
+
+	/* A PVT reset starts the receiver time over */
+	dt = input.clock.receiver_time - last_time;
+	last_time = input.clock.receiver_time;
+	if((dt <= 0) || (dt > EKF_MAX_DT))
+	{
+		Reset();
+		Output(t0, mask);
+		return;
+	}
+
+	Predict(dt);
+
+	tried = used = 0;
+	for(lcv = 0; lcv < MAX_CHANNELS; lcv++)
+	{
+		if(((input.sps.nsvs >> lcv) & 0x1) == 0)
+			continue;
+
+		sv = &input.sv_positions[lcv];
+		pr = &input.pseudoranges[lcv];
+		output.residual.sv[lcv] = input.sps.chanmap[lcv];
+
+		/* Pseudorange */
+		dx = X[0] - sv->x;
+		dy = X[1] - sv->y;
+		dz = X[2] - sv->z;
+		range = sqrt(dx*dx + dy*dy + dz*dz);
+
+		memset(h, 0x0, sizeof(h));
+		h[0] = dx/range;
+		h[1] = dy/range;
+		h[2] = dz/range;
+		h[6] = 1.0;
+
+		innov = pr->uncorrected - (range + X[6] - sv->clock_bias*SPEED_OF_LIGHT);
+		output.residual.pseudorange_residuals[lcv] = innov;
+
+		tried++;
+		if(Scalar(h, EKF_SIGMA_PR*EKF_SIGMA_PR, innov))
+		{
+			used++;
+			mask |= (0x1 << lcv);
+		}
+		else
+			output.residual.status[lcv] |= (0x1 << EKF_MEAS_PSEUDO_ERR);
+
+		/* Pseudorange rate, along the line of sight the update just moved */
+		dx = X[0] - sv->x;
+		dy = X[1] - sv->y;
+		dz = X[2] - sv->z;
+		range = 1.0/sqrt(dx*dx + dy*dy + dz*dz);
+
+		memset(h, 0x0, sizeof(h));
+		h[3] = dx*range;
+		h[4] = dy*range;
+		h[5] = dz*range;
+		h[7] = 1.0;
+
+		relvel = h[3]*(X[3] - sv->vx) + h[4]*(X[4] - sv->vy) + h[5]*(X[5] - sv->vz);
+		innov = pr->meters_rate - (relvel + X[7] - sv->frequency_bias*SPEED_OF_LIGHT);
+
+		if(!Scalar(h, EKF_SIGMA_PRR*EKF_SIGMA_PRR, innov))
+			output.residual.status[lcv] |= (0x1 << EKF_MEAS_DOPPLER_ERR);
+	}
+
+	if(used)
+	{
+		status |= (0x1 << EKF_STATE_UPDATE_OCCURED);
+		rejects = 0;
+	}
+	else if(tried)
+		rejects++;
+
+	ticks++;
+
+	Check();
+
+	Output(t0, mask);
+
+	/* Diverged, start over off the next point solution */
+	if((status & ~((0x1 << EKF_STATE_INITIALIZED) | (0x1 << EKF_STATE_CONVERGED) | (0x1 << EKF_STATE_UPDATE_OCCURED))) ||
+		(rejects >= EKF_MAX_REJECTS))
+		Reset();
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void EKF::Check()
+{
+
+	double pos, vel;
+	int32 lcv, lcv2;
+
+	for(lcv = 0; lcv < EKF_STATES; lcv++)
+		if(!(D[lcv] > 0))
+			status |= (0x1 << EKF_STATE_COVARIANCE_OVERFLOW_ERR);
+
+	/* Diagonal of UDU' */
+	pos = vel = 0;
+	for(lcv = 0; lcv < 6; lcv++)
+	{
+		for(lcv2 = lcv; lcv2 < EKF_STATES; lcv2++)
+		{
+			if(lcv < 3)
+				pos += U[lcv][lcv2]*U[lcv][lcv2]*D[lcv2];
+			else
+				vel += U[lcv][lcv2]*U[lcv][lcv2]*D[lcv2];
+		}
+	}
+
+	if(!(pos < EKF_MAX_POS*EKF_MAX_POS))
+		status |= (0x1 << EKF_STATE_POSITION_SIGMA_ERR);
+
+	if(!(vel < EKF_MAX_VEL*EKF_MAX_VEL))
+		status |= (0x1 << EKF_STATE_VELOCITY_SIGMA_ERR);
+
+	if(pos < EKF_CONVERGED_POS*EKF_CONVERGED_POS)
+		status |= (0x1 << EKF_STATE_CONVERGED);
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void EKF::Output(uint64 _t0, uint32 _mask)
+{
+
+	EKF_State_M *s = &output.state;
+	EKF_Covariance_M *c = &output.covariance;
+	double sigma[EKF_STATES];
+	int32 lcv, lcv2, nsvs;
+	uint64 t;
+
+	for(lcv = 0; lcv < EKF_STATES; lcv++)
+	{
+		sigma[lcv] = 0;
+		for(lcv2 = lcv; lcv2 < EKF_STATES; lcv2++)
+			sigma[lcv] += U[lcv][lcv2]*U[lcv][lcv2]*D[lcv2];
+		sigma[lcv] = sqrt(sigma[lcv]);
+	}
+
+	nsvs = 0;
+	for(lcv = 0; lcv < MAX_CHANNELS; lcv++)
+		if((_mask >> lcv) & 0x1)
+			nsvs++;
+
+	s->x = X[0];
+	s->y = X[1];
+	s->z = X[2];
+	s->vx = X[3];
+	s->vy = X[4];
+	s->vz = X[5];
+	s->solar = 0;
+	s->drag = 0;
+	s->clock_bias = X[6];
+	s->clock_rate = X[7];
+	s->time = input.clock.time;
+	s->nsvs = _mask;
+	s->week = input.clock.week;
+	s->status = status | (nsvs << 16);
+	s->ekf_ticks = ticks;
+	s->tic = input.sps.tic;
+
+	c->x = sigma[0];
+	c->y = sigma[1];
+	c->z = sigma[2];
+	c->vx = sigma[3];
+	c->vy = sigma[4];
+	c->vz = sigma[5];
+	c->clock_bias = sigma[6];
+	c->clock_rate = sigma[7];
+	c->solar = 0;
+	c->drag = 0;
+	c->tic = input.sps.tic;
+
+	output.residual.tic = input.sps.tic;
+
+	/* In the 500 us units the GUI expects, the histogram keeps the real figure */
+	t = tsc_now() - _t0;
+	s->period = (tsc_ns(t) + 499999)/500000;
+	update_hist.Add(t);
+
+}
+/*----------------------------------------------------------------------------------------------*/
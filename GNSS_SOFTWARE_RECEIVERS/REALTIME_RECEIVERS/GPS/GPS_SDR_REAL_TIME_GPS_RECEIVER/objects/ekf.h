@@ -0,0 +1,106 @@
+/*----------------------------------------------------------------------------------------------*/
+/*! \file ekf.h
+//
+// FILENAME: ekf.h
+//
+// DESCRIPTION: Defines the EKF class, the navigation filter behind the point solution
+//
+// DEVELOPERS: Gregory W. Heckler (2003-2009)
+//
+// LICENSE TERMS: Copyright (c) Gregory W. Heckler 2009
+//
+// This file is part of the GPS Software Defined Radio (GPS-SDR)
+//
+// The GPS-SDR is free software; you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation; either version 2 of
+// the License, or (at your option) any later version. The GPS-SDR is distributed in the hope that
+// it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// Note:  Comments within this file follow a syntax that is compatible with
+//        DOXYGEN and are utilized for automated document extraction
+//
+// Reference: G. J. Bierman, Factorization Methods for Discrete Sequential Estimation, 1977
+*/
+/*----------------------------------------------------------------------------------------------*/
+
+#ifndef EKF_H_
+#define EKF_H_
+
+#include "includes.h"
+
+#define EKF_STATES	(8)		//!< x, y, z, vx, vy, vz, clock bias (meters), clock rate (meters/sec)
+
+/*! Bits of EKF_State_M.status, the number of SVs used sits in the top 16 */
+enum EKF_STATE_CODES
+{
+	EKF_STATE_INITIALIZED,
+	EKF_STATE_CONVERGED,
+	EKF_STATE_UPDATE_OCCURED,
+	EKF_STATE_POSITION_SIGMA_ERR,
+	EKF_STATE_VELOCITY_SIGMA_ERR,
+	EKF_STATE_COVARIANCE_OVERFLOW_ERR
+};
+
+/*! Bits of EKF_Residual_M.status */
+enum EKF_MEASUREMENT_CODES
+{
+	EKF_MEAS_HORP_ERR,
+	EKF_MEAS_PSEUDO_ERR,
+	EKF_MEAS_DOPPLER_ERR,
+	EKF_MEAS_MANEUVER_ERR
+};
+
+/*! \ingroup CLASSES
+ *	@brief Position, velocity and clock filter, run on every measurement epoch the PVT hands
+ *	over. The covariance is kept as P = UDU' (U unit upper triangular), propagated with
+ *	Thornton's modified weighted Gram-Schmidt and updated one pseudorange or pseudorange rate at
+ *	a time with Bierman's scalar update, so there is no matrix inversion and P cannot lose its
+ *	symmetry or go negative. It works on the raw (uncorrected) pseudoranges, so its clock bias is
+ *	the receiver's own rather than the one the PVT steers out. It starts off the first converged
+ *	point solution and starts over when it diverges.
+ */
+class EKF : public Threaded_Object
+{
+
+	private:
+
+		PVT_2_EKF_S	input;									//!< This epoch's measurements
+		EKF_2_TLM_S	output;									//!< State, covariance and residuals out
+
+		double X[EKF_STATES];								//!< State
+		double U[EKF_STATES][EKF_STATES];					//!< Unit upper triangular factor of P
+		double D[EKF_STATES];								//!< Diagonal factor of P
+		double G[EKF_STATES][EKF_STATES];					//!< Factor of the process noise, Q = G diag(Dq) G'
+		double Dq[EKF_STATES];								//!< Diagonal of the process noise factor
+		double q_dt;										//!< Time step G and Dq were formed for
+
+		double last_time;									//!< Receiver time of the last epoch
+		uint32 status;										//!< EKF_STATE_CODES bits
+		uint32 ticks;										//!< Epochs filtered since the last reset
+		uint32 rejects;										//!< Epochs in a row with every measurement rejected
+
+		Histogram update_hist;								//!< Time spent in Update()
+
+		void Init();										//!< Start off the point solution
+		void Predict(double _dt);							//!< Propagate X, U and D by _dt
+		int32 Scalar(double *_h, double _r, double _innov);	//!< One scalar measurement update, false if gated out
+		void Check();										//!< Covariance sanity and convergence
+		void Output(uint64 _t0, uint32 _mask);				//!< Fill output, _mask is the SVs that got in
+
+	public:
+
+		EKF();
+		~EKF();
+		void Start();										//!< Start the thread
+		int32 Import();										//!< Get the PVT's epoch, returns false if the queue was closed
+		void Update();										//!< Filter it
+		void Export();										//!< Send the state to the telemetry and sv select
+		void Reset();										//!< Forget everything, start again off the next fix
+		void Filter(PVT_2_EKF_S *_in, EKF_2_TLM_S *_out);	//!< Run one epoch without the thread, for tests
+		Histogram *getUpdateHist(){return(&update_hist);}	//!< Get the update time histogram
+
+};
+
+#endif /* EKF_H_ */
@@ -33,7 +33,7 @@ void *Ephemeris_Thread(void *_arg)
 
 	Ephemeris *aEphemeris = pEphemeris;
 
-	while(grun)
+	while(aEphemeris->Running())
 	{
 		aEphemeris->Import();
 	}
@@ -164,7 +164,8 @@ void Ephemeris::Import()
 	uint32 bread;
 
 	/* Read a Subframe */
-	read(CHN_2_EPH_P[READ], (void *)&ephem_packet, sizeof(Channel_2_Ephemeris_S));
+	if(!CHN_2_EPH_P->Receive(&ephem_packet))
+		return;
 
 	IncStartTic();
 
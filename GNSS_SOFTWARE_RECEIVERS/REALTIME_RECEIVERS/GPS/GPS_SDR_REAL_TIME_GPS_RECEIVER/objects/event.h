@@ -0,0 +1,127 @@
+/*----------------------------------------------------------------------------------------------*/
+/*! \file event.h
+//
+// FILENAME: event.h
+//
+// DESCRIPTION: Defines the event a thread sleeps on when it serves several queues and files.
+//
+// DEVELOPERS: Gregory W. Heckler (2003-2009)
+//
+// LICENSE TERMS: Copyright (c) Gregory W. Heckler 2009
+//
+// This file is part of the GPS Software Defined Radio (GPS-SDR)
+//
+// The GPS-SDR is free software; you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation; either version 2 of
+// the License, or (at your option) any later version. The GPS-SDR is distributed in the hope that
+// it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// Note:  Comments within this file follow a syntax that is compatible with
+//        DOXYGEN and are utilized for automated document extraction
+//
+// Reference:
+*/
+/*----------------------------------------------------------------------------------------------*/
+
+#ifndef EVENT_H_
+#define EVENT_H_
+
+/* Pulled in by includes.h ahead of queue.h, so only lean on the system headers and defines.h */
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+#define EVENT_MAX_FDS	(4)		//!< Descriptors an Event can watch besides its own
+
+/*! \ingroup CLASSES
+ *	@brief Lets one thread sleep on several message queues and file descriptors at once. Queues
+ *	given the event with Queue::setNotify() bump an eventfd on every message, the descriptors
+ *	added with Watch() are polled alongside it with epoll. Wait() returns when any of them has
+ *	something, on the timeout, or when THREAD_WAKE_SIGNAL interrupts it for a stop.
+ */
+class Event
+{
+
+	private:
+
+		int32 efd;			//!< eventfd the queues write to
+		int32 epfd;			//!< epoll set holding efd and the watched descriptors
+		int32 hup;			//!< Watched descriptor the last Wait() found hung up, -1 if none
+
+	public:
+
+		Event()
+		{
+			struct epoll_event ev;
+
+			efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+			epfd = epoll_create1(EPOLL_CLOEXEC);
+			hup = -1;
+
+			ev.events = EPOLLIN;
+			ev.data.fd = efd;
+			epoll_ctl(epfd, EPOLL_CTL_ADD, efd, &ev);
+		}
+
+		~Event()
+		{
+			close(epfd);
+			close(efd);
+		}
+
+		//!< Wake the sleeper, cheap enough to call for every message
+		void Signal()
+		{
+			uint64 one = 1;
+
+			if(write(efd, &one, sizeof(one)) != sizeof(one))
+				return;
+		}
+
+		//!< Also wake up when _fd is readable or hung up
+		int32 Watch(int32 _fd)
+		{
+			struct epoll_event ev;
+
+			ev.events = EPOLLIN;
+			ev.data.fd = _fd;
+
+			return(epoll_ctl(epfd, EPOLL_CTL_ADD, _fd, &ev) == 0);
+		}
+
+		//!< Stop watching _fd, call before closing it
+		void Unwatch(int32 _fd)
+		{
+			struct epoll_event ev;
+
+			epoll_ctl(epfd, EPOLL_CTL_DEL, _fd, &ev);
+		}
+
+		//!< Sleep at most _msec (-1 for ever), returns false on a timeout or an interruption
+		int32 Wait(int32 _msec)
+		{
+			struct epoll_event ev[EVENT_MAX_FDS + 1];
+			uint64 count;
+			int32 nfds, lcv;
+
+			nfds = epoll_wait(epfd, ev, EVENT_MAX_FDS + 1, _msec);
+
+			/* A hang up stays reported until the owner closes the descriptor */
+			hup = -1;
+			for(lcv = 0; lcv < nfds; lcv++)
+				if((ev[lcv].data.fd != efd) && (ev[lcv].events & (EPOLLHUP | EPOLLERR)))
+					hup = ev[lcv].data.fd;
+
+			/* Signals are level triggered too, so soak them up for the next Wait() */
+			if(read(efd, &count, sizeof(count)) != sizeof(count))
+				count = 0;
+
+			return(nfds > 0);
+		}
+
+		int32 getHangUp(){return(hup);}	//!< Descriptor the last Wait() found hung up, -1 if none
+};
+
+#endif /* EVENT_H_ */
@@ -73,7 +73,6 @@ FFT::FFT(int32 _N)
 	W = (MIX *)malloc(N/2*sizeof(MIX));  	// Forward twiddle lookup
 	iW = (MIX *)malloc(N/2*sizeof(MIX)); 	// Inverse twiddle lookup
 	BR  = (int32 *)malloc(N*sizeof(int32)); 	// Bit reverse lookup
-	BRX  = (int32 *)malloc(N*sizeof(CPX)); 	// Shuffle temp array
 
 	initW();
 	initBR();
@@ -102,7 +101,6 @@ FFT::FFT(int32 _N, int32 _R[MAX_RANKS])
 	W = (MIX *)malloc(N/2*sizeof(MIX));  	// Forward twiddle lookup
 	iW = (MIX *)malloc(N/2*sizeof(MIX)); 	// Inverse twiddle lookup
 	BR  = (int32 *)malloc(N*sizeof(int32)); 	// Bit reverse lookup
-	BRX  = (int32 *)malloc(N*sizeof(CPX)); 	// Shuffle temp array
 
 	initW();
 	initBR();
@@ -112,7 +110,6 @@ FFT::FFT(int32 _N, int32 _R[MAX_RANKS])
 
 FFT::~FFT()
 {
-	free(BRX);
 	free(BR);
 	free(W);
 	free(iW);
@@ -298,13 +295,19 @@ void FFT::doiFFTdf(CPX *_x, bool _shuf)
 void FFT::doShuffle(CPX *_x)
 {
 
-	int32 lcv;
+	int32 lcv, t;
 	int32 *p = (int32 *)_x;
 
-	memcpy(BRX, p, N*sizeof(CPX));
-
+	/* Bit reversal pairs the samples up, so swap each pair once */
 	for(lcv = 0; lcv < N; lcv++)
-		p[lcv] = BRX[BR[lcv]];
+	{
+		if(lcv < BR[lcv])
+		{
+			t = p[lcv];
+			p[lcv] = p[BR[lcv]];
+			p[BR[lcv]] = t;
+		}
+	}
 
 }
 
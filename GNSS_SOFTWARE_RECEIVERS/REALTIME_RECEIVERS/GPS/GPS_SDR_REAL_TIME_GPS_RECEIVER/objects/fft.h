@@ -41,7 +41,6 @@ class FFT
 
 		MIX *W;						//!< Twiddle lookup array for FFT
 		MIX *iW;					//!< Twiddle lookup array for iFFT
-		int32 *BRX;					//!< Re-order temp array
 		int32 *BR;					//!< Re-order index array
 
 		int32 N;					//!< Length (should be 2^N!!!)
@@ -50,7 +49,7 @@ class FFT
 
 		void initW();				//!< Initialize twiddles
 		void initBR();				//!< Initialize re-order array
-		void doShuffle(CPX *_x);	//!< Do bit-reverse shuffling
+		void doShuffle(CPX *_x);	//!< Do bit-reverse shuffling, in place so a plan can be shared
 
 	public:
 
@@ -33,11 +33,7 @@ void *FIFO_Thread(void *_arg)
 
 	FIFO *aFIFO = pFIFO;
 
-	/* This thread must be cancellable by the watchdog */
-	pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
-	pthread_setcanceltype(PTHREAD_CANCEL_ASYNCHRONOUS, NULL);
-
-	while(grun)
+	while(aFIFO->Running())
 	{
 		aFIFO->Import();
 		aFIFO->IncExecTic();
@@ -80,6 +76,8 @@ FIFO::FIFO():Threaded_Object("FIFTASK")
 	buff[FIFO_DEPTH-1].next = &buff[0];
 
 	tic = count = 0;
+	overruns = 0;
+	closed = false;
 
 	sem_init(&sem_full, NULL, 0);
 	sem_init(&sem_empty, NULL, FIFO_DEPTH);
@@ -120,11 +118,15 @@ void FIFO::Import()
 
 	IncStartTic();
 
-	/* Read from the GPS source */
+	/* Read from the GPS source, a stop request can interrupt this */
 	if(pSource != NULL)
 		pSource->Read(head);
 
-	Enqueue();
+	if(!Running())
+		return;
+
+	if(!Enqueue())
+		return;
 
 	IncStopTic();
 
@@ -135,35 +137,87 @@ void FIFO::Import()
 
 
 /*----------------------------------------------------------------------------------------------*/
-void FIFO::Enqueue()
+int32 FIFO::Enqueue()
 {
 
-	sem_wait(&sem_empty);
+	/* No room, the correlator is FIFO_DEPTH ms behind and the source is about to overrun */
+	if(sem_trywait(&sem_empty) != 0)
+	{
+		overruns++;
+
+		/* The wait is interrupted (EINTR) when this thread is asked to stop */
+		while(sem_wait(&sem_empty) != 0)
+			if(!Running() || closed)
+				return(false);
+	}
+
+	if(closed)
+	{
+		sem_post(&sem_empty);
+		return(false);
+	}
 
 	head->count = count;
 
 	/* Send a packet to the acquisition (nonblocking) */
-	write(COR_2_ACQ_P[WRITE], head, sizeof(ms_packet));
+	COR_2_ACQ_P->TrySend(head);
 
 	head = head->next;
 
 	sem_post(&sem_full);
 
+	return(true);
+
 }
 /*----------------------------------------------------------------------------------------------*/
 
 
 /*----------------------------------------------------------------------------------------------*/
-void FIFO::Dequeue(ms_packet *p)
+int32 FIFO::Dequeue(ms_packet *p)
 {
 
-	sem_wait(&sem_full);
+	while(sem_wait(&sem_full) != 0)
+		if(closed)
+			return(false);
+
+	/* Pass the wake up on, nothing more is coming */
+	if(closed)
+	{
+		sem_post(&sem_full);
+		return(false);
+	}
 
 	memcpy(p, tail, sizeof(ms_packet));
 	tail = tail->next;
 
 	sem_post(&sem_empty);
 
+	return(true);
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void FIFO::Close()
+{
+
+	closed = true;
+	sem_post(&sem_full);
+	sem_post(&sem_empty);
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+uint32 FIFO::getDepth()
+{
+	int32 depth;
+
+	sem_getvalue(&sem_full, &depth);
+
+	return(depth > 0 ? depth : 0);
 }
 /*----------------------------------------------------------------------------------------------*/
 
@@ -185,3 +239,26 @@ void FIFO::ResetSource()
 }
 /*----------------------------------------------------------------------------------------------*/
 
+
+/*----------------------------------------------------------------------------------------------*/
+/*! Only the reader thread and the source are replaced. The buffer, its semaphores and the packet
+ *  count are left alone, so the correlator just sees a gap and the channels, acquisition and PVT
+ *  carry on with the state they have. */
+void FIFO::Restart()
+{
+	uint32 stop_us;
+	uint64 t0;
+
+	t0 = tsc_now();
+
+	stop_us = Stop();
+	ResetSource();
+
+	if(grun)
+		Start();
+
+	fprintf(stdout,"Source restarted in %u ms (reader stopped in %u us)\n", tsc_ns(tsc_now() - t0)/1000000, stop_us);
+	fflush(stdout);
+}
+/*----------------------------------------------------------------------------------------------*/
+
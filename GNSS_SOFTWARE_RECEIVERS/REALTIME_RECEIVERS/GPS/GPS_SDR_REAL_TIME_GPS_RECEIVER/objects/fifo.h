@@ -50,6 +50,8 @@ class FIFO : public Threaded_Object
 
 		int32 count;		//!< Count the number of packets received
 		int32 tic;			//!< Master receiver tic
+		uint32 overruns;	//!< Packets that found the FIFO full, a live source drops data then
+		volatile int32 closed;	//!< Set by Close(), Enqueue/Dequeue stop blocking
 
 	public:
 
@@ -60,8 +62,13 @@ class FIFO : public Threaded_Object
 		void Export();		//!< Get data out of the thread
 
 		void Open();
-		void Enqueue();
-		void Dequeue(ms_packet *p);
+		int32 Enqueue();	//!< Returns false if it gave up waiting for room
+		int32 Dequeue(ms_packet *p);	//!< Returns false once the FIFO is closed
+		void Close();		//!< Release the correlator for a shutdown
+		void Restart();		//!< Reopen the source under the running receiver
+		uint32 getDepth();	//!< ms of data waiting to be dequeued
+		uint32 getOverruns(){return(overruns);}	//!< Times the reader had to wait for room
+		int32 getEOF(){return(pSource != NULL ? pSource->getEOF() : false);}	//!< Source file ran out (batch mode)
 		void ResetSource();
 };
 
@@ -0,0 +1,161 @@
+/*----------------------------------------------------------------------------------------------*/
+/*! \file freq_lock.cpp
+//
+// FILENAME: freq_lock.cpp
+//
+// DESCRIPTION: Implements member functions of the Freq_Lock class.
+//
+// DEVELOPERS: Gregory W. Heckler (2003-2009)
+//
+// LICENSE TERMS: Copyright (c) Gregory W. Heckler 2009
+//
+// This file is part of the GPS Software Defined Radio (GPS-SDR)
+//
+// The GPS-SDR is free software; you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation; either version 2 of
+// the License, or (at your option) any later version. The GPS-SDR is distributed in the hope that
+// it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// Note:  Comments within this file follow a syntax that is compatible with
+//        DOXYGEN and are utilized for automated document extraction
+//
+// Reference:
+*/
+/*----------------------------------------------------------------------------------------------*/
+
+#include "freq_lock.h"
+
+/*----------------------------------------------------------------------------------------------*/
+Freq_Lock::Freq_Lock()
+{
+	int32 lcv;
+
+	pFFT = new FFT(FREQ_LOCK_POINTS);
+
+	for(lcv = 0; lcv < FREQ_LOCK_POINTS; lcv++)
+	{
+		tw_i[lcv] = (float)cos(-TWO_PI*lcv/FREQ_LOCK_POINTS);
+		tw_q[lcv] = (float)sin(-TWO_PI*lcv/FREQ_LOCK_POINTS);
+	}
+
+	if(gopt.verbose)
+		fprintf(stdout,"Creating Freq_Lock\n");
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+Freq_Lock::~Freq_Lock()
+{
+	delete pFFT;
+
+	if(gopt.verbose)
+		fprintf(stdout,"Destructing Freq_Lock\n");
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+int32 Freq_Lock::Full(CPX *_x)
+{
+	int32 *p;
+	int32 max, mind, lcv;
+
+	p = (int32 *)_x;
+
+	/* Now do the FFT */
+	pFFT->doFFT(_x, true);
+
+	/* Convert to power */
+	x86_cmag(_x, FREQ_LOCK_POINTS);
+
+	/* Get peak */
+	max = mind = 0;
+	for(lcv = 0; lcv < FREQ_LOCK_POINTS; lcv++)
+	{
+		if(p[lcv] > max)
+		{
+			max = p[lcv];
+			mind = lcv;
+		}
+	}
+
+	/* Positive and negative frequency adjustment */
+	if(mind >= (FREQ_LOCK_POINTS/2))
+		mind -= FREQ_LOCK_POINTS;
+
+	return(mind);
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+int32 Freq_Lock::Zoom(CPX *_x, int64 _re, int64 _im)
+{
+	float yi[FREQ_LOCK_POINTS/FREQ_LOCK_DECIMATE];
+	float yq[FREQ_LOCK_POINTS/FREQ_LOCK_DECIMATE];
+	float bi[2*FREQ_LOCK_ZOOM+1];
+	float bq[2*FREQ_LOCK_ZOOM+1];
+	float si, sq, xi, xq, pwr, max;
+	int32 center, lcv, k, n, idx, mind;
+
+	/* Nearest bin to the phase difference, which is unambiguous over the whole FFT span */
+	center = (int32)floor(0.5 + atan2((double)_im, (double)_re)*FREQ_LOCK_POINTS/TWO_PI);
+
+	/* Move that bin to DC and sum down, the boxcar loses < 0.1 dB at the outer bins */
+	n = 0;
+	idx = 0;
+	for(lcv = 0; lcv < FREQ_LOCK_POINTS/FREQ_LOCK_DECIMATE; lcv++)
+	{
+		si = sq = 0;
+		for(k = 0; k < FREQ_LOCK_DECIMATE; k++, n++, idx = (idx + center) & (FREQ_LOCK_POINTS-1))
+		{
+			xi = _x[n].i;
+			xq = _x[n].q;
+			si += xi*tw_i[idx] - xq*tw_q[idx];
+			sq += xi*tw_q[idx] + xq*tw_i[idx];
+		}
+		yi[lcv] = si;
+		yq[lcv] = sq;
+	}
+
+	/* The bank, each bin a straight DFT sum off the same twiddles */
+	for(k = 0; k < 2*FREQ_LOCK_ZOOM+1; k++)
+	{
+		si = sq = 0;
+		idx = 0;
+		for(lcv = 0; lcv < FREQ_LOCK_POINTS/FREQ_LOCK_DECIMATE; lcv++)
+		{
+			si += yi[lcv]*tw_i[idx] - yq[lcv]*tw_q[idx];
+			sq += yi[lcv]*tw_q[idx] + yq[lcv]*tw_i[idx];
+			idx = (idx + (k - FREQ_LOCK_ZOOM)*FREQ_LOCK_DECIMATE) & (FREQ_LOCK_POINTS-1);
+		}
+		bi[k] = si;
+		bq[k] = sq;
+	}
+
+	/* Get peak */
+	max = -1;
+	mind = 0;
+	for(k = 0; k < 2*FREQ_LOCK_ZOOM+1; k++)
+	{
+		pwr = bi[k]*bi[k] + bq[k]*bq[k];
+		if(pwr > max)
+		{
+			max = pwr;
+			mind = k;
+		}
+	}
+
+	/* Back to a bin of the full FFT */
+	mind += center - FREQ_LOCK_ZOOM;
+	if(mind >= (FREQ_LOCK_POINTS/2))
+		mind -= FREQ_LOCK_POINTS;
+	if(mind < -(FREQ_LOCK_POINTS/2))
+		mind += FREQ_LOCK_POINTS;
+
+	return(mind);
+}
+/*----------------------------------------------------------------------------------------------*/
@@ -0,0 +1,63 @@
+/*----------------------------------------------------------------------------------------------*/
+/*! \file freq_lock.h
+//
+// FILENAME: freq_lock.h
+//
+// DESCRIPTION: Defines the Freq_Lock class, the frequency search every channel runs once after
+//				its acquisition
+//
+// DEVELOPERS: Gregory W. Heckler (2003-2009)
+//
+// LICENSE TERMS: Copyright (c) Gregory W. Heckler 2009
+//
+// This file is part of the GPS Software Defined Radio (GPS-SDR)
+//
+// The GPS-SDR is free software; you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation; either version 2 of
+// the License, or (at your option) any later version. The GPS-SDR is distributed in the hope that
+// it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// Note:  Comments within this file follow a syntax that is compatible with
+//        DOXYGEN and are utilized for automated document extraction
+//
+// Reference:
+*/
+/*----------------------------------------------------------------------------------------------*/
+
+#ifndef FREQ_LOCK_H_
+#define FREQ_LOCK_H_
+
+#include "includes.h"
+#include "fft.h"
+
+#define FREQ_LOCK_POINTS	(512)	//!< Squared prompt samples per search, a power of 2
+#define FREQ_LOCK_DECIMATE	(8)		//!< Samples summed into one by the zoom
+#define FREQ_LOCK_ZOOM		(4)		//!< Bins the zoom searches either side of the phase difference estimate
+
+/*! \ingroup CLASSES
+ *	@brief The channels' frequency search, one read-only plan shared by all of them. Full() is the
+ *	original search, an FFT over all FREQ_LOCK_POINTS bins. Zoom() (-F) takes the phase difference
+ *	of consecutive samples, which the channel sums up as they come in, as the estimate, shifts that
+ *	bin to DC and sums the samples down by FREQ_LOCK_DECIMATE, then evaluates only the
+ *	2*FREQ_LOCK_ZOOM+1 bins around it. Both return the peak bin in [-N/2, N/2).
+ */
+class Freq_Lock
+{
+
+	private:
+
+		FFT *pFFT;							//!< FFT plan, nothing in it changes after construction
+		float tw_i[FREQ_LOCK_POINTS];		//!< cos(-2*pi*n/N)
+		float tw_q[FREQ_LOCK_POINTS];		//!< sin(-2*pi*n/N)
+
+	public:
+
+		Freq_Lock();
+		~Freq_Lock();
+		int32 Full(CPX *_x);							//!< FFT and peak search over every bin, overwrites _x
+		int32 Zoom(CPX *_x, int64 _re, int64 _im);		//!< Peak search around the phase difference _re + j*_im
+};
+
+#endif /* FREQ_LOCK_H_ */
@@ -32,10 +32,13 @@
 /*----------------------------------------------------------------------------------------------*/
 GPS_Source::GPS_Source(Options_S *_opt)
 {
-	int i;
+
+	int32 lcv;
 
 	memcpy(&opt, _opt, sizeof(Options_S));
-	record_on = (opt.recorder==1);
+	rs_a = rs_b = NULL;
+	dbs_rx_a = dbs_rx_b = NULL;
+	eof = false;
 	switch(opt.source)
 	{
 		case SOURCE_USRP_V1:
@@ -60,40 +63,27 @@ GPS_Source::GPS_Source(Options_S *_opt)
 			break;
 	}
 
-	overflw = soverflw = 0;
-	agc_scale = 1;
+	/* The USRP hands over full scale 16 bit samples, everything else is already small */
+	antennas = (opt.mode == 1) ? 2 : 1;
+	for(lcv = 0; lcv < MAX_ANTENNAS; lcv++)
+	{
+		agc_shift[lcv] = (source_type == SOURCE_USRP_V1) ? AGC_SHIFT : 0;
+		agc_scale[lcv] = 0;
+		overflw[lcv] = soverflw[lcv] = shigh[lcv] = 0;
+	}
 
 	/* Assign to base */
 	buff_out_p = &buff_out[0];
 	ms_count = 0;
 	
 
-	if(record_on)
-	{
-		// init record files
-		
-		out_file_a = fopen("./data.dba","wb");
-		if(out_file_a != NULL) fprintf(stdout,"data.dba opened\n");
-		if(opt.mode) // dual board
-		{
-
-			out_file_b = fopen("./data.dbb","wb");
-			if(out_file_b != NULL) fprintf(stdout,"data.dbb opened\n");
-		}		
-		fflush(stdout);
-
-	}
-
-
 	if(opt.verbose)
 		fprintf(stdout,"Creating GPS Source\n");
 
-	for (i=0; i<1024; i=i+1) {
-		sin_table[i] = -8*sin(2*M_PI*i/1024);
-		cos_table[i] = +8*cos(2*M_PI*i/1024);
-	}
-	phase = 0;//2*M_PI*3889200/16000000;
-	delta_phase = unsigned(2557223528);
+	/* Integer NCO for the GN3S mixer, pshufb/psignb need SSSE3 */
+	phase = 0;
+	delta_phase = 2557223528u;
+	mix_ssse3 = CPU_SSSE3();
 }
 /*----------------------------------------------------------------------------------------------*/
 
@@ -124,9 +114,6 @@ GPS_Source::~GPS_Source()
 	if(opt.verbose)
 		fprintf(stdout,"Destructing GPS Source\n");
 
-
-
-	fclose(out_file_a);
 }
 /*----------------------------------------------------------------------------------------------*/
 
@@ -135,9 +122,6 @@ GPS_Source::~GPS_Source()
 void GPS_Source::Read(ms_packet *_p)
 {
 
-	double gain;
-	int32 shift;
-	CPX agc_buff[SAMPS_MS];
 	switch(source_type)
 	{
 		case SOURCE_USRP_V1:
@@ -164,70 +148,81 @@ void GPS_Source::Read(ms_packet *_p)
 
 	}
 
-	if( record_on && (source_type != SOURCE_FILE) )
-	{
+	/* Record the samples as they came off the front end, ahead of the AGC's requantizing, and never
+	   a file being played back. This never blocks */
+	if((pRecorder != NULL) && (source_type != SOURCE_FILE))
+		pRecorder->Push(_p);
 
-		fwrite (&_p->data[0][0] , sizeof(CPX) , SAMPS_MS , out_file_a );
+	Run_AGC(_p);
 
-		if(opt.mode)
-		{
-			fwrite(&_p->data[1][0],sizeof(CPX),SAMPS_MS, out_file_b);
-		}
+	ms_count++;
 
-	}
+}
+/*----------------------------------------------------------------------------------------------*/
 
 
+/*----------------------------------------------------------------------------------------------*/
+void GPS_Source::Run_AGC(ms_packet *_p)
+{
 
-	//TODO: FIX THE AGC FOR MULTI INPUT STUFZ
+	db_dbs_rx *dbs_rx[MAX_ANTENNAS];
+	int32 stats[2];
+	int32 lcv;
+	double gain;
 
+	/* A replay is processed exactly as it was recorded, there is no front end to steer */
+	if(source_type == SOURCE_FILE)
+		return;
 
-	switch(source_type)
+	/* Requantize to AGC_BITS and count overflows in one pass */
+	for(lcv = 0; lcv < antennas; lcv++)
 	{
-		case SOURCE_USRP_V1:
-			
-			/* Count the overflows and shift if needed */
-			soverflw += run_agc(&_p->data[0][0], SAMPS_MS, AGC_BITS, 6);
-			
-			/* Figure out the agc_scale value */
-			if((ms_count & 0xFF) == 0)
-			{
-				gain = dbs_rx_a->rf_gain();
-
-				if(soverflw > OVERFLOW_HIGH)
-					gain -= 0.5;
+		sse_agc((int16 *)&_p->data[lcv][0], 2*SAMPS_MS, agc_shift[lcv], AGC_BITS, stats);
+		soverflw[lcv] += stats[0];
+		shigh[lcv] += stats[1];
+	}
 
-				if(soverflw < OVERFLOW_LOW)
-					gain += 0.5;
+	if((ms_count & (AGC_PERIOD-1)) != (AGC_PERIOD-1))
+		return;
 
-				dbs_rx_a->rf_gain(gain);
+	/* Step the shift, the hysteresis comes from comparing the upper half count against OVERFLOW_LOW,
+	 * it becomes the overflow count after a step down */
+	for(lcv = 0; lcv < antennas; lcv++)
+	{
+		if((soverflw[lcv] > OVERFLOW_HIGH) && (agc_shift[lcv] < 15))
+			agc_shift[lcv]++;
+		else if((shigh[lcv] < OVERFLOW_LOW) && (agc_shift[lcv] > 0))
+			agc_shift[lcv]--;
 
-				agc_scale = (int32)floor(2.0*(dbs_rx_a->max_rf_gain() - gain));
+		overflw[lcv] = soverflw[lcv];
+		soverflw[lcv] = shigh[lcv] = 0;
+	}
 
-				overflw = soverflw;
-				soverflw = 0;
-			}
-			
+	/* Slowly steer the DBS-RX gain so the shift sits at AGC_SHIFT */
+	if(source_type == SOURCE_USRP_V1)
+	{
+		dbs_rx[0] = dbs_rx_a;
+		dbs_rx[1] = dbs_rx_b;
 
+		for(lcv = 0; lcv < antennas; lcv++)
+		{
+			if(dbs_rx[lcv] == NULL)
+				continue;
 
+			gain = dbs_rx[lcv]->rf_gain();
 
-			break;
-		case SOURCE_USRP_V2:
+			if(agc_shift[lcv] > AGC_SHIFT)
+				gain -= 0.5;
 
-//			Read_SOURCE_USRP_V2(_p);
-			break;
+			if(agc_shift[lcv] < AGC_SHIFT)
+				gain += 0.5;
 
-		case SOURCE_SIGE_GN3S:
+			dbs_rx[lcv]->rf_gain(gain);
 
-			break;
-		case SOURCE_FILE:
-			break;
-		default:
-			break;
+			agc_scale[lcv] = (int32)floor(2.0*(dbs_rx[lcv]->max_rf_gain() - gain));
+		}
 	}
 
-
-	ms_count++;
-
 }
 /*----------------------------------------------------------------------------------------------*/
 
@@ -238,6 +233,7 @@ void GPS_Source::Open_USRP_V1()
 
 	double ddc_correct_a = 0;
 	double ddc_correct_b = 0;
+	int32 samps_ms;
 
 	leftover = 0;
 
@@ -269,6 +265,11 @@ void GPS_Source::Open_USRP_V1()
 		}
 	}
 
+	/* Filter & resample from 4.0 or 4.096 Msps down to 2.048 Msps, one resampler per board */
+	samps_ms = (int32)floor(opt.f_sample/opt.decimate/1e3);
+	rs_a = new Resampler(SAMPS_MS, samps_ms, 14, samps_ms);
+	rs_b = new Resampler(SAMPS_MS, samps_ms, 14, samps_ms);
+
 	/* Make the URX */
 //Art!!! urx = usrp_standard_rx::make(0, opt.decimate, 1, -1, 0, 0, 0);
 	urx = NULL;
@@ -422,19 +423,12 @@ void GPS_Source::Open_GN3S()
 {
 	unsigned char bbbb[4];
 
-	int32 lcv;
-	const double mul = 8.1838e6/2.048e6;
-	//const double mul = 16e6/2.048e6;
 
 	/* Create the object */
 	gn3s_a = new gn3s(0);
 
-	/* Create decimation lookup table */
-	for(lcv = 0; lcv < 10240; lcv++)
-	{
-		//gdec[lcv] = (int32)floor((double)lcv * mul);
-		gdec[lcv] = (int32)floor((lcv+1)*4000/2048);
-	}
+	/* Filter & resample 5 ms of 4 Msps data to 2.048 Msps */
+	rs_a = new Resampler(SAMPS_MS, 4000, 14, 20000);
 
 
 	//fprintf(stdout, "Writing command words! /n");
@@ -471,7 +465,20 @@ void GPS_Source::Open_GN3S()
 /*----------------------------------------------------------------------------------------------*/
 void GPS_Source::Open_GPS_File()
 {
-	
+
+	ifz = NULL;
+
+	/* Compressed recordings carry both antennas in one file */
+	if(IF_Reader::Detect(opt.file_name_1))
+	{
+		ifz = new IF_Reader(opt.file_name_1);
+		if(!ifz->Seek(opt.start_minute*60000))
+		{
+			fprintf(stdout,"%s is shorter than %d minutes\n", opt.file_name_1, opt.start_minute);
+			ifz->Seek(0);
+		}
+		return;
+	}
 
 	fp_a = fopen(opt.file_name_1,"rb");	
 	rewind(fp_a);
@@ -513,6 +520,9 @@ void GPS_Source::Close_USRP_V1()
 	if(urx != NULL)
 		delete urx;
 
+	delete rs_a;
+	delete rs_b;
+
 	if(opt.verbose)
 		fprintf(stdout,"Destructing USRP\n");
 
@@ -527,6 +537,8 @@ void GPS_Source::Close_GN3S()
 	if(gn3s_a != NULL)
 		delete gn3s_a;
 
+	delete rs_a;
+
 	if(opt.verbose)
 		fprintf(stdout,"Destructing GN3S\n");
 
@@ -537,6 +549,12 @@ void GPS_Source::Close_GN3S()
 /*----------------------------------------------------------------------------------------------*/
 void GPS_Source::Close_GPS_File()
 {
+	if(ifz != NULL)
+	{
+		delete ifz;
+		return;
+	}
+
 	fclose(fp_a);	
 	if( opt.mode == 1 )
 	{
@@ -688,10 +706,6 @@ void GPS_Source::Read_GN3S(ms_packet *_p)
 	bool overrun;
 	int32 ms_mod5;
 	int32 lcv;
-	//int16 LUT[4] = {1, -1, 1, -1};
-	int16 LUT[4] = {-3, -1, 1, 3};
-	int16 *pbuff;
-	CPX mine_iq;
 
 	ms_mod5 = ms_count % 5;
 
@@ -729,15 +743,11 @@ void GPS_Source::Read_GN3S(ms_packet *_p)
 		/*for(lcv = 0; lcv < 40919*2; lcv++)
 			pbuff[lcv] = LUT[gbuff[lcv] & 0x3];*/
 
-		for(lcv = 0; lcv < 20000; lcv++){
-			short_phase = phase >> 22;
-//			mine_iq.i = (LUT[gbuff[lcv] & 0x03] * sin_table[short_phase]);
-//			mine_iq.q = (LUT[gbuff[lcv] & 0x03] * cos_table[short_phase]);
-			mine_iq.q = (LUT[gbuff[lcv] & 0x03] * sin_table[short_phase]);
-			mine_iq.i = (LUT[gbuff[lcv] & 0x03] * cos_table[short_phase]);
-			buff[lcv] = mine_iq;
-			phase = phase + delta_phase;
-		}
+		/* Mix to baseband with the integer NCO, 2 bit codes map to {-3,-1,1,3} */
+		if(mix_ssse3)
+			sse_mix_2bit(&gbuff[0], &buff[0], 20000, &phase, delta_phase);
+		else
+			x86_mix_2bit(&gbuff[0], &buff[0], 20000, &phase, delta_phase);
 
 		/* Filter & decimate the data to regain bit precision */
 		Resample_GN3S(&buff[0], &buff_out[0]);
@@ -771,11 +781,33 @@ void GPS_Source::Read_GN3S(ms_packet *_p)
 /*----------------------------------------------------------------------------------------------*/
 void GPS_Source::Read_GPS_File(ms_packet *_p)
 {
-	
-	
 
-	
-	fread(file_buff,sizeof(CPX),SAMPS_MS,fp_a);
+	if(ifz != NULL)
+	{
+		if(!ifz->Read(&_p->data[0][0], &_p->data[1][0]))
+		{
+			/* Batch mode stops at the end instead */
+			if(!opt.realtime)
+			{
+				eof = true;
+				return;
+			}
+
+			ifz->Seek(opt.start_minute*60000);
+			ifz->Read(&_p->data[0][0], &_p->data[1][0]);
+			fprintf(stdout,"Rewinding GPS Data File\n");
+		}
+
+		if(opt.realtime)
+			usleep(1000);
+		return;
+	}
+
+	if((fread(file_buff,sizeof(CPX),SAMPS_MS,fp_a) != SAMPS_MS) && !opt.realtime)
+	{
+		eof = true;
+		return;
+	}
 
 	memcpy(&_p->data[0][0], file_buff, SAMPS_MS*sizeof(CPX));
 
@@ -798,7 +830,8 @@ void GPS_Source::Read_GPS_File(ms_packet *_p)
 	}
 
 
-	usleep(1000); // force a nap so we don't bust through this in 2 sec
+	if(opt.realtime)
+		usleep(1000); // force a nap so we don't bust through this in 2 sec
 }
 
 /*----------------------------------------------------------------------------------------------*/
@@ -815,27 +848,18 @@ void GPS_Source::Resample_USRP_V1(CPX *_in, CPX *_out)
 	int32 *p_a;
 	int32 *p_b;
 	int32 *p_in;
-	int32 *p_out, *p_out2;
 	int32 samps_ms;
 	int32 lcv;
 
 	p_a = (int32 *)&buff_a[0];
 	p_b = (int32 *)&buff_b[0];
 	p_in = (int32 *)_in;
-	p_out = (int32 *)_out;
-	p_out2 = (int32 *)&_out[2048];
 	samps_ms = (int32)floor(opt.f_sample/opt.decimate/1e3);
 
 	if(opt.mode == 0)
 	{
-		/* Not much to do, just downsample from either 4.096 or 4.0 to 2.048e6 */
-		if(opt.f_sample != 65.536e6)
-			downsample(_out, _in, 2.048e6, opt.f_sample/opt.decimate, samps_ms);
-		else
-		{
-			for(lcv = 0; lcv < samps_ms; lcv += 2)
-				*p_out++ = p_in[lcv];
-		}
+		/* Not much to do, just filter & resample from either 4.096 or 4.0 to 2.048e6 */
+		rs_a->Run(_in, _out, samps_ms);
 	}
 	else //!< 2 boards are being used, must first de-interleave data before downsampling
 	{
@@ -848,11 +872,9 @@ void GPS_Source::Resample_USRP_V1(CPX *_in, CPX *_out)
 			
 		}
 		
-		/* Downsample (and copy!) into appropriate location */
-		
-		
-		downsample(&_out[0],    buff_a, 2.048e6, opt.f_sample/opt.decimate, samps_ms);
-		downsample(&_out[2048], buff_b, 2.048e6, opt.f_sample/opt.decimate, samps_ms);
+		/* Resample (and copy!) into appropriate location */
+		rs_a->Run(buff_a, &_out[0], samps_ms);
+		rs_b->Run(buff_b, &_out[2048], samps_ms);
 		
 	
 	}
@@ -932,13 +954,7 @@ void GPS_Source::Resample_USRP_V1(CPX *_in, CPX *_out)
 
 void GPS_Source::Resample_GN3S(CPX *_in, CPX *_out)
 {
-	int i;
-    /* Process the array */
-	for(i = 0; i < 10240; i++)
-	{
-		_out[i] = _in[gdec[i]];
-	}
-
-	return;
+	/* Polyphase filter 20000 samples @ 4 Msps into 10240 samples @ 2.048 Msps */
+	rs_a->Run(_in, _out, 20000);
 }
 /*----------------------------------------------------------------------------------------------*/
@@ -31,6 +31,9 @@
 #include "includes.h"
 #include "db_dbs_rx.h"
 #include "gn3s.h"
+#include "resampler.h"
+#include "recorder.h"
+#include "if_file.h"
 
 enum GPS_SOURCE_TYPE
 {
@@ -63,13 +66,13 @@ class GPS_Source
 		time_t rawtime;
 		struct tm * timeinfo;
 
-		/* AGC Values */
-		int32 agc_scale;		//!< To do the AGC
-		int32 overflw;			//!< Overflow counter
-		int32 soverflw;			//!< Overflow counter
-		int32 soverflw2;			//!< Overflow counter
-		int32 agc_scale2;
-		int32 overflw2;			//!< Overflow counter
+		/* AGC Values, per antenna */
+		int32 antennas;						//!< Antennas to run the AGC on
+		int32 agc_shift[MAX_ANTENNAS];		//!< Requantizer shift
+		int32 agc_scale[MAX_ANTENNAS];		//!< DBS-RX attenuation in 0.5 dB steps
+		int32 overflw[MAX_ANTENNAS];		//!< Overflows in the last AGC period
+		int32 soverflw[MAX_ANTENNAS];		//!< Overflows in this AGC period
+		int32 shigh[MAX_ANTENNAS];			//!< Samples in the upper half of the range this AGC period
 
 
 
@@ -81,14 +84,12 @@ class GPS_Source
 		CPX *buff_out_p; 		//!< Pointer to a spot in buff_out
 		CPX dbuff[16384]; 		//!< Buffer for double buffering
 		MIX gn3s_mix[10240];	//!< Mix GN3S to the same IF frequency
-		int32 gdec[10240];		//!< Index array to filter & resample GN3S data to 2.048 Msps
 		CPX file_buff[SAMPS_MS]; 	//!< Base 1ms buffer for a file	
 
-		double sin_table[1024];
-		double cos_table[1024];
-		unsigned int delta_phase;
-		unsigned int short_phase;
-		unsigned int phase;
+		/* GN3S mixer */
+		uint32 phase;			//!< Integer NCO phase, 2^32 == 1 cycle
+		uint32 delta_phase;		//!< NCO phase increment per sample
+		int32 mix_ssse3;		//!< Use the SSSE3 mixer
 
 
 		/* USRP V1 Handles */
@@ -102,14 +103,16 @@ class GPS_Source
 		gn3s *gn3s_a;
 		gn3s *gn3s_b;
 
+		/* Filter & resample to 2.048 Msps */
+		Resampler *rs_a;		//!< Resampler for board A (or the GN3S)
+		Resampler *rs_b;		//!< Resampler for board B
+
 		/* File handles */
 		FILE *fp_a;		//!<file for input 1
 		FILE *fp_b;		//!<file for input 2
-		FILE *out_file_a;	//!< output file 1
-		FILE *out_file_b;	//!<output file 2
-	
+		IF_Reader *ifz;	//!< Compressed file, replaces fp_a/fp_b
+		int32 eof;		//!< Ran off the end of the file (batch mode only, realtime rewinds)
 
-		bool record_on;
 		int32 started;
 		
 
@@ -130,14 +133,17 @@ class GPS_Source
 		void Read_GPS_File(ms_packet *_p);	//!< Read from a file
 		void Resample_USRP_V1(CPX *_in, CPX *_out);
 		void Resample_GN3S(CPX *_in, CPX *_out);
+		void Run_AGC(ms_packet *_p);	//!< Requantize each antenna and update the gains
 
 	public:
 
 		GPS_Source(Options_S *_opt);	//!< Create the GPS source with the proper hardware type
 		~GPS_Source();					//!< Kill the object
 		void Read(ms_packet *_p);		//!< Read in a single ms of data
-		int32 getScale(){return(agc_scale);}
-		int32 getOvrflw(){return(overflw);}
+		int32 getScale(int32 _ant){return(agc_scale[_ant]);}
+		int32 getShift(int32 _ant){return(agc_shift[_ant]);}
+		int32 getOvrflw(int32 _ant){return(overflw[_ant]);}
+		int32 getEOF(){return(eof);}	//!< No more data from the file
 
 };
 
@@ -0,0 +1,122 @@
+/*----------------------------------------------------------------------------------------------*/
+/*! \file histogram.cpp
+//
+// FILENAME: histogram.cpp
+//
+// DESCRIPTION: Implements member functions of the Histogram class.
+//
+// DEVELOPERS: Gregory W. Heckler (2003-2009)
+//
+// LICENSE TERMS: Copyright (c) Gregory W. Heckler 2009
+//
+// This file is part of the GPS Software Defined Radio (GPS-SDR)
+//
+// The GPS-SDR is free software; you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation; either version 2 of
+// the License, or (at your option) any later version. The GPS-SDR is distributed in the hope that
+// it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// Note:  Comments within this file follow a syntax that is compatible with
+//        DOXYGEN and are utilized for automated document extraction
+//
+// Reference:
+*/
+/*----------------------------------------------------------------------------------------------*/
+
+#include "includes.h"
+
+uint32 tsc_mult = 0;
+double tsc_2_tic = 0;
+uint64 tsc_origin = 0;
+__thread uint64 queue_stamp = 0;
+
+/*----------------------------------------------------------------------------------------------*/
+void TSC_Calibrate()
+{
+	struct timespec t0, t1;
+	uint64 c0, c1;
+	double ns;
+
+	clock_gettime(CLOCK_MONOTONIC_RAW, &t0);
+	c0 = tsc_now();
+	usleep(20000);
+	clock_gettime(CLOCK_MONOTONIC_RAW, &t1);
+	c1 = tsc_now();
+
+	ns = 1e9*(t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec);
+	tsc_mult = (uint32)(65536.0*ns/(double)(c1 - c0) + 0.5);
+	tsc_2_tic = ns/(1e7*(double)(c1 - c0));
+	tsc_origin = c1;
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+Histogram::Histogram()
+{
+	if(tsc_mult == 0)
+		TSC_Calibrate();
+
+	Clear();
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void Histogram::Clear()
+{
+	memset(count, 0x0, sizeof(count));
+	samples = 0;
+	max = 0;
+	sum = 0;
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+uint32 Histogram::getPercentile(double _p)
+{
+	uint32 target, total, g, m, low, width;
+	int32 lcv;
+
+	if(samples == 0)
+		return(0);
+
+	target = (uint32)ceil(_p*samples);
+	if(target < 1)
+		target = 1;
+
+	total = 0;
+	for(lcv = 0; lcv < HIST_BUCKETS; lcv++)
+	{
+		total += count[lcv];
+		if(total >= target)
+			break;
+	}
+
+	if(lcv < HIST_SUB)
+		return(lcv);
+
+	if(lcv == HIST_BUCKETS)
+		return(max);
+
+	/* Middle of the bucket, never past the largest sample */
+	g = lcv >> HIST_SUB_BITS;
+	m = lcv & (HIST_SUB - 1);
+	low = (HIST_SUB + m) << (g - 1);
+	width = 1 << (g - 1);
+
+	return(low + width/2 < max ? low + width/2 : max);
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void Histogram::Print(FILE *_fp, const char *_name)
+{
+	fprintf(_fp,"%-14s %10u %10.1f %10.1f %10.1f %10.1f %10.1f\n", _name, samples, getMean()/1e3,
+		getPercentile(0.5)/1e3, getPercentile(0.99)/1e3, getPercentile(0.999)/1e3, max/1e3);
+}
+/*----------------------------------------------------------------------------------------------*/
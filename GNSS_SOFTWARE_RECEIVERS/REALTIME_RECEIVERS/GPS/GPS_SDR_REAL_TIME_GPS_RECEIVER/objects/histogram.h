@@ -0,0 +1,122 @@
+/*----------------------------------------------------------------------------------------------*/
+/*! \file histogram.h
+//
+// FILENAME: histogram.h
+//
+// DESCRIPTION: Defines the Histogram class and the TSC clock used to time the tasks.
+//
+// DEVELOPERS: Gregory W. Heckler (2003-2009)
+//
+// LICENSE TERMS: Copyright (c) Gregory W. Heckler 2009
+//
+// This file is part of the GPS Software Defined Radio (GPS-SDR)
+//
+// The GPS-SDR is free software; you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation; either version 2 of
+// the License, or (at your option) any later version. The GPS-SDR is distributed in the hope that
+// it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// Note:  Comments within this file follow a syntax that is compatible with
+//        DOXYGEN and are utilized for automated document extraction
+//
+// Reference:
+*/
+/*----------------------------------------------------------------------------------------------*/
+
+#ifndef HISTOGRAM_H_
+#define HISTOGRAM_H_
+
+/* Pulled in by includes.h ahead of queue.h and globals.h, so only lean on defines.h */
+#include <stdio.h>
+
+#define HIST_SUB_BITS	(4)											//!< 16 linear buckets per power of 2, <= 6.25% error
+#define HIST_SUB		(1 << HIST_SUB_BITS)
+#define HIST_BUCKETS	((32 - HIST_SUB_BITS + 1) * HIST_SUB)		//!< Covers 1 ns to 4.29 s
+
+extern uint32 tsc_mult;				//!< ns per TSC tick, 16.16 fixed point
+extern double tsc_2_tic;			//!< 10 ms receiver tics per TSC tick
+extern uint64 tsc_origin;			//!< TSC at calibration, tic 0
+extern __thread uint64 queue_stamp;	//!< TSC when the last message this thread blocked on was sent
+
+void TSC_Calibrate();				//!< Measure the TSC rate against CLOCK_MONOTONIC_RAW
+
+/*! Read the time stamp counter */
+static inline uint64 tsc_now()
+{
+	uint32 lo, hi;
+
+	__asm volatile ("rdtsc" : "=a" (lo), "=d" (hi));
+
+	return(((uint64)hi << 32) | lo);
+}
+
+/*! Convert a TSC interval to ns, saturating at 4.29 s */
+static inline uint32 tsc_ns(uint64 _ticks)
+{
+	uint64 ns;
+
+	if(_ticks >> 40)
+		return(0xFFFFFFFF);
+
+	ns = (_ticks * tsc_mult) >> 16;
+
+	return(ns > 0xFFFFFFFF ? 0xFFFFFFFF : (uint32)ns);
+}
+
+/*! Convert a TSC value to the 10 ms tic counted from startup */
+static inline uint32 tsc_tic(uint64 _tsc)
+{
+	return((uint32)((double)(int64)(_tsc - tsc_origin) * tsc_2_tic));
+}
+
+/*! \ingroup CLASSES
+ *	@brief Log-linear histogram of ns intervals. Each power of 2 is split into HIST_SUB linear
+ *	buckets, so any percentile is good to a few percent over the whole range. Only the owning
+ *	thread calls Add(), readers may see a sample or two in flight but never need a lock.
+ */
+class Histogram
+{
+
+	private:
+
+		uint32 count[HIST_BUCKETS];	//!< Samples per bucket
+		uint32 samples;				//!< Total samples
+		uint32 max;					//!< Largest sample (ns)
+		uint64 sum;					//!< For the mean (ns)
+
+	public:
+
+		Histogram();					//!< Empty histogram, calibrate the TSC if needed
+		void Clear();					//!< Throw away all samples
+		uint32 getPercentile(double _p);//!< Value (ns) below which a fraction _p of the samples lie
+		uint32 getMax(){return(max);}
+		uint32 getSamples(){return(samples);}
+		double getMean(){return(samples ? (double)sum/samples : 0);}
+		void Print(FILE *_fp, const char *_name);	//!< One line of samples/mean/p50/p99/p99.9/max
+
+		/*! Record an interval given in TSC ticks */
+		void Add(uint64 _ticks)
+		{
+			uint32 ns, e, b;
+
+			ns = tsc_ns(_ticks);
+
+			if(ns < HIST_SUB)
+				b = ns;
+			else
+			{
+				e = 31 - __builtin_clz(ns);
+				b = ((e - HIST_SUB_BITS + 1) << HIST_SUB_BITS) + ((ns >> (e - HIST_SUB_BITS)) & (HIST_SUB - 1));
+			}
+
+			count[b]++;
+			samples++;
+			sum += ns;
+			if(ns > max)
+				max = ns;
+		}
+};
+
+#endif /* HISTOGRAM_H_ */
@@ -0,0 +1,494 @@
+/*----------------------------------------------------------------------------------------------*/
+/*! \file if_file.cpp
+//
+// FILENAME: if_file.cpp
+//
+// DESCRIPTION: Implements the .ifz codec and the IF_Writer/IF_Reader classes.
+//
+// DEVELOPERS: Gregory W. Heckler (2003-2009)
+//
+// LICENSE TERMS: Copyright (c) Gregory W. Heckler 2009
+//
+// This file is part of the GPS Software Defined Radio (GPS-SDR)
+//
+// The GPS-SDR is free software; you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation; either version 2 of
+// the License, or (at your option) any later version. The GPS-SDR is distributed in the hope that
+// it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// Note:  Comments within this file follow a syntax that is compatible with
+//        DOXYGEN and are utilized for automated document extraction
+//
+// Reference:
+*/
+/*----------------------------------------------------------------------------------------------*/
+
+#define _FILE_OFFSET_BITS 64	//!< Recordings are far bigger than 2 GB, even compressed
+
+#include "if_file.h"
+
+/*----------------------------------------------------------------------------------------------*/
+/*! Rice code _cnt values, _cnt must be a multiple of IFZ_BLOCK */
+int32 ifz_encode(int16 *_in, int32 _cnt, uint8 *_out)
+{
+	uint32 z[IFZ_BLOCK];
+	uint64 acc;
+	uint32 sum, q, best, cost;
+	int32 lcv, blk, k, kk, nbits;
+	uint8 *p;
+
+	p = _out;
+	acc = 0;
+	nbits = 0;
+
+	for(blk = 0; blk < _cnt; blk += IFZ_BLOCK)
+	{
+		/* Zigzag so small magnitudes of either sign get short codes */
+		sum = 0;
+		for(lcv = 0; lcv < IFZ_BLOCK; lcv++)
+		{
+			z[lcv] = (uint16)((_in[blk+lcv] << 1) ^ (_in[blk+lcv] >> 15));
+			sum += z[lcv];
+		}
+
+		/* The mean gives k to within one, price the neighbours exactly */
+		kk = 0;
+		while((kk < 15) && ((uint32)(IFZ_BLOCK << (kk+1)) <= sum))
+			kk++;
+
+		best = 0xFFFFFFFF;
+		k = kk;
+		for(q = (kk > 0 ? kk-1 : 0); q <= (uint32)(kk < 15 ? kk+1 : 15); q++)
+		{
+			cost = IFZ_BLOCK*(q+1);
+			for(lcv = 0; lcv < IFZ_BLOCK; lcv++)
+				cost += z[lcv] >> q;
+
+			if(cost < best)
+			{
+				best = cost;
+				k = q;
+			}
+		}
+
+		acc = (acc << 4) | k;
+		nbits += 4;
+
+		for(lcv = 0; lcv < IFZ_BLOCK; lcv++)
+		{
+			q = z[lcv] >> k;
+			if(q < IFZ_ESCAPE)
+			{
+				/* q ones, a zero, then the low k bits */
+				acc = (acc << (q+1)) | (((1 << q) - 1) << 1);
+				acc = (acc << k) | (z[lcv] & ((1 << k) - 1));
+				nbits += q + 1 + k;
+			}
+			else
+			{
+				acc = (acc << IFZ_ESCAPE) | ((1 << IFZ_ESCAPE) - 1);
+				acc = (acc << 16) | z[lcv];
+				nbits += IFZ_ESCAPE + 16;
+			}
+
+			while(nbits >= 8)
+			{
+				nbits -= 8;
+				*p++ = (uint8)(acc >> nbits);
+			}
+		}
+	}
+
+	/* Byte align */
+	if(nbits)
+		*p++ = (uint8)(acc << (8 - nbits));
+
+	return(p - _out);
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+/*! Undo ifz_encode, _in must have 8 readable bytes past the end of the frame */
+int32 ifz_decode(uint8 *_in, int16 *_out, int32 _cnt)
+{
+	uint64 acc;
+	uint32 z, q;
+	int32 lcv, blk, k, nbits;
+	uint8 *p;
+
+	p = _in;
+	acc = 0;
+	nbits = 0;
+
+	for(blk = 0; blk < _cnt; blk += IFZ_BLOCK)
+	{
+		/* Keep acc MSB aligned with at least 57 valid bits, enough for one escape */
+		while(nbits <= 56)
+		{
+			acc |= (uint64)(*p++) << (56 - nbits);
+			nbits += 8;
+		}
+
+		k = (int32)(acc >> 60);
+		acc <<= 4;
+		nbits -= 4;
+
+		for(lcv = 0; lcv < IFZ_BLOCK; lcv++)
+		{
+			while(nbits <= 56)
+			{
+				acc |= (uint64)(*p++) << (56 - nbits);
+				nbits += 8;
+			}
+
+			q = (~acc) ? __builtin_clzll(~acc) : 64;
+			if(q < IFZ_ESCAPE)
+			{
+				acc <<= q + 1;
+				z = (q << k);
+				if(k)
+					z |= (uint32)(acc >> (64 - k));
+				acc <<= k;
+				nbits -= q + 1 + k;
+			}
+			else
+			{
+				acc <<= IFZ_ESCAPE;
+				z = (uint32)(acc >> 48);
+				acc <<= 16;
+				nbits -= IFZ_ESCAPE + 16;
+			}
+
+			_out[blk+lcv] = (int16)((z >> 1) ^ -(z & 1));
+		}
+	}
+
+	/* Whole bytes consumed, the look ahead goes back */
+	return((p - _in) - nbits/8);
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+IF_Writer::IF_Writer(const char *_fname, int32 _antennas)
+{
+	IFZ_Header hdr;
+
+	antennas = _antennas;
+	if(antennas > MAX_ANTENNAS)
+		antennas = MAX_ANTENNAS;
+
+	ms = chunk_ms = chunk_bytes = chunks = 0;
+	chunk_start = 0;
+	raw_bytes = out_bytes = 0;
+	index_size = 1024;
+	index = (int64 *)malloc(index_size*sizeof(int64));
+	frame = (uint8 *)malloc(IFZ_FRAME_MAX);
+
+	fp = fopen(_fname, "wb");
+	if(fp == NULL)
+		return;
+
+	setvbuf(fp, NULL, _IOFBF, 1 << 20);
+
+	hdr.magic = IFZ_MAGIC;
+	hdr.antennas = antennas;
+	hdr.samps_ms = SAMPS_MS;
+	hdr.chunk_ms = IFZ_CHUNK_MS;
+	fwrite(&hdr, sizeof(IFZ_Header), 1, fp);
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+IF_Writer::~IF_Writer()
+{
+	IFZ_Trailer trailer;
+
+	if(fp != NULL)
+	{
+		if(chunk_ms)
+			CloseChunk();
+
+		trailer.magic = IFZ_INDEX;
+		trailer.chunks = chunks;
+		trailer.index = ftello(fp);
+		fwrite(index, sizeof(int64), chunks, fp);
+		fwrite(&trailer, sizeof(IFZ_Trailer), 1, fp);
+		fclose(fp);
+	}
+
+	free(index);
+	free(frame);
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void IF_Writer::Write(CPX *_a, CPX *_b)
+{
+	IFZ_Chunk chdr;
+	CPX *in[MAX_ANTENNAS];
+	int32 lcv, bytes;
+
+	if(fp == NULL)
+		return;
+
+	/* Placeholder header, patched in CloseChunk */
+	if(chunk_ms == 0)
+	{
+		chunk_start = ftello(fp);
+		memset(&chdr, 0x0, sizeof(IFZ_Chunk));
+		fwrite(&chdr, sizeof(IFZ_Chunk), 1, fp);
+	}
+
+	in[0] = _a;
+	in[1] = _b;
+
+	bytes = 0;
+	for(lcv = 0; lcv < antennas; lcv++)
+		bytes += ifz_encode((int16 *)in[lcv], 2*SAMPS_MS, &frame[bytes]);
+
+	fwrite(frame, 1, bytes, fp);
+
+	chunk_bytes += bytes;
+	raw_bytes += antennas*SAMPS_MS*sizeof(CPX);
+	out_bytes += bytes;
+	chunk_ms++;
+	ms++;
+
+	if(chunk_ms == IFZ_CHUNK_MS)
+		CloseChunk();
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void IF_Writer::CloseChunk()
+{
+	IFZ_Chunk chdr;
+	int64 end;
+
+	chdr.magic = IFZ_CHUNK;
+	chdr.first_ms = ms - chunk_ms;
+	chdr.ms = chunk_ms;
+	chdr.bytes = chunk_bytes;
+
+	end = ftello(fp);
+	fseeko(fp, chunk_start, SEEK_SET);
+	fwrite(&chdr, sizeof(IFZ_Chunk), 1, fp);
+	fseeko(fp, end, SEEK_SET);
+
+	if(chunks == index_size)
+	{
+		index_size *= 2;
+		index = (int64 *)realloc(index, index_size*sizeof(int64));
+	}
+	index[chunks++] = chunk_start;
+
+	chunk_ms = 0;
+	chunk_bytes = 0;
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+int32 IF_Reader::Detect(const char *_fname)
+{
+	FILE *fp;
+	uint32 magic;
+	int32 found;
+
+	found = 0;
+	fp = fopen(_fname, "rb");
+	if(fp != NULL)
+	{
+		if(fread(&magic, sizeof(uint32), 1, fp) == 1)
+			found = (magic == IFZ_MAGIC);
+		fclose(fp);
+	}
+
+	return(found);
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+IF_Reader::IF_Reader(const char *_fname)
+{
+	IFZ_Trailer trailer;
+
+	index = NULL;
+	buff = NULL;
+	buff_size = 0;
+	chunks = 0;
+	chunk = -1;
+	chunk_ms = ms = 0;
+	pos = NULL;
+
+	fp = fopen(_fname, "rb");
+	if(fp == NULL)
+		return;
+
+	if((fread(&hdr, sizeof(IFZ_Header), 1, fp) != 1) || (hdr.magic != IFZ_MAGIC) ||
+		(hdr.samps_ms != SAMPS_MS) || (hdr.antennas < 1) || (hdr.antennas > MAX_ANTENNAS))
+	{
+		fclose(fp);
+		fp = NULL;
+		return;
+	}
+
+	/* Use the index if the file was closed cleanly */
+	fseeko(fp, -(int64)sizeof(IFZ_Trailer), SEEK_END);
+	if((fread(&trailer, sizeof(IFZ_Trailer), 1, fp) == 1) && (trailer.magic == IFZ_INDEX))
+	{
+		chunks = trailer.chunks;
+		index = (int64 *)malloc((chunks+1)*sizeof(int64));
+		fseeko(fp, trailer.index, SEEK_SET);
+		if(fread(index, sizeof(int64), chunks, fp) != (size_t)chunks)
+			Scan();
+	}
+	else
+		Scan();
+
+	Seek(0);
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+IF_Reader::~IF_Reader()
+{
+	if(fp != NULL)
+		fclose(fp);
+
+	free(index);
+	free(buff);
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void IF_Reader::Scan()
+{
+	IFZ_Chunk chdr;
+	int64 offset;
+	int32 size;
+
+	free(index);
+	size = 1024;
+	index = (int64 *)malloc(size*sizeof(int64));
+	chunks = 0;
+
+	offset = sizeof(IFZ_Header);
+	fseeko(fp, offset, SEEK_SET);
+
+	/* An unpatched header means the recorder died inside that chunk */
+	while((fread(&chdr, sizeof(IFZ_Chunk), 1, fp) == 1) && (chdr.magic == IFZ_CHUNK))
+	{
+		if(chunks == size)
+		{
+			size *= 2;
+			index = (int64 *)realloc(index, size*sizeof(int64));
+		}
+		index[chunks++] = offset;
+		offset += sizeof(IFZ_Chunk) + chdr.bytes;
+		fseeko(fp, offset, SEEK_SET);
+	}
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+int32 IF_Reader::Load(int32 _chunk)
+{
+	IFZ_Chunk chdr;
+
+	if((_chunk < 0) || (_chunk >= chunks))
+		return(0);
+
+	fseeko(fp, index[_chunk], SEEK_SET);
+	if((fread(&chdr, sizeof(IFZ_Chunk), 1, fp) != 1) || (chdr.magic != IFZ_CHUNK))
+		return(0);
+
+	if(chdr.bytes + 8 > buff_size)
+	{
+		buff_size = chdr.bytes + 8;
+		buff = (uint8 *)realloc(buff, buff_size);
+	}
+
+	if(fread(buff, 1, chdr.bytes, fp) != (size_t)chdr.bytes)
+		return(0);
+
+	/* Slack for the bit reader's look ahead */
+	memset(&buff[chdr.bytes], 0x0, 8);
+
+	chunk = _chunk;
+	chunk_ms = chdr.ms;
+	ms = 0;
+	pos = buff;
+
+	return(1);
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+int32 IF_Reader::Seek(int32 _ms)
+{
+	int16 scratch[2*SAMPS_MS];
+	int32 lcv, skip;
+
+	if(fp == NULL)
+		return(0);
+
+	if(!Load(_ms / hdr.chunk_ms))
+		return(0);
+
+	/* Frames are variable length, decode up to the one we want */
+	skip = _ms % hdr.chunk_ms;
+	if(skip >= chunk_ms)
+		return(0);
+
+	for(; skip > 0; skip--)
+	{
+		for(lcv = 0; lcv < hdr.antennas; lcv++)
+			pos += ifz_decode(pos, scratch, 2*SAMPS_MS);
+		ms++;
+	}
+
+	return(1);
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+int32 IF_Reader::Read(CPX *_a, CPX *_b)
+{
+	if(fp == NULL)
+		return(0);
+
+	if(ms == chunk_ms)
+		if(!Load(chunk+1))
+			return(0);
+
+	pos += ifz_decode(pos, (int16 *)_a, 2*SAMPS_MS);
+	if(hdr.antennas > 1)
+	{
+		if(_b != NULL)
+			pos += ifz_decode(pos, (int16 *)_b, 2*SAMPS_MS);
+		else
+		{
+			int16 scratch[2*SAMPS_MS];
+			pos += ifz_decode(pos, scratch, 2*SAMPS_MS);
+		}
+	}
+
+	ms++;
+
+	return(1);
+}
+/*----------------------------------------------------------------------------------------------*/
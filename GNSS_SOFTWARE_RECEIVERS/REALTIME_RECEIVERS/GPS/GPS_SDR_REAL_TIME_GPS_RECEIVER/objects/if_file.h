@@ -0,0 +1,152 @@
+/*----------------------------------------------------------------------------------------------*/
+/*! \file if_file.h
+//
+// FILENAME: if_file.h
+//
+// DESCRIPTION: Defines the compressed IF recording format and its reader/writer classes.
+//
+// DEVELOPERS: Gregory W. Heckler (2003-2009)
+//
+// LICENSE TERMS: Copyright (c) Gregory W. Heckler 2009
+//
+// This file is part of the GPS Software Defined Radio (GPS-SDR)
+//
+// The GPS-SDR is free software; you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation; either version 2 of
+// the License, or (at your option) any later version. The GPS-SDR is distributed in the hope that
+// it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// Note:  Comments within this file follow a syntax that is compatible with
+//        DOXYGEN and are utilized for automated document extraction
+//
+// Reference:
+*/
+/*----------------------------------------------------------------------------------------------*/
+
+#ifndef IF_FILE_H_
+#define IF_FILE_H_
+
+#include "includes.h"
+
+/*! @file
+ *	The .ifz format stores 1 ms frames of CPX samples losslessly. Each frame holds, per antenna,
+ *	the interleaved I/Q values in blocks of IFZ_BLOCK, each block a 4 bit Rice parameter followed
+ *	by the Rice coded zigzag of every value. Frames are byte aligned and grouped into chunks of
+ *	IFZ_CHUNK_MS. An index of chunk offsets at the end of the file allows seeking to any second;
+ *	if the index is missing (the recorder died) the chunk headers are walked instead.
+ *
+ *	File:	IFZ_Header, IFZ_Chunk + frames, ..., IFZ_Chunk + frames, index[chunks], IFZ_Trailer
+ */
+
+#define IFZ_MAGIC		(0x315A4649)	//!< "IFZ1"
+#define IFZ_CHUNK		(0x435A4649)	//!< "IFZC"
+#define IFZ_INDEX		(0x495A4649)	//!< "IFZI"
+#define IFZ_CHUNK_MS	(1000)			//!< Seek granularity in ms
+#define IFZ_BLOCK		(256)			//!< Values per Rice parameter
+#define IFZ_ESCAPE		(20)			//!< Quotients this big are sent raw
+#define IFZ_FRAME_MAX	(MAX_ANTENNAS*(2*SAMPS_MS*(IFZ_ESCAPE+16)/8 + 2*SAMPS_MS/IFZ_BLOCK) + 16) //!< Worst case frame bytes
+
+/*! \ingroup STRUCTS
+ *	@brief Start of an .ifz file */
+typedef struct IFZ_Header
+{
+	uint32	magic;			//!< IFZ_MAGIC
+	int32	antennas;		//!< Antennas per frame
+	int32	samps_ms;		//!< CPX per antenna per frame
+	int32	chunk_ms;		//!< Frames per chunk
+} IFZ_Header;
+
+/*! \ingroup STRUCTS
+ *	@brief Start of every chunk */
+typedef struct IFZ_Chunk
+{
+	uint32	magic;			//!< IFZ_CHUNK
+	int32	first_ms;		//!< ms index of the first frame
+	int32	ms;				//!< Frames in the chunk
+	int32	bytes;			//!< Bytes of frames that follow
+} IFZ_Chunk;
+
+/*! \ingroup STRUCTS
+ *	@brief End of a cleanly closed file */
+typedef struct IFZ_Trailer
+{
+	uint32	magic;			//!< IFZ_INDEX
+	int32	chunks;			//!< Entries in the index
+	int64	index;			//!< File offset of the index
+} IFZ_Trailer;
+
+
+/*! \ingroup CLASSES
+ *	@brief Compress 1 ms frames to an .ifz file
+ */
+class IF_Writer
+{
+
+	private:
+
+		FILE *fp;				//!< Output file
+		int32 antennas;			//!< Antennas per frame
+		int32 ms;				//!< Frames written
+		int32 chunk_ms;			//!< Frames in the open chunk
+		int32 chunk_bytes;		//!< Bytes in the open chunk
+		int64 chunk_start;		//!< Offset of the open chunk
+		int64 *index;			//!< Chunk offsets
+		int32 index_size;		//!< Allocated entries in index
+		int32 chunks;			//!< Chunks written
+		uint8 *frame;			//!< Encoded frame
+		int64 raw_bytes;		//!< Uncompressed bytes in
+		int64 out_bytes;		//!< Compressed bytes out
+
+		void CloseChunk();		//!< Patch the chunk header
+
+	public:
+
+		IF_Writer(const char *_fname, int32 _antennas);	//!< Create the file
+		~IF_Writer();			//!< Flush the last chunk and write the index
+		int32 isOpen(){return(fp != NULL);}
+		void Write(CPX *_a, CPX *_b);	//!< Compress and write 1 ms (_b ignored with 1 antenna)
+		double getRatio(){return(out_bytes ? (double)raw_bytes/out_bytes : 0);}
+};
+
+
+/*! \ingroup CLASSES
+ *	@brief Decompress 1 ms frames from an .ifz file
+ */
+class IF_Reader
+{
+
+	private:
+
+		FILE *fp;				//!< Input file
+		IFZ_Header hdr;			//!< File header
+		int64 *index;			//!< Chunk offsets
+		int32 chunks;			//!< Chunks in the file
+		int32 chunk;			//!< Chunk that is loaded
+		int32 chunk_ms;			//!< Frames in the loaded chunk
+		int32 ms;				//!< Frame within the loaded chunk
+		uint8 *buff;			//!< Loaded chunk, padded for the bit reader
+		int32 buff_size;		//!< Allocated bytes in buff
+		uint8 *pos;				//!< Next frame in buff
+
+		int32 Load(int32 _chunk);	//!< Read a chunk into buff
+		void Scan();			//!< Rebuild the index from the chunk headers
+
+	public:
+
+		IF_Reader(const char *_fname);	//!< Open the file and load the index
+		~IF_Reader();
+		int32 isOpen(){return(fp != NULL);}
+		int32 getAntennas(){return(hdr.antennas);}
+		int32 getChunks(){return(chunks);}
+		int32 Seek(int32 _ms);			//!< Position at the frame _ms, returns 0 if past the end
+		int32 Read(CPX *_a, CPX *_b);	//!< Decompress 1 ms, returns 0 at the end of the file
+		static int32 Detect(const char *_fname);	//!< Does the file start with IFZ_MAGIC?
+};
+
+/* Frame codec, exposed for the benchmark */
+int32 ifz_encode(int16 *_in, int32 _cnt, uint8 *_out);	//!< Returns bytes written
+int32 ifz_decode(uint8 *_in, int16 *_out, int32 _cnt);	//!< Returns bytes read
+
+#endif /* IF_FILE_H_ */
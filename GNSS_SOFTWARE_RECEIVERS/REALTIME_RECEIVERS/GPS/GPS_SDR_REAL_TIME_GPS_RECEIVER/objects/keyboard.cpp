@@ -34,8 +34,9 @@ void *Keyboard_Thread(void *_arg)
 	Keyboard *aKeyboard = pKeyboard;
 	int32 key;
 
-	while(grun)
+	while(aKeyboard->Running())
 	{
+		/* Stop() interrupts the read with THREAD_WAKE_SIGNAL */
 		key = getchar();
 
 		fprintf(stderr,"%c\n",(char)key);
@@ -0,0 +1,476 @@
+/*----------------------------------------------------------------------------------------------*/
+/*! \file metrics.cpp
+//
+// FILENAME: metrics.cpp
+//
+// DESCRIPTION: Serve the receiver counters as plain text, in the Prometheus text format so the
+//				usual scrapers can read it, or just nc -U the socket
+//
+// DEVELOPERS: Gregory W. Heckler (2003-2009)
+//
+// LICENSE TERMS: Copyright (c) Gregory W. Heckler 2009
+//
+// This file is part of the GPS Software Defined Radio (GPS-SDR)
+//
+// The GPS-SDR is free software; you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation; either version 2 of
+// the License, or (at your option) any later version. The GPS-SDR is distributed in the hope that
+// it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// Note:  Comments within this file follow a syntax that is compatible with
+//        DOXYGEN and are utilized for automated document extraction
+//
+// Reference:
+*/
+/*----------------------------------------------------------------------------------------------*/
+
+#include "metrics.h"
+#include "fifo.h"				//!< Circular buffer for Importing IF data
+#include "correlator.h"			//!< Correlator
+#include "tracking.h"			//!< Runs the channels' loops
+#include "acquisition.h"		//!< Acquisition
+#include "pvt.h"				//!< PVT solution
+#include "ekf.h"				//!< Navigation filter
+#include "ephemeris.h"			//!< Ephemeris decode
+#include "telemetry.h"			//!< Serial/GUI telemetry
+#include "commando.h"			//!< Command interface
+#include "sv_select.h"			//!< Drives acquisition/reacquisition process
+#include "predictor.h"			//!< Constellation prediction for the SV select
+#include "recorder.h"			//!< Record IF data to disk
+#include <stdarg.h>
+
+/*----------------------------------------------------------------------------------------------*/
+void *Metrics_Thread(void *_arg)
+{
+
+	Metrics *aMetrics = pMetrics;
+
+	while(aMetrics->Running())
+	{
+		aMetrics->Import();
+		aMetrics->IncExecTic();
+	}
+
+	pthread_exit(0);
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void Metrics::Start()
+{
+	Start_Thread(Metrics_Thread, NULL);
+
+	if(gopt.verbose)
+		fprintf(stdout,"Metrics thread started\n");
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+Metrics::Metrics():Threaded_Object("METTASK")
+{
+
+	buff = new char[METRICS_BUFF_SIZE];
+	len = 0;
+
+	samples = 0;
+	last_sample = 0;
+
+	/* Open it now so a port that is taken shows up at startup */
+	sock = -1;
+	unix_socket = false;
+	Open();
+
+	if(gopt.verbose)
+		fprintf(stdout,"Creating Metrics\n");
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+Metrics::~Metrics()
+{
+
+	Close();
+
+	delete [] buff;
+
+	if(gopt.verbose)
+		fprintf(stdout,"Destructing Metrics\n");
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+/*! All digits is a TCP port on the loopback interface only, anything else is a unix socket path */
+void Metrics::Open()
+{
+	struct sockaddr_in in;
+	struct sockaddr_un un;
+	struct stat st;
+	const char *p;
+	int32 port, on, ok, len;
+
+	for(p = gopt.metrics; isdigit(*p); p++) ;
+	port = (*p == '\0') ? atoi(gopt.metrics) : 0;
+
+	if(port)
+	{
+		sock = socket(AF_INET, SOCK_STREAM, 0);
+
+		on = 1;
+		setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+		memset(&in, 0x0, sizeof(in));
+		in.sin_family = AF_INET;
+		in.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		in.sin_port = htons(port);
+		ok = (sock >= 0) && (bind(sock, (struct sockaddr *)&in, sizeof(in)) == 0);
+	}
+	else
+	{
+		/* A path bind() would cut short names some other file, refuse it */
+		len = strlen(gopt.metrics);
+		ok = (len < (int32)sizeof(un.sun_path));
+		if(!ok)
+			errno = ENAMETOOLONG;
+
+		/* A socket left behind by a receiver that did not shut down cleanly goes, anything else there stays */
+		if(ok && (lstat(gopt.metrics, &st) == 0))
+		{
+			ok = S_ISSOCK(st.st_mode);
+			if(ok)
+				unlink(gopt.metrics);
+			else
+				errno = EEXIST;
+		}
+
+		if(ok)
+		{
+			sock = socket(AF_UNIX, SOCK_STREAM, 0);
+
+			memset(&un, 0x0, sizeof(un));
+			un.sun_family = AF_UNIX;
+			memcpy(un.sun_path, gopt.metrics, len + 1);
+			ok = (sock >= 0) && (bind(sock, (struct sockaddr *)&un, sizeof(un)) == 0);
+		}
+		unix_socket = ok;
+	}
+
+	/* poll() says when to accept, a client that gave up in between must not block us */
+	ok = ok && (listen(sock, 4) == 0) && (fcntl(sock, F_SETFL, O_NONBLOCK) == 0);
+
+	if(ok)
+		fprintf(stdout,"Serving metrics on %s%s\n", port ? "127.0.0.1:" : "", gopt.metrics);
+	else
+	{
+		fprintf(stderr,"Could not open the metrics endpoint %s (%s)\n", gopt.metrics, strerror(errno));
+		Close();
+	}
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void Metrics::Close()
+{
+
+	if(sock >= 0)
+		close(sock);
+	sock = -1;
+
+	if(unix_socket)
+		unlink(gopt.metrics);
+	unix_socket = false;
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void Metrics::Import()
+{
+	struct pollfd pfd;
+	uint32 elapsed;
+	int32 fd, timeout;
+
+	elapsed = tsc_ns(tsc_now() - last_sample)/1000000;
+	timeout = (elapsed >= METRICS_SAMPLE_PERIOD) ? 0 : METRICS_SAMPLE_PERIOD - elapsed;
+
+	if(sock < 0)
+	{
+		if(Pause(timeout*1000))
+			Sample();
+		return;
+	}
+
+	/* A stop request interrupts this */
+	pfd.fd = sock;
+	pfd.events = POLLIN;
+	pfd.revents = 0;
+	poll(&pfd, 1, timeout);
+
+	if(!Running())
+		return;
+
+	if(tsc_ns(tsc_now() - last_sample)/1000000 >= METRICS_SAMPLE_PERIOD)
+		Sample();
+
+	if(!(pfd.revents & POLLIN))
+		return;
+
+	fd = accept(sock, NULL, NULL);
+	if(fd < 0)
+		return;
+
+	IncStartTic();
+	Export(fd);
+	IncStopTic();
+
+	close(fd);
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void Metrics::Sample()
+{
+	int32 slot;
+
+	slot = samples % METRICS_RATE_WINDOW;
+
+	last_sample = tsc_now();
+	sample_tsc[slot] = last_sample;
+	sample_acq[slot] = pAcquisition->getExecTic();
+	samples++;
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+double Metrics::getAcqRate()
+{
+	int32 newest, oldest;
+	double secs;
+
+	if(samples < 2)
+		return(0);
+
+	newest = (samples - 1) % METRICS_RATE_WINDOW;
+	oldest = (samples < METRICS_RATE_WINDOW) ? 0 : samples % METRICS_RATE_WINDOW;
+
+	/* Longer than tsc_ns() can hold */
+	secs = (double)(sample_tsc[newest] - sample_tsc[oldest])*tsc_mult/65536.0/1e9;
+
+	return(secs > 0 ? (sample_acq[newest] - sample_acq[oldest])/secs : 0);
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void Metrics::Print(const char *_fmt, ...)
+{
+	va_list args;
+	int32 n;
+
+	va_start(args, _fmt);
+	n = vsnprintf(&buff[len], METRICS_BUFF_SIZE - len, _fmt, args);
+	va_end(args);
+
+	if(n > 0)
+		len = (len + n < METRICS_BUFF_SIZE) ? len + n : METRICS_BUFF_SIZE - 1;
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void Metrics::PrintHist(const char *_name, const char *_labels, Histogram *_hist)
+{
+	const char *sep;
+
+	sep = _labels[0] ? "," : "";
+
+	Print("%s{%s%squantile=\"0.5\"} %.1f\n", _name, _labels, sep, _hist->getPercentile(0.5)/1e3);
+	Print("%s{%s%squantile=\"0.99\"} %.1f\n", _name, _labels, sep, _hist->getPercentile(0.99)/1e3);
+	Print("%s{%s%squantile=\"0.999\"} %.1f\n", _name, _labels, sep, _hist->getPercentile(0.999)/1e3);
+
+	if(_labels[0])
+	{
+		Print("%s_max{%s} %.1f\n", _name, _labels, _hist->getMax()/1e3);
+		Print("%s_count{%s} %u\n", _name, _labels, _hist->getSamples());
+	}
+	else
+	{
+		Print("%s_max %.1f\n", _name, _hist->getMax()/1e3);
+		Print("%s_count %u\n", _name, _hist->getSamples());
+	}
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void Metrics::PrintThread(Threaded_Object *_obj)
+{
+	char labels[32];
+
+	if(_obj == NULL)
+		return;
+
+	snprintf(labels, sizeof(labels), "task=\"%.8s\"", _obj->getTaskName());
+
+	Print("gps_sdr_thread_exec_total{%s} %u\n", labels, _obj->getExecTic());
+	PrintHist("gps_sdr_thread_run_us", labels, _obj->getRunHist());
+	PrintHist("gps_sdr_thread_wake_us", labels, _obj->getWakeHist());
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+/*! Nothing in here takes a lock, every value is a single word written by the thread that owns it
+	or a seqlock snapshot */
+void Metrics::Export(int32 _fd)
+{
+	struct pollfd pfd;
+	struct timeval now, tv;
+	Channel_Status_S chan;
+	PRE_2_SVS_S pred;
+	char request[256], header[128];
+	int32 lcv, http, n, sent;
+
+	/* Scrapers speak HTTP, wait a moment for the request line. Over the unix socket it is just text */
+	http = false;
+	if(!unix_socket)
+	{
+		pfd.fd = _fd;
+		pfd.events = POLLIN;
+		if(poll(&pfd, 1, METRICS_REQUEST_WAIT) > 0)
+		{
+			n = recv(_fd, request, sizeof(request) - 1, MSG_DONTWAIT);
+			http = (n >= 4) && (strncmp(request, "GET ", 4) == 0);
+		}
+	}
+
+	len = 0;
+	gettimeofday(&now, NULL);
+
+	Print("# TYPE gps_sdr_uptime_seconds gauge\n");
+	Print("gps_sdr_uptime_seconds %.3f\n", (now.tv_sec - starttime.tv_sec) + (now.tv_usec - starttime.tv_usec)*1e-6);
+
+	Print("# TYPE gps_sdr_fifo_depth_ms gauge\n");
+	Print("gps_sdr_fifo_depth_ms %u\n", pFIFO->getDepth());
+	Print("# TYPE gps_sdr_fifo_peak_ms gauge\n");
+	Print("gps_sdr_fifo_peak_ms %u\n", pCorrelator->getFIFOPeak());
+	Print("# TYPE gps_sdr_fifo_capacity_ms gauge\n");
+	Print("gps_sdr_fifo_capacity_ms %d\n", FIFO_DEPTH);
+	Print("# TYPE gps_sdr_fifo_overruns_total counter\n");
+	Print("gps_sdr_fifo_overruns_total %u\n", pFIFO->getOverruns());
+
+	Print("# TYPE gps_sdr_correlator_ms_total counter\n");
+	Print("gps_sdr_correlator_ms_total %u\n", pCorrelator->getExecTic());
+	Print("# TYPE gps_sdr_correlator_late_ms_total counter\n");
+	Print("gps_sdr_correlator_late_ms_total %u\n", pCorrelator->getLate());
+	Print("# TYPE gps_sdr_correlator_lock_waits_total counter\n");
+	Print("gps_sdr_correlator_lock_waits_total %u\n", pCorrelator->getLockWaits());
+	Print("# TYPE gps_sdr_correlator_loop_misses_total counter\n");
+	Print("gps_sdr_correlator_loop_misses_total %u\n", pCorrelator->getLoopMisses());
+	Print("# TYPE gps_sdr_correlator_dumps_dropped_total counter\n");
+	Print("gps_sdr_correlator_dumps_dropped_total %u\n", pCorrelator->getDumpDrops());
+	Print("# TYPE gps_sdr_correlator_start_waits_total counter\n");
+	Print("gps_sdr_correlator_start_waits_total %u\n", pCorrelator->getStartWaits());
+	Print("# TYPE gps_sdr_tracking_commands_dropped_total counter\n");
+	Print("gps_sdr_tracking_commands_dropped_total %u\n", pTracking->getDropped());
+	Print("# TYPE gps_sdr_channel_snapshot_retries_total counter\n");
+	Print("gps_sdr_channel_snapshot_retries_total %u\n", pCorrelator->getRetries());
+
+	Print("# TYPE gps_sdr_acquisitions_total counter\n");
+	Print("gps_sdr_acquisitions_total %u\n", pAcquisition->getExecTic());
+	Print("# TYPE gps_sdr_acquisitions_per_second gauge\n");
+	Print("gps_sdr_acquisitions_per_second %.2f\n", getAcqRate());
+
+	Print("# TYPE gps_sdr_measurement_rate_hz gauge\n");
+	Print("gps_sdr_measurement_rate_hz %d\n", MEASUREMENTS_PER_SECOND);
+	Print("# TYPE gps_sdr_pvt_epochs_total counter\n");
+	Print("gps_sdr_pvt_epochs_total %u\n", pPVT->getExecTic());
+	Print("# TYPE gps_sdr_pvt_epochs_dropped_total counter\n");
+	Print("gps_sdr_pvt_epochs_dropped_total %u\n", pCorrelator->getEpochDrops());
+	Print("# TYPE gps_sdr_pvt_solve_us summary\n");
+	PrintHist("gps_sdr_pvt_solve_us", "", pPVT->getSolveHist());
+	Print("# TYPE gps_sdr_ekf_update_us summary\n");
+	PrintHist("gps_sdr_ekf_update_us", "", pEKF->getUpdateHist());
+
+	/* Age is how long ago the last sweep finished, lag how old the receiver state it used was */
+	pPredictor->getOutput(&pred);
+	Print("# TYPE gps_sdr_svs_predict_sweeps_total counter\n");
+	Print("gps_sdr_svs_predict_sweeps_total %u\n", pred.sweeps);
+	Print("# TYPE gps_sdr_svs_predicted_visible gauge\n");
+	Print("gps_sdr_svs_predicted_visible %u\n", pred.visible);
+	Print("# TYPE gps_sdr_svs_prediction_age_seconds gauge\n");
+	Print("gps_sdr_svs_prediction_age_seconds %.3f\n", pred.tsc ? (tsc_now() - pred.tsc)*(tsc_mult/65536.0)*1e-9 : 0.0);
+	Print("# TYPE gps_sdr_svs_prediction_lag_seconds gauge\n");
+	Print("gps_sdr_svs_prediction_lag_seconds %.3f\n", pred.input_tsc ? (pred.tsc - pred.input_tsc)*(tsc_mult/65536.0)*1e-9 : 0.0);
+	Print("# TYPE gps_sdr_svs_predict_us summary\n");
+	PrintHist("gps_sdr_svs_predict_us", "", pPredictor->getSweepHist());
+
+	Print("# TYPE gps_sdr_thread_exec_total counter\n");
+	Print("# TYPE gps_sdr_thread_run_us summary\n");
+	Print("# TYPE gps_sdr_thread_wake_us summary\n");
+	PrintThread(pFIFO);
+	PrintThread(pCorrelator);
+	PrintThread(pTracking);
+	PrintThread(pAcquisition);
+	PrintThread(pSV_Select);
+	PrintThread(pPredictor);
+	PrintThread(pEphemeris);
+	PrintThread(pPVT);
+	PrintThread(pEKF);
+	PrintThread(pTelemetry);
+	PrintThread(pCommando);
+	PrintThread(pRecorder);
+
+	Print("# TYPE gps_sdr_channel_state gauge\n");
+	Print("# TYPE gps_sdr_channel_prn gauge\n");
+	Print("# TYPE gps_sdr_channel_cn0_dbhz gauge\n");
+	Print("# TYPE gps_sdr_channel_bit_lock gauge\n");
+	Print("# TYPE gps_sdr_channel_frame_lock gauge\n");
+	Print("# TYPE gps_sdr_channel_dumps_dropped_total counter\n");
+	for(lcv = 0; lcv < MAX_CHANNELS; lcv++)
+	{
+		pChannels[lcv]->getStatus(&chan);
+
+		Print("gps_sdr_channel_state{chan=\"%d\"} %d\n", lcv, chan.state);
+		Print("gps_sdr_channel_dumps_dropped_total{chan=\"%d\"} %u\n", lcv, pCorrelator->getDumpDrops(lcv));
+		if(chan.state == CHANNEL_EMPTY)
+			continue;
+
+		Print("gps_sdr_channel_prn{chan=\"%d\"} %d\n", lcv, chan.sv + 1);
+		Print("gps_sdr_channel_cn0_dbhz{chan=\"%d\"} %.1f\n", lcv, chan.cn0);
+		Print("gps_sdr_channel_bit_lock{chan=\"%d\"} %d\n", lcv, chan.bit_lock);
+		Print("gps_sdr_channel_frame_lock{chan=\"%d\"} %d\n", lcv, chan.frame_lock);
+	}
+
+	/* A client that stops reading gets cut off rather than holding the thread */
+	tv.tv_sec = 0;
+	tv.tv_usec = METRICS_SEND_TIMEOUT*1000;
+	setsockopt(_fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+	if(http)
+	{
+		n = snprintf(header, sizeof(header), "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: %d\r\n\r\n", len);
+		if(send(_fd, header, n, MSG_NOSIGNAL) != n)
+			return;
+	}
+
+	for(sent = 0; sent < len; sent += n)
+	{
+		n = send(_fd, &buff[sent], len - sent, MSG_NOSIGNAL);
+		if(n <= 0)
+			break;
+	}
+}
+/*----------------------------------------------------------------------------------------------*/
@@ -0,0 +1,83 @@
+/*----------------------------------------------------------------------------------------------*/
+/*! \file metrics.h
+//
+// FILENAME: metrics.h
+//
+// DESCRIPTION: Defines the Metrics class, a plain text snapshot of the receiver for monitoring
+//
+// DEVELOPERS: Gregory W. Heckler (2003-2009)
+//
+// LICENSE TERMS: Copyright (c) Gregory W. Heckler 2009
+//
+// This file is part of the GPS Software Defined Radio (GPS-SDR)
+//
+// The GPS-SDR is free software; you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation; either version 2 of
+// the License, or (at your option) any later version. The GPS-SDR is distributed in the hope that
+// it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// Note:  Comments within this file follow a syntax that is compatible with
+//        DOXYGEN and are utilized for automated document extraction
+//
+// Reference:
+*/
+/*----------------------------------------------------------------------------------------------*/
+
+
+#ifndef METRICS_H_
+#define METRICS_H_
+
+#include "includes.h"
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <poll.h>
+
+#define METRICS_SAMPLE_PERIOD	(1000)		//!< ms between samples of the rate counters
+#define METRICS_RATE_WINDOW		(10)		//!< Rates are averaged over this many samples
+#define METRICS_REQUEST_WAIT	(100)		//!< ms to wait for an HTTP request line before answering in plain text
+#define METRICS_SEND_TIMEOUT	(100)		//!< ms a slow client gets to take the snapshot
+#define METRICS_BUFF_SIZE		(32768)		//!< Bytes of text per snapshot
+
+/*! \ingroup CLASSES
+ *	@brief Serves a snapshot of the receiver's counters to anyone who connects to a unix socket
+ *	or a loopback TCP port (-M). Everything is read straight out of the other objects without
+ *	taking their locks, so a scrape can never hold up the correlator, at worst a line is a
+ *	sample or two out of step with the next.
+ */
+class Metrics : public Threaded_Object
+{
+
+	private:
+
+		int32 sock;									//!< Listening socket, -1 if it could not be opened
+		int32 unix_socket;							//!< sock is a unix socket, unlink the path when done
+		char *buff;									//!< The snapshot being formatted
+		int32 len;									//!< Bytes in buff
+		uint64 sample_tsc[METRICS_RATE_WINDOW];		//!< When each rate sample was taken
+		uint32 sample_acq[METRICS_RATE_WINDOW];		//!< Acquisitions done at that point
+		uint32 samples;								//!< Rate samples taken
+		uint64 last_sample;							//!< TSC of the newest sample
+
+		void Print(const char *_fmt, ...);			//!< Append to the snapshot
+		void PrintThread(Threaded_Object *_obj);	//!< Exec count and latency quantiles for a task
+		void PrintHist(const char *_name, const char *_labels, Histogram *_hist);	//!< Quantiles in us
+		void Sample();								//!< Take a rate sample
+		double getAcqRate();						//!< Acquisitions per second over the window
+
+	public:
+
+		Metrics();
+		~Metrics();
+		void Start();								//!< Start the thread
+		void Open();								//!< Listen on gopt.metrics
+		void Close();								//!< Stop listening
+		void Import();								//!< Wait for a client or the next rate sample
+		void Export(int32 _fd);						//!< Format a snapshot and send it
+};
+
+#endif /* METRICS_H_ */
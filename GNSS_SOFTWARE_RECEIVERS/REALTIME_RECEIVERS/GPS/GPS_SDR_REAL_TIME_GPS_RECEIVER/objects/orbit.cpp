@@ -0,0 +1,203 @@
+/*----------------------------------------------------------------------------------------------*/
+/*! \file orbit.cpp
+//
+// FILENAME: orbit.cpp
+//
+// DESCRIPTION: Implements member functions of the Orbit class.
+//
+// DEVELOPERS: Gregory W. Heckler (2003-2009)
+//
+// LICENSE TERMS: Copyright (c) Gregory W. Heckler 2009
+//
+// This file is part of the GPS Software Defined Radio (GPS-SDR)
+//
+// The GPS-SDR is free software; you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation; either version 2 of
+// the License, or (at your option) any later version. The GPS-SDR is distributed in the hope that
+// it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// Note:  Comments within this file follow a syntax that is compatible with
+//        DOXYGEN and are utilized for automated document extraction
+//
+// Reference:
+*/
+/*----------------------------------------------------------------------------------------------*/
+
+#include "orbit.h"
+
+/*----------------------------------------------------------------------------------------------*/
+Orbit::Orbit()
+{
+
+	memset(&eph, 0x0, sizeof(Ephemeris_M));
+	memset(&alm, 0x0, sizeof(Almanac_M));
+	evals = 0;
+
+	Flush();
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void Orbit::Flush()
+{
+
+	source = ORBIT_NONE;
+	spacing = ORBIT_NODE_EPHEMERIS;
+	loaded = false;
+	dE = 0;
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+int32 Orbit::Set(Ephemeris_M *_e)
+{
+
+	/* Only the IODE and toe say the orbit changed, the rest of the struct ticks along */
+	if((source == ORBIT_EPHEMERIS) && (_e->sv == eph.sv) && (_e->iode == eph.iode) &&
+		(_e->toe == eph.toe) && (_e->valid == eph.valid))
+		return(false);
+
+	Flush();
+	eph = *_e;
+	source = ORBIT_EPHEMERIS;
+	spacing = ORBIT_NODE_EPHEMERIS;
+
+	return(true);
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+int32 Orbit::Set(Almanac_M *_a)
+{
+
+	if((source == ORBIT_ALMANAC) && (_a->sv == alm.sv) && (_a->toa == alm.toa) &&
+		(_a->week == alm.week) && (_a->valid == alm.valid))
+		return(false);
+
+	Flush();
+	alm = *_a;
+	source = ORBIT_ALMANAC;
+	spacing = ORBIT_NODE_ALMANAC;
+
+	return(true);
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void Orbit::Node(double _t, Orbit_Node_S *_n)
+{
+
+	SV_Position_M s;
+
+	if(source == ORBIT_EPHEMERIS)
+	{
+		dE = SV_Ephemeris(&eph, _t, dE, &s);
+		_n->relativistic = eph.relativistic;
+	}
+	else
+	{
+		SV_Almanac(&alm, _t, &s);
+		_n->relativistic = 0;
+	}
+
+	_n->t = _t;
+	_n->p[0] = s.x;  _n->p[1] = s.y;  _n->p[2] = s.z;
+	_n->v[0] = s.vx; _n->v[1] = s.vy; _n->v[2] = s.vz;
+
+	evals++;
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void Orbit::Position(double _t, SV_Position_M *_s)
+{
+
+	double t0, u, u2, u3, h00, h10, h01, h11, d00, d10, d01, d11;
+	double p[3], v[3], rel, tk, dt;
+	int32 lcv;
+
+	if(source == ORBIT_NONE)
+		return;
+
+	/* The pair of nodes around _t, usually the same as last time or one along */
+	t0 = floor(_t/spacing)*spacing;
+	if(!loaded || (node[0].t != t0))
+	{
+		if(loaded && (node[1].t == t0))
+		{
+			node[0] = node[1];
+			Node(t0 + spacing, &node[1]);
+		}
+		else
+		{
+			Node(t0, &node[0]);
+			Node(t0 + spacing, &node[1]);
+		}
+		loaded = true;
+	}
+
+	/* Cubic Hermite basis and its derivative */
+	u = (_t - t0)/spacing;
+	u2 = u*u;
+	u3 = u2*u;
+	h00 = 2.0*u3 - 3.0*u2 + 1.0;
+	h10 = (u3 - 2.0*u2 + u)*spacing;
+	h01 = -2.0*u3 + 3.0*u2;
+	h11 = (u3 - u2)*spacing;
+	d00 = (6.0*u2 - 6.0*u)/spacing;
+	d10 = 3.0*u2 - 4.0*u + 1.0;
+	d01 = -d00;
+	d11 = 3.0*u2 - 2.0*u;
+
+	for(lcv = 0; lcv < 3; lcv++)
+	{
+		p[lcv] = h00*node[0].p[lcv] + h10*node[0].v[lcv] + h01*node[1].p[lcv] + h11*node[1].v[lcv];
+		v[lcv] = d00*node[0].p[lcv] + d10*node[0].v[lcv] + d01*node[1].p[lcv] + d11*node[1].v[lcv];
+	}
+
+	_s->x = p[0];  _s->y = p[1];  _s->z = p[2];
+	_s->vx = v[0]; _s->vy = v[1]; _s->vz = v[2];
+
+	/* The clock the same way SV_Ephemeris() and SV_Almanac() do it */
+	if(source == ORBIT_EPHEMERIS)
+	{
+		tk = _t - eph.toe;
+		if(tk > HALF_OF_SECONDS_IN_WEEK)
+			tk -= SECONDS_IN_WEEK;
+		else if(tk < (-HALF_OF_SECONDS_IN_WEEK))
+			tk += SECONDS_IN_WEEK;
+
+		rel = node[0].relativistic + (node[1].relativistic - node[0].relativistic)*u;
+		dt = _t - eph.toc;
+
+		_s->time = tk;
+		_s->clock_bias = eph.af0 + eph.af1*dt + eph.af2*dt*dt + rel - eph.tgd;
+		_s->frequency_bias = eph.af1 + eph.af2*dt*2.0;
+	}
+	else
+	{
+		tk = _t - alm.toa;
+		if(tk > HALF_OF_SECONDS_IN_WEEK)
+			tk -= SECONDS_IN_WEEK;
+		else if(tk < (-HALF_OF_SECONDS_IN_WEEK))
+			tk += SECONDS_IN_WEEK;
+
+		_s->time = tk;
+		_s->clock_bias = alm.af0 + tk*alm.af1;
+		_s->frequency_bias = alm.af1;
+	}
+
+}
+/*----------------------------------------------------------------------------------------------*/
@@ -0,0 +1,87 @@
+/*----------------------------------------------------------------------------------------------*/
+/*! \file orbit.h
+//
+// FILENAME: orbit.h
+//
+// DESCRIPTION: Defines the Orbit class, a cache of one SV's orbit interpolated between exact
+//				ephemeris or almanac evaluations
+//
+// DEVELOPERS: Gregory W. Heckler (2003-2009)
+//
+// LICENSE TERMS: Copyright (c) Gregory W. Heckler 2009
+//
+// This file is part of the GPS Software Defined Radio (GPS-SDR)
+//
+// The GPS-SDR is free software; you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation; either version 2 of
+// the License, or (at your option) any later version. The GPS-SDR is distributed in the hope that
+// it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// Note:  Comments within this file follow a syntax that is compatible with
+//        DOXYGEN and are utilized for automated document extraction
+//
+// Reference:
+*/
+/*----------------------------------------------------------------------------------------------*/
+
+#ifndef ORBIT_H_
+#define ORBIT_H_
+
+#include "includes.h"
+
+/*! Where an Orbit gets its exact positions */
+enum ORBIT_SOURCE
+{
+	ORBIT_NONE,
+	ORBIT_EPHEMERIS,
+	ORBIT_ALMANAC
+};
+
+/*! One exact evaluation */
+typedef struct Orbit_Node_S
+{
+	double t;						//!< Time (seconds of week), a whole number of node spacings
+	double p[3];					//!< ECEF position (meters)
+	double v[3];					//!< ECEF velocity (meters/sec)
+	double relativistic;			//!< Relativistic clock correction (seconds)
+} Orbit_Node_S;
+
+/*! \ingroup CLASSES
+ *	@brief One SV's orbit. SV_Ephemeris() or SV_Almanac() is run at node times a fixed spacing
+ *	apart and Position() serves anything in between off the cubic Hermite through the two nodes
+ *	either side, positions and velocities. Nodes sit on multiples of the spacing so the answer for
+ *	a given time does not depend on what was asked before, and moving on to the next pair costs
+ *	one evaluation. The clock polynomial is exact, only the relativistic term is interpolated
+ *	(linearly). At 30 s the ephemeris interpolation is well under a millimeter off, orbit-test
+ *	checks it. A new IODE or toe, or a new almanac, drops the nodes.
+ */
+class Orbit
+{
+
+	private:
+
+		Ephemeris_M		eph;							//!< Ephemeris the nodes come from
+		Almanac_M		alm;							//!< Or the almanac
+		int32			source;							//!< ORBIT_SOURCE
+		double			spacing;						//!< Seconds between nodes
+		Orbit_Node_S	node[2];						//!< Nodes either side of the last time asked for
+		int32			loaded;							//!< node[] is good
+		double			dE;								//!< E - M at the last node, where Kepler's equation starts
+		uint32			evals;							//!< Exact evaluations
+
+		void Node(double _t, Orbit_Node_S *_n);			//!< Exact evaluation at _t
+
+	public:
+
+		Orbit();
+		void Flush();									//!< Forget the orbit
+		int32 Set(Ephemeris_M *_e);						//!< Use _e, true if it is a new one
+		int32 Set(Almanac_M *_a);						//!< Use _a, true if it is a new one
+		void Position(double _t, SV_Position_M *_s);	//!< Position, velocity and clock at _t
+		uint32 getEvals(){return(evals);}				//!< Exact evaluations so far
+
+};
+
+#endif /* ORBIT_H_ */
@@ -33,7 +33,7 @@ void *Patience_Thread(void *_arg)
 
 	Patience *aPatience = pPatience;
 
-	while(grun)
+	while(aPatience->Running())
 	{
 		aPatience->PetMe();
 	}
@@ -88,9 +88,7 @@ void Patience::PetMe()
 		if(new_tic == last_tic)
 		{
 			fprintf(stdout, "Watchdog Tripped!\n");
-			pFIFO->Stop();
-			pFIFO->ResetSource();
-			pFIFO->Start();
+			pFIFO->Restart();
 			last_tic = 0;
 		}
 		else
@@ -99,6 +97,6 @@ void Patience::PetMe()
 		}
 	}
 
-	sleep(1);
+	Pause(1000000);
 }
 /*----------------------------------------------------------------------------------------------*/
@@ -0,0 +1,285 @@
+/*----------------------------------------------------------------------------------------------*/
+/*! \file predictor.cpp
+//
+// FILENAME: predictor.cpp
+//
+// DESCRIPTION: Implements member functions of the Predictor class.
+//
+// DEVELOPERS: Gregory W. Heckler (2003-2009)
+//
+// LICENSE TERMS: Copyright (c) Gregory W. Heckler 2009
+//
+// This file is part of the GPS Software Defined Radio (GPS-SDR)
+//
+// The GPS-SDR is free software; you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation; either version 2 of
+// the License, or (at your option) any later version. The GPS-SDR is distributed in the hope that
+// it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// Note:  Comments within this file follow a syntax that is compatible with
+//        DOXYGEN and are utilized for automated document extraction
+//
+// Reference:
+*/
+/*----------------------------------------------------------------------------------------------*/
+
+#include "predictor.h"
+#include "ephemeris.h"			//!< Almanacs
+#include "sv_select.h"			//!< SV_SELECT_MODE
+#include <new>					//!< std::bad_alloc
+
+/*----------------------------------------------------------------------------------------------*/
+void *Predictor_Thread(void *_arg)
+{
+
+	while(pPredictor->Running())
+	{
+		pPredictor->Sweep();
+		pPredictor->IncExecTic();
+		pPredictor->Pause(PREDICT_PERIOD*1000);
+	}
+
+	pthread_exit(0);
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void Predictor::Start()
+{
+
+	Start_Thread(Predictor_Thread, NULL);
+
+	if(gopt.verbose)
+		fprintf(stdout,"Predictor thread started\n");
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+Predictor::Predictor():Threaded_Object("PRETASK")
+{
+
+	object_mem = this;
+	size = sizeof(Predictor);
+
+	memset(&state, 0x0, sizeof(SVS_2_PRE_S));
+	memset(&sweep, 0x0, sizeof(PRE_2_SVS_S));
+	memset(&almanacs[0], 0x0, MAX_SV*sizeof(Almanac_M));
+	memset(&sv_positions[0], 0x0, MAX_SV*sizeof(SV_Position_M));
+	state.mode = ACQ_MODE_COLD;
+
+	/* movaps, both have to be 16 byte aligned. Fail the way new would */
+	if(posix_memalign((void **)&bank, 16, PREDICT_BANKS*sizeof(Predict_Bank_S)))
+		throw std::bad_alloc();
+	if(posix_memalign((void **)&frame, 16, sizeof(Predict_Frame_S)))
+	{
+		free(bank);
+		throw std::bad_alloc();
+	}
+	memset(bank, 0x0, PREDICT_BANKS*sizeof(Predict_Bank_S));
+	memset(frame, 0x0, sizeof(Predict_Frame_S));
+
+	if(gopt.verbose)
+		fprintf(stdout,"Creating Predictor\n");
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+Predictor::~Predictor()
+{
+
+	free(bank);
+	free(frame);
+
+	if(gopt.verbose)
+		fprintf(stdout,"Destructing Predictor\n");
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void Predictor::GetAlmanacs()
+{
+
+	int32 lcv;
+
+	pEphemeris->Lock();
+	for(lcv = 0; lcv < MAX_SV; lcv++)
+		almanacs[lcv] = pEphemeris->getAlmanac(lcv);
+	pEphemeris->Unlock();
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void Predictor::Frame(double *_r)
+{
+
+	double ct, st, cp, sp, r;
+	int32 lane;
+
+	ct = cos(state.sps.longitude); st = sin(state.sps.longitude);
+	cp = cos(state.sps.latitude);  sp = sin(state.sps.latitude);
+	r = sqrt(_r[0]*_r[0] + _r[1]*_r[1] + _r[2]*_r[2]);
+
+	for(lane = 0; lane < 4; lane++)
+	{
+		frame->ex[lane] = -st;
+		frame->ey[lane] = ct;
+		frame->ez[lane] = 0;
+		frame->nx[lane] = -sp*ct;
+		frame->ny[lane] = -sp*st;
+		frame->nz[lane] = cp;
+		frame->ux[lane] = cp*ct;
+		frame->uy[lane] = cp*st;
+		frame->uz[lane] = sp;
+		frame->gx[lane] = _r[0]/r;
+		frame->gy[lane] = _r[1]/r;
+		frame->gz[lane] = _r[2]/r;
+		frame->mask[lane] = -cos(state.mask_angle);
+	}
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void Predictor::Sweep()
+{
+
+	Predict_Bank_S *b;
+	SV_Position_M *psv;
+	SV_Prediction_M *ppred;
+	double t, dt, ra, r[3], v[3], na[3], sa[3];
+	uint64 t0;
+	int32 lcv, lane;
+	uint32 valid;
+
+	t0 = tsc_now();
+
+	IncStartTic();
+
+	input.Read(&state);
+
+	/* Carry the receiver on to now, in batch mode the state is as new as anything gets */
+	dt = 0;
+	if(gopt.realtime && state.tsc)
+		dt = (t0 - state.tsc)*(tsc_mult/65536.0)*1e-9;
+
+	t = (double)state.clock.time + dt;
+	r[0] = state.sps.x + state.sps.vx*dt;
+	r[1] = state.sps.y + state.sps.vy*dt;
+	r[2] = state.sps.z + state.sps.vz*dt;
+	v[0] = state.sps.vx;
+	v[1] = state.sps.vy;
+	v[2] = state.sps.vz;
+
+	sweep.time = t;
+	sweep.mode = state.mode;
+	sweep.input_tsc = state.tsc;
+	sweep.visible = 0;
+
+	/* Nothing to go on when cold */
+	valid = 0;
+	if(state.mode != ACQ_MODE_COLD)
+	{
+		GetAlmanacs();
+		Frame(r);
+
+		/* Receiver acceleration, gravity plus the rotating frame, the same for every SV */
+		ra = sqrt(r[0]*r[0] + r[1]*r[1] + r[2]*r[2]);
+		ra = GRAVITY_CONSTANT/(ra*ra*ra);
+		na[0] = -r[0]*ra +  2.0*WGS84OE*v[1] + WGS84OE*WGS84OE*r[0];
+		na[1] = -r[1]*ra + -2.0*WGS84OE*v[0] + WGS84OE*WGS84OE*r[1];
+		na[2] = -r[2]*ra;
+
+		for(lcv = 0; lcv < MAX_SV; lcv++)
+		{
+			b = &bank[lcv >> 2];
+			lane = lcv & 0x3;
+
+			if(almanacs[lcv].valid != true)
+			{
+				/* Keep the lane finite, it is thrown away */
+				b->dx[lane] = b->dy[lane] = b->dz[lane] = 1.0f;
+				b->dvx[lane] = b->dvy[lane] = b->dvz[lane] = 0;
+				b->dax[lane] = b->day[lane] = b->daz[lane] = 0;
+				b->clock[lane] = b->drift[lane] = 0;
+				continue;
+			}
+
+			valid |= 0x1 << lcv;
+
+			/* The cache goes back to the almanac every ORBIT_NODE_ALMANAC, and when a new one comes in */
+			psv = &sv_positions[lcv];
+			orbits[lcv].Set(&almanacs[lcv]);
+			orbits[lcv].Position(t, psv);
+
+			ra = sqrt(psv->x*psv->x + psv->y*psv->y + psv->z*psv->z);
+			ra = GRAVITY_CONSTANT/(ra*ra*ra);
+			sa[0] = -psv->x*ra +  2.0*WGS84OE*psv->vy + WGS84OE*WGS84OE*psv->x;
+			sa[1] = -psv->y*ra + -2.0*WGS84OE*psv->vx + WGS84OE*WGS84OE*psv->y;
+			sa[2] = -psv->z*ra;
+
+			/* Differences in double, only what is left goes to float */
+			b->dx[lane] = psv->x - r[0];
+			b->dy[lane] = psv->y - r[1];
+			b->dz[lane] = psv->z - r[2];
+			b->dvx[lane] = psv->vx - v[0];
+			b->dvy[lane] = psv->vy - v[1];
+			b->dvz[lane] = psv->vz - v[2];
+			b->dax[lane] = sa[0] - na[0];
+			b->day[lane] = sa[1] - na[1];
+			b->daz[lane] = sa[2] - na[2];
+			b->clock[lane] = psv->clock_bias;
+			b->drift[lane] = state.sps.clock_rate + psv->frequency_bias*SPEED_OF_LIGHT;
+		}
+
+		sse_predict(bank, frame, PREDICT_BANKS);
+	}
+
+	for(lcv = 0; lcv < MAX_SV; lcv++)
+	{
+		b = &bank[lcv >> 2];
+		lane = lcv & 0x3;
+		ppred = &sweep.sv[lcv];
+
+		ppred->sv = lcv;
+		ppred->time = t;
+		ppred->mode = state.mode;
+		ppred->tracked = false;
+		ppred->predicted = (valid >> lcv) & 0x1;
+
+		if(ppred->predicted)
+		{
+			ppred->delay = b->delay[lane];
+			ppred->doppler = b->doppler[lane];
+			ppred->doppler_rate = b->doppler_rate[lane];
+			ppred->elev = b->elev[lane];
+			ppred->azim = b->azim[lane];
+			ppred->visible = b->visible[lane] ? true : false;
+			sweep.visible += ppred->visible;
+		}
+		else
+			ppred->visible = false;
+	}
+
+	sweep.sweeps++;
+	sweep.tsc = tsc_now();
+	sweep_hist.Add(sweep.tsc - t0);
+
+	output.Write(&sweep);
+
+	IncStopTic();
+
+}
+/*----------------------------------------------------------------------------------------------*/
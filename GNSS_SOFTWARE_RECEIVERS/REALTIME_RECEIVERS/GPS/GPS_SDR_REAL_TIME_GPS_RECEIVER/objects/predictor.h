@@ -0,0 +1,74 @@
+/*----------------------------------------------------------------------------------------------*/
+/*! \file predictor.h
+//
+// FILENAME: predictor.h
+//
+// DESCRIPTION: Defines the Predictor class, the whole constellation's visibility, Doppler and
+//				delay off the almanac, swept on its own clock
+//
+// DEVELOPERS: Gregory W. Heckler (2003-2009)
+//
+// LICENSE TERMS: Copyright (c) Gregory W. Heckler 2009
+//
+// This file is part of the GPS Software Defined Radio (GPS-SDR)
+//
+// The GPS-SDR is free software; you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation; either version 2 of
+// the License, or (at your option) any later version. The GPS-SDR is distributed in the hope that
+// it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// Note:  Comments within this file follow a syntax that is compatible with
+//        DOXYGEN and are utilized for automated document extraction
+//
+// Reference:
+*/
+/*----------------------------------------------------------------------------------------------*/
+
+#ifndef PREDICTOR_H_
+#define PREDICTOR_H_
+
+#include "includes.h"
+#include "orbit.h"
+
+/*! \ingroup CLASSES
+ *	@brief Predicts every SV at once every PREDICT_PERIOD ms, whatever the acquisition is doing.
+ *	SV_Select hands over the receiver state it picked (setInput()) and reads back the last sweep
+ *	(getOutput()), both through a Seqlock so neither side waits on the other. A sweep carries
+ *	the receiver state forward to now, runs each SV's almanac orbit out of its Orbit cache,
+ *	forms the relative vectors in double and leaves the range, range rate, range acceleration
+ *	and the local level angles to sse_predict(), 4 SVs a pass.
+ */
+class Predictor : public Threaded_Object
+{
+
+	private:
+
+		Seqlock<SVS_2_PRE_S>	input;					//!< Receiver state from SV_Select
+		Seqlock<PRE_2_SVS_S>	output;					//!< The last sweep, for SV_Select
+		SVS_2_PRE_S			state;						//!< Receiver state this sweep is working from
+		PRE_2_SVS_S			sweep;						//!< The sweep being made
+		Almanac_M			almanacs[MAX_SV];			//!< The decoded almanacs
+		SV_Position_M		sv_positions[MAX_SV];		//!< Where each SV is at the sweep's time
+		Orbit				orbits[MAX_SV];				//!< Interpolated almanac orbits
+		Predict_Bank_S		*bank;						//!< PREDICT_BANKS, 16 byte aligned for sse_predict()
+		Predict_Frame_S		*frame;						//!< The receiver's local frame
+		Histogram			sweep_hist;					//!< Time spent in Sweep()
+
+		void GetAlmanacs();								//!< Every almanac under one lock
+		void Frame(double *_r);							//!< Fill in frame for the receiver at _r
+
+	public:
+
+		Predictor();
+		~Predictor();
+		void Start();									//!< Start the thread
+		void Sweep();									//!< Predict every SV
+		void setInput(SVS_2_PRE_S *_in){input.Write(_in);}		//!< Receiver state, only SV_Select calls this
+		void getOutput(PRE_2_SVS_S *_out){output.Read(_out);}	//!< The last sweep
+		Histogram *getSweepHist(){return(&sweep_hist);}			//!< Get the sweep time histogram
+
+};
+
+#endif /* PREDICTOR_H_ */
@@ -0,0 +1,306 @@
+/*----------------------------------------------------------------------------------------------*/
+/*! \file profiler.cpp
+//
+// FILENAME: profiler.cpp
+//
+// DESCRIPTION: Sample every thread on its own CPU time with SIGPROF, walk the frame pointers,
+//				and write the stacks out in the collapsed format the flame graph tools read
+//
+// DEVELOPERS: Gregory W. Heckler (2003-2009)
+//
+// LICENSE TERMS: Copyright (c) Gregory W. Heckler 2009
+//
+// This file is part of the GPS Software Defined Radio (GPS-SDR)
+//
+// The GPS-SDR is free software; you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation; either version 2 of
+// the License, or (at your option) any later version. The GPS-SDR is distributed in the hope that
+// it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// Note:  Comments within this file follow a syntax that is compatible with
+//        DOXYGEN and are utilized for automated document extraction
+//
+// Reference:
+*/
+/*----------------------------------------------------------------------------------------------*/
+
+#include "includes.h"
+
+#ifdef PROFILE
+
+#include <ucontext.h>
+#include <dlfcn.h>
+#include <cxxabi.h>
+
+#ifndef sigev_notify_thread_id
+	#define sigev_notify_thread_id _sigev_un._tid
+#endif
+
+__thread Profile_Thread_S *profile_thread = NULL;
+
+static Profile_Thread_S *profile_threads[PROFILE_THREADS];	//!< Every thread that was sampled
+static int32 profile_count = 0;								//!< Slots of profile_threads claimed
+
+/*----------------------------------------------------------------------------------------------*/
+/*! Runs on the thread that used up its CPU time slice, so nothing here needs a lock */
+static void Profile_Handler(int _sig, siginfo_t *_info, void *_context)
+{
+	Profile_Thread_S *p;
+	Profile_Stack_S *s;
+	ucontext_t *uc;
+	uintptr_t pc[PROFILE_DEPTH], frame[PROFILE_DEPTH];
+	char *fp[PROFILE_DEPTH], *f, *next;
+	uint32 scopes, hash, slot;
+	int32 npc, depth, nscope, lcv, k;
+
+	p = profile_thread;
+	if(p == NULL)
+		return;
+
+	uc = (ucontext_t *)_context;
+
+	#if defined(__x86_64__)
+		pc[0] = uc->uc_mcontext.gregs[REG_RIP];
+		f = (char *)uc->uc_mcontext.gregs[REG_RBP];
+	#else
+		pc[0] = uc->uc_mcontext.gregs[REG_EIP];
+		f = (char *)uc->uc_mcontext.gregs[REG_EBP];
+	#endif
+
+	/* fp[k] is the frame of the function pc[k] is in, leave room for the scopes */
+	fp[0] = f;
+	npc = 1;
+	while((npc < PROFILE_DEPTH - PROFILE_SCOPES) && (f >= p->stack_lo) && (f + 2*sizeof(void *) <= p->stack_hi) &&
+		(((uintptr_t)f & (sizeof(void *) - 1)) == 0))
+	{
+		next = ((char **)f)[0];
+		pc[npc] = ((uintptr_t *)f)[1];
+
+		/* Frames only ever go up the stack, anything else is not a frame pointer */
+		if(next <= f)
+			break;
+
+		fp[npc++] = f = next;
+	}
+
+	/* Outermost first, each scope goes in after the frame it was opened in */
+	nscope = p->scope_depth;
+	depth = 0;
+	scopes = 0;
+	k = 0;
+	for(lcv = npc - 1; lcv >= 0; lcv--)
+	{
+		while((k < nscope) && (p->scope_fp[k] > fp[lcv]))
+		{
+			scopes |= 1 << depth;
+			frame[depth++] = (uintptr_t)p->scope[k++];
+		}
+		frame[depth++] = pc[lcv];
+	}
+	while(k < nscope)
+	{
+		scopes |= 1 << depth;
+		frame[depth++] = (uintptr_t)p->scope[k++];
+	}
+
+	hash = 2166136261u ^ scopes;
+	for(lcv = 0; lcv < depth; lcv++)
+		hash = (hash ^ (uint32)frame[lcv]) * 16777619u;
+
+	p->samples++;
+
+	for(lcv = 0; lcv < PROFILE_STACKS; lcv++)
+	{
+		slot = (hash + lcv) & (PROFILE_STACKS - 1);
+		s = &p->stacks[slot];
+
+		if(s->count == 0)
+		{
+			s->depth = depth;
+			s->scopes = scopes;
+			memcpy(s->frame, frame, depth*sizeof(uintptr_t));
+			s->count = 1;
+			return;
+		}
+
+		if((s->depth == depth) && (s->scopes == scopes) && (memcmp(s->frame, frame, depth*sizeof(uintptr_t)) == 0))
+		{
+			s->count++;
+			return;
+		}
+	}
+
+	p->dropped++;
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void Profile_Start_Thread(const char *_name)
+{
+	Profile_Thread_S *p;
+	struct sigaction act;
+	struct sigevent sev;
+	struct itimerspec its;
+	pthread_attr_t attr;
+	void *addr;
+	size_t len;
+	int32 slot;
+
+	if(gopt.profile <= 0)
+		return;
+
+	slot = __sync_fetch_and_add(&profile_count, 1);
+	if(slot >= PROFILE_THREADS)
+	{
+		fprintf(stderr,"Profiler: no room for %.8s\n", _name);
+		return;
+	}
+
+	p = new Profile_Thread_S;
+	memset(p, 0x0, sizeof(Profile_Thread_S));
+	strncpy(p->task_name, _name, 8);
+
+	if(pthread_getattr_np(pthread_self(), &attr) == 0)
+	{
+		pthread_attr_getstack(&attr, &addr, &len);
+		p->stack_lo = (char *)addr;
+		p->stack_hi = (char *)addr + len;
+		pthread_attr_destroy(&attr);
+	}
+
+	/* SA_RESTART, a profiling tick must not look like a stop request to anyone */
+	memset(&act, 0x0, sizeof(act));
+	act.sa_sigaction = Profile_Handler;
+	act.sa_flags = SA_SIGINFO | SA_RESTART;
+	sigemptyset(&act.sa_mask);
+	sigaction(SIGPROF, &act, NULL);
+
+	profile_thread = p;
+	profile_threads[slot] = p;
+
+	/* The clock only runs while this thread is on a cpu, so a sleeping thread is never woken. It is
+	 * checked on the scheduler tick, anything faster than the kernel HZ comes out at HZ */
+	memset(&sev, 0x0, sizeof(sev));
+	sev.sigev_notify = SIGEV_THREAD_ID;
+	sev.sigev_signo = SIGPROF;
+	sev.sigev_notify_thread_id = syscall(SYS_gettid);
+	if(timer_create(CLOCK_THREAD_CPUTIME_ID, &sev, &p->timer) != 0)
+	{
+		fprintf(stderr,"Profiler: timer_create failed for %.8s (%s)\n", _name, strerror(errno));
+		profile_thread = NULL;
+		return;
+	}
+
+	its.it_interval.tv_sec = 0;
+	its.it_interval.tv_nsec = 1000000000 / gopt.profile;
+	its.it_value = its.it_interval;
+	timer_settime(p->timer, 0, &its, NULL);
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+/*! Function name for a pc, return addresses are looked up at the call instruction */
+static void Profile_Symbol(FILE *_fp, uintptr_t _pc, int32 _return)
+{
+	Dl_info info;
+	char *name, *args;
+	int status;
+
+	if(_return)
+		_pc--;
+
+	if(dladdr((void *)_pc, &info) && (info.dli_sname != NULL))
+	{
+		name = abi::__cxa_demangle(info.dli_sname, NULL, NULL, &status);
+		if(name != NULL)
+		{
+			/* Flame graphs read better without the argument lists */
+			args = strchr(name, '(');
+			if(args != NULL)
+				*args = '\0';
+			fprintf(_fp, ";%s", name);
+			free(name);
+		}
+		else
+			fprintf(_fp, ";%s", info.dli_sname);
+	}
+	else if(dladdr((void *)_pc, &info) && (info.dli_fname != NULL))
+		fprintf(_fp, ";%s+0x%lx", strrchr(info.dli_fname, '/') ? strrchr(info.dli_fname, '/') + 1 : info.dli_fname,
+			(unsigned long)(_pc - (uintptr_t)info.dli_fbase));
+	else
+		fprintf(_fp, ";0x%lx", (unsigned long)_pc);
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void Profile_Dump(const char *_fname)
+{
+	Profile_Thread_S *p;
+	Profile_Stack_S *s;
+	FILE *fp;
+	uint32 samples, dropped;
+	int32 nthreads, lcv, slot, k, leaf;
+
+	nthreads = (profile_count < PROFILE_THREADS) ? profile_count : PROFILE_THREADS;
+	if(nthreads == 0)
+		return;
+
+	/* The threads have been joined, this only stops the caller's own timer firing under us */
+	for(lcv = 0; lcv < nthreads; lcv++)
+		if(profile_threads[lcv] != NULL)
+			timer_delete(profile_threads[lcv]->timer);
+	profile_thread = NULL;
+
+	fp = fopen(_fname, "wt");
+	if(fp == NULL)
+	{
+		fprintf(stderr,"Profiler: could not create %s\n", _fname);
+		return;
+	}
+
+	samples = dropped = 0;
+	for(lcv = 0; lcv < nthreads; lcv++)
+	{
+		p = profile_threads[lcv];
+		if(p == NULL)
+			continue;
+
+		samples += p->samples;
+		dropped += p->dropped;
+
+		for(slot = 0; slot < PROFILE_STACKS; slot++)
+		{
+			s = &p->stacks[slot];
+			if(s->count == 0)
+				continue;
+
+			/* Only the innermost pc is where the thread actually was */
+			leaf = -1;
+			for(k = 0; k < (int32)s->depth; k++)
+				if(!((s->scopes >> k) & 0x1))
+					leaf = k;
+
+			fprintf(fp, "%.8s", p->task_name);
+			for(k = 0; k < (int32)s->depth; k++)
+			{
+				if((s->scopes >> k) & 0x1)
+					fprintf(fp, ";[%s]", (const char *)s->frame[k]);
+				else
+					Profile_Symbol(fp, s->frame[k], k != leaf);
+			}
+			fprintf(fp, " %u\n", s->count);
+		}
+	}
+
+	fclose(fp);
+
+	fprintf(stdout,"Profiler: %u samples from %d threads in %s, %u dropped\n", samples, nthreads, _fname, dropped);
+}
+/*----------------------------------------------------------------------------------------------*/
+
+#endif /* PROFILE */
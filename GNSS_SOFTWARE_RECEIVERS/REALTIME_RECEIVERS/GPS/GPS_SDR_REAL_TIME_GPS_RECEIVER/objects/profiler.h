@@ -0,0 +1,116 @@
+/*----------------------------------------------------------------------------------------------*/
+/*! \file profiler.h
+//
+// FILENAME: profiler.h
+//
+// DESCRIPTION: Defines the built in sampling profiler, compiled in with make PROFILE=1
+//
+// DEVELOPERS: Gregory W. Heckler (2003-2009)
+//
+// LICENSE TERMS: Copyright (c) Gregory W. Heckler 2009
+//
+// This file is part of the GPS Software Defined Radio (GPS-SDR)
+//
+// The GPS-SDR is free software; you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation; either version 2 of
+// the License, or (at your option) any later version. The GPS-SDR is distributed in the hope that
+// it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// Note:  Comments within this file follow a syntax that is compatible with
+//        DOXYGEN and are utilized for automated document extraction
+//
+// Reference:
+*/
+/*----------------------------------------------------------------------------------------------*/
+
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+#define PROFILE_DEPTH		(32)	//!< Frames plus scopes kept per sample, at most 32
+#define PROFILE_SCOPES		(8)		//!< Nested PROFILE_SCOPE markers tracked per thread
+#define PROFILE_STACKS		(2048)	//!< Distinct stacks per thread, must be a power of 2
+#define PROFILE_THREADS		(32)	//!< Threads that can be profiled, restarts take a new one
+#define PROFILE_FILE		"gps-sdr.folded"	//!< Collapsed stacks, one "TASK;outer;...;leaf count" per line
+
+#ifdef PROFILE
+
+#include <stdint.h>
+#include <time.h>
+
+/*! One distinct stack, outermost frame first */
+typedef struct Profile_Stack_S
+{
+	uint32		count;					//!< Samples that landed here, 0 for a free slot
+	uint32		depth;					//!< Entries in frame
+	uint32		scopes;					//!< Bit n set when frame[n] is a scope name, not a pc
+	uintptr_t	frame[PROFILE_DEPTH];	//!< pcs and PROFILE_SCOPE names
+} Profile_Stack_S;
+
+/*! Everything the SIGPROF handler touches for one thread, only ever written by that thread */
+typedef struct Profile_Thread_S
+{
+	char				task_name[9];				//!< Root of every stack
+	char				*stack_lo;					//!< Bounds for the frame pointer walk
+	char				*stack_hi;
+	timer_t				timer;						//!< Thread CPU time timer raising SIGPROF
+	volatile uint32		scope_depth;				//!< Open PROFILE_SCOPEs
+	const char			*scope[PROFILE_SCOPES];		//!< Their names
+	char				*scope_fp[PROFILE_SCOPES];	//!< Frame each was opened in
+	uint32				samples;					//!< Ticks taken
+	uint32				dropped;					//!< Ticks that found the stack table full
+	Profile_Stack_S		stacks[PROFILE_STACKS];		//!< Open addressed on a hash of the stack
+} Profile_Thread_S;
+
+extern __thread Profile_Thread_S *profile_thread;	//!< This thread's samples, NULL when not profiled
+
+/*! Names the code it is declared in, so samples inside get the name as a frame even where there
+ *	is no frame pointer to walk (the SIMD kernels). Only exists in PROFILE builds. */
+class Profile_Scope
+{
+
+	private:
+
+		int32 pushed;
+
+	public:
+
+		Profile_Scope(const char *_name)
+		{
+			Profile_Thread_S *p = profile_thread;
+			uint32 d;
+
+			pushed = false;
+			if((p == NULL) || (p->scope_depth >= PROFILE_SCOPES))
+				return;
+
+			d = p->scope_depth;
+			p->scope[d] = _name;
+			p->scope_fp[d] = (char *)__builtin_frame_address(0);
+
+			/* The handler runs on this thread, it only needs the entry written before the depth */
+			__asm__ __volatile__("" ::: "memory");
+			p->scope_depth = d + 1;
+			pushed = true;
+		}
+
+		~Profile_Scope()
+		{
+			if(pushed)
+				profile_thread->scope_depth--;
+		}
+};
+
+#define PROFILE_SCOPE(_name)	Profile_Scope profile_scope(_name)
+
+void Profile_Start_Thread(const char *_name);	//!< Start sampling the calling thread at gopt.profile Hz
+void Profile_Dump(const char *_fname);			//!< Stop all the timers and write the collapsed stacks
+
+#else
+
+#define PROFILE_SCOPE(_name)
+
+#endif /* PROFILE */
+
+#endif /* PROFILER_H_ */
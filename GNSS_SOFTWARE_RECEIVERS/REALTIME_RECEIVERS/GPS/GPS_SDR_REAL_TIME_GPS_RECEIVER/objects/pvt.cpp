@@ -30,13 +30,17 @@
 void *PVT_Thread(void *_arg)
 {
 
-	while(grun)
+	while(pPVT->Running())
 	{
 		pPVT->Import();
+		if(!pPVT->Running())
+			break;
 		pPVT->Navigate();
 		pPVT->Export();
 	}
 
+	pthread_exit(0);
+
 }
 /*----------------------------------------------------------------------------------------------*/
 
@@ -70,6 +74,7 @@ PVT::PVT():Threaded_Object("PVTTASK")
 	object_mem = this;
 	size = sizeof(PVT);
 
+	last_tic = 0;
 	Reset();
 
 	master_nav.stale_ticks = STALE_SPS_VALUE;
@@ -85,11 +90,12 @@ void PVT::Import()
 {
 	int32 lcv;
 	int32 sv, chan;
-	uint32 bread;
 	Measurement_M temp;
 
-	/* Get number of channels coming off the pipe */
-	read(ISRP_2_PVT_P[READ], &preamble, sizeof(Preamble_2_PVT_S));
+	/* Wait for the next batch of measurements */
+	if(!ISRM_2_PVT_P->Receive(&isr_s))
+		return;
+	preamble = isr_s.preamble;
 
 	Lock();
 
@@ -109,7 +115,7 @@ void PVT::Import()
 	/* Initial set of nav_channels, gets refined in Error_Check() */
 	for(lcv = 0; lcv < MAX_CHANNELS; lcv++)
 	{
-		read(ISRM_2_PVT_P[READ], &temp, sizeof(Measurement_M));
+		temp = isr_s.measurements[lcv];
 
 		if(temp.navigate == true)
 		{
@@ -211,7 +217,6 @@ void PVT::PipeCheck()
 void PVT::Export()
 {
 	int32 lcv;
-	int32 integer_second;
 
 	master_nav.nsvs = 0;
 	for(lcv = 0; lcv < MAX_CHANNELS; lcv++)
@@ -238,22 +243,29 @@ void PVT::Export()
 	master_clock.tic = master_nav.tic;
 	tot.tic = master_nav.tic;
 
-	/* Note, this is some shady shit done to save SRAM !*/
-	memcpy(&tlm_s.sps, 			&master_nav, 		sizeof(SPS_M));
-	memcpy(&tlm_s.clock, 		&master_clock, 		sizeof(Clock_M));
-	memcpy(&tlm_s.sv_positions[0],&sv_positions[0],	sizeof(SV_Position_M)*MAX_CHANNELS);
-	memcpy(&tlm_s.pseudoranges[0],&pseudoranges[0], sizeof(Pseudorange_M)*MAX_CHANNELS);
-	memcpy(&tlm_s.measurements[0],&measurements[0], sizeof(Measurement_M)*MAX_CHANNELS);
-	memcpy(&tlm_s.tot, 			&tot,		 		sizeof(TOT_M));
-
-//	write(PVT_2_PPS_P[WRITE], &tlm_s, sizeof(PVT_2_PPS_S));
-	write(PVT_2_SVS_P[WRITE], &tlm_s, sizeof(PVT_2_SVS_S));
-	write(PVT_2_TLM_P[WRITE], &tlm_s, sizeof(PVT_2_TLM_S));
+	/* The telemetry and SV select stay at REPORT_RATE however fast the measurements come */
+	if((master_nav.tic % REPORT_DECIMATION) == 0)
+	{
+		/* Note, this is some shady shit done to save SRAM !*/
+		memcpy(&tlm_s.sps, 			&master_nav, 		sizeof(SPS_M));
+		memcpy(&tlm_s.clock, 		&master_clock, 		sizeof(Clock_M));
+		memcpy(&tlm_s.sv_positions[0],&sv_positions[0],	sizeof(SV_Position_M)*MAX_CHANNELS);
+		memcpy(&tlm_s.pseudoranges[0],&pseudoranges[0], sizeof(Pseudorange_M)*MAX_CHANNELS);
+		memcpy(&tlm_s.measurements[0],&measurements[0], sizeof(Measurement_M)*MAX_CHANNELS);
+		memcpy(&tlm_s.tot, 			&tot,		 		sizeof(TOT_M));
+
+//		write(PVT_2_PPS_P[WRITE], &tlm_s, sizeof(PVT_2_PPS_S));
+		PVT_2_SVS_P->TrySend((PVT_2_SVS_S *)&tlm_s);
+		PVT_2_TLM_P->Send(&tlm_s);
+	}
 
-	/* Send info to EKF aligned with the GPS second mod EKF_MOD */
-//	integer_second = (int32)floor(master_clock.time + .5);
-//	if((integer_second % EKF_UPDATE_PERIOD) == 0)
-//		write(&PVT_2_EKF_P, &tlm_s, sizeof(PVT_2_EKF_S), NU_NO_SUSPEND);
+	/* Every measurement epoch goes to the EKF, which must not hold up the PVT */
+	memcpy(&ekf_s.sps, 			&master_nav, 		sizeof(SPS_M));
+	memcpy(&ekf_s.clock, 		&master_clock, 		sizeof(Clock_M));
+	memcpy(&ekf_s.pseudoranges[0],&pseudoranges[0], sizeof(Pseudorange_M)*MAX_CHANNELS);
+	memcpy(&ekf_s.measurements[0],&measurements[0], sizeof(Measurement_M)*MAX_CHANNELS);
+	memcpy(&ekf_s.sv_positions[0],&sv_positions[0],	sizeof(SV_Position_M)*MAX_CHANNELS);
+	PVT_2_EKF_P->TrySend(&ekf_s);
 
 	Unlock();
 
@@ -268,8 +280,12 @@ void PVT::Export()
 void PVT::Navigate()
 {
 
-	double dt;
-	int32 lcv;
+	uint32 solved;
+	uint64 t0;
+
+	PROFILE_SCOPE("PVT::Navigate");
+
+	t0 = tsc_now();
 
 	/* Always tag nav sltn with current tic */
 	master_nav.tic = preamble.tic_measurement;
@@ -294,33 +310,24 @@ void PVT::Navigate()
 
 	if(PreErrorCheck())  //If everything looks good then navigate
 	{
-		/* Copy over master_nav to temp_nav */
-		memcpy(&temp_nav, &master_nav, sizeof(SPS_M));
-
-		/* This can be edited out to have PVT iterate from center of Earth */
-//		temp_nav.x = 0; temp_nav.y = 0; temp_nav.z = 0;
-//		temp_nav.vx = 0; temp_nav.vy = 0; temp_nav.vz = 0;
+		Weights();
 
 		/* Ummm Yeah, you need to do the point solution */
-		for(lcv = 0; lcv < PVT_ITERATIONS; lcv++)
-		{
-			FormModel();
-			dt = PVT_Estimation();
+		solved = PointSolution();
 
-			/* Break out if we are iterating from a previous position */
-			if((fabs(dt) < 1e-4) && temp_nav.converged)
-				break;
+		/* One exclusion an epoch, then solve again without it */
+		if(solved && gopt.pvt_weight && RAIM())
+		{
+			Weights();
+			solved = PointSolution();
 		}
 
-		master_nav.iterations = lcv;
-
-		if(PostErrorCheck())
+		if(solved)
 		{
 			master_nav.converged = true;
 			master_nav.converged_ticks++;
 			master_nav.stale_ticks = 0;
 
-			//SV_Elevations();
 			ClockUpdate();
 			LatLong();
 			DOP();
@@ -345,6 +352,8 @@ void PVT::Navigate()
 	/* Last step is to form time of tone packet */
 	UTCTime();
 
+	solve_hist.Add(tsc_now() - t0);
+
 }
 /*----------------------------------------------------------------------------------------------*/
 
@@ -353,7 +362,16 @@ void PVT::Navigate()
 void PVT::Update_Time()
 {
 
-	master_clock.receiver_time	+= SECONDS_PER_TICK * MEASUREMENT_MOD;
+	int32 tics;
+
+	/* The correlator drops epochs rather than wait on a PVT that fell behind, so count the tics
+	   that went by rather than the epochs that arrived */
+	tics = (int32)(preamble.tic_measurement - last_tic);
+	if((last_tic == 0) || (tics <= 0))
+		tics = MEASUREMENT_MOD;
+	last_tic = preamble.tic_measurement;
+
+	master_clock.receiver_time	+= SECONDS_PER_TICK * tics;
 	master_clock.time_raw 		= master_clock.time0 + master_clock.receiver_time;
 	master_clock.time 			= master_clock.time_raw - master_clock.bias;
 
@@ -508,28 +526,12 @@ void PVT::SV_Positions()
 {
 
 	int32 lcv;
-	int32 iter;
-	double dtemp, M, E, cE, sE, dEdM, P, U, R, I, cU, sU, Xp, Yp, L, sI, cI, sL, cL, ecc, s2P, c2P, toc;
-	double Edot, Pdot, Udot, Rdot, sUdot, cUdot, Xpdot, Ypdot, Idot, Ldot;
-	double Mdot, sqrt1mee;
-	double tk_p_toe, toe;
-	double dtk;
-	double tk;
-	double whole_sec, partial_sec;
 	double code_phase, code_time;
-	Ephemeris_M *e;
-	SV_Position_M *s;
 
 	for(lcv = 0; lcv < MAX_CHANNELS; lcv++)
 	{
 		if(good_channels[lcv])
 		{
-			e = &ephemerides[lcv];
-			s = &sv_positions[lcv];
-
-			/* Compute the difference, in seconds, between the epoch and wk & sec. */
-			toe = (double) e->toe;
-
 			/* Calculate the code phase */
 			code_phase = (double)(measurements[lcv].code_phase) * 1.0 +
 						 (double)(measurements[lcv].frac_code_phase) * TWO_N31;
@@ -539,118 +541,11 @@ void PVT::SV_Positions()
 						(double)(measurements[lcv]._20ms_epoch * .02) +
 						(double)(measurements[lcv]._1ms_epoch * .001);
 
-			/* Time of transmission is calculated directly tracking channel */
-			partial_sec = code_time - s->clock_bias;
-			whole_sec = (double)measurements[lcv].subframe_sec;
-
-			dtk = partial_sec + whole_sec;
-
-			tk = (double)(dtk - (double)toe);
-			tk_p_toe = (double)(dtk);
-
-			if (tk > HALF_OF_SECONDS_IN_WEEK)
-				tk -= SECONDS_IN_WEEK;
-			else if (tk < (-HALF_OF_SECONDS_IN_WEEK))
-				tk += SECONDS_IN_WEEK;
-
-			//Mean anomaly, M (rads).
-			Mdot = e->n0 + e->deltan;
-			M = e->m0 + Mdot * tk;
-
-			// Obtain eccentric anomaly E by solving Kepler's equation.
-			ecc = e->ecc;
-
-			sqrt1mee = sqrt (1.0 - ecc * ecc);
-			E = M;
-			for (iter = 0; iter < 20; iter++)
-			{
-				sE = sin(E); cE = cos(E);
-				dEdM = 1.0 / (1.0 - ecc * cE);
-				if (fabs (dtemp = (M - E + ecc * sE) * dEdM) < 1.0E-14)
-					break;
-				E += dtemp;
-			}
-
-			/* Compute the relativistic correction term (seconds). */
-			e->relativistic = (double)(-4.442807633E-10) * ecc * e->sqrta * sE;
-
-			Edot = dEdM * Mdot;
-
-			/* Compute the argument of latitude, P. */
-			P = atan2 (sqrt1mee * sE, cE - ecc) + e->argp;
-			Pdot = sqrt1mee * dEdM * Edot;
-
-			/* Generate harmonic correction terms for P and R. */
-			s2P = sin (2.0 * P);
-			c2P = cos (2.0 * P);
-
-			/* Compute the corrected argument of latitude, U. */
-			U = P + (e->cus * s2P + e->cuc * c2P);
-			sU = sin (U);
-			cU = cos (U);
-			Udot = Pdot * (1.0 + 2.0 * (e->cus * c2P - e->cuc * s2P));
-			sUdot = cU * Udot;
-			cUdot = -sU * Udot;
-
-			/* Compute the corrected radius, R. */
-			R = e->a * (1.0 - ecc * cE) + (e->crs * s2P +
-				e->crc * c2P);
-			Rdot = e->a * ecc * sE * Edot + 2.0 * Pdot
-				* (e->crs * c2P - e->crc * s2P);
-
-			/* Compute the corrected orbital inclination, I. */
-			I = e->in0 + e->idot * tk
-			+ (e->cis * s2P + e->cic * c2P);
-			sI = sin (I);
-			cI = cos (I);
-			Idot = e->idot + 2.0 * Pdot * (e->cis * c2P - e->cic * s2P);
-
-			/* Compute the satellite's position in its orbital plane, (Xp,Yp). */
-			Xp = R * cU;
-			Yp = R * sU;
-			Xpdot = Rdot * cU + R * cUdot;
-			Ypdot = Rdot * sU + R * sUdot;
-
-			/* Compute the longitude of the ascending node, L. */
-			L = e->om0 + tk * (e->omd - (double)WGS84OE) - (double)WGS84OE * e->toe;
-			Ldot = e->omd - (double)WGS84OE;
-			sL = sin (L);
-			cL = cos (L);
-
-			/* Compute the satellite's position in space, (x,y,z). */
-			s->x = Xp * cL - Yp * cI * sL;
-			s->y = Xp * sL + Yp * cI * cL;
-	        s->z = Yp * sI;
-
-
-	        /* Compute SV clock correction */
-			s->time = tk;
-			toc = e->toc;
-
-
-			s->clock_bias = e->af0 +
-													(e->af1 *(tk_p_toe - toc)) +
-													(e->af2 *(tk_p_toe - toc)*(tk_p_toe - toc)) +
-													e->relativistic;
-
-			s->clock_bias -= e->tgd;
-
-			s->frequency_bias = e->af1 + (e->af2 *(tk_p_toe - toc)*2.0);
-
-
-			/* Satellite's velocity, (vx,vy,vz). */
-			s->vx = -Ldot * (s->y)
-			+ Xpdot * cL
-			- Ypdot * cI * sL
-			+ Yp * sI * Idot * sL;
-
-			s->vy = Ldot * (s->x)
-			+ Xpdot * sL
-			+ Ypdot * cI * cL
-			- Yp * sI * Idot * cL;
-
-			s->vz = +Yp * cI * Idot
-			+ Ypdot * sI;
+			/* Time of transmission is calculated directly tracking channel, the orbit comes out
+			 * of the cache, which only goes back to the ephemeris every ORBIT_NODE_EPHEMERIS */
+			orbits[lcv].Set(&ephemerides[lcv]);
+			orbits[lcv].Position((double)measurements[lcv].subframe_sec + code_time - sv_positions[lcv].clock_bias,
+				&sv_positions[lcv]);
 
 		} //end if good channel
 	}	//end lcv
@@ -865,7 +760,7 @@ void PVT::ErrorCheckCrossCorr()
 {
 
 	int32 lcv, lcv2, cross, icn0;
-	float fcn0[MAX_CHANNELS];
+	Channel_Status_S chan;
 	double a, in0, ecc;
 
 	/* Get CN0s real quickly */
@@ -873,18 +768,17 @@ void PVT::ErrorCheckCrossCorr()
 	{
 		if(good_channels[lcv])
 		{
-			pChannels[lcv]->Lock();
-			icn0 = pChannels[lcv]->getCN0();
-			pChannels[lcv]->Unlock();
-			fcn0[lcv] = icn0;
-			//fcn0[lcv] = icn0_2_fcn0(icn0);
+			pChannels[lcv]->getStatus(&chan);
+			icn0 = chan.cn0;
+			cn0[lcv] = icn0;
+			//cn0[lcv] = icn0_2_fcn0(icn0);
 		}
 	}
 
 	/* Channel by channel resets */
 	for(lcv = 0; lcv < MAX_CHANNELS; lcv++)
 	{
-		if(good_channels[lcv] && (fcn0[lcv] > 40.0))
+		if(good_channels[lcv] && (cn0[lcv] > 40.0))
 		{
 
 			a = ephemerides[lcv].a;
@@ -896,7 +790,7 @@ void PVT::ErrorCheckCrossCorr()
 				if(lcv2 == lcv)
 					continue;
 
-				if(good_channels[lcv2] && (fcn0[lcv2] < 40.0))
+				if(good_channels[lcv2] && (cn0[lcv2] < 40.0))
 				{
 					cross = false;
 
@@ -916,9 +810,7 @@ void PVT::ErrorCheckCrossCorr()
 						pEphemeris->Lock();
 						pEphemeris->ClearEphemeris(master_sv[lcv2]);
 						pEphemeris->Unlock();
-						pChannels[lcv2]->Lock();
-						pChannels[lcv2]->Kill();
-						pChannels[lcv2]->Unlock();
+						pChannels[lcv2]->RequestKill();
 					}
 				}
 			}
@@ -969,89 +861,148 @@ void PVT::FormModel()
 
 
 /*----------------------------------------------------------------------------------------------*/
-double PVT::PVT_Estimation()
+void PVT::Weights()
 {
+	int32 lcv, nav_channels;
+	double sum;
 
-	int32 lcv, lcv2, lcv3;
-	int32 inv, nav_channels;
-	double D[MAX_CHANNELS];
-	double L[MAX_CHANNELS];
-	double sum, dt;
+	/* Elevations off the last fix, until there is one every SV is weighted as if overhead */
+	if(gopt.pvt_weight && master_nav.converged)
+		SV_Elevations();
 
+	sum = 0;
 	nav_channels = 0;
 	for(lcv = 0; lcv < MAX_CHANNELS; lcv++)
 	{
 		if(good_channels[lcv])
 		{
-			L[nav_channels] = pseudorangeres[lcv];
-			D[nav_channels] = pseudorangerateres[lcv];
-			alpha[nav_channels] = dircos[lcv];
+			if(!gopt.pvt_weight)
+				weight[lcv] = 1.0;
+			else if(master_nav.converged)
+				weight[lcv] = WLS::Weight(cn0[lcv], sv_positions[lcv].elev);
+			else
+				weight[lcv] = WLS::Weight(cn0[lcv], PI_OVER_2);
+
+			sum += weight[lcv];
 			nav_channels++;
 		}
 	}
 
-	/* Form alpha_2 = A'A */
-	for(lcv = 0; lcv < 4; lcv++)
+	/* Scale to a mean of 1 so the DOP stays comparable to the unweighted one */
+	weight_scale = 1.0;
+	if(gopt.pvt_weight && (sum > 0))
 	{
-		for(lcv2 = 0; lcv2 < 4; lcv2++)
-		{
-			sum = 0;
-			for(lcv3 = 0; lcv3 < nav_channels; lcv3++)
-				sum += alpha[lcv3][lcv]*alpha[lcv3][lcv2];
-			alpha_2[lcv][lcv2] = sum;
-		}
+		weight_scale = sum/nav_channels;
+		for(lcv = 0; lcv < MAX_CHANNELS; lcv++)
+			if(good_channels[lcv])
+				weight[lcv] /= weight_scale;
+	}
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+uint32 PVT::PointSolution()
+{
+	double dt;
+	int32 lcv;
+
+	/* Copy over master_nav to temp_nav */
+	memcpy(&temp_nav, &master_nav, sizeof(SPS_M));
+
+	/* This can be edited out to have PVT iterate from center of Earth */
+//	temp_nav.x = 0; temp_nav.y = 0; temp_nav.z = 0;
+//	temp_nav.vx = 0; temp_nav.vy = 0; temp_nav.vz = 0;
+
+	factored = false;
+	singular = false;
+	for(lcv = 0; lcv < PVT_ITERATIONS; lcv++)
+	{
+		FormModel();
+		dt = PVT_Estimation();
+
+		if(singular)
+			break;
+
+		/* Break out if we are iterating from a previous position */
+		if((fabs(dt) < 1e-4) && temp_nav.converged)
+			break;
 	}
 
-	/* Invert alpha_2 */
-	inv = Invert4x4(alpha_2, alpha_inv);
+	master_nav.iterations = lcv;
+
+	if(!PostErrorCheck())
+		return(false);
+
+	/* One covariance for both DOP() and RAIM() */
+	wls.Covariance();
+
+	return(true);
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
 
-	/* alpha_pinv = inv(A'A)*A' */
-	for(lcv = 0; lcv < 4; lcv++)
+/*----------------------------------------------------------------------------------------------*/
+double PVT::PVT_Estimation()
+{
+
+	int32 lcv, nav_channels;
+	double H[MAX_CHANNELS][4];
+	double W[MAX_CHANNELS];
+	double D[MAX_CHANNELS];
+	double L[MAX_CHANNELS];
+	double dv[4];
+	double dx, dy, dz;
+
+	nav_channels = 0;
+	for(lcv = 0; lcv < MAX_CHANNELS; lcv++)
 	{
-		for(lcv2 = 0; lcv2 < nav_channels; lcv2++)
+		if(good_channels[lcv])
 		{
-			sum = 0;
-			for(lcv3 = 0; lcv3 < 4; lcv3++)
-				sum += alpha_inv[lcv][lcv3]*alpha[lcv2][lcv3];
-			alpha_pinv[lcv][lcv2] = sum;
+			L[nav_channels] = pseudorangeres[lcv];
+			D[nav_channels] = pseudorangerateres[lcv];
+			W[nav_channels] = weight[lcv];
+			memcpy(H[nav_channels], dircos[lcv], 4*sizeof(double));
+			nav_channels++;
 		}
 	}
 
-	/* Estimate Postion and Clock Bias Updates */
-	//dR = A_pinv*L;
-	for(lcv = 0; lcv < 4; lcv++)
+	/* Iterating from the last fix the geometry barely moves, so one factor does the whole epoch */
+	dx = temp_nav.x - factor_at[0];
+	dy = temp_nav.y - factor_at[1];
+	dz = temp_nav.z - factor_at[2];
+	if(!factored || ((dx*dx + dy*dy + dz*dz) > PVT_REFACTOR*PVT_REFACTOR))
 	{
-		sum = 0;
-		for(lcv2 = 0; lcv2 < nav_channels; lcv2++)
-			sum += alpha_pinv[lcv][lcv2]*L[lcv2];
-		dr[lcv] = sum;
+		factored = wls.Factor(H, W, nav_channels);
+		if(!factored)
+		{
+			singular = true;
+			return(0);
+		}
+
+		factor_at[0] = temp_nav.x;
+		factor_at[1] = temp_nav.y;
+		factor_at[2] = temp_nav.z;
 	}
 
+	/* Position and clock bias updates, and velocity and clock rate updates, off the same factor */
+	wls.Solve(H, W, L, D, nav_channels, dr, dv);
+
 	/* Update Postion and Clock Bias */
 	temp_nav.x += dr[0];
 	temp_nav.y += dr[1];
 	temp_nav.z += dr[2];
 	temp_nav.clock_bias += dr[3];
 
-	dt = dr[3];
-
-	/* Estimate Velocity and Clock Rate Updates	 */
-	//dR = A_pinv*D
-	for(lcv = 0; lcv < 4; lcv++)
-	{
-		sum = 0;
-		for(lcv2 = 0; lcv2 < nav_channels; lcv2++)
-			sum += alpha_pinv[lcv][lcv2]*D[lcv2];
-		dr[lcv] = sum;
-	}
-
 	/* Update Velocity and Clock Rate */
-	temp_nav.vx += dr[0];
-	temp_nav.vy += dr[1];
-	temp_nav.vz += dr[2];
-	temp_nav.clock_rate += dr[3];
+	temp_nav.vx += dv[0];
+	temp_nav.vy += dv[1];
+	temp_nav.vz += dv[2];
+	temp_nav.clock_rate += dv[3];
 
-	return(dt);
+	return(dr[3]);
 
 }
 /*----------------------------------------------------------------------------------------------*/
@@ -1061,6 +1012,10 @@ double PVT::PVT_Estimation()
 uint32 PVT::PostErrorCheck()
 {
 
+	/* The geometry would not factor */
+	if(singular)
+		return(false);
+
 	/* Catch any serious errors */
 	if(isnan(temp_nav.x) || isnan(temp_nav.y) || isnan(temp_nav.z))
 		return(false);
@@ -1125,35 +1080,67 @@ void PVT::Residuals()
 {
 
 	int32 lcv;
-	double range, dx, dy, dz, relvel;
 
-	/* Pseudorange Residuals */
+	/* The model at the solution, which also leaves dircos there for RAIM() */
+	FormModel();
+
 	for(lcv = 0; lcv < MAX_CHANNELS; lcv++)
 	{
 		if(good_channels[lcv])
 		{
-			range      =  	sqrt(	(temp_nav.x - sv_positions[lcv].x)*(temp_nav.x - sv_positions[lcv].x) +
-						   			(temp_nav.y - sv_positions[lcv].y)*(temp_nav.y - sv_positions[lcv].y) +
-						   			(temp_nav.z - sv_positions[lcv].z)*(temp_nav.z - sv_positions[lcv].z)	);
+			pseudoranges[lcv].residual = pseudorangeres[lcv];
+			pseudoranges[lcv].residual_rate = pseudorangerateres[lcv];
+		}
+	}
 
+}
+/*----------------------------------------------------------------------------------------------*/
 
-			pseudoranges[lcv].residual = pseudoranges[lcv].meters - (range + temp_nav.clock_bias - sv_positions[lcv].clock_bias*SPEED_OF_LIGHT);
 
-			range = 1.0 / range;
+/*----------------------------------------------------------------------------------------------*/
+uint32 PVT::RAIM()
+{
+	int32 lcv, worst, nav_channels;
+	double red, test, max;
 
-			dx = (temp_nav.x - sv_positions[lcv].x) * range;
-			dy = (temp_nav.y - sv_positions[lcv].y) * range;
-			dz = (temp_nav.z - sv_positions[lcv].z) * range;
+	nav_channels = 0;
+	for(lcv = 0; lcv < MAX_CHANNELS; lcv++)
+		if(good_channels[lcv])
+			nav_channels++;
 
-			relvel	 = 	dx * (temp_nav.vx - sv_positions[lcv].vx) +
-				      			dy * (temp_nav.vy - sv_positions[lcv].vy) +
-				      			dz * (temp_nav.vz - sv_positions[lcv].vz);
+	if(nav_channels < PVT_RAIM_CHANNELS)
+		return(false);
 
-			pseudoranges[lcv].residual_rate = pseudoranges[lcv].meters_rate - (relvel + temp_nav.clock_rate - sv_positions[lcv].frequency_bias*SPEED_OF_LIGHT);
+	/* Each residual against its own sigma and the share of it the fit could not absorb */
+	worst = -1;
+	max = PVT_RAIM_THRESHOLD;
+	for(lcv = 0; lcv < MAX_CHANNELS; lcv++)
+	{
+		if(good_channels[lcv])
+		{
+			red = wls.Redundancy(dircos[lcv], weight[lcv]);
 
+			/* The fix rests on this SV alone, its residual says nothing */
+			if(red < 1e-6)
+				continue;
+
+			test = fabs(pseudoranges[lcv].residual)*sqrt(weight[lcv]*weight_scale)/(PVT_SIGMA*sqrt(red));
+			if(test > max)
+			{
+				max = test;
+				worst = lcv;
+			}
 		}
 	}
 
+	if(worst < 0)
+		return(false);
+
+	sv_codes[worst] = PVT_ERROR_PSEUDO;
+	good_channels[worst] = false;
+
+	return(true);
+
 }
 /*----------------------------------------------------------------------------------------------*/
 
@@ -1252,29 +1239,13 @@ void PVT::LatLong()
 /*----------------------------------------------------------------------------------------------*/
 void PVT::DOP()
 {
-	int32 lcv, lcv2, nav_channels;
-
 	double gdop, pdop, tdop;
 
-	nav_channels = 0;
-	for(lcv = 0; lcv < MAX_CHANNELS; lcv++)
-	{
-		if(good_channels[lcv])
-		{
-			nav_channels++;
-		}
-	}
-
-	/* Position DOP */
-	pdop = 0.0;
-	for (lcv = 0; lcv < 3; lcv++)
-		for (lcv2 = 0; lcv2 < nav_channels; lcv2++)
-			pdop += alpha_pinv[lcv][lcv2]*alpha_pinv[lcv][lcv2];
+	/* Off the diagonal of (H'WH)^-1, the geometry alone when the weights are all 1 */
+	pdop = wls.Trace(0, 3);
 
 	/* Time DOP */
-	tdop = 0.0;
-	for (lcv2 = 0; lcv2 < nav_channels; lcv2++)
-		tdop += alpha_pinv[3][lcv2]*alpha_pinv[3][lcv2];
+	tdop = wls.Trace(3, 4);
 
 	/* GDOP */
 	gdop = pdop + tdop;
@@ -1343,6 +1314,7 @@ void PVT::ResetChannel(int32 _chan)
 	memset(&sv_positions[_chan], 0x0, sizeof(SV_Position_M));
 	memset(&pseudoranges[_chan], 0x0, sizeof(Pseudorange_M));
 	memset(&ephemerides[_chan],  0x0, sizeof(Ephemeris_M));
+	orbits[_chan].Flush();
 
 	good_channels[_chan] = false;
 
@@ -31,6 +31,8 @@
 #include "includes.h"
 #include "ephemeris.h"
 #include "channel.h"
+#include "wls.h"
+#include "orbit.h"
 
 enum PVT_CLOCK_STATE
 {
@@ -50,7 +52,7 @@ enum PVT_ERROR_CODES
 };
 
 /*! @ingroup CLASSES
-	@brief Performs least squares point solution.
+	@brief Performs (weighted) least squares point solution.
 */
 class PVT : public Threaded_Object
 {
@@ -62,6 +64,7 @@ class PVT : public Threaded_Object
 		/* Satellite related stuff */
 		Ephemeris_M		ephemerides[MAX_CHANNELS];				//!< Decoded ephemerides
 		SV_Position_M	sv_positions[MAX_CHANNELS];				//!< Calculated SV positions
+		Orbit			orbits[MAX_CHANNELS];					//!< Interpolated orbits off the ephemerides
 		Pseudorange_M	pseudoranges[MAX_CHANNELS];				//!< Pseudoranges
 		Measurement_M	measurements[MAX_CHANNELS];				//!< Raw measurements
 
@@ -77,19 +80,27 @@ class PVT : public Threaded_Object
 		TOT_M tot;												//!< Time of tone message
 		UTC_Parameter_S utc;									//!< UTC parameter
 		Preamble_2_PVT_S preamble;								//!< Preamble from tracking isr
-		PVT_2_TLM_S tlm_s;										//!< Dump stuff to telemetry, sv_select, pps, and ekf
+		uint32 last_tic;										//!< tic_measurement of the previous epoch, 0 before the first
+		ISR_2_PVT_S isr_s;										//!< Preamble and measurements from tracking isr
+		PVT_2_TLM_S tlm_s;										//!< Dump stuff to telemetry, sv_select, and pps
+		PVT_2_EKF_S ekf_s;										//!< Measurements and SV positions for the ekf
 
 		/* Matrices used in nav solution */
-		double *alpha[MAX_CHANNELS];
-		double alpha_2[4][4];
-		double alpha_inv[4][4];
-		double alpha_pinv[4][MAX_CHANNELS];
+		WLS wls;												//!< Factor of the geometry, reused by DOP() and RAIM()
+		int32 factored;											//!< wls holds a factor of the current channel set
+		int32 singular;											//!< The geometry would not factor this epoch
+		double factor_at[3];									//!< Position the factor was formed at
+		double weight[MAX_CHANNELS];							//!< Measurement weights, mean of 1 over the good channels
+		double weight_scale;									//!< What the weights were divided by to get that mean
+		float cn0[MAX_CHANNELS];								//!< C/N0 of each channel this epoch
 
 		double dircos[MAX_CHANNELS][4];
 		double pseudorangeres[MAX_CHANNELS];					//!< Pseudorange residuals
 		double pseudorangerateres[MAX_CHANNELS];				//!< Pseudorange rate residuals
 		double dr[4];
 
+		Histogram solve_hist;									//!< Time spent in Navigate()
+
 	public:
 
 		PVT();
@@ -98,6 +109,7 @@ class PVT : public Threaded_Object
 		void Import();							//!< Get data into the thread
 		void Export();							//!< Get data out of the thread
 		void PipeCheck();						//!< Make sure the pipes are EMPTY
+		Histogram *getSolveHist(){return(&solve_hist);}	//!< Get the solve time histogram
 
 		void Navigate();						//!< main navigation task, call the following tabbed functions
 			void ProjectState();				//!< project state to current measurement epoch
@@ -109,6 +121,9 @@ class PVT : public Threaded_Object
 			void SV_Correct();					//!< correct SV positions for transit time
 			void PseudoRange();					//!< calculate the pseudo ranges
 			void FormModel();					//!< form direction cosine matrix and prediction residuals
+			void Weights();						//!< weight each good channel, all 1 without -W
+			uint32 PointSolution();				//!< iterate the least squares from master_nav and check it
+			uint32 RAIM();						//!< exclude the worst channel if its residual fails the test
 			uint32 PreErrorCheck();				//!< check all SV's for bad measurements, etc
 			void ErrorCheckCrossCorr();			//!< check for cross-correlation problem via ephemeris match
 			uint32 PostErrorCheck();			//!< check all SV's for bad measurements, etc
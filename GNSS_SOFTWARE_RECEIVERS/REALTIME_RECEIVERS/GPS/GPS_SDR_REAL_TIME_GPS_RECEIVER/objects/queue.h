@@ -0,0 +1,264 @@
+/*----------------------------------------------------------------------------------------------*/
+/*! \file queue.h
+//
+// FILENAME: queue.h
+//
+// DESCRIPTION: Defines the bounded message queues that connect the threads.
+//
+// DEVELOPERS: Gregory W. Heckler (2003-2009)
+//
+// LICENSE TERMS: Copyright (c) Gregory W. Heckler 2009
+//
+// This file is part of the GPS Software Defined Radio (GPS-SDR)
+//
+// The GPS-SDR is free software; you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation; either version 2 of
+// the License, or (at your option) any later version. The GPS-SDR is distributed in the hope that
+// it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// Note:  Comments within this file follow a syntax that is compatible with
+//        DOXYGEN and are utilized for automated document extraction
+//
+// Reference:
+*/
+/*----------------------------------------------------------------------------------------------*/
+
+#ifndef QUEUE_H_
+#define QUEUE_H_
+
+/* Pulled in by includes.h ahead of globals.h, so only lean on the system headers, defines.h and histogram.h */
+#include <errno.h>
+#include <string.h>
+#include <semaphore.h>
+#include <sched.h>
+#include <sys/time.h>
+#include <time.h>
+
+/*! \ingroup CLASSES
+ *	@brief Bounded queue of messages of type T, N a power of 2. Slots are claimed and published with
+ *	atomics, so a message costs two copies and no syscalls unless a thread has to sleep. The two
+ *	counting semaphores (free slots, full slots) provide the blocking and timed variants, the same
+ *	scheme as the FIFO. MULTI allows several producer threads; there is always a single consumer.
+ *	The blocking receives leave the send time in queue_stamp, Threaded_Object turns it into the
+ *	task's wake up latency. Close() wakes everything blocked on the queue for a shutdown, from then
+ *	on the blocking calls return false straight away. A consumer that serves other queues or files
+ *	too can hand the queue an Event with setNotify() and sleep on that instead.
+ */
+template <class T, int32 N, int32 MULTI> class Queue
+{
+
+	private:
+
+		T buff[N];					//!< Messages
+		volatile uint32 seq[N];		//!< seq[i] == n+1 once message n is in slot i
+		uint64 stamp[N];			//!< TSC when each message was sent
+		volatile uint32 head;		//!< Next message to receive
+		volatile uint32 tail;		//!< Next message to send
+		sem_t sem_full;				//!< Messages ready
+		sem_t sem_empty;			//!< Free slots
+		uint32 dropped;				//!< TrySend calls that found the queue full
+		volatile int32 closed;		//!< Set by Close(), nothing blocks any more
+		Event *notify;				//!< Signalled for every message, NULL if nobody sleeps on an Event
+
+		//!< Sleep on a semaphore, returns false if the queue was closed meanwhile
+		int32 Wait(sem_t *_sem)
+		{
+			while(sem_wait(_sem) != 0)
+				if(closed)
+					return(false);
+
+			/* Pass the wake up on to the next caller */
+			if(closed)
+			{
+				sem_post(_sem);
+				return(false);
+			}
+
+			return(true);
+		}
+
+		void Put(const T *_msg)
+		{
+			uint32 n;
+
+			if(MULTI)
+				n = __sync_fetch_and_add(&tail, 1);
+			else
+				n = tail++;
+
+			memcpy(&buff[n & (N-1)], _msg, sizeof(T));
+			stamp[n & (N-1)] = tsc_now();
+			__sync_synchronize();
+			seq[n & (N-1)] = n + 1;
+
+			sem_post(&sem_full);
+
+			if(notify != NULL)
+				notify->Signal();
+		}
+
+		uint64 Get(T *_msg)
+		{
+			uint64 sent;
+			uint32 n;
+
+			/* With several producers the slot may be claimed but not yet filled */
+			n = head;
+			while(seq[n & (N-1)] != n + 1)
+				sched_yield();
+
+			__sync_synchronize();
+			memcpy(_msg, &buff[n & (N-1)], sizeof(T));
+			sent = stamp[n & (N-1)];
+			head = n + 1;
+
+			sem_post(&sem_empty);
+
+			return(sent);
+		}
+
+	public:
+
+		Queue()
+		{
+			int32 lcv;
+
+			for(lcv = 0; lcv < N; lcv++)
+				seq[lcv] = 0;
+
+			head = tail = dropped = 0;
+			closed = false;
+			notify = NULL;
+			sem_init(&sem_full, 0, 0);
+			sem_init(&sem_empty, 0, N);
+		}
+
+		~Queue()
+		{
+			sem_destroy(&sem_full);
+			sem_destroy(&sem_empty);
+		}
+
+		//!< Send, sleep while the queue is full, returns false if the queue was closed
+		int32 Send(const T *_msg)
+		{
+			if(!Wait(&sem_empty))
+				return(false);
+			Put(_msg);
+			return(true);
+		}
+
+		//!< Send if there is room, returns false (and counts a drop) otherwise
+		int32 TrySend(const T *_msg)
+		{
+			if(sem_trywait(&sem_empty) != 0)
+			{
+				dropped++;
+				return(false);
+			}
+			Put(_msg);
+			return(true);
+		}
+
+		//!< Receive, sleep until a message arrives, returns false if the queue was closed
+		int32 Receive(T *_msg)
+		{
+			if(!Wait(&sem_full))
+				return(false);
+			queue_stamp = Get(_msg);
+			return(true);
+		}
+
+		//!< Receive if a message is waiting, returns false otherwise. _sent gets the send time
+		int32 TryReceive(T *_msg, uint64 *_sent = NULL)
+		{
+			uint64 sent;
+
+			if(sem_trywait(&sem_full) != 0)
+				return(false);
+
+			/* That was the wake up from Close(), not a message */
+			if(closed)
+			{
+				sem_post(&sem_full);
+				return(false);
+			}
+
+			sent = Get(_msg);
+			if(_sent != NULL)
+				*_sent = sent;
+			return(true);
+		}
+
+		//!< Receive, sleep at most _usec, returns false on a timeout
+		int32 TimedReceive(T *_msg, int32 _usec)
+		{
+			struct timespec ts;
+
+			clock_gettime(CLOCK_REALTIME, &ts);
+			ts.tv_sec += _usec / 1000000;
+			ts.tv_nsec += (_usec % 1000000) * 1000;
+			if(ts.tv_nsec >= 1000000000)
+			{
+				ts.tv_sec++;
+				ts.tv_nsec -= 1000000000;
+			}
+
+			while(sem_timedwait(&sem_full, &ts) != 0)
+				if((errno != EINTR) || closed)
+					return(false);
+
+			if(closed)
+			{
+				sem_post(&sem_full);
+				return(false);
+			}
+
+			queue_stamp = Get(_msg);
+			return(true);
+		}
+
+		//!< Throw away everything queued
+		void Flush()
+		{
+			T msg;
+
+			while(TryReceive(&msg))
+				;
+		}
+
+		//!< Release every thread sleeping in Send/Receive, for good
+		void Close()
+		{
+			closed = true;
+			sem_post(&sem_full);
+			sem_post(&sem_empty);
+
+			if(notify != NULL)
+				notify->Signal();
+		}
+
+		//!< Signal _event for each message from now on, the consumer then sleeps on _event
+		void setNotify(Event *_event){notify = _event;}
+
+		uint32 getDropped(){return(dropped);}
+		uint32 getCount(){return(tail - head);}	//!< Messages waiting, exact when one thread does both ends
+};
+
+
+/*! \ingroup CLASSES
+ *	@brief Single producer, single consumer queue */
+template <class T, int32 N> class SPSC_Queue : public Queue<T, N, 0>
+{
+};
+
+
+/*! \ingroup CLASSES
+ *	@brief Multiple producer, single consumer queue */
+template <class T, int32 N> class MPSC_Queue : public Queue<T, N, 1>
+{
+};
+
+#endif /* QUEUE_H_ */
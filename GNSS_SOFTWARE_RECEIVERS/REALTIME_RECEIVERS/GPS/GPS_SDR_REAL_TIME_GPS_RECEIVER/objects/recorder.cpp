@@ -0,0 +1,294 @@
+/*----------------------------------------------------------------------------------------------*/
+/*! \file recorder.cpp
+//
+// FILENAME: recorder.cpp
+//
+// DESCRIPTION: Implements member functions of the Recorder class.
+//
+// DEVELOPERS: Gregory W. Heckler (2003-2009)
+//
+// LICENSE TERMS: Copyright (c) Gregory W. Heckler 2009
+//
+// This file is part of the GPS Software Defined Radio (GPS-SDR)
+//
+// The GPS-SDR is free software; you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation; either version 2 of
+// the License, or (at your option) any later version. The GPS-SDR is distributed in the hope that
+// it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// Note:  Comments within this file follow a syntax that is compatible with
+//        DOXYGEN and are utilized for automated document extraction
+//
+// Reference:
+*/
+/*----------------------------------------------------------------------------------------------*/
+
+#include "recorder.h"
+#include "fifo.h"
+
+/*----------------------------------------------------------------------------------------------*/
+void *Recorder_Thread(void *_arg)
+{
+
+	Recorder *aRecorder = pRecorder;
+
+	while(aRecorder->Running())
+	{
+		aRecorder->Import();
+		aRecorder->IncExecTic();
+		aRecorder->Pause(10000);
+	}
+
+	pthread_exit(0);
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void Recorder::Start()
+{
+
+	Start_Thread(Recorder_Thread, NULL);
+
+	if(gopt.verbose)
+		fprintf(stdout,"Recorder thread started\n");
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+Recorder::Recorder(const char *_path, int32 _antennas, int32 _compress):Threaded_Object("RECTASK")
+{
+
+	const char *names[MAX_ANTENNAS] = {"data.dba", "data.dbb"};
+	char fname[1024];
+	int32 lcv;
+
+	antennas = _antennas;
+	if(antennas > MAX_ANTENNAS)
+		antennas = MAX_ANTENNAS;
+
+	head = tail = pushed = 0;
+	written = dropped = stale = late = errors = 0;
+	max_write = 0;
+	block_ms = 0;
+	direct = 1;
+	ifz = NULL;
+
+	for(lcv = 0; lcv < MAX_ANTENNAS; lcv++)
+	{
+		fd[lcv] = -1;
+		block[lcv] = NULL;
+	}
+
+	if(_compress)
+	{
+		snprintf(fname, 1024, "%s/data.ifz", _path);
+		ifz = new IF_Writer(fname, antennas);
+		direct = 0;
+
+		if(ifz->isOpen())
+			fprintf(stdout,"%s opened\n", fname);
+		else
+			fprintf(stdout,"Could not open %s for recording\n", fname);
+	}
+
+	for(lcv = 0; lcv < antennas; lcv++)
+	{
+		if(posix_memalign((void **)&block[lcv], RECORDER_ALIGN, RECORDER_BLOCK_MS*SAMPS_MS*sizeof(CPX)))
+			block[lcv] = NULL;
+
+		if(ifz != NULL)
+			continue;
+
+		snprintf(fname, 1024, "%s/%s", _path, names[lcv]);
+
+		/* tmpfs and friends refuse O_DIRECT, fall back to the page cache */
+		fd[lcv] = open(fname, O_WRONLY | O_CREAT | O_TRUNC | O_LARGEFILE | O_DIRECT, 0644);
+		if((fd[lcv] < 0) && (errno == EINVAL))
+		{
+			fd[lcv] = open(fname, O_WRONLY | O_CREAT | O_TRUNC | O_LARGEFILE, 0644);
+			direct = 0;
+		}
+
+		if((fd[lcv] >= 0) && (block[lcv] != NULL))
+			fprintf(stdout,"%s opened%s\n", fname, direct ? " (O_DIRECT)" : "");
+		else
+			fprintf(stdout,"Could not open %s for recording\n", fname);
+	}
+
+	fflush(stdout);
+
+	if(gopt.verbose)
+		fprintf(stdout,"Creating Recorder\n");
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+Recorder::~Recorder()
+{
+	int32 lcv;
+
+	/* The FIFO is stopped but its buffer is still around, get whatever is left */
+	Import();
+	if(block_ms)
+		Write();
+
+	for(lcv = 0; lcv < antennas; lcv++)
+	{
+		if(fd[lcv] >= 0)
+			close(fd[lcv]);
+		if(block[lcv] != NULL)
+			free(block[lcv]);
+	}
+
+	fprintf(stdout,"Recorder: %u blocks written, %u dropped, %u stale, %u late, %u errors, %.1f ms max write\n",
+		written, dropped, stale, late, errors, max_write);
+
+	if(ifz != NULL)
+	{
+		fprintf(stdout,"Recorder: compressed %.2f:1\n", ifz->getRatio());
+		delete ifz;
+	}
+	fflush(stdout);
+
+	if(gopt.verbose)
+		fprintf(stdout,"Destructing Recorder\n");
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void Recorder::Push(ms_packet *_p)
+{
+	uint32 s;
+	uint32 lcv;
+
+	s = pushed;
+
+	if((tail - head) >= RECORDER_QUEUE)
+	{
+		dropped++;
+	}
+	else
+	{
+		lcv = tail & (RECORDER_QUEUE-1);
+		queue[lcv] = _p;
+		seq[lcv] = s;
+		__sync_synchronize();
+		tail = tail + 1;
+	}
+
+	/* Publish before the source can start refilling an older packet */
+	pushed = s + 1;
+	__sync_synchronize();
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void Recorder::Import()
+{
+	ms_packet *p;
+	uint32 s;
+	uint32 lcv;
+	int32 a;
+
+	IncStartTic();
+
+	while(head != tail)
+	{
+		__sync_synchronize();
+		lcv = head & (RECORDER_QUEUE-1);
+		p = queue[lcv];
+		s = seq[lcv];
+
+		for(a = 0; a < antennas; a++)
+			if(block[a] != NULL)
+				memcpy(&block[a][block_ms*SAMPS_MS], &p->data[a][0], SAMPS_MS*sizeof(CPX));
+
+		/* The FIFO reuses a packet FIFO_DEPTH reads later, if the source got that far
+		 * during the copy the copy is torn and must not hit the disk */
+		__sync_synchronize();
+		if((pushed - s) >= (FIFO_DEPTH - 1))
+			stale++;
+		else
+			block_ms++;
+
+		__sync_synchronize();
+		head = head + 1;
+
+		if(block_ms == RECORDER_BLOCK_MS)
+			Write();
+	}
+
+	IncStopTic();
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void Recorder::Write()
+{
+	struct timeval t0, t1;
+	double ms;
+	char *b;
+	int32 lcv, bytes, nbytes;
+
+	gettimeofday(&t0, NULL);
+
+	if(ifz != NULL)
+	{
+		for(lcv = 0; lcv < block_ms; lcv++)
+			ifz->Write(&block[0][lcv*SAMPS_MS], (antennas > 1) ? &block[1][lcv*SAMPS_MS] : NULL);
+	}
+
+	for(lcv = 0; lcv < antennas; lcv++)
+	{
+		if((fd[lcv] < 0) || (block[lcv] == NULL))
+			continue;
+
+		/* Any whole number of ms is a multiple of RECORDER_ALIGN, so partial blocks are fine too */
+		b = (char *)block[lcv];
+		bytes = block_ms*SAMPS_MS*sizeof(CPX);
+		while(bytes > 0)
+		{
+			nbytes = write(fd[lcv], b, bytes);
+			if(nbytes < 0)
+			{
+				if(errno == EINTR)
+					continue;
+
+				fprintf(stdout,"Recorder write failed: %s\n", strerror(errno));
+				close(fd[lcv]);
+				fd[lcv] = -1;
+				errors++;
+				break;
+			}
+			b += nbytes;
+			bytes -= nbytes;
+		}
+	}
+
+	gettimeofday(&t1, NULL);
+
+	/* A block has to reach the disk faster than it was sampled */
+	ms = 1e3*(t1.tv_sec - t0.tv_sec) + 1e-3*(t1.tv_usec - t0.tv_usec);
+	if(ms > block_ms)
+		late++;
+	if(ms > max_write)
+		max_write = ms;
+
+	written++;
+	block_ms = 0;
+
+}
+/*----------------------------------------------------------------------------------------------*/
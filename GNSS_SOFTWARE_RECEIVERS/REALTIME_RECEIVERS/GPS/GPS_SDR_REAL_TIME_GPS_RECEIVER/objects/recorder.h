@@ -0,0 +1,89 @@
+/*----------------------------------------------------------------------------------------------*/
+/*! \file recorder.h
+//
+// FILENAME: recorder.h
+//
+// DESCRIPTION: Defines the Recorder class.
+//
+// DEVELOPERS: Gregory W. Heckler (2003-2009)
+//
+// LICENSE TERMS: Copyright (c) Gregory W. Heckler 2009
+//
+// This file is part of the GPS Software Defined Radio (GPS-SDR)
+//
+// The GPS-SDR is free software; you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation; either version 2 of
+// the License, or (at your option) any later version. The GPS-SDR is distributed in the hope that
+// it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// Note:  Comments within this file follow a syntax that is compatible with
+//        DOXYGEN and are utilized for automated document extraction
+//
+// Reference:
+*/
+/*----------------------------------------------------------------------------------------------*/
+
+#ifndef RECORDER_H_
+#define RECORDER_H_
+
+#include "includes.h"
+#include "if_file.h"
+
+#define RECORDER_QUEUE		(2048)	//!< Packet references in flight, must be a power of 2
+#define RECORDER_BLOCK_MS	(64)	//!< ms of data per disk write (512 kB per antenna)
+#define RECORDER_ALIGN		(4096)	//!< O_DIRECT buffer/length alignment
+
+/*! \ingroup CLASSES
+ *	@brief Record the IF data to disk from its own thread. The source thread only pushes
+ *	a reference to the FIFO packet into a single producer/single consumer ring, the writer
+ *	copies the packet into a large aligned block and writes it with O_DIRECT, or hands the
+ *	block to an IF_Writer when recording compressed.
+ */
+class Recorder : public Threaded_Object
+{
+
+	private:
+
+		int32 antennas;				//!< Number of antennas to record
+		int32 fd[MAX_ANTENNAS];		//!< Output file descriptors
+		int32 direct;				//!< Files opened with O_DIRECT
+		IF_Writer *ifz;				//!< Compressed output, replaces fd[]
+		CPX *block[MAX_ANTENNAS];	//!< Aligned write blocks
+		int32 block_ms;				//!< ms currently held in the blocks
+
+		ms_packet *queue[RECORDER_QUEUE];	//!< Packet references
+		uint32 seq[RECORDER_QUEUE];			//!< Sequence number of each reference
+		volatile uint32 head;		//!< Written by the recorder thread only
+		volatile uint32 tail;		//!< Written by the source thread only
+		volatile uint32 pushed;		//!< Every packet offered to Push, recorded or not
+
+		/* Stats */
+		uint32 written;				//!< Blocks written
+		uint32 dropped;				//!< Packets dropped because the queue was full
+		uint32 stale;				//!< Packets overwritten in the FIFO before they were copied
+		uint32 late;				//!< Blocks whose write took longer than real time
+		uint32 errors;				//!< Failed writes
+		double max_write;			//!< Longest block write (ms)
+
+		void Write();				//!< Flush the blocks to disk
+
+	public:
+
+		Recorder(const char *_path, int32 _antennas, int32 _compress);	//!< Open data.dba (and data.dbb) or data.ifz
+		~Recorder();				//!< Drain the queue, flush and close the files
+		void Start();				//!< Start the thread
+		void Import();				//!< Copy out queued packets, write full blocks
+		void Push(ms_packet *_p);	//!< Called by the source thread, never blocks
+
+		uint32 getWritten(){return(written);}
+		uint32 getDropped(){return(dropped);}
+		uint32 getStale(){return(stale);}
+		uint32 getLate(){return(late);}
+		uint32 getErrors(){return(errors);}
+		double getMaxWrite(){return(max_write);}
+		int32 getDirect(){return(direct);}
+};
+
+#endif /* RECORDER_H_ */
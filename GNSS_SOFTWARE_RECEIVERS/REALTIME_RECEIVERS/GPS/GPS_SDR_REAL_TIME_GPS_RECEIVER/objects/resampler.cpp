@@ -0,0 +1,200 @@
+/*----------------------------------------------------------------------------------------------*/
+/*! \file resampler.cpp
+//
+// FILENAME: resampler.cpp
+//
+// DESCRIPTION: Implements member functions of the Resampler class.
+//
+// DEVELOPERS: Gregory W. Heckler (2003-2009)
+//
+// LICENSE TERMS: Copyright (c) Gregory W. Heckler 2009
+//
+// This file is part of the GPS Software Defined Radio (GPS-SDR)
+//
+// The GPS-SDR is free software; you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation; either version 2 of
+// the License, or (at your option) any later version. The GPS-SDR is distributed in the hope that
+// it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// Note:  Comments within this file follow a syntax that is compatible with
+//        DOXYGEN and are utilized for automated document extraction
+//
+// Reference:
+*/
+/*----------------------------------------------------------------------------------------------*/
+
+#include "resampler.h"
+#include <new>				//!< std::bad_alloc
+
+/*----------------------------------------------------------------------------------------------*/
+Resampler::Resampler(int32 _up, int32 _down, int32 _shift, int32 _max_samps)
+{
+
+	int32 a, b, t;
+
+	/* Reduce the ratio */
+	a = _up; b = _down;
+	while(b)
+	{
+		t = a % b; a = b; b = t;
+	}
+
+	up = _up / a;
+	down = _down / a;
+	taps = RESAMPLER_TAPS;
+	shift = _shift;
+	max_samps = _max_samps;
+
+	/* Group several cycles of up outputs so each kernel call does a decent amount of work */
+	outputs = up * ((RESAMPLER_BLOCK + up - 1) / up);
+	inputs = down * (outputs / up);
+
+	/* pmaddwd reads the taps straight from memory, they must be 16 byte aligned. Fail the way new would.
+	 * Rows go in pairs, so round up to an even count */
+	if(posix_memalign((void **)&H, 16, ((outputs + 1) & ~1)*taps*sizeof(int16)))
+		throw std::bad_alloc();
+	memset(H, 0x0, ((outputs + 1) & ~1)*taps*sizeof(int16));
+	off = (int32 *)malloc(outputs*sizeof(int32));
+	work_i = (int16 *)malloc((max_samps + taps)*sizeof(int16));
+	work_q = (int16 *)malloc((max_samps + taps)*sizeof(int16));
+
+	Design();
+	Reset();
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+Resampler::~Resampler()
+{
+	free(H);
+	free(off);
+	free(work_i);
+	free(work_q);
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void Resampler::Reset()
+{
+	memset(work_i, 0x0, (taps - 1)*sizeof(int16));
+	memset(work_q, 0x0, (taps - 1)*sizeof(int16));
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+/*!
+ * Design, the prototype runs at up times the input rate and is taps*up long. Output k of a block
+ * sits at input time k*down/up, it uses branch p = (k*down)%up over the taps inputs ending at
+ * floor(k*down/up). Branches are stored reversed so the kernel walks the input forwards, and rows are
+ * paired 8 taps at a time as x86_polyphase describes.
+ * */
+void Resampler::Design()
+{
+
+	int32 lcv, k, j, n, p, len;
+	double *proto;
+	double fc, x, w, sum, bessel, term, i0beta;
+	int16 *row;
+
+	len = taps*up;
+	proto = (double *)malloc(len*sizeof(double));
+
+	/* Cutoff at the lower Nyquist rate, in cycles per prototype sample */
+	fc = 0.5 / ((up > down) ? up : down);
+
+	/* I0(beta) for the Kaiser window */
+	i0beta = term = 1.0;
+	for(lcv = 1; lcv < 32; lcv++)
+	{
+		term *= (RESAMPLER_BETA / (2.0*lcv))*(RESAMPLER_BETA / (2.0*lcv));
+		i0beta += term;
+	}
+
+	sum = 0;
+	for(lcv = 0; lcv < len; lcv++)
+	{
+		x = lcv - (len - 1) / 2.0;
+
+		/* Windowed sinc */
+		if(x == 0)
+			proto[lcv] = 2.0*fc;
+		else
+			proto[lcv] = sin(2.0*M_PI*fc*x) / (M_PI*x);
+
+		w = 2.0*x / (len - 1);
+		w = RESAMPLER_BETA*sqrt(1.0 - w*w);
+		bessel = term = 1.0;
+		for(k = 1; k < 32; k++)
+		{
+			term *= (w / (2.0*k))*(w / (2.0*k));
+			bessel += term;
+		}
+
+		proto[lcv] *= bessel / i0beta;
+		sum += proto[lcv];
+	}
+
+	/* Unity DC gain at the output, in units of 1 << shift */
+	for(lcv = 0; lcv < len; lcv++)
+		proto[lcv] *= (double)up * (double)(1 << shift) / sum;
+
+	/* Split into branches, one row per output of the block */
+	for(k = 0; k < outputs; k++)
+	{
+		n = (k*down) / up;
+		p = (k*down) % up;
+		off[k] = n;
+		row = &H[(k & ~1)*taps + (k & 1)*8];
+
+		for(j = 0; j < taps; j++)
+			row[(j >> 3)*16 + (j & 7)] = (int16)floor(proto[p + (taps - 1 - j)*up] + 0.5);
+	}
+
+	free(proto);
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+/*!
+ * Run, _samps must be a multiple of down and no larger than max_samps. The input is split into I and Q
+ * planes so the MAC kernel needs no shuffles, and the last taps-1 inputs are kept so the filter runs
+ * continuously across calls.
+ * */
+int32 Resampler::Run(CPX *_in, CPX *_out, int32 _samps)
+{
+
+	int32 lcv, cycles, nout;
+
+	if(_samps > max_samps)
+		_samps = max_samps;
+
+	sse_deinterleave(_in, &work_i[taps - 1], &work_q[taps - 1], _samps);
+
+	/* Whole blocks */
+	cycles = _samps / inputs;
+	for(lcv = 0; lcv < cycles; lcv++)
+		sse_polyphase(&work_i[lcv*inputs], &work_q[lcv*inputs], &_out[lcv*outputs], outputs, H, off, taps, shift);
+	nout = cycles*outputs;
+
+	/* Leftover cycles of up outputs */
+	cycles = (_samps - cycles*inputs) / down;
+	if(cycles)
+		sse_polyphase(&work_i[nout/up*down], &work_q[nout/up*down], &_out[nout], cycles*up, H, off, taps, shift);
+	nout += cycles*up;
+
+	/* Save the history */
+	memcpy(&work_i[0], &work_i[_samps], (taps - 1)*sizeof(int16));
+	memcpy(&work_q[0], &work_q[_samps], (taps - 1)*sizeof(int16));
+
+	return(nout);
+
+}
+/*----------------------------------------------------------------------------------------------*/
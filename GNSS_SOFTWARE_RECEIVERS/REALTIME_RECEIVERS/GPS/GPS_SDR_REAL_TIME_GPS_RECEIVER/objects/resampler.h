@@ -0,0 +1,69 @@
+/*----------------------------------------------------------------------------------------------*/
+/*! \file resampler.h
+//
+// FILENAME: resampler.h
+//
+// DESCRIPTION: Defines the Resampler class.
+//
+// DEVELOPERS: Gregory W. Heckler (2003-2009)
+//
+// LICENSE TERMS: Copyright (c) Gregory W. Heckler 2009
+//
+// This file is part of the GPS Software Defined Radio (GPS-SDR)
+//
+// The GPS-SDR is free software; you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation; either version 2 of
+// the License, or (at your option) any later version. The GPS-SDR is distributed in the hope that
+// it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// Note:  Comments within this file follow a syntax that is compatible with
+//        DOXYGEN and are utilized for automated document extraction
+//
+// Reference:
+*/
+/*----------------------------------------------------------------------------------------------*/
+
+#ifndef RESAMPLER_H_
+#define RESAMPLER_H_
+
+#include "includes.h"
+
+#define RESAMPLER_TAPS		(32)		//!< Taps per polyphase branch, must be a multiple of 8
+#define RESAMPLER_BLOCK		(64)		//!< Minimum outputs handed to the MAC kernel per call
+#define RESAMPLER_BETA		(5.0)		//!< Kaiser window beta, ~55 dB stopband
+
+/*! @ingroup CLASSES
+	@brief Rational polyphase FIR resampler for CPX data. Designs a Kaiser windowed
+	sinc at startup with its cutoff at the lower of the two Nyquist rates, so out of
+	band noise is filtered rather than aliased in by picking samples. */
+class Resampler
+{
+
+	private:
+
+		int32 up;					//!< Interpolation factor
+		int32 down;					//!< Decimation factor
+		int32 taps;					//!< Taps per polyphase branch
+		int32 shift;				//!< Output shift, taps are scaled so 1 << shift is unity gain
+		int32 outputs;				//!< Outputs per MAC kernel call (a multiple of up)
+		int32 inputs;				//!< Inputs consumed per MAC kernel call
+		int32 max_samps;			//!< Largest input block accepted by Run()
+		int16 *H;					//!< Taps, one row per output of a block, rows paired 8 taps at a time
+		int32 *off;					//!< Input offset of each output of a block
+		int16 *work_i;				//!< I history followed by the current input
+		int16 *work_q;				//!< Q history followed by the current input
+
+		void Design();				//!< Design the prototype filter and split it into branches
+
+	public:
+
+		Resampler(int32 _up, int32 _down, int32 _shift, int32 _max_samps);	//!< Resample by _up/_down, accepting up to _max_samps per Run()
+		~Resampler();
+		int32 Run(CPX *_in, CPX *_out, int32 _samps);	//!< Filter and resample _samps (a multiple of down), returns the output count
+		void Reset();									//!< Clear the filter history
+
+};
+
+#endif /*RESAMPLER_H_*/
@@ -0,0 +1,94 @@
+/*----------------------------------------------------------------------------------------------*/
+/*! \file seqlock.h
+//
+// FILENAME: seqlock.h
+//
+// DESCRIPTION: Defines the sequence lock that publishes state one thread owns to the others.
+//
+// DEVELOPERS: Gregory W. Heckler (2003-2009)
+//
+// LICENSE TERMS: Copyright (c) Gregory W. Heckler 2009
+//
+// This file is part of the GPS Software Defined Radio (GPS-SDR)
+//
+// The GPS-SDR is free software; you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation; either version 2 of
+// the License, or (at your option) any later version. The GPS-SDR is distributed in the hope that
+// it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// Note:  Comments within this file follow a syntax that is compatible with
+//        DOXYGEN and are utilized for automated document extraction
+//
+// Reference:
+*/
+/*----------------------------------------------------------------------------------------------*/
+
+
+#ifndef SEQLOCK_H_
+#define SEQLOCK_H_
+
+/* Pulled in by includes.h ahead of globals.h, so only lean on the system headers and defines.h */
+#include <string.h>
+#include <sched.h>
+
+/*! \ingroup CLASSES
+ *	@brief Publishes a T from one writer thread to any number of readers. The writer never waits:
+ *	it bumps the sequence to odd, copies, and bumps it back to even. A reader copies between two
+ *	reads of the sequence and goes round again if they differ or were odd, so it always gets a
+ *	consistent copy and the writer never knows it was there.
+ */
+template <class T> class Seqlock
+{
+
+	private:
+
+		volatile uint32 seq;		//!< Odd while a write is in progress
+		T data;						//!< The published copy
+		volatile uint32 retries;	//!< Reads that overlapped a write and had to copy again
+
+	public:
+
+		Seqlock()
+		{
+			seq = 0;
+			retries = 0;
+			memset(&data, 0x0, sizeof(T));
+		}
+
+		//!< Publish, only ever called from the owning thread
+		void Write(const T *_src)
+		{
+			seq = seq + 1;
+			__sync_synchronize();
+			memcpy(&data, _src, sizeof(T));
+			__sync_synchronize();
+			seq = seq + 1;
+		}
+
+		//!< Take a consistent copy, never blocks the writer
+		void Read(T *_dst)
+		{
+			uint32 s;
+
+			while(true)
+			{
+				s = seq;
+				__sync_synchronize();
+				memcpy(_dst, &data, sizeof(T));
+				__sync_synchronize();
+
+				if(((s & 0x1) == 0) && (seq == s))
+					return;
+
+				/* The writer may have been preempted mid copy, let it finish */
+				__sync_fetch_and_add(&retries, 1);
+				sched_yield();
+			}
+		}
+
+		uint32 getRetries(){return(retries);}
+};
+
+#endif /* SEQLOCK_H_ */
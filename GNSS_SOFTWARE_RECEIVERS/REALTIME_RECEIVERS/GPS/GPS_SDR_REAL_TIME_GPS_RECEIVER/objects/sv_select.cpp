@@ -31,7 +31,7 @@
 void *SV_Select_Thread(void *_arg)
 {
 
-	while(grun)
+	while(pSV_Select->Running())
 	{
 		pSV_Select->Import();
 	}
@@ -70,6 +70,11 @@ SV_Select::SV_Select():Threaded_Object("SVSTASK")
 	mode = ACQ_MODE_COLD;
 	mask_angle = PI/2;
 	command.evenodd = 0;
+	acq_pending = false;
+
+	memset(&pre_in, 0x0, sizeof(SVS_2_PRE_S));
+	memset(&pre_s, 0x0, sizeof(PRE_2_SVS_S));
+	memset(&sv_prediction[0], 0x0, MAX_SV*sizeof(SV_Prediction_M));
 
 	pnav->stale_ticks 		= STALE_SPS_VALUE;
 
@@ -104,10 +109,11 @@ void SV_Select::Import()
 	uint32 bread, k, nsvs;
 
 	/* Pend on PVT sltn */
-	read(PVT_2_SVS_P[READ], &pvt_s, sizeof(PVT_2_SVS_S));
+	if(!PVT_2_SVS_P->Receive(&pvt_s))
+		return;
 
-	/* Receive from EKF */
-	//read(EKF_2_SVS_P[READ], &ekf_s, sizeof(EKF_2_SVS_S));
+	/* Latest from the EKF, it runs behind the PVT so there may be nothing new */
+	while(EKF_2_SVS_P->TryReceive(&ekf_s));
 
 	 /* Use PVT if it is up to date */
 	if(pnav->stale_ticks == 0)
@@ -127,19 +133,27 @@ void SV_Select::Import()
 	/* Compute Mask Angle */
 	MaskAngle();
 
+	/* Hand the state over, the predictor sweeps the constellation on its own time */
+	pre_in.sps = *pnav;
+	pre_in.clock = *pclock;
+	pre_in.mask_angle = mask_angle;
+	pre_in.mode = mode;
+	pre_in.tsc = tsc_now();
+	pPredictor->setInput(&pre_in);
+
 	nsvs = 0;
 	for(k = 0; k < MAX_CHANNELS; k++)
 		if((pnav->nsvs >> k) & 0x1)
 			nsvs++;
 
-	/* Slow down acquisition if PVT is doing fine */
-	acqs_per_pvt = MAX_ACQS_PER_PVT - nsvs;
-
-	if(acqs_per_pvt < 1)
+	/* Slow down acquisition if PVT is doing fine, nsvs is unsigned so don't let this wrap */
+	if(nsvs < MAX_ACQS_PER_PVT)
+		acqs_per_pvt = MAX_ACQS_PER_PVT - nsvs;
+	else
 		acqs_per_pvt = 1;
 
-	/* Multiple acqs in some cases */
-	for(k = 0; k < acqs_per_pvt; k++)
+	/* Multiple acqs in some cases, in batch mode only one can be outstanding */
+	for(k = 0; (k < acqs_per_pvt) && !acq_pending; k++)
 	{
 		Lock();
 		Acquire();
@@ -179,7 +193,7 @@ void SV_Select::Export(int32 _sv)
 	}
 
 	/* Dump prediction to SV Select */
-	write(SVS_2_TLM_P[WRITE], &sv_prediction[_sv], sizeof(SVS_2_TLM_S));
+	SVS_2_TLM_P->TrySend(&sv_prediction[_sv]);
 
 }
 /*----------------------------------------------------------------------------------------------*/
@@ -195,6 +209,7 @@ void SV_Select::Acquire()
 	int32 already;
 	int32 current_sv;
 	int32 doacq;
+	Channel_Status_S cstatus;
 
 	chan = 666;
 	already = 666;
@@ -212,17 +227,16 @@ void SV_Select::Acquire()
 	/* Find an empty channel and if the given SV is currently being tracked */
 	for(lcv = 0; lcv < MAX_CHANNELS; lcv++)
 	{
-		pChannels[lcv]->Lock();
-		if(pChannels[lcv]->getState() == CHANNEL_EMPTY)
+		pChannels[lcv]->getStatus(&cstatus);
+		if(cstatus.state == CHANNEL_EMPTY)
 		{
 			chan = lcv;
 		}
-		else if(pChannels[lcv]->getSV() == current_sv)
+		else if(cstatus.sv == current_sv)
 		{
 			already = lcv;
 			sv_prediction[current_sv].tracked = true;
 		}
-		pChannels[lcv]->Unlock();
 	}
 
 	/* Up to date PVT */
@@ -244,13 +258,17 @@ void SV_Select::Acquire()
 		command.chan = chan;
 
 		/* Send to the acquisition thread */
-		write(SVS_2_ACQ_P[WRITE], &command, sizeof(Acq_Command_S));
-
-		/* Wait for acq to return, do stuff depending on the state */
-		read(ACQ_2_SVS_P[READ], &command, sizeof(Acq_Command_S));
+		SVS_2_ACQ_P->Send(&command);
 
-		if(command.success)
-			write(SVS_2_COR_P[WRITE], &command, sizeof(Acq_Command_S));
+		/* Wait for acq to return, do stuff depending on the state. In batch mode the
+		 * acquisition has to wait on file time, so CheckAcquisition() picks it up later */
+		if(gopt.realtime)
+		{
+			if(ACQ_2_SVS_P->Receive(&command))
+				Acquired();
+		}
+		else
+			acq_pending = true;
 	}
 
 	/* Dump state info */
@@ -263,6 +281,37 @@ void SV_Select::Acquire()
 /*----------------------------------------------------------------------------------------------*/
 
 
+/*----------------------------------------------------------------------------------------------*/
+void SV_Select::Acquired()
+{
+
+	acq_pending = false;
+
+	if(command.success)
+		SVS_2_COR_P->Send(&command);
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+int32 SV_Select::CheckAcquisition()
+{
+
+	if(!acq_pending)
+		return(false);
+
+	if(!ACQ_2_SVS_P->TryReceive(&command))
+		return(false);
+
+	Acquired();
+
+	return(true);
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
 /*----------------------------------------------------------------------------------------------*/
 uint32 SV_Select::SetupRequest(int32 _sv)
 {
@@ -325,35 +374,24 @@ uint32 SV_Select::SetupRequest(int32 _sv)
     		return_val = false;
 	}
 
-	/* Only update prediction if it is longer than 30 seconds old */
-//    dt = pclock->time - sv_prediction[_sv].time;
-//	if(fabs(dt) > 30.0)
-//	{
-//		 /* Log updated time */
-//		dt = 0;
-//		/* Get the almanac */
-//
-//	}
-
+	/* Almanac for the health, the predictor's last sweep for the rest */
 	GetAlmanac(_sv);
-	sv_prediction[_sv].time = (double)pclock->time;
+	GetPrediction(_sv);
 
 	/* Use almanac info if it is available */
-	if((almanacs[_sv].valid == true) && (mode != ACQ_MODE_COLD))
+	if((almanacs[_sv].valid == true) && (mode != ACQ_MODE_COLD) && (sv_prediction[_sv].predicted == true))
 	{
-		/* Update predicted state */
-		SV_Position(_sv);
-		SV_Predict(_sv);
-
 		/* Get the predicted state */
 		ppred = &sv_prediction[_sv];
 
+		/* The sweep is up to PREDICT_PERIOD old, run the Doppler on to now */
+		dt = pclock->time - ppred->time;
+
 		/* Value to stuff into w accumulator */
 		command.accel = (int32)(ppred->doppler_rate * 4096.0);
 
 		/* Search over the defined range */
-		//command.cendopp = (int32)ppred->doppler + dt*ppred->doppler_rate;
-		command.cendopp = (int32)ppred->doppler;
+		command.cendopp = (int32)(ppred->doppler + dt*ppred->doppler_rate);
 
 		/* Bound the Doppler (dont trust the accel either in this case) */
 		if(command.cendopp < -MAX_DOPPLER_ABSOLUTE)
@@ -386,6 +424,7 @@ uint32 SV_Select::SetupRequest(int32 _sv)
 	else
 	{
 		sv_prediction[_sv].predicted = false;
+		sv_prediction[_sv].time = (double)pclock->time;
 	}
 
 	IncStopTic();
@@ -445,263 +484,20 @@ void SV_Select::GetAlmanac(int32 _sv)
 
 
 /*----------------------------------------------------------------------------------------------*/
-void SV_Select::SV_Position(int32 _sv)
+void SV_Select::GetPrediction(int32 _sv)
 {
 
-	int32 iter;
-	double a, n0, M, E, P, R, I, L;
-	double sE, cE, sI, cI, sL, cL, sP, cP;
-	double dEdM, ecc, sqrt1mee, dtemp, Xp, Yp;
-	double Edot, Pdot, Rdot, Idot, Xpdot, Ypdot, Ldot, sPdot, cPdot;
-	double tk;
-
-	Almanac_M *alm;
-	SV_Position_M *psv;
-
-	alm = &almanacs[_sv];
-	psv = &sv_positions[_sv];
-
-	/* Time to calculate position */
-	tk = pclock->time - alm->toa;
+	int32 tracked;
 
-	if (tk > HALF_OF_SECONDS_IN_WEEK)
-		tk -= SECONDS_IN_WEEK;
-	else if (tk < (-HALF_OF_SECONDS_IN_WEEK))
-		tk += SECONDS_IN_WEEK;
-
-	/* Mean motion */
-	a = alm->sqrta * alm->sqrta;
-	n0 = sqrt(GRAVITY_CONSTANT/(a*a*a));
-
-	/* Mean anomaly, M (rads). */
-	M = alm->m0 + n0 * tk;
-	M = fmod(M, TWO_PI);
-
-	/* Obtain eccentric anomaly E by solving Kepler's equation. */
-	ecc = alm->ecc;
-
-	sqrt1mee = sqrt (1.0 - ecc * ecc);
-
-	E = M;
-
-	for(iter = 0; iter < 20; iter++)
+	if((_sv >= 0) && (_sv < MAX_SV))
 	{
-		sE = sin(E);
-		cE = cos(E);
-		dEdM = 1.0 / (1.0 - ecc * cE);
-		if (fabs(dtemp = (M - E + ecc * sE) * dEdM) < 1.0E-14)
-			break;
-		E += dtemp;
+		/* Tracked is ours, Acquire() has just worked it out */
+		pPredictor->getOutput(&pre_s);
+		tracked = sv_prediction[_sv].tracked;
+		sv_prediction[_sv] = pre_s.sv[_sv];
+		sv_prediction[_sv].tracked = tracked;
 	}
 
-	Edot = dEdM * n0;
-
-	/* Compute the argument of latitude, P. */
-	P = atan2 (sqrt1mee * sE, cE - ecc) + alm->argp;
-	Pdot = sqrt1mee * dEdM * Edot;
-	sP = sin(P);
-	cP = cos(P);
-	sPdot = cP*Pdot;
-	cPdot = -sP*Pdot;
-
-	/* Compute the corrected radius, R. */
-	R = a * (1.0 - ecc * cE);
-	Rdot = a * ecc * sE * Edot;
-
-	/* Compute the corrected orbital inclination, I. */
-	I = alm->in0; Idot = 0.0;
-	sI = sin (I); cI = cos (I);
-
-	/* Compute the satellite's position in its orbital plane, (Xp,Yp) */
-	Xp = R * cP;
-	Yp = R * sP;
-
-	/* Compute the longitude of the ascending node, L. */
-	L = alm->om0 + tk * (alm->omd - (double)WGS84OE) - (double)WGS84OE * alm->toa;
-	Ldot = alm->omd - (double)WGS84OE;
-	sL = sin (L); cL = cos (L);
-
-	/* Compute the satellite's position in space, (x,y,z). */
-	psv->x = Xp * cL - Yp * cI * sL;
-	psv->y = Xp * sL + Yp * cI * cL;
-	psv->z = Yp * sI;
-
-	/* Compute the satellite's velocity in its orbital plane, (Xpdot,Ypdot) */
-	Xpdot = Rdot * cP + R * cPdot;
-	Ypdot = Rdot * sP + R * sPdot;
-
-	/* Satellite's velocity, (vx,vy,vz). */
-	psv->vx = -Ldot * (psv->y)
-	+ Xpdot * cL
-	- Ypdot * cI * sL;
-
-	psv->vy = Ldot * (psv->x)
-	+ Xpdot * sL
-	+ Ypdot * cI * cL;
-
-	psv->vz = Ypdot * sI;
-
-	 /* Compute SV clock correction */
-	psv->time = tk;
-	psv->clock_bias = alm->af0 + tk * alm->af1;
-	psv->frequency_bias = alm->af1;
-
-}
-/*----------------------------------------------------------------------------------------------*/
-
-
-/*----------------------------------------------------------------------------------------------*/
-void SV_Select::SV_Predict(int32 _sv)
-{
-	/* Ugh */
-	double rho, theta;
-	double fdoppler;
-
-	/* Accelerations */
-	double nax, nay, naz;
-	double sax, say, saz;
-	double ra;						/* Raw acceleration */
-	double a, b, c;					/* Vector lengths */
-	double dx, dy, dz, radius;		/* Relative position */
-	double dvx, dvy, dvz, relvel;	/* Relative velocity */
-	double dax, day, daz, relaccel;	/* Relative acceleration */
-	double ux, uy, uz;				/* Unit vector */
-	double dux, duy, duz;			/* Derivative of unit vector */
-
-	/* Only needed for SV azimuth/elevation */
-//	double elev, azim;
-	double phi;
-	double e, n, u;
-	double ct, cp;
-	double st, sp;
-//	double sct, scp;
-//	double sst, ssp;
-
-	SV_Position_M *psv;
-	SV_Prediction_M *ppred;
-
-	psv = &sv_positions[_sv];
-	ppred = &sv_prediction[_sv];
-	ppred->sv 	= _sv;
-	ppred->predicted = true;
-
-	/* Relative position vector */
-	dx = (psv->x - pnav->x);
-	dy = (psv->y - pnav->y);
-	dz = (psv->z - pnav->z);
-
-	/* Triangle Leg Lengths */
-	a = pnav->x*pnav->x + pnav->y*pnav->y + pnav->z*pnav->z;	/* Vehicle */
-	b = psv->x*psv->x + psv->y*psv->y + psv->z*psv->z;			/* SV */
-	c = dx*dx + dy*dy + dz*dz;									/* Vehicle->SV */
-
-	/* Law of cosines beotch! OR Dot product relationship */
-	rho   = a + c - b;
-	theta = b + c - a;
-
-	a = sqrt(a); b = sqrt(b); c = sqrt(c);
-
-	rho	= rho / (2*a*c);		rho	= acos(rho);	 /* Angle of SV relative to vehicle */
-	theta = theta / (2*b*c);	theta = acos(theta); /* Angle of vehicle relative to SV */
-
-	/* Predict visibility */
-	if(rho > mask_angle)
-		ppred->visible = true;
-	else
-		ppred->visible = false;
-
-	/* Last section, pseudorange acceleration, AKA Doppler rate */
-
-	/* Newton's Law */
-	ra = GRAVITY_CONSTANT / (a*a*a);
-
-	/* Acceleration is INTO the Earth */
-	nax = -pnav->x * ra;
-	nay = -pnav->y * ra;
-	naz = -pnav->z * ra;
-
-	/* ECEF Correction */
-	nax +=  2.0*WGS84OE*pnav->vy + WGS84OE*WGS84OE*pnav->x;
-	nay += -2.0*WGS84OE*pnav->vx + WGS84OE*WGS84OE*pnav->y;
-
-	/* Newton's Law */
-	ra = GRAVITY_CONSTANT / (b*b*b);
-
-	/* Acceleration is INTO the Earth */
-	sax = -psv->x * ra;
-	say = -psv->y * ra;
-	saz = -psv->z * ra;
-
-	/* ECEF Correction */
-	sax +=  2.0*WGS84OE*psv->vy + WGS84OE*WGS84OE*psv->x;
-	say += -2.0*WGS84OE*psv->vx + WGS84OE*WGS84OE*psv->y;
-
-	/* Relative velocity vector */
-	dvx = (psv->vx - pnav->vx);
-	dvy = (psv->vy - pnav->vy);
-	dvz = (psv->vz - pnav->vz);
-
-	/* Relative acceleration vector */
-	dax = (sax - nax);
-	day = (say - nay);
-	daz = (saz - naz);
-
-	/* Reduce some divides */
-	radius = c*c;
-
-	/* Relative unit vector */
-	ux = dx / c;
-	uy = dy / c;
-	uz = dz / c;
-
-	/* Line of sight velocity */
-	relvel = dvx*ux + dvy*uy + dvz*uz;
-
-	/* Derivative of unit vector */
-	dux = (dvx * c - dx * relvel) / radius;
-	duy = (dvy * c - dy * relvel) / radius;
-	duz = (dvz * c - dz * relvel) / radius;
-
-	/* Relative acceleration along line of sight */
-	relaccel = 	ux * dax + dux * dvx +
-				uy * day + duy * dvy +
-				uz * daz + duz * dvz;
-
-	/* Predict time of flight in terms of chips */
-	//ppred->delay = (c + pnav->clock_bias)*INVERSE_SPEED_OF_LIGHT - psv->clock_bias;	/* Seconds */
-	ppred->delay = c*INVERSE_SPEED_OF_LIGHT - psv->clock_bias;
-
-	/* Predict observed doppler in terms of Hz */
-	fdoppler = -relvel - pnav->clock_rate - psv->frequency_bias*SPEED_OF_LIGHT; /* Meters/second */
-	//fdoppler = -relvel - psv->frequency_bias*SPEED_OF_LIGHT;		/* Meters/second */
-	fdoppler *= L1_OVER_C; /* Hz */
-	ppred->doppler = fdoppler;
-
-	/* Predicted observed doppler rate in terms of Hz */
-	/* THIS NEEDS TO INCLUDE THE CLOCK ACCELERATION EVENTUALLY */
-	relaccel *= L1_OVER_C;
-	ppred->doppler_rate = -relaccel;
-
-	/* Use the SV position and PVT sltn to make a prediction of: Elev, Azim, Delay, Doppler */
-	theta = pnav->longitude; phi = pnav->latitude;
-	ct = cos(theta); st = sin(theta);
-	cp = cos(phi);   sp = sin(phi);
-
-	/* Normalize the direction vector */
-	dx = (psv->x - pnav->x) / c;
-	dy = (psv->y - pnav->y) / c;
-	dz = (psv->z - pnav->z) / c;
-
-	/* Elevation/Azimuth of SV relative to Vehicle */
-	e = -st*dx    +  ct*dy;
-	n = -sp*ct*dx + -sp*st*dy + cp*dz;
-	u =  cp*ct*dx +  cp*st*dy + sp*dz;
-
-	rho = sqrt(n*n + e*e);
-
-	ppred->elev = atan2(u, rho);
-	ppred->azim = atan2(e, n);
-
 }
 /*----------------------------------------------------------------------------------------------*/
 
@@ -31,7 +31,8 @@
 #include "includes.h"
 #include "ephemeris.h"
 #include "channel.h"
-#define EKF_STATE_INITIALIZED (1)
+#include "ekf.h"
+#include "predictor.h"
 
 enum SV_SELECT_MODE
 {
@@ -65,7 +66,9 @@ enum SV_PREDICTION_STATE
 /*! @ingroup CLASSES
 	@brief SV_Select uses state information from the PVT/EKF and the almanac to
  * predict the state of the GPS constellation. This information is used to aid
- * the acquisition process. */
+ * the acquisition process. The prediction itself is the Predictor's, which sweeps
+ * every SV on its own clock off the state handed over here, so an acquisition
+ * that takes a while does not hold it up. */
 class SV_Select : public Threaded_Object
 {
 
@@ -79,7 +82,8 @@ class SV_Select : public Threaded_Object
 		SPS_M				*pnav;							//!< Pointer to nav sltn
 		Clock_M 			*pclock;						//!< Point to clock sltn
 		Almanac_M			almanacs[MAX_SV];				//!< The decoded almanacs
-		SV_Position_M		sv_positions[MAX_SV];			//!< The GPS positions calculated from the almanac
+		SVS_2_PRE_S			pre_in;							//!< State handed to the predictor
+		PRE_2_SVS_S			pre_s;							//!< The predictor's last sweep
 		SV_Prediction_M 	sv_prediction[MAX_SV];			//!< Predicated delay/doppler visibility, etc
 		int32				mode;							//!< SV select mode (COLD, WARM, HOT)
 		int32				type;							//!< WEAK or STRONG
@@ -87,6 +91,7 @@ class SV_Select : public Threaded_Object
 		int32				weak_sv;						//!< The current weak SV
 		int32				acq_ticks;						//!< Number of acq ticks
 		float				mask_angle;						//!< Elevation mask angle
+		int32				acq_pending;					//!< Batch mode, waiting on the acquisition
 
 	public:
 
@@ -97,9 +102,11 @@ class SV_Select : public Threaded_Object
 		void Export(int32 _sv);			//!< Export state info for the given SV
  		void UpdateState();				//!< Update acq type
  		void Acquire();					//!< Run the acquisition
+		void Acquired();				//!< Act on the acquisition result in command
+		int32 CheckAcquisition();		//!< Batch mode, pick up a finished acquisition without waiting
+		Acq_Command_S getCommand(){return(command);}	//!< The last acquisition request/result
 		void GetAlmanac(int32 _sv);		//!< Get the most up-to-date almanacs from the ephemeris
-		void SV_Predict(int32 _sv);		//!< Predict states of SVs
-		void SV_Position(int32 _sv);	//!< Compute SV positions from almanac
+		void GetPrediction(int32 _sv);	//!< Get the SV's state from the predictor's last sweep
  		uint32 SetupRequest(int32 _sv);	//!< Setup the acq request
 		void MaskAngle();				//!< Calculate elevation mask angle
 		void EKF_2_Nav();				//!< Get the GEONS data into the proper structure
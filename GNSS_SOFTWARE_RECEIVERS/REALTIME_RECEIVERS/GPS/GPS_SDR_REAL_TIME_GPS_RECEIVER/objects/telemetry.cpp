@@ -39,13 +39,17 @@ void lost_gui_pipe(int _sig)
 void *Telemetry_Thread(void *_arg)
 {
 
-	while(grun)
+	while(pTelemetry->Running())
 	{
-		pTelemetry->Import();
-		pTelemetry->Export();
-		usleep(10000);
+		pTelemetry->Wait();
+
+		/* One message per queue at a time, until all of them are empty */
+		while(pTelemetry->Import())
+			pTelemetry->Export();
 	}
 
+	pthread_exit(0);
+
 }
 /*----------------------------------------------------------------------------------------------*/
 
@@ -76,6 +80,12 @@ Telemetry::Telemetry():Threaded_Object("TLMTASK")
 
 	signal(SIGPIPE, lost_gui_pipe);
 
+	/* Everything that feeds the telemetry wakes it up */
+	PVT_2_TLM_P->setNotify(&event);
+	SVS_2_TLM_P->setNotify(&event);
+	EKF_2_TLM_P->setNotify(&event);
+	CMD_2_TLM_P->setNotify(&event);
+
 	remove("/tmp/GPS2GUI");
 	fifo[WRITE] = mkfifo("/tmp/GPS2GUI", S_IRWXU|S_IRWXG|S_IRWXO|S_IROTH|S_IWOTH);
 	if(fifo[WRITE] == -1)
@@ -103,6 +113,7 @@ Telemetry::Telemetry():Threaded_Object("TLMTASK")
 	msg_handlers[MEASUREMENT_M_ID] 			= &Telemetry::SendMeasurements;
 	msg_handlers[PSEUDORANGE_M_ID] 			= &Telemetry::SendPseudoranges;
 	msg_handlers[SV_PREDICTION_M_ID] 		= &Telemetry::SendSVPredictions;
+	msg_handlers[BUDGET_M_ID] 				= &Telemetry::SendBudget;
 	msg_handlers[LAST_PERIODIC_M_ID]		= NULL;
 	msg_handlers[EKF_STATE_M_ID] 			= &Telemetry::SendEKFState;
 	msg_handlers[EKF_COVARIANCE_M_ID] 		= &Telemetry::SendEKFCovariance;
@@ -133,6 +144,7 @@ Telemetry::Telemetry():Threaded_Object("TLMTASK")
 	msg_rates[MEASUREMENT_M_ID] 		= 0;
 	msg_rates[PSEUDORANGE_M_ID] 		= 1;
 	msg_rates[SV_PREDICTION_M_ID] 		= 1;
+	msg_rates[BUDGET_M_ID] 				= 1;
 	msg_rates[LAST_PERIODIC_M_ID]		= 0;
 	msg_rates[EKF_STATE_M_ID] 			= 1;
 	msg_rates[EKF_COVARIANCE_M_ID] 		= 1;
@@ -215,6 +227,7 @@ void Telemetry::OpenSerial()
 	/* Alias the serial port */
 	npipe[READ] = npipe[WRITE] = spipe;
 	npipe_open = true;
+	event.Watch(spipe);
 }
 /*----------------------------------------------------------------------------------------------*/
 
@@ -232,6 +245,7 @@ void Telemetry::OpenPipe()
 		fcntl(npipe[READ] , F_SETFL, O_NONBLOCK);
 		fcntl(npipe[WRITE] , F_SETFL, O_NONBLOCK);
 		npipe_open = true;
+		event.Watch(npipe[READ]);
 		fprintf(stdout,"GUI connected\n");
 	}
 	else
@@ -249,6 +263,9 @@ void Telemetry::OpenPipe()
 /*----------------------------------------------------------------------------------------------*/
 void Telemetry::ClosePipe()
 {
+	if(npipe_open)
+		event.Unwatch(npipe[READ]);
+
 	npipe_open = false;
 	close(npipe[READ]);
 	close(npipe[WRITE]);
@@ -259,38 +276,62 @@ void Telemetry::ClosePipe()
 
 
 /*----------------------------------------------------------------------------------------------*/
-void Telemetry::Import()
+void Telemetry::Wait()
+{
+
+	event.Wait(TELEM_IDLE_WAIT);
+
+	/* The GUI closed its end, epoll would keep reporting that until the pipe is closed */
+	if(npipe_open && (event.getHangUp() == npipe[READ]))
+	{
+		ClosePipe();
+		fprintf(stderr,"GUI disconnected\n");
+	}
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+int32 Telemetry::Import()
 {
 
-	/* Wait for data from the PVT */
-	ImportPVT();
+	int32 got;
+
+	/* Data from the PVT */
+	got = ImportPVT();
 
 	/* Get data from EKF */
-	ImportEKF();
+	got |= ImportEKF();
 
 	/* Get data from serial port */
 	ImportSerial();
 
 	/* Bent pipe anything from Commando */
-	ImportCommando();
+	got |= ImportCommando();
 
 	/* Increment execution counter */
 	IncExecTic();
 
+	return(got);
+
 }
 /*----------------------------------------------------------------------------------------------*/
 
 
 /*----------------------------------------------------------------------------------------------*/
-void Telemetry::ImportPVT()
+int32 Telemetry::ImportPVT()
 {
 
-	uint32 bread, sv;
+	uint32 sv;
+	int32 got;
 
-	bread = read(PVT_2_TLM_P[READ], &pvt_s, sizeof(PVT_2_TLM_S));
+	got = false;
 
-	if(bread == sizeof(PVT_2_TLM_S))
+	/* The PVT is what wakes the exports, so its send time goes in the wake up histogram */
+	if(PVT_2_TLM_P->TryReceive(&pvt_s, &queue_stamp))
 	{
+		got = true;
 		export_messages = true;
 		if(npipe_open == false)
 		{
@@ -305,9 +346,9 @@ void Telemetry::ImportPVT()
 		}
 	}
 
-	bread = read(SVS_2_TLM_P[READ], &svs_s, sizeof(SVS_2_TLM_S));
-	if(bread == sizeof(SVS_2_TLM_S))
+	if(SVS_2_TLM_P->TryReceive(&svs_s))
 	{
+		got = true;
 		sv = svs_s.sv;
 		if((sv >= 0) && (sv < MAX_SV))
 		{
@@ -315,19 +356,20 @@ void Telemetry::ImportPVT()
 		}
 	}
 
+	return(got);
+
 }
 /*----------------------------------------------------------------------------------------------*/
 
 
 /*----------------------------------------------------------------------------------------------*/
-void Telemetry::ImportEKF()
+int32 Telemetry::ImportEKF()
 {
-	uint32 bread;
-
-	bread = read(EKF_2_TLM_P[READ], &ekf_s, sizeof(EKF_2_TLM_S));
+	if(!EKF_2_TLM_P->TryReceive(&ekf_s))
+		return(false);
 
-	if(bread == sizeof(EKF_2_TLM_S))
-		export_ekf = true;
+	export_ekf = true;
+	return(true);
 }
 /*----------------------------------------------------------------------------------------------*/
 
@@ -471,8 +513,9 @@ void Telemetry::StateThree()
 	if(checksumc == checksumr)
 	{
 		/* Bent pipe data to Commando */
-		write(TLM_2_CMD_P[WRITE], &command_header, sizeof(CCSDS_Packet_Header));
-		write(TLM_2_CMD_P[WRITE], &command_body, decoded_header.length);
+		command_packet.header = command_header;
+		command_packet.body = command_body;
+		TLM_2_CMD_P->Send(&command_packet);
 	}
 
 	checksum_bytes = 0;
@@ -487,20 +530,18 @@ void Telemetry::StateThree()
 
 
 /*----------------------------------------------------------------------------------------------*/
-void Telemetry::ImportCommando()
+int32 Telemetry::ImportCommando()
 {
 
-	uint32 bread, status;
+	if(!CMD_2_TLM_P->TryReceive(&message_packet))
+		return(false);
 
-	bread = read(CMD_2_TLM_P[READ], &command_header, sizeof(CCSDS_Packet_Header));
+	DecodeCCSDSPacketHeader(&decoded_header, &message_packet.header);
+	FormCCSDSPacketHeader(&packet_header, decoded_header.id, 0, decoded_header.length, 0, packet_tic++);
+	memcpy(&message_body, &message_packet.body, decoded_header.length);
+	EmitCCSDSPacket(&message_body, decoded_header.length);
 
-	if(bread == sizeof(CCSDS_Packet_Header))
-	{
-		DecodeCCSDSPacketHeader(&decoded_header, &command_header);
-		FormCCSDSPacketHeader(&packet_header, decoded_header.id, 0, decoded_header.length, 0, packet_tic++);
-		read(CMD_2_TLM_P[READ], &message_body, decoded_header.length);
-		EmitCCSDSPacket(&message_body, decoded_header.length);
-	}
+	return(true);
 
 }
 /*----------------------------------------------------------------------------------------------*/
@@ -512,6 +553,8 @@ void Telemetry::Export()
 
 	int32 lcv;
 
+	PROFILE_SCOPE("Telemetry::Export");
+
 	/* Dump EKF ASAP */
 	if(export_ekf == true)
 	{
@@ -569,14 +612,14 @@ void Telemetry::SendBoardHealth()
 	board_health->fft_version = 0;
 
 	/* DSA Values */
-	board_health->dsa0 = pSource->getScale();
-	board_health->dsa1 = 0;
-	board_health->dsa2 = 0;
-	board_health->dsa3 = 0;
+	board_health->dsa0 = pSource->getScale(0);
+	board_health->dsa1 = pSource->getScale(1);
+	board_health->dsa2 = pSource->getShift(0);
+	board_health->dsa3 = pSource->getShift(1);
 
 	/* Overflow on A/Ds */
-	board_health->ovrflw0 = pSource->getOvrflw();
-	board_health->ovrflw1 = 0;
+	board_health->ovrflw0 = pSource->getOvrflw(0);
+	board_health->ovrflw1 = pSource->getOvrflw(1);
 	board_health->ovrflw2 = 0;
 	board_health->ovrflw3 = 0;
 
@@ -612,11 +655,32 @@ void Telemetry::SendBoardHealth()
 /*----------------------------------------------------------------------------------------------*/
 
 
+/*----------------------------------------------------------------------------------------------*/
+void Telemetry::SendBudget()
+{
+
+	Budget_M *budget = &message_body.budget;
+
+	pCorrelator->getBudget(budget);
+
+	/* Form the packet header */
+	FormCCSDSPacketHeader(&packet_header, BUDGET_M_ID, 0, sizeof(Budget_M), 0, packet_tic++);
+
+	/* Emit the packet */
+	EmitCCSDSPacket((void *)&message_body.budget, sizeof(Budget_M));
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
 /*----------------------------------------------------------------------------------------------*/
 void Telemetry::SendTaskHealth()
 {
 
 	Task_Health_M *task_health = &message_body.task_health;
+	Threaded_Object *tasks[MAX_TASKS];
+	Histogram *run, *wake;
+	int32 lcv;
 
 	/* Get execution counters */
 	task_health->execution_tic[TRACKING_ISR_TASK_ID]= pCorrelator->getExecTic();
@@ -626,7 +690,7 @@ void Telemetry::SendTaskHealth()
 	task_health->execution_tic[EPHEMERIS_TASK_ID] 	= pEphemeris->getExecTic();
 	task_health->execution_tic[TELEMETRY_TASK_ID]  	= execution_tic;
 	task_health->execution_tic[PATIENCE_TASK_ID]  	= 0;
-	task_health->execution_tic[EKF_TASK_ID]  		= 0;
+	task_health->execution_tic[EKF_TASK_ID]  		= pEKF->getExecTic();
 	task_health->execution_tic[PVT_TASK_ID]  		= pPVT->getExecTic();
 	task_health->execution_tic[PPS_TASK_ID]  		= 0;
 	task_health->execution_tic[IDLE_TASK_ID]  		= 0;
@@ -639,7 +703,7 @@ void Telemetry::SendTaskHealth()
 	task_health->start_tic[EPHEMERIS_TASK_ID] 		= pEphemeris->getStartTic();
 	task_health->start_tic[TELEMETRY_TASK_ID]  		= last_start_tic;
 	task_health->start_tic[PATIENCE_TASK_ID]  		= 0;
-	task_health->start_tic[EKF_TASK_ID]  			= 0;
+	task_health->start_tic[EKF_TASK_ID]  			= pEKF->getStartTic();
 	task_health->start_tic[PVT_TASK_ID]  			= pPVT->getStartTic();
 	task_health->start_tic[PPS_TASK_ID]  			= 0;
 	task_health->start_tic[IDLE_TASK_ID]  			= 0;
@@ -652,11 +716,46 @@ void Telemetry::SendTaskHealth()
 	task_health->stop_tic[EPHEMERIS_TASK_ID] 		= pEphemeris->getStopTic();
 	task_health->stop_tic[TELEMETRY_TASK_ID]  		= last_stop_tic;
 	task_health->stop_tic[PATIENCE_TASK_ID]  		= 0;
-	task_health->stop_tic[EKF_TASK_ID]  			= 0;
+	task_health->stop_tic[EKF_TASK_ID]  			= pEKF->getStopTic();
 	task_health->stop_tic[PVT_TASK_ID]  			= pPVT->getStopTic();
 	task_health->stop_tic[PPS_TASK_ID]  			= 0;
 	task_health->stop_tic[IDLE_TASK_ID]  			= 0;
 
+	/* Latency percentiles */
+	memset(tasks, 0x0, sizeof(tasks));
+	tasks[TRACKING_ISR_TASK_ID]	= pCorrelator;
+	tasks[COMMANDO_TASK_ID]		= pCommando;
+	tasks[ACQUISITION_TASK_ID]	= pAcquisition;
+	tasks[SV_SELECT_TASK_ID]	= pSV_Select;
+	tasks[EPHEMERIS_TASK_ID]	= pEphemeris;
+	tasks[TELEMETRY_TASK_ID]	= this;
+	tasks[PVT_TASK_ID]			= pPVT;
+	tasks[EKF_TASK_ID]			= pEKF;
+
+	for(lcv = 0; lcv < MAX_TASKS; lcv++)
+	{
+		if(tasks[lcv] == NULL)
+		{
+			task_health->run_p50[lcv] = task_health->run_p99[lcv] = 0;
+			task_health->run_p999[lcv] = task_health->run_max[lcv] = 0;
+			task_health->wake_p50[lcv] = task_health->wake_p99[lcv] = 0;
+			task_health->wake_p999[lcv] = task_health->wake_max[lcv] = 0;
+			continue;
+		}
+
+		run = tasks[lcv]->getRunHist();
+		task_health->run_p50[lcv]	= run->getPercentile(0.5);
+		task_health->run_p99[lcv]	= run->getPercentile(0.99);
+		task_health->run_p999[lcv]	= run->getPercentile(0.999);
+		task_health->run_max[lcv]	= run->getMax();
+
+		wake = tasks[lcv]->getWakeHist();
+		task_health->wake_p50[lcv]	= wake->getPercentile(0.5);
+		task_health->wake_p99[lcv]	= wake->getPercentile(0.99);
+		task_health->wake_p999[lcv]	= wake->getPercentile(0.999);
+		task_health->wake_max[lcv]	= wake->getMax();
+	}
+
 	/* Check for missed interrupts */
 	task_health->missed_interrupts = 0;
 	task_health->tic_fpu_mul = 0;
@@ -679,39 +778,39 @@ void Telemetry::SendChannelHealth()
 
 	int32 lcv;
 	Channel_M *channel = &message_body.channel;
-	Channel *aChannel;
+	Channel_Status_S aChannel;
 
 	for(lcv = 0; lcv < MAX_CHANNELS; lcv++)
 	{
-		aChannel = pChannels[lcv];
+		pChannels[lcv]->getStatus(&aChannel);
 	//	bChannel = l2Channels[lcv];		
 
 
 		/* Only emit active channels */
 		channel->chan 		= lcv;
 		channel->tic		= pvt_s.sps.tic;
-		channel->state 		= aChannel->state;		//!< Channel's state
-		channel->sv 		= aChannel->sv;			//!< SV/PRN number the channel is tracking
-		channel->antenna 	= aChannel->antenna;	//!< Antenna channel is tracking off of
-		channel->len 		= aChannel->len;		//!< Accumulation length (1 or 20 ms)
-		channel->cn0 		= aChannel->cn0 * 128;	//!< CN0 estimate
-		channel->p_avg		= aChannel->P_avg;		//!< Filtered version of I^2+Q^2
-		channel->bit_lock 	= aChannel->bit_lock;	//!< Bit lock?
-		channel->frame_lock = aChannel->frame_lock;	//!< Frame lock?
-		channel->navigate 	= aChannel->navigate;	//!< Navigate on this channel flag
-		channel->count 		= aChannel->count;		//!< Number of accumulations that have been processed
-		channel->subframe	= aChannel->subframe;	//!< Current subframe number
-		channel->best_epoch = aChannel->best_epoch;	//!< Best estimate of bit edge position
-		channel->w 			= aChannel->aPLL.w*4096.0;						//!< 3rd order PLL state
-		channel->x 			= aChannel->aPLL.x*4096.0;						//!< 3rd order PLL state
-		channel->z 			= aChannel->aPLL.z*4096.0;						//!< 3rd order PLL state
-		channel->code_nco 	= aChannel->code_nco*HZ_2_NCO_CODE_INCR;		//!< State of code_nco
-		channel->carrier_nco = aChannel->carrier_nco*HZ_2_NCO_CARR_INCR;	//!< State of carrier_nco
+		channel->state 		= aChannel.state;		//!< Channel's state
+		channel->sv 		= aChannel.sv;			//!< SV/PRN number the channel is tracking
+		channel->antenna 	= aChannel.antenna;	//!< Antenna channel is tracking off of
+		channel->len 		= aChannel.len;		//!< Accumulation length (1 or 20 ms)
+		channel->cn0 		= aChannel.cn0 * 128;	//!< CN0 estimate
+		channel->p_avg		= aChannel.p_avg;		//!< Filtered version of I^2+Q^2
+		channel->bit_lock 	= aChannel.bit_lock;	//!< Bit lock?
+		channel->frame_lock = aChannel.frame_lock;	//!< Frame lock?
+		channel->navigate 	= aChannel.navigate;	//!< Navigate on this channel flag
+		channel->count 		= aChannel.count;		//!< Number of accumulations that have been processed
+		channel->subframe	= aChannel.subframe;	//!< Current subframe number
+		channel->best_epoch = aChannel.best_epoch;	//!< Best estimate of bit edge position
+		channel->w 			= aChannel.w*4096.0;						//!< 3rd order PLL state
+		channel->x 			= aChannel.x*4096.0;						//!< 3rd order PLL state
+		channel->z 			= aChannel.z*4096.0;						//!< 3rd order PLL state
+		channel->code_nco 	= aChannel.code_nco*HZ_2_NCO_CODE_INCR;		//!< State of code_nco
+		channel->carrier_nco = aChannel.carrier_nco*HZ_2_NCO_CARR_INCR;	//!< State of carrier_nco
 
 /* New L2 Telem Stuff ... eventually we will populate this */
 		channel->l2_Mode 	= 0;
 		channel->l2_len 	= 4;//bChannel->len;
-		channel->l2_cn0 	= aChannel->cn0;//bChannel->cn0*128;
+		channel->l2_cn0 	= aChannel.cn0;//bChannel->cn0*128;
 		channel->l2_p_avg 	= 1000;// bChannel->
 		channel->l2_bit_lock	= 0;//bChannel->bit_lock;
 		channel->l2_frame_lock  = 0; //bChannel->frame_lock;
@@ -36,8 +36,10 @@ enum Telemetry_Type
 
 #include "sys/stat.h"
 
+#define TELEM_IDLE_WAIT	(1000)	//!< ms the telemetry sleeps when nothing at all is coming in
+
 #include "includes.h"
-//#include "ekf.h"				//!< The EKF driver
+#include "ekf.h"				//!< The EKF driver
 //#include "idle.h"				//!< Idle CPU counter
 #include "telemetry.h"			//!< Handle the 422 telemetry
 //#include "patience.h"			//!< Service the watchdog timer
@@ -76,6 +78,7 @@ class Telemetry : public Threaded_Object
 		int32 fifo[2];
 		int32 npipe[2];								//!< Named pipe and/or serial interface
 		int32 npipe_open;							//!< Is the named pipe open!?
+		Event event;								//!< The input queues and the GUI/serial side wake this
 
 		CCSDS_Packet_Header packet_header;			//!< CCSDS Packet header
 		CCSDS_Packet_Header command_header;			//!< CCSDS Command header
@@ -83,6 +86,8 @@ class Telemetry : public Threaded_Object
 
 		Command_Union command_body;					//!< Body of a command
 		Message_Union message_body;					//!< Body of a message
+		Command_Packet_S command_packet;			//!< Command bent piped to Commando
+		Message_Packet_S message_packet;			//!< Command result from Commando
 		SV_Prediction_M sv_predictions[MAX_SV];		//!< Buffer SV predictions
 
 		uint8 packet_body[2048];					//!< Complete packet body
@@ -120,11 +125,12 @@ class Telemetry : public Threaded_Object
 		void OpenSerial();
 		void ClosePipe();
 		void Start();								//!< Start the thread
-		void Import();								//!< Get data into the thread
+		void Wait();								//!< Sleep until a queue or the GUI has something
+		int32 Import();								//!< Get data into the thread, returns false if the queues were empty
 		void Export();								//!< Get data out of the thread
-		void ImportPVT();							//!< Get data from the PVT
-		void ImportEKF();							//!< Get data from the EKF
-		void ImportCommando();						//!< Bent pipe info from Commando
+		int32 ImportPVT();							//!< Get data from the PVT
+		int32 ImportEKF();							//!< Get data from the EKF
+		int32 ImportCommando();						//!< Bent pipe info from Commando
 
 		void ImportSerial();						//!< Parse on serial input
 		void StateZero();							//!< State zero, waiting for 0xAAAAAAAA preamble
@@ -141,6 +147,7 @@ class Telemetry : public Threaded_Object
 		/* Types of output messages */
 		void SendBoardHealth();						//!< Emit hardware health values
 		void SendTaskHealth();						//!< Emit task health values
+		void SendBudget();							//!< Emit the correlator real-time budget
 		void SendChannelHealth();					//!< Emit channel health
 		void SendSPS();								//!< Emit a PVT
 		void SendClock();							//!< Emit a Clock state
@@ -27,6 +27,8 @@
 
 #include "threaded_object.h"
 
+__thread uint32 lock_waits = 0;
+
 /*----------------------------------------------------------------------------------------------*/
 Threaded_Object::Threaded_Object(const char _task_name[8])
 {
@@ -43,10 +45,19 @@ Threaded_Object::Threaded_Object(const char _task_name[8])
 	stack = TASK_STACK_SIZE;
 	task_mem = NULL;
 	object_mem = NULL;
+	run_start = 0;
+	run = true;
 
 	#ifdef LINUX_OS
+		start_routine = NULL;
+		start_arg = NULL;
+		sched = NULL;
+		sched_refused = 0;
+		joinable = false;
 		pthread_mutex_init(&mutex, NULL);
 		pthread_mutex_unlock(&mutex);
+		pthread_mutex_init(&pause_mutex, NULL);
+		pthread_cond_init(&pause_cond, NULL);
 	#endif
 
 	#ifdef NUCLEUS_OS
@@ -67,6 +78,8 @@ Threaded_Object::~Threaded_Object()
 {
 	#ifdef LINUX_OS
 		pthread_mutex_destroy(&mutex);
+		pthread_mutex_destroy(&pause_mutex);
+		pthread_cond_destroy(&pause_cond);
 	#endif
 
 	#ifdef NUCLEUS_OS
@@ -81,7 +94,11 @@ void Threaded_Object::Lock()
 {
 
 	#ifdef LINUX_OS
-		pthread_mutex_lock(&mutex);
+		if(pthread_mutex_trylock(&mutex) != 0)
+		{
+			lock_waits++;
+			pthread_mutex_lock(&mutex);
+		}
 	#endif
 
 	#ifdef NUCLEUS_OS
@@ -126,9 +143,165 @@ uint32 Threaded_Object::Trylock()
 
 /*----------------------------------------------------------------------------------------------*/
 #ifdef LINUX_OS
+/*! Only there so THREAD_WAKE_SIGNAL interrupts blocking calls instead of killing the process */
+static void Wake_Handler(int _sig)
+{
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
 void Threaded_Object::Start_Thread(void *(*_start_routine)(void*), void *_arg)
 {
-	pthread_create(&task, NULL, _start_routine, _arg);
+	pthread_attr_t attr;
+	struct sched_param param;
+	struct sigaction act;
+	cpu_set_t cpus;
+	int32 lcv, err;
+
+	/* No SA_RESTART, so read(), sem_wait() and friends come back with EINTR */
+	memset(&act, 0x0, sizeof(act));
+	act.sa_handler = Wake_Handler;
+	sigemptyset(&act.sa_mask);
+	sigaction(THREAD_WAKE_SIGNAL, &act, NULL);
+
+	start_routine = _start_routine;
+	start_arg = _arg;
+	sched_refused = 0;
+	run = true;
+	joinable = true;
+
+	/* Find the -a option for this task, later ones win */
+	sched = NULL;
+	for(lcv = 0; lcv < gopt.num_sched; lcv++)
+		if((strcmp(gopt.sched[lcv].task_name, "ALL") == 0) ||
+			(strncmp(task_name, gopt.sched[lcv].task_name, strlen(gopt.sched[lcv].task_name)) == 0))
+			sched = &gopt.sched[lcv];
+
+	if(sched == NULL)
+	{
+		pthread_create(&task, NULL, Launch, this);
+		return;
+	}
+
+	pthread_attr_init(&attr);
+
+	if(sched->cpus)
+	{
+		CPU_ZERO(&cpus);
+		for(lcv = 0; lcv < 32; lcv++)
+			if(sched->cpus & (1 << lcv))
+				CPU_SET(lcv, &cpus);
+		pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
+	}
+
+	if(sched->policy == SCHED_FIFO)
+	{
+		param.sched_priority = sched->priority;
+		pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+		pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+		pthread_attr_setschedparam(&attr, &param);
+	}
+
+	err = pthread_create(&task, &attr, Launch, this);
+
+	/* Not privileged, keep the affinity but run as an ordinary thread */
+	if((err == EPERM) && (sched->policy == SCHED_FIFO))
+	{
+		sched_refused |= SCHED_REFUSED_FIFO;
+		pthread_attr_setinheritsched(&attr, PTHREAD_INHERIT_SCHED);
+		err = pthread_create(&task, &attr, Launch, this);
+	}
+
+	/* Bad cpu mask, still have to run somewhere */
+	if(err)
+	{
+		sched_refused |= SCHED_REFUSED_CPUS;
+		if(sched->policy == SCHED_FIFO)
+			sched_refused |= SCHED_REFUSED_FIFO;
+		pthread_create(&task, NULL, Launch, this);
+	}
+
+	pthread_attr_destroy(&attr);
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+/*! The frame is gone by the time the thread body runs, so the body gets the pages this touched
+	rather than Launch() holding on to them */
+void Threaded_Object::PrefaultStack()
+{
+	char prefault[PREFAULT_STACK_SIZE];
+	volatile char *page;
+	int32 lcv;
+
+	/* Stores through a volatile pointer are not optimized out */
+	page = prefault;
+	for(lcv = 0; lcv < PREFAULT_STACK_SIZE; lcv += 4096)
+		page[lcv] = 0;
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void *Threaded_Object::Launch(void *_obj)
+{
+	Threaded_Object *obj;
+
+	obj = (Threaded_Object *)_obj;
+
+	/* Niceness is per thread on Linux but has no pthread attribute, so set it from in here */
+	if((obj->sched != NULL) && (obj->sched->nice != 0))
+		if(setpriority(PRIO_PROCESS, syscall(SYS_gettid), obj->sched->nice) != 0)
+			obj->sched_refused |= SCHED_REFUSED_NICE;
+
+	/* With mlockall(MCL_FUTURE) this pulls the pages in now rather than on the first deep call */
+	if(gopt.lock_memory)
+		PrefaultStack();
+
+	if(obj->sched != NULL)
+		obj->PrintSched(stdout);
+
+#ifdef PROFILE
+	Profile_Start_Thread(obj->task_name);
+#endif
+
+	return(obj->start_routine(obj->start_arg));
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void Threaded_Object::PrintSched(FILE *_fp)
+{
+	struct sched_param param;
+	cpu_set_t cpus;
+	uint32 mask;
+	int32 policy, lcv;
+
+	mask = 0;
+	if(pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpus) == 0)
+		for(lcv = 0; lcv < 32; lcv++)
+			if(CPU_ISSET(lcv, &cpus))
+				mask |= 1 << lcv;
+
+	pthread_getschedparam(pthread_self(), &policy, &param);
+
+	if(policy == SCHED_FIFO)
+		fprintf(_fp,"%.8s: cpus 0x%08x SCHED_FIFO %d", task_name, mask, param.sched_priority);
+	else
+		fprintf(_fp,"%.8s: cpus 0x%08x SCHED_OTHER nice %d", task_name, mask, getpriority(PRIO_PROCESS, syscall(SYS_gettid)));
+
+	if(sched_refused & SCHED_REFUSED_FIFO)
+		fprintf(_fp,", SCHED_FIFO refused (needs CAP_SYS_NICE or ulimit -r)");
+	if(sched_refused & SCHED_REFUSED_CPUS)
+		fprintf(_fp,", cpu mask 0x%08x refused", sched->cpus);
+	if(sched_refused & SCHED_REFUSED_NICE)
+		fprintf(_fp,", nice %d refused", sched->nice);
+
+	fprintf(_fp,"\n");
+	fflush(_fp);
 }
 #endif
 
@@ -146,17 +319,104 @@ void Threaded_Object::Start_Thread(void (*_start_routine)(UNSIGNED)(void*))
 
 
 /*----------------------------------------------------------------------------------------------*/
-void Threaded_Object::Stop()
+void Threaded_Object::RequestStop()
 {
+	run = false;
+	Wake();
+
 	#ifdef LINUX_OS
-		pthread_cancel(task);
-		pthread_join(task, NULL);
+		if(joinable)
+			pthread_kill(task, THREAD_WAKE_SIGNAL);
 	#endif
+}
+/*----------------------------------------------------------------------------------------------*/
 
 
+/*----------------------------------------------------------------------------------------------*/
+uint32 Threaded_Object::Stop()
+{
+	uint64 t0;
+
+	t0 = tsc_now();
+
+	RequestStop();
+
+	#ifdef LINUX_OS
+		struct timespec ts;
+
+		if(!joinable)
+			return(0);
+
+		/* The first signal can land before the thread blocks, so keep knocking until it is out */
+		while(true)
+		{
+			clock_gettime(CLOCK_REALTIME, &ts);
+			ts.tv_nsec += THREAD_STOP_KICK*1000;
+			if(ts.tv_nsec >= 1000000000)
+			{
+				ts.tv_sec++;
+				ts.tv_nsec -= 1000000000;
+			}
+
+			if(pthread_timedjoin_np(task, NULL, &ts) != ETIMEDOUT)
+				break;
+
+			Wake();
+			pthread_kill(task, THREAD_WAKE_SIGNAL);
+		}
+
+		joinable = false;
+	#endif
+
 	#ifdef NUCLEUS_OS
 
 	#endif
+
+	return(tsc_ns(tsc_now() - t0)/1000);
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void Threaded_Object::Wake()
+{
+	#ifdef LINUX_OS
+		pthread_mutex_lock(&pause_mutex);
+		pthread_cond_broadcast(&pause_cond);
+		pthread_mutex_unlock(&pause_mutex);
+	#endif
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+int32 Threaded_Object::Pause(int32 _usec)
+{
+	#ifdef LINUX_OS
+		struct timespec ts;
+
+		clock_gettime(CLOCK_REALTIME, &ts);
+		ts.tv_sec += _usec / 1000000;
+		ts.tv_nsec += (_usec % 1000000) * 1000;
+		if(ts.tv_nsec >= 1000000000)
+		{
+			ts.tv_sec++;
+			ts.tv_nsec -= 1000000000;
+		}
+
+		/* Checked under the mutex so a Wake() between the test and the wait is not lost */
+		pthread_mutex_lock(&pause_mutex);
+		while(Running())
+			if(pthread_cond_timedwait(&pause_cond, &pause_mutex, &ts) == ETIMEDOUT)
+				break;
+		pthread_mutex_unlock(&pause_mutex);
+	#endif
+
+	#ifdef NUCLEUS_OS
+		NU_Sleep(_usec/1000);
+	#endif
+
+	return(Running());
 }
 /*----------------------------------------------------------------------------------------------*/
 
@@ -228,9 +488,17 @@ void Threaded_Object::IncExecTic()
 /*----------------------------------------------------------------------------------------------*/
 void Threaded_Object::IncStartTic()
 {
+	run_start = tsc_now();
+
+	/* Woken by a message, how long did it sit there */
+	if(queue_stamp)
+	{
+		wake_hist.Add(run_start - queue_stamp);
+		queue_stamp = 0;
+	}
+
 	#ifdef LINUX_OS
-		gettimeofday(&tv, NULL);
-		temp_start_tic = 100*(tv.tv_sec - starttime.tv_sec) + (tv.tv_usec - starttime.tv_usec)/10000;
+		temp_start_tic = tsc_tic(run_start);
 	#endif
 
 	#ifdef NUCLEUS_OS
@@ -243,9 +511,14 @@ void Threaded_Object::IncStartTic()
 /*----------------------------------------------------------------------------------------------*/
 void Threaded_Object::IncStopTic()
 {
+	uint64 now;
+
+	now = tsc_now();
+	if(run_start)
+		run_hist.Add(now - run_start);
+
 	#ifdef LINUX_OS
-		gettimeofday(&tv, NULL);
-		stop_tic = 100*(tv.tv_sec - starttime.tv_sec) + (tv.tv_usec - starttime.tv_usec)/10000;
+		stop_tic = tsc_tic(now);
 		start_tic = temp_start_tic;
 	#endif
 
@@ -257,6 +530,20 @@ void Threaded_Object::IncStopTic()
 /*----------------------------------------------------------------------------------------------*/
 
 
+/*----------------------------------------------------------------------------------------------*/
+void Threaded_Object::PrintLatency(FILE *_fp)
+{
+	char name[32];
+
+	sprintf(name, "%.8s run", task_name);
+	run_hist.Print(_fp, name);
+
+	sprintf(name, "%.8s wake", task_name);
+	wake_hist.Print(_fp, name);
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
 /*----------------------------------------------------------------------------------------------*/
 void Threaded_Object::setStack()
 {
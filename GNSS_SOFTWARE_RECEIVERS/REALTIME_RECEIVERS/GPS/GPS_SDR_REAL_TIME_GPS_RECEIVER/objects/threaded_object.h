@@ -35,6 +35,14 @@
 	#include <time.h>
 #endif
 
+#define SCHED_REFUSED_FIFO	(0x1)	//!< No CAP_SYS_NICE/RLIMIT_RTPRIO, running SCHED_OTHER
+#define SCHED_REFUSED_CPUS	(0x2)	//!< None of the cpus are online, left floating
+#define SCHED_REFUSED_NICE	(0x4)	//!< Not allowed to lower the niceness
+
+#define THREAD_WAKE_SIGNAL	(SIGUSR2)	//!< Interrupts a system call the thread is blocked in, the handler does nothing
+
+extern __thread uint32 lock_waits;	//!< Lock() calls by this thread that found the mutex already taken
+
 /*! @ingroup CLASSES
 	@brief The Threaded_Object class provides the base functionality to monitor each tasks' status
 	 and health. This should be OS transparent, and will depend on the #defines LINUX_OS or NUCLEUS_OS
@@ -54,6 +62,10 @@ class Threaded_Object
 		uint32				stack;			//!< Number of bytes on stack
 		void 				*task_mem;		//!< Pointer to the task memory
 		void				*object_mem;	//!< Pointer to the class memory
+		uint64				run_start;		//!< TSC at start of function
+		Histogram			run_hist;		//!< Time from IncStartTic to IncStopTic
+		Histogram			wake_hist;		//!< Time from the waking message being sent to IncStartTic
+		volatile int32		run;			//!< Stop token, cleared by RequestStop() and polled through Running()
 
 		#ifdef NUCLEUS_OS
 			NU_TASK 		task;			//!< Nucleus task variable
@@ -63,7 +75,13 @@ class Threaded_Object
 		#ifdef LINUX_OS
 			pthread_t 		task;			//!< pthread task variable
 			pthread_mutex_t	mutex;			//!< Lock and unlock the object
-			struct timeval 	tv;				//!< To emulate 500 us tic
+			void			*(*start_routine)(void*);	//!< Thread body, run by Launch()
+			void			*start_arg;		//!< Argument to start_routine
+			Sched_Option_S	*sched;			//!< Scheduling asked for with -a, NULL if none
+			uint32			sched_refused;	//!< SCHED_REFUSED_* bits, what the OS would not give us
+			pthread_mutex_t	pause_mutex;	//!< Guards pause_cond
+			pthread_cond_t	pause_cond;		//!< Pause() sleeps on this, Wake() broadcasts it
+			int32			joinable;		//!< Start_Thread() made a thread that has not been joined yet
 		#endif
 
 	public:
@@ -75,8 +93,13 @@ class Threaded_Object
 		void Lock();			//!< Lock the object's mutex
 		void Unlock();			//!< Unlock the object's mutex
 		uint32 Trylock();		//!< Trylock, locks the mutex and returns true, else returns false
-		void Stop();			//!< Stop the thread
+		void RequestStop();		//!< Clear the stop token and wake the thread, does not wait
+		uint32 Stop();			//!< Stop the thread and join it, returns how long that took in us
+		void Wake();			//!< Cut short a Pause()
+		int32 Running(){return(run && grun);}	//!< Loop condition for the thread, false once asked to stop
+		int32 Pause(int32 _usec);	//!< Sleep that Wake() cuts short, returns Running()
 
+		const char *getTaskName(){return(task_name);}	//!< 8 characters, not always terminated
 		uint32 getExecTic();	//!< Get the execution counter
 		uint32 getStartTic();	//!< Get the 500 us ISR tic at start of function
 		uint32 getStopTic();	//!< Get the 500 us ISR tic at end of function
@@ -84,6 +107,9 @@ class Threaded_Object
 		uint32 getStack();		//!< Get the stack size
 		void *getTaskMem();		//!< Get the task memory
 		void *getObjectMem();	//!< Get the class memory
+		Histogram *getRunHist(){return(&run_hist);}		//!< Get the run time histogram
+		Histogram *getWakeHist(){return(&wake_hist);}	//!< Get the wake up latency histogram
+		void PrintLatency(FILE *_fp);					//!< Dump both histograms
 
 		void IncExecTic();		//!< Increment execution tic
 		void IncStartTic();		//!< Get the 500 us ISR tic
@@ -92,6 +118,9 @@ class Threaded_Object
 
 		#ifdef LINUX_OS
 			void Start_Thread(void *(*_start_routine)(void*), void *_arg);	//!< Start the thread
+			static void *Launch(void *_obj);	//!< Apply niceness/prefault inside the new thread, then run it
+			static void PrefaultStack() __attribute__((noinline));	//!< Touch the stack the thread body will run on
+			void PrintSched(FILE *_fp);			//!< Log the affinity/policy the calling thread actually got
 		#endif
 
 		#ifdef NUCLEUS_OS
@@ -0,0 +1,189 @@
+/*----------------------------------------------------------------------------------------------*/
+/*! \file tracking.cpp
+//
+// FILENAME: tracking.cpp
+//
+// DESCRIPTION: Close the channels' tracking loops on their own thread, so a channel hitting the
+//				FFT or a subframe boundary does not eat into the correlator's 1 ms
+//
+// DEVELOPERS: Gregory W. Heckler (2003-2009)
+//
+// LICENSE TERMS: Copyright (c) Gregory W. Heckler 2009
+//
+// This file is part of the GPS Software Defined Radio (GPS-SDR)
+//
+// The GPS-SDR is free software; you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation; either version 2 of
+// the License, or (at your option) any later version. The GPS-SDR is distributed in the hope that
+// it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// Note:  Comments within this file follow a syntax that is compatible with
+//        DOXYGEN and are utilized for automated document extraction
+//
+// Reference:
+*/
+/*----------------------------------------------------------------------------------------------*/
+
+#include "tracking.h"
+
+/*----------------------------------------------------------------------------------------------*/
+void *Tracking_Thread(void *_arg)
+{
+
+	Tracking *aTracking = pTracking;
+
+	while(aTracking->Running())
+	{
+		aTracking->Import();
+		aTracking->Step();
+		aTracking->IncExecTic();
+	}
+
+	pthread_exit(0);
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void Tracking::Start()
+{
+	Start_Thread(Tracking_Thread, NULL);
+
+	if(gopt.verbose)
+		fprintf(stdout,"Tracking thread started\n");
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+Tracking::Tracking():Threaded_Object("TRKTASK")
+{
+
+	object_mem = this;
+	size = sizeof(Tracking);
+
+	signal_tsc = 0;
+	dropped = 0;
+
+	if(gopt.verbose)
+		fprintf(stdout,"Creating Tracking\n");
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+Tracking::~Tracking()
+{
+	if(gopt.verbose)
+		fprintf(stdout,"Destructing Tracking\n");
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void Tracking::Import()
+{
+
+	event.Wait(TRACKING_IDLE_WAIT);
+
+	/* The correlator's signal stands in for the message the other tasks wake on */
+	queue_stamp = signal_tsc;
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+int32 Tracking::Step()
+{
+
+	Dump_S dump[MAX_CHANNELS];
+	NCO_Command_S feedback;
+	int32 pending[MAX_CHANNELS];
+	int32 lcv, count, received, loaded;
+
+	IncStartTic();
+
+	count = 0;
+	do
+	{
+		/* Take at most one dump per channel per sweep, so each channel's dumps stay in order */
+		received = loaded = 0;
+		for(lcv = 0; lcv < MAX_CHANNELS; lcv++)
+		{
+			pending[lcv] = false;
+
+			if(!COR_2_TRK_P[lcv]->TryReceive(&dump[lcv]))
+				continue;
+
+			received++;
+
+			if(dump[lcv].start)
+			{
+				StartChannel(lcv, &dump[lcv].result);
+				continue;
+			}
+
+			pChannels[lcv]->Accum(&dump[lcv].corr, dump[lcv].tic, dump[lcv].count);
+			pending[lcv] = true;
+			loaded++;
+		}
+
+		count += received;
+		if(loaded == 0)
+			continue;
+
+		/* Discriminators, loop filters and cn0 of every channel that dumped, in one go */
+		sse_track(&gloops[0], LOOP_BANKS);
+
+		for(lcv = 0; lcv < MAX_CHANNELS; lcv++)
+		{
+			if(!pending[lcv])
+				continue;
+
+			memset(&feedback, 0x0, sizeof(NCO_Command_S));
+			pChannels[lcv]->Close(&feedback);
+
+			/* Tag it so the correlator can tell which dump it answers */
+			feedback.generation = dump[lcv].generation;
+			feedback.dump_1ms_epoch = dump[lcv]._1ms_epoch;
+			feedback.dump_20ms_epoch = dump[lcv]._20ms_epoch;
+			feedback.dump_z_count = dump[lcv]._z_count;
+
+			if(!TRK_2_COR_P[lcv]->TrySend(&feedback))
+				dropped++;
+		}
+
+	} while(received);
+
+	IncStopTic();
+
+	return(count);
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void Tracking::StartChannel(int32 _chan, Acq_Command_S *_result)
+{
+
+	switch(_result->type)
+	{
+		case ACQ_TYPE_STRONG:
+			pChannels[_chan]->Start(_result->sv, *_result, 1);
+			break;
+		case ACQ_TYPE_MEDIUM:
+			pChannels[_chan]->Start(_result->sv, *_result, 10);
+			break;
+		case ACQ_TYPE_WEAK:
+			pChannels[_chan]->Start(_result->sv, *_result, 10);
+			break;
+	}
+
+}
+/*----------------------------------------------------------------------------------------------*/
@@ -0,0 +1,70 @@
+/*----------------------------------------------------------------------------------------------*/
+/*! \file tracking.h
+//
+// FILENAME: tracking.h
+//
+// DESCRIPTION: Defines the Tracking class, runs the channels' loops off the correlator thread
+//
+// DEVELOPERS: Gregory W. Heckler (2003-2009)
+//
+// LICENSE TERMS: Copyright (c) Gregory W. Heckler 2009
+//
+// This file is part of the GPS Software Defined Radio (GPS-SDR)
+//
+// The GPS-SDR is free software; you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation; either version 2 of
+// the License, or (at your option) any later version. The GPS-SDR is distributed in the hope that
+// it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// Note:  Comments within this file follow a syntax that is compatible with
+//        DOXYGEN and are utilized for automated document extraction
+//
+// Reference:
+*/
+/*----------------------------------------------------------------------------------------------*/
+
+
+#ifndef TRACKING_H_
+#define TRACKING_H_
+
+#include "includes.h"
+#include "channel.h"
+#include "sv_select.h"
+
+#define TRACKING_IDLE_WAIT	(100)	//!< ms the tracking sleeps when the correlator has nothing for it
+
+/*! \ingroup CLASSES
+ *	@brief Owns the channels. The correlator hands every dump to a channel's COR_2_TRK_P queue and
+ *	goes straight on with the next one, this thread runs Channel::Accum() on it, closes the loops
+ *	and the C/N0 of all the channels that dumped with one sse_track() over gloops, then lets
+ *	Channel::Close() do bit and frame sync and sends the NCO command back on TRK_2_COR_P. The
+ *	correlator applies it at the channel's next dump, so the feedback is always exactly one
+ *	integration period (1 ms) old; a command that is not back by then is counted as a loop miss
+ *	and used at the dump after. The epoch resets in it are replayed relative to the dump they were
+ *	made for, so a late command never puts the measurements out of step.
+ */
+class Tracking : public Threaded_Object
+{
+
+	private:
+
+		Event event;					//!< The correlator signals this once per ms it dumped
+		volatile uint64 signal_tsc;		//!< When it last did, for the wake up latency
+		uint32 dropped;					//!< Commands that found the correlator's queue full
+
+		void StartChannel(int32 _chan, Acq_Command_S *_result);	//!< Start a channel on an acquisition
+
+	public:
+
+		Tracking();
+		~Tracking();
+		void Start();					//!< Start the thread
+		void Import();					//!< Sleep until the correlator has dumped something
+		int32 Step();					//!< Process every dump that is waiting, returns how many
+		void Signal(){signal_tsc = tsc_now(); event.Signal();}	//!< Called by the correlator
+		uint32 getDropped(){return(dropped);}
+};
+
+#endif /* TRACKING_H_ */
@@ -0,0 +1,198 @@
+/*----------------------------------------------------------------------------------------------*/
+/*! \file wls.cpp
+//
+// FILENAME: wls.cpp
+//
+// DESCRIPTION: Implements member functions of the WLS class.
+//
+// DEVELOPERS: Gregory W. Heckler (2003-2009)
+//
+// LICENSE TERMS: Copyright (c) Gregory W. Heckler 2009
+//
+// This file is part of the GPS Software Defined Radio (GPS-SDR)
+//
+// The GPS-SDR is free software; you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation; either version 2 of
+// the License, or (at your option) any later version. The GPS-SDR is distributed in the hope that
+// it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// Note:  Comments within this file follow a syntax that is compatible with
+//        DOXYGEN and are utilized for automated document extraction
+//
+// Reference:
+*/
+/*----------------------------------------------------------------------------------------------*/
+
+#include "wls.h"
+
+/*----------------------------------------------------------------------------------------------*/
+double WLS::Weight(double _cn0, double _elev)
+{
+	double s;
+
+	/* Inverse of the DLL's noise variance, which goes with 1/(C/N0), times sin^2 for the rest */
+	if(_elev < PVT_ELEV_MIN*DEG_2_RAD)
+		_elev = PVT_ELEV_MIN*DEG_2_RAD;
+
+	s = sin(_elev);
+
+	return(pow(10.0, (_cn0 - PVT_CN0_REF)/10.0)*s*s);
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+int32 WLS::Factor(double _H[][4], double *_w, int32 _cnt)
+{
+	double N[4][4];
+	double h0, h1, h2, h3, w, s;
+	int32 lcv, lcv2, lcv3;
+
+	/* H'WH, only the 10 terms of the lower triangle */
+	memset(N, 0x0, sizeof(N));
+	for(lcv = 0; lcv < _cnt; lcv++)
+	{
+		w = _w[lcv];
+		h0 = _H[lcv][0]; h1 = _H[lcv][1]; h2 = _H[lcv][2]; h3 = _H[lcv][3];
+
+		N[0][0] += w*h0*h0;
+		N[1][0] += w*h1*h0; N[1][1] += w*h1*h1;
+		N[2][0] += w*h2*h0; N[2][1] += w*h2*h1; N[2][2] += w*h2*h2;
+		N[3][0] += w*h3*h0; N[3][1] += w*h3*h1; N[3][2] += w*h3*h2; N[3][3] += w*h3*h3;
+	}
+
+	/* Cholesky, N = LL' */
+	for(lcv = 0; lcv < 4; lcv++)
+	{
+		s = N[lcv][lcv];
+		for(lcv3 = 0; lcv3 < lcv; lcv3++)
+			s -= L[lcv][lcv3]*L[lcv][lcv3];
+
+		/* Singular geometry, or close enough to it that the update would be noise */
+		if(s <= 1e-12*N[lcv][lcv])
+			return(false);
+
+		L[lcv][lcv] = sqrt(s);
+		s = 1.0/L[lcv][lcv];
+
+		for(lcv2 = lcv + 1; lcv2 < 4; lcv2++)
+		{
+			L[lcv2][lcv] = N[lcv2][lcv];
+			for(lcv3 = 0; lcv3 < lcv; lcv3++)
+				L[lcv2][lcv] -= L[lcv2][lcv3]*L[lcv][lcv3];
+			L[lcv2][lcv] *= s;
+		}
+	}
+
+	return(true);
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void WLS::Solve(double _H[][4], double *_w, double *_y, double *_z, int32 _cnt, double *_dy, double *_dz)
+{
+	double by[4], bz[4];
+	double wy, wz;
+	int32 lcv, lcv2;
+
+	/* H'Wy and H'Wz in one pass over the rows */
+	by[0] = by[1] = by[2] = by[3] = 0;
+	bz[0] = bz[1] = bz[2] = bz[3] = 0;
+	for(lcv = 0; lcv < _cnt; lcv++)
+	{
+		wy = _w[lcv]*_y[lcv];
+		wz = _w[lcv]*_z[lcv];
+		for(lcv2 = 0; lcv2 < 4; lcv2++)
+		{
+			by[lcv2] += _H[lcv][lcv2]*wy;
+			bz[lcv2] += _H[lcv][lcv2]*wz;
+		}
+	}
+
+	/* Forward, Lu = b */
+	for(lcv = 0; lcv < 4; lcv++)
+	{
+		for(lcv2 = 0; lcv2 < lcv; lcv2++)
+		{
+			by[lcv] -= L[lcv][lcv2]*by[lcv2];
+			bz[lcv] -= L[lcv][lcv2]*bz[lcv2];
+		}
+		by[lcv] /= L[lcv][lcv];
+		bz[lcv] /= L[lcv][lcv];
+	}
+
+	/* Back, L'x = u */
+	for(lcv = 3; lcv >= 0; lcv--)
+	{
+		for(lcv2 = lcv + 1; lcv2 < 4; lcv2++)
+		{
+			by[lcv] -= L[lcv2][lcv]*by[lcv2];
+			bz[lcv] -= L[lcv2][lcv]*bz[lcv2];
+		}
+		by[lcv] /= L[lcv][lcv];
+		bz[lcv] /= L[lcv][lcv];
+	}
+
+	memcpy(_dy, by, sizeof(by));
+	memcpy(_dz, bz, sizeof(bz));
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void WLS::Covariance()
+{
+	double Li[4][4];
+	double s;
+	int32 lcv, lcv2, lcv3;
+
+	/* Invert the triangle */
+	memset(Li, 0x0, sizeof(Li));
+	for(lcv = 0; lcv < 4; lcv++)
+	{
+		Li[lcv][lcv] = 1.0/L[lcv][lcv];
+		for(lcv2 = lcv + 1; lcv2 < 4; lcv2++)
+		{
+			s = 0;
+			for(lcv3 = lcv; lcv3 < lcv2; lcv3++)
+				s -= L[lcv2][lcv3]*Li[lcv3][lcv];
+			Li[lcv2][lcv] = s/L[lcv2][lcv2];
+		}
+	}
+
+	/* C = Li'Li */
+	for(lcv = 0; lcv < 4; lcv++)
+	{
+		for(lcv2 = lcv; lcv2 < 4; lcv2++)
+		{
+			s = 0;
+			for(lcv3 = lcv2; lcv3 < 4; lcv3++)
+				s += Li[lcv3][lcv]*Li[lcv3][lcv2];
+			C[lcv][lcv2] = C[lcv2][lcv] = s;
+		}
+	}
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+double WLS::Redundancy(double *_h, double _w)
+{
+	double s, t;
+	int32 lcv, lcv2;
+
+	s = 0;
+	for(lcv = 0; lcv < 4; lcv++)
+	{
+		t = 0;
+		for(lcv2 = 0; lcv2 < 4; lcv2++)
+			t += C[lcv][lcv2]*_h[lcv2];
+		s += _h[lcv]*t;
+	}
+
+	return(1.0 - _w*s);
+}
+/*----------------------------------------------------------------------------------------------*/
@@ -0,0 +1,59 @@
+/*----------------------------------------------------------------------------------------------*/
+/*! \file wls.h
+//
+// FILENAME: wls.h
+//
+// DESCRIPTION: Defines the WLS class, the weighted least squares factorization behind the
+//				point solution
+//
+// DEVELOPERS: Gregory W. Heckler (2003-2009)
+//
+// LICENSE TERMS: Copyright (c) Gregory W. Heckler 2009
+//
+// This file is part of the GPS Software Defined Radio (GPS-SDR)
+//
+// The GPS-SDR is free software; you can redistribute it and/or modify it under the terms of the
+// GNU General Public License as published by the Free Software Foundation; either version 2 of
+// the License, or (at your option) any later version. The GPS-SDR is distributed in the hope that
+// it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// Note:  Comments within this file follow a syntax that is compatible with
+//        DOXYGEN and are utilized for automated document extraction
+//
+// Reference:
+*/
+/*----------------------------------------------------------------------------------------------*/
+
+#ifndef WLS_H_
+#define WLS_H_
+
+#include "includes.h"
+
+/*! \ingroup CLASSES
+ *	@brief Weighted least squares on the MAX_CHANNELS x 4 geometry matrix, everything on the
+ *	stack or in the object, nothing allocated. Factor() forms H'WH and takes its Cholesky factor,
+ *	Solve() runs the position and the velocity right hand sides through that one factor, and
+ *	Covariance() turns it into (H'WH)^-1 once per fix for the DOP and the RAIM redundancies.
+ */
+class WLS
+{
+
+	private:
+
+		double L[4][4];							//!< Lower Cholesky factor of H'WH
+		double C[4][4];							//!< (H'WH)^-1, valid after Covariance()
+
+	public:
+
+		static double Weight(double _cn0, double _elev);	//!< Weight of a measurement at _cn0 dB-Hz and _elev radians
+
+		int32 Factor(double _H[][4], double *_w, int32 _cnt);	//!< Factor H'WH, false if it is not positive definite
+		void Solve(double _H[][4], double *_w, double *_y, double *_z, int32 _cnt, double *_dy, double *_dz); //!< Both updates off the factor
+		void Covariance();						//!< (H'WH)^-1 from the factor
+		double Redundancy(double *_h, double _w);	//!< 1 - w*h'Ch, the part of a residual the fit cannot absorb
+		double Trace(int32 _lo, int32 _hi){double t = 0; for(int32 i = _lo; i < _hi; i++) t += C[i][i]; return(t);} //!< Sum of the covariance diagonal
+};
+
+#endif /* WLS_H_ */
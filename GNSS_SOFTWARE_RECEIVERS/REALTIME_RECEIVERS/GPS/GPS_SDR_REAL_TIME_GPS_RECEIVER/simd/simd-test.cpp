@@ -23,6 +23,7 @@ Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1
 #define GLOBALS_HERE
 
 #include "includes.h"
+#include "resampler.h"
 
 #define VECTSIZE (10000)
 #define REPEATS	 (100)
@@ -102,6 +103,366 @@ void fill_prn_new(MIX *_vect, int32 _samps)
 
 }
 
+void fill_2bit(int8 *_vect, int32 _samps)
+{
+	int32 lcv;
+
+	/* Raw sampler bytes, only the bottom 2 bits are used */
+	for(lcv = 0; lcv < _samps; lcv++)
+		_vect[lcv] = (int8)rand();
+
+}
+
+
+//!< The original floating point GN3S mixer, kept to check the integer NCO against
+void dbl_mix_2bit(int8 *_A, CPX *_B, int32 _cnt, uint32 *_phase, uint32 _dphase)
+{
+	static double sin_table[1024];
+	static double cos_table[1024];
+	static int32 init = 0;
+	int16 LUT[4] = {-3, -1, 1, 3};
+	int32 lcv;
+	uint32 phase = *_phase;
+
+	if(!init)
+	{
+		for(lcv = 0; lcv < 1024; lcv++)
+		{
+			sin_table[lcv] = -8*sin(2*M_PI*lcv/1024);
+			cos_table[lcv] = +8*cos(2*M_PI*lcv/1024);
+		}
+		init = 1;
+	}
+
+	for(lcv = 0; lcv < _cnt; lcv++)
+	{
+		_B[lcv].q = (int16)(LUT[_A[lcv] & 0x03] * sin_table[phase >> 22]);
+		_B[lcv].i = (int16)(LUT[_A[lcv] & 0x03] * cos_table[phase >> 22]);
+		phase += _dphase;
+	}
+
+	*_phase = phase;
+}
+
+
+//!< Power of _vect at _f (normalized to the sample rate), skipping the filter transient
+double tone_power(CPX *_vect, int32 _samps, double _f)
+{
+	int32 lcv;
+	double si, sq;
+
+	si = sq = 0;
+
+	for(lcv = 64; lcv < _samps; lcv++)
+	{
+		si += _vect[lcv].i*cos(2*M_PI*_f*lcv) + _vect[lcv].q*sin(2*M_PI*_f*lcv);
+		sq += _vect[lcv].q*cos(2*M_PI*_f*lcv) - _vect[lcv].i*sin(2*M_PI*_f*lcv);
+	}
+
+	si /= (_samps - 64);
+	sq /= (_samps - 64);
+
+	return(si*si + sq*sq);
+}
+
+
+//!< Tracking loop inputs and state in the ranges a channel sees, half the lanes masked off
+void fill_loops(Loop_Bank_S *_A, int32 _cnt)
+{
+	Loop_Bank_S *a;
+	int32 lcv, lane;
+	float t, w0p, np;
+
+	for(lcv = 0; lcv < _cnt; lcv++)
+	{
+		a = &_A[lcv];
+		for(lane = 0; lane < 4; lane++)
+		{
+			a->ip[lane] = (float)((rand() % 12001) - 6000);
+			a->qp[lane] = (float)((rand() % 12001) - 6000);
+			if((rand() & 0x7) == 0)
+				a->ip[lane] = 0;
+			a->pe[lane] = (float)(rand() % 40000000);
+			a->pl[lane] = (float)(rand() % 40000000 + 1);
+
+			np = 20.0f*(float)rand()/RAND_MAX;
+			a->wbp[lane] = (float)(rand() % 10000000);
+			a->nbp[lane] = (float)(int32)(np*a->wbp[lane]);
+
+			/* As Channel::PLL_W(18.0) sets them */
+			t = (rand() & 0x1) ? .001 : .020;
+			w0p = 18.0/0.7845;
+			a->kw[lane] = t*w0p*w0p*w0p;
+			a->kx[lane] = t*1.10*w0p*w0p;
+			a->kh[lane] = 0.5*t;
+			a->kz[lane] = 2.40*w0p;
+
+			a->w[lane] = (float)((rand() % 2001) - 1000)/10.0;
+			a->x[lane] = (float)((rand() % 20001) - 10000);
+			a->z[lane] = 0.5*a->x[lane];
+			a->cn0[lane] = 15.0 + (float)(rand() % 3500)/100.0;
+
+			a->pll[lane] = (rand() & 0x1) ? 0xffffffff : 0;
+			a->est[lane] = (rand() & 0x1) ? 0xffffffff : 0;
+		}
+	}
+}
+
+
+//!< The loops as Channel::PLL(), DLL() and EstCN0() closed them one channel at a time, kept to check sse_track against
+void dbl_track(Loop_Bank_S *_A, int32 _cnt)
+{
+	Loop_Bank_S *a;
+	int32 lcv, lane;
+	double dp, np, ncn0;
+
+	for(lcv = 0; lcv < _cnt; lcv++)
+	{
+		a = &_A[lcv];
+		for(lane = 0; lane < 4; lane++)
+		{
+			dp = 0;
+			if(a->pll[lane])
+			{
+				if(a->ip[lane] != 0)
+					dp = atan((double)a->qp[lane]/(double)a->ip[lane])/(2*M_PI);
+				a->w[lane] += a->kw[lane]*dp;
+				a->x[lane] += a->kh[lane]*a->w[lane] + a->kx[lane]*dp;
+				a->z[lane]  = 0.5*a->x[lane] + a->kz[lane]*dp;
+			}
+			a->dp[lane] = dp;
+
+			a->code_err[lane] = (sqrt((double)a->pe[lane]) - sqrt((double)a->pl[lane]))/sqrt((double)a->pe[lane] + a->pl[lane]);
+
+			if(a->est[lane])
+			{
+				if(a->wbp[lane] > 0)
+				{
+					np = (double)a->nbp[lane]/a->wbp[lane];
+					if((np - 1.0)/(20.0 - np) > 0.0)
+					{
+						ncn0 = 10*log10((np - 1.0)/(20.0 - np)) + 30.0 + .25;
+						a->cn0[lane] += (ncn0 - a->cn0[lane])*.02;
+					}
+				}
+				if(a->cn0[lane] < 15.0)
+					a->cn0[lane] = 15.0;
+			}
+		}
+	}
+}
+
+
+/*! Lanes of _B that stray from _A by more than the sweep is allowed to: 2.5e-6 cycles of phase
+	discriminator, that error times the gains plus 1 ppm + 1e-4 Hz of loop filter state, 1e-5 of
+	code discriminator and 1e-3 dB of CN0. The worst phase and CN0 errors seen go in _max. */
+int32 track_check(Loop_Bank_S *_A, Loop_Bank_S *_B, int32 _cnt, double *_max)
+{
+	Loop_Bank_S *a, *b;
+	int32 lcv, lane, err;
+	double kx;
+
+	err = 0;
+	for(lcv = 0; lcv < _cnt; lcv++)
+	{
+		a = &_A[lcv];
+		b = &_B[lcv];
+		for(lane = 0; lane < 4; lane++)
+		{
+			kx = a->kx[lane] + a->kh[lane]*a->kw[lane];
+
+			if(!(fabs(a->dp[lane] - b->dp[lane]) <= 2.5e-6))
+				err++;
+			if(!(fabs(a->w[lane] - b->w[lane]) <= 2.5e-6*a->kw[lane] + 1e-6*fabs(a->w[lane]) + 1e-4))
+				err++;
+			if(!(fabs(a->x[lane] - b->x[lane]) <= 2.5e-6*kx + 1e-6*fabs(a->x[lane]) + 1e-4))
+				err++;
+			if(!(fabs(a->z[lane] - b->z[lane]) <= 2.5e-6*(0.5*kx + a->kz[lane]) + 1e-6*fabs(a->z[lane]) + 1e-4))
+				err++;
+			if(!(fabs(a->code_err[lane] - b->code_err[lane]) <= 1e-5))
+				err++;
+			if(!(fabs(a->cn0[lane] - b->cn0[lane]) <= 1e-3))
+				err++;
+
+			if(fabs(a->dp[lane] - b->dp[lane]) > _max[0])
+				_max[0] = fabs(a->dp[lane] - b->dp[lane]);
+			if(fabs(a->cn0[lane] - b->cn0[lane]) > _max[1])
+				_max[1] = fabs(a->cn0[lane] - b->cn0[lane]);
+		}
+	}
+
+	return(err);
+}
+
+
+//!< A receiver somewhere between the ground and a low orbit and SVs all round it, half of them below the horizon
+void fill_predict(Predict_Bank_S *_A, Predict_Frame_S *_F, int32 _cnt)
+{
+	Predict_Bank_S *a;
+	int32 lcv, lane, k;
+	double lat, lon, glat, alt, r, rx[3], rv[3], s[3], v[3], w[3], m;
+
+	lat = M_PI*((double)rand()/RAND_MAX - 0.5);
+	lon = 2*M_PI*(double)rand()/RAND_MAX;
+	glat = lat - 0.0034*sin(2*lat);
+	alt = (rand() & 0x1) ? 0 : 2e6*(double)rand()/RAND_MAX;
+	r = 6371e3 + alt;
+
+	rx[0] = r*cos(glat)*cos(lon);
+	rx[1] = r*cos(glat)*sin(lon);
+	rx[2] = r*sin(glat);
+	for(k = 0; k < 3; k++)
+		rv[k] = (alt > 0 ? 7500.0 : 30.0)*((double)rand()/RAND_MAX - 0.5);
+
+	for(lane = 0; lane < 4; lane++)
+	{
+		_F->ex[lane] = -sin(lon);
+		_F->ey[lane] = cos(lon);
+		_F->ez[lane] = 0;
+		_F->nx[lane] = -sin(lat)*cos(lon);
+		_F->ny[lane] = -sin(lat)*sin(lon);
+		_F->nz[lane] = cos(lat);
+		_F->ux[lane] = cos(lat)*cos(lon);
+		_F->uy[lane] = cos(lat)*sin(lon);
+		_F->uz[lane] = sin(lat);
+		_F->gx[lane] = cos(glat)*cos(lon);
+		_F->gy[lane] = cos(glat)*sin(lon);
+		_F->gz[lane] = sin(glat);
+		_F->mask[lane] = (alt > 10000) ? -cos(atan(6367e3/r)) : -cos(M_PI/2);
+	}
+
+	for(lcv = 0; lcv < _cnt; lcv++)
+	{
+		a = &_A[lcv];
+		for(lane = 0; lane < 4; lane++)
+		{
+			/* On a 26560 km sphere, moving at 3.9 km/s across it */
+			for(k = 0; k < 3; k++)
+				s[k] = (double)rand()/RAND_MAX - 0.5;
+			m = sqrt(s[0]*s[0] + s[1]*s[1] + s[2]*s[2]);
+			for(k = 0; k < 3; k++)
+			{
+				s[k] /= m;
+				w[k] = (double)rand()/RAND_MAX - 0.5;
+			}
+			v[0] = s[1]*w[2] - s[2]*w[1];
+			v[1] = s[2]*w[0] - s[0]*w[2];
+			v[2] = s[0]*w[1] - s[1]*w[0];
+			m = sqrt(v[0]*v[0] + v[1]*v[1] + v[2]*v[2]);
+
+			a->dx[lane] = 26560e3*s[0] - rx[0];
+			a->dy[lane] = 26560e3*s[1] - rx[1];
+			a->dz[lane] = 26560e3*s[2] - rx[2];
+			a->dvx[lane] = 3874.0*v[0]/m - rv[0];
+			a->dvy[lane] = 3874.0*v[1]/m - rv[1];
+			a->dvz[lane] = 3874.0*v[2]/m - rv[2];
+			a->dax[lane] = -0.57*s[0] + 8.0*((double)rand()/RAND_MAX - 0.5);
+			a->day[lane] = -0.57*s[1] + 8.0*((double)rand()/RAND_MAX - 0.5);
+			a->daz[lane] = -0.57*s[2] + 8.0*((double)rand()/RAND_MAX - 0.5);
+			a->clock[lane] = 1e-3*((double)rand()/RAND_MAX - 0.5);
+			a->drift[lane] = 300.0*((double)rand()/RAND_MAX - 0.5);
+		}
+	}
+}
+
+
+//!< The prediction as SV_Select::SV_Predict() made it one SV at a time, in double off the same inputs
+void dbl_predict(Predict_Bank_S *_A, Predict_Frame_S *_F, int32 _cnt)
+{
+	Predict_Bank_S *a;
+	int32 lcv, lane;
+	double dx, dy, dz, dvx, dvy, dvz, c, ux, uy, uz, dux, duy, duz, relvel, relaccel, e, n, u;
+
+	for(lcv = 0; lcv < _cnt; lcv++)
+	{
+		a = &_A[lcv];
+		for(lane = 0; lane < 4; lane++)
+		{
+			dx = a->dx[lane]; dy = a->dy[lane]; dz = a->dz[lane];
+			dvx = a->dvx[lane]; dvy = a->dvy[lane]; dvz = a->dvz[lane];
+
+			c = sqrt(dx*dx + dy*dy + dz*dz);
+			ux = dx/c; uy = dy/c; uz = dz/c;
+			relvel = dvx*ux + dvy*uy + dvz*uz;
+			dux = (dvx*c - dx*relvel)/(c*c);
+			duy = (dvy*c - dy*relvel)/(c*c);
+			duz = (dvz*c - dz*relvel)/(c*c);
+			relaccel = ux*a->dax[lane] + dux*dvx + uy*a->day[lane] + duy*dvy + uz*a->daz[lane] + duz*dvz;
+
+			a->delay[lane] = c*INVERSE_SPEED_OF_LIGHT - a->clock[lane];
+			a->doppler[lane] = (-relvel - a->drift[lane])*L1_OVER_C;
+			a->doppler_rate[lane] = -relaccel*L1_OVER_C;
+
+			e = _F->ex[0]*ux + _F->ey[0]*uy + _F->ez[0]*uz;
+			n = _F->nx[0]*ux + _F->ny[0]*uy + _F->nz[0]*uz;
+			u = _F->ux[0]*ux + _F->uy[0]*uy + _F->uz[0]*uz;
+			a->elev[lane] = atan2(u, sqrt(n*n + e*e));
+			a->azim[lane] = atan2(e, n);
+			a->visible[lane] = (acos(-(_F->gx[0]*ux + _F->gy[0]*uy + _F->gz[0]*uz)) > acos(-_F->mask[0])) ? 0xffffffff : 0;
+		}
+	}
+}
+
+
+/*! Lanes of _B that stray from _A by more than the sweep is allowed to: 5e-8 s of delay (15 m, about
+	what a float holds at 34000 km), 0.02 Hz of Doppler, 1e-3 Hz/s of Doppler rate and 3e-5 rad of
+	elevation and azimuth, the azimuth scaled by cos(elevation) as it means nothing straight up or down.
+	Visibility has to agree unless the SV is within 1e-5 of the mask. The worst Doppler and angle errors
+	seen go in _max. */
+int32 predict_check(Predict_Bank_S *_A, Predict_Bank_S *_B, Predict_Frame_S *_F, int32 _cnt, double *_max)
+{
+	Predict_Bank_S *a, *b;
+	int32 lcv, lane, err;
+	double g, da;
+
+	err = 0;
+	for(lcv = 0; lcv < _cnt; lcv++)
+	{
+		a = &_A[lcv];
+		b = &_B[lcv];
+		for(lane = 0; lane < 4; lane++)
+		{
+			da = fabs(remainder((double)a->azim[lane] - b->azim[lane], 2*M_PI))*cos(a->elev[lane]);
+
+			if(!(fabs(a->delay[lane] - b->delay[lane]) <= 5e-8))
+				err++;
+			if(!(fabs(a->doppler[lane] - b->doppler[lane]) <= 0.02))
+				err++;
+			if(!(fabs(a->doppler_rate[lane] - b->doppler_rate[lane]) <= 1e-3))
+				err++;
+			if(!(fabs(a->elev[lane] - b->elev[lane]) <= 3e-5))
+				err++;
+			if(!(da <= 3e-5))
+				err++;
+
+			g = ((double)_F->gx[0]*a->dx[lane] + (double)_F->gy[0]*a->dy[lane] + (double)_F->gz[0]*a->dz[lane]);
+			g /= sqrt((double)a->dx[lane]*a->dx[lane] + (double)a->dy[lane]*a->dy[lane] + (double)a->dz[lane]*a->dz[lane]);
+			if((a->visible[lane] != b->visible[lane]) && (fabs(g - _F->mask[0]) > 1e-5))
+				err++;
+
+			if(fabs(a->doppler[lane] - b->doppler[lane]) > _max[0])
+				_max[0] = fabs(a->doppler[lane] - b->doppler[lane]);
+			if(fabs(a->elev[lane] - b->elev[lane]) > _max[1])
+				_max[1] = fabs(a->elev[lane] - b->elev[lane]);
+			if(da > _max[1])
+				_max[1] = da;
+		}
+	}
+
+	return(err);
+}
+
+
+double elapsed(struct timeval *_start)
+{
+	struct timeval now;
+
+	gettimeofday(&now, NULL);
+
+	return((now.tv_sec - _start->tv_sec) + 1e-6*(now.tv_usec - _start->tv_usec));
+}
+
+
 int main(int32 argc, char* argv[])
 {
 
@@ -125,6 +486,20 @@ int main(int32 argc, char* argv[])
 	int32 shift;
 	int32 ai1, aq1;
 	int32 ai2, aq2;
+	uint32 phase1, phase2;
+	double rxy, rxx, ryy;
+	double t_dbl, t_x86, t_sse;
+	struct timeval tv;
+	int8 *testbytes;
+	int16 *testtaps;
+	int32 testoff[64];
+	double p_old, p_new, p_in;
+	int32 stats1[2], stats2[2];
+	Resampler *aResampler;
+	Loop_Bank_S loops1[LOOP_BANKS], loops2[LOOP_BANKS], loops3[LOOP_BANKS];
+	Predict_Bank_S preds1[PREDICT_BANKS], preds2[PREDICT_BANKS], preds3[PREDICT_BANKS];
+	Predict_Frame_S frame;
+	double max1[2], max2[2], t_run;
 
 	testvecta = new CPX[VECTSIZE];
 	testvectb = new CPX[VECTSIZE];
@@ -136,6 +511,15 @@ int main(int32 argc, char* argv[])
 	testvectg = new MIX[VECTSIZE];
 	testvecth = new MIX[VECTSIZE];
 
+	testbytes = new int8[VECTSIZE];
+
+	if(posix_memalign((void **)&testtaps, 16, 64*64*sizeof(int16)))
+	{
+		fprintf(stderr,"Could not allocate the polyphase taps\n");
+		return(-1);
+	}
+	memset(testtaps, 0x0, 64*64*sizeof(int16));
+
 
 
 	/* SIMD ADD */
@@ -549,6 +933,376 @@ int main(int32 argc, char* argv[])
 		fprintf(stdout,"CPX PRN ACCUM NEW\t\tPASSED\n",err);
 	/*----------------------------------------------------------------------------------------------*/
 
+
+	/* SIMD 2 bit mixer */
+	/*----------------------------------------------------------------------------------------------*/
+	err = 0;
+
+	for(lcv = 0; lcv < REPEATS; lcv++)
+	{
+
+		pts = rand() % VECTSIZE;
+		phase1 = phase2 = rand();
+
+		fill_2bit(testbytes, pts);
+
+		x86_mix_2bit(testbytes, testvecta, pts, &phase1, 2557223528u);
+		sse_mix_2bit(testbytes, testvectb, pts, &phase2, 2557223528u);
+
+		if(phase1 != phase2)
+			err++;
+
+		for(lcv2 = 0; lcv2 < pts; lcv2++)
+		{
+			if(testvecta[lcv2].i != testvectb[lcv2].i)
+				err++;
+
+			if(testvecta[lcv2].q != testvectb[lcv2].q)
+				err++;
+		}
+
+	}
+	if(err)
+		fprintf(stdout,"2BIT MIX \t\t\tFAILED: %d\n",err);
+	else
+		fprintf(stdout,"2BIT MIX \t\t\tPASSED\n");
+	/*----------------------------------------------------------------------------------------------*/
+
+
+	/* Integer 2 bit mixer vs the floating point one it replaced, must be >= 0.99 correlated */
+	/*----------------------------------------------------------------------------------------------*/
+	rxy = rxx = ryy = 0;
+
+	for(lcv = 0; lcv < REPEATS; lcv++)
+	{
+
+		pts = rand() % VECTSIZE;
+		phase1 = phase2 = rand();
+
+		fill_2bit(testbytes, pts);
+
+		dbl_mix_2bit(testbytes, testvecta, pts, &phase1, 2557223528u);
+		x86_mix_2bit(testbytes, testvectb, pts, &phase2, 2557223528u);
+
+		for(lcv2 = 0; lcv2 < pts; lcv2++)
+		{
+			rxy += testvecta[lcv2].i*testvectb[lcv2].i + testvecta[lcv2].q*testvectb[lcv2].q;
+			rxx += testvecta[lcv2].i*testvecta[lcv2].i + testvecta[lcv2].q*testvecta[lcv2].q;
+			ryy += testvectb[lcv2].i*testvectb[lcv2].i + testvectb[lcv2].q*testvectb[lcv2].q;
+		}
+
+	}
+
+	rxy /= sqrt(rxx*ryy);
+	if(rxy < 0.99)
+		fprintf(stdout,"2BIT MIX VS DOUBLE \t\tFAILED: %.4f\n",rxy);
+	else
+		fprintf(stdout,"2BIT MIX VS DOUBLE \t\tPASSED: %.4f\n",rxy);
+	/*----------------------------------------------------------------------------------------------*/
+
+
+	/* 2 bit mixer throughput, the GN3S needs 4 Msps */
+	/*----------------------------------------------------------------------------------------------*/
+	fill_2bit(testbytes, VECTSIZE);
+	pts = VECTSIZE;
+
+	gettimeofday(&tv, NULL);
+	for(lcv = 0; lcv < 100*REPEATS; lcv++)
+		dbl_mix_2bit(testbytes, testvecta, pts, &phase1, 2557223528u);
+	t_dbl = elapsed(&tv);
+
+	gettimeofday(&tv, NULL);
+	for(lcv = 0; lcv < 100*REPEATS; lcv++)
+		x86_mix_2bit(testbytes, testvecta, pts, &phase1, 2557223528u);
+	t_x86 = elapsed(&tv);
+
+	gettimeofday(&tv, NULL);
+	for(lcv = 0; lcv < 100*REPEATS; lcv++)
+		sse_mix_2bit(testbytes, testvecta, pts, &phase1, 2557223528u);
+	t_sse = elapsed(&tv);
+
+	fprintf(stdout,"2BIT MIX Msps \t\t\tDOUBLE: %.1f, X86: %.1f, SSE: %.1f\n",
+		1e-6*pts*100*REPEATS/t_dbl, 1e-6*pts*100*REPEATS/t_x86, 1e-6*pts*100*REPEATS/t_sse);
+	/*----------------------------------------------------------------------------------------------*/
+
+
+	/* SIMD polyphase FIR */
+	/*----------------------------------------------------------------------------------------------*/
+	err = 0;
+
+	for(lcv = 0; lcv < REPEATS; lcv++)
+	{
+
+		pts = 1 + rand() % 64;
+		shift = 1 + rand() % 15;
+
+		fill_vect(testvecta, VECTSIZE);
+		for(lcv2 = 0; lcv2 < 64*64; lcv2++)
+			testtaps[lcv2] = (int16)((rand() % 4096) - 2048);
+		for(lcv2 = 0; lcv2 < pts; lcv2++)
+			testoff[lcv2] = rand() % (VECTSIZE - 64);
+
+		/* Planes of I and Q */
+		x86_polyphase((int16 *)testvecta, (int16 *)&testvecta[VECTSIZE/2], testvectb, pts, testtaps, testoff, 64, shift);
+		sse_polyphase((int16 *)testvecta, (int16 *)&testvecta[VECTSIZE/2], testvectc, pts, testtaps, testoff, 64, shift);
+
+		for(lcv2 = 0; lcv2 < pts; lcv2++)
+		{
+			if(testvectb[lcv2].i != testvectc[lcv2].i)
+				err++;
+
+			if(testvectb[lcv2].q != testvectc[lcv2].q)
+				err++;
+		}
+
+	}
+	if(err)
+		fprintf(stdout,"POLYPHASE FIR \t\t\tFAILED: %d\n",err);
+	else
+		fprintf(stdout,"POLYPHASE FIR \t\t\tPASSED\n");
+	/*----------------------------------------------------------------------------------------------*/
+
+
+	/* Resampler alias rejection, 4 Msps to 2.048 Msps as on the GN3S. A 1.5 MHz tone is out of band
+	 * and aliases to -548 kHz, the old index picking passes it at full power, the filter must knock
+	 * it down by at least 40 dB while passing a 500 kHz tone within 1 dB */
+	/*----------------------------------------------------------------------------------------------*/
+	aResampler = new Resampler(2048, 4000, 14, 4000);
+
+	sine_gen(testvecta, 1.5e6, 4e6, 4000, 0);
+	for(lcv = 0; lcv < 4000; lcv++)
+	{
+		testvecta[lcv].i = (int16)(testvecta[lcv].i * 0.25);
+		testvecta[lcv].q = (int16)(testvecta[lcv].q * 0.25);
+	}
+
+	for(lcv = 0; lcv < 2048; lcv++)
+		testvectb[lcv] = testvecta[((lcv+1)*4000/2048) % 4000];
+	aResampler->Run(testvecta, testvectc, 4000);
+
+	p_old = tone_power(testvectb, 2048, -0.548e6/2.048e6);
+	p_new = tone_power(testvectc, 2048, -0.548e6/2.048e6);
+
+	aResampler->Reset();
+	sine_gen(testvecta, 0.5e6, 4e6, 4000, 0);
+	for(lcv = 0; lcv < 4000; lcv++)
+	{
+		testvecta[lcv].i = (int16)(testvecta[lcv].i * 0.25);
+		testvecta[lcv].q = (int16)(testvecta[lcv].q * 0.25);
+	}
+	aResampler->Run(testvecta, testvectc, 4000);
+
+	p_in = tone_power(testvectc, 2048, 0.5e6/2.048e6) / tone_power(testvecta, 4000, 0.5e6/4e6);
+
+	if((10*log10(p_new/p_old) > -40) || (fabs(10*log10(p_in)) > 1))
+		fprintf(stdout,"RESAMPLER ALIAS \t\tFAILED: %.1f dB, passband %.2f dB\n", 10*log10(p_new/p_old), 10*log10(p_in));
+	else
+		fprintf(stdout,"RESAMPLER ALIAS \t\tPASSED: %.1f dB, passband %.2f dB\n", 10*log10(p_new/p_old), 10*log10(p_in));
+
+	/* Throughput, in ns per output sample, best of 10 runs */
+	t_sse = 1e9;
+	for(lcv2 = 0; lcv2 < 10; lcv2++)
+	{
+		gettimeofday(&tv, NULL);
+		for(lcv = 0; lcv < REPEATS; lcv++)
+			aResampler->Run(testvecta, testvectc, 4000);
+		t_x86 = elapsed(&tv);
+		if(t_x86 < t_sse)
+			t_sse = t_x86;
+	}
+
+	fprintf(stdout,"RESAMPLER ns/sample \t\t%.2f\n", 1e9*t_sse/(2048.0*REPEATS));
+
+	delete aResampler;
+	/*----------------------------------------------------------------------------------------------*/
+
+
+	/* SIMD AGC */
+	/*----------------------------------------------------------------------------------------------*/
+	err = 0;
+
+	for(lcv = 0; lcv < REPEATS; lcv++)
+	{
+
+		pts = rand() % VECTSIZE;
+		shift = rand() % 16;
+
+		fill_vect(testvecta, pts);
+
+		/* Half the time use the full range to hit the saturation */
+		if(lcv & 1)
+			for(lcv2 = 0; lcv2 < pts; lcv2++)
+			{
+				testvecta[lcv2].i = (int16)rand();
+				testvecta[lcv2].q = (int16)rand();
+			}
+
+		memcpy(testvectb, testvecta, pts*sizeof(CPX));
+
+		x86_agc((int16 *)testvecta, 2*pts, shift, AGC_BITS, stats1);
+		sse_agc((int16 *)testvectb, 2*pts, shift, AGC_BITS, stats2);
+
+		if(memcmp(testvecta, testvectb, pts*sizeof(CPX)))
+			err++;
+
+		for(lcv2 = 0; lcv2 < 2; lcv2++)
+			if(stats1[lcv2] != stats2[lcv2])
+				err++;
+
+	}
+	if(err)
+		fprintf(stdout,"AGC 				FAILED: %d\n",err);
+	else
+		fprintf(stdout,"AGC 				PASSED\n");
+	/*----------------------------------------------------------------------------------------------*/
+
+
+	/* AGC cost, 1 s of 2 antennas at 2.048 Msps must take under 1% of a core */
+	/*----------------------------------------------------------------------------------------------*/
+	t_sse = 1e9;
+
+	for(lcv = 0; lcv < 10; lcv++)
+	{
+		fill_vect(testvecta, 2*SAMPS_MS);
+
+		gettimeofday(&tv, NULL);
+		for(lcv2 = 0; lcv2 < 1000; lcv2++)
+		{
+			sse_agc((int16 *)&testvecta[0], 2*SAMPS_MS, 6, AGC_BITS, stats1);
+			sse_agc((int16 *)&testvecta[SAMPS_MS], 2*SAMPS_MS, 6, AGC_BITS, stats2);
+		}
+		t_x86 = elapsed(&tv);
+		if(t_x86 < t_sse)
+			t_sse = t_x86;
+	}
+
+	if(t_sse > 0.01)
+		fprintf(stdout,"AGC %% core 			FAILED: %.3f\n", 100*t_sse);
+	else
+		fprintf(stdout,"AGC %% core 			PASSED: %.3f\n", 100*t_sse);
+	/*----------------------------------------------------------------------------------------------*/
+
+	/* SIMD tracking loops, against the x86 version and the original double precision loops */
+	/*----------------------------------------------------------------------------------------------*/
+	err = 0;
+	max1[0] = max1[1] = max2[0] = max2[1] = 0;
+
+	for(lcv = 0; lcv < REPEATS; lcv++)
+	{
+		fill_loops(loops1, LOOP_BANKS);
+		memcpy(loops2, loops1, sizeof(loops1));
+		memcpy(loops3, loops1, sizeof(loops1));
+
+		dbl_track(loops1, LOOP_BANKS);
+		x86_track(loops2, LOOP_BANKS);
+		sse_track(loops3, LOOP_BANKS);
+
+		err += track_check(loops2, loops3, LOOP_BANKS, max1);
+		err += track_check(loops1, loops2, LOOP_BANKS, max2);
+	}
+	if(err)
+		fprintf(stdout,"TRACK 				FAILED: %d\n",err);
+	else
+		fprintf(stdout,"TRACK 				PASSED: %.2e cycles, %.2e dB\n", max2[0], max2[1]);
+	/*----------------------------------------------------------------------------------------------*/
+
+
+	/* Tracking loop cost, one sweep of every channel */
+	/*----------------------------------------------------------------------------------------------*/
+	t_dbl = t_x86 = t_sse = 1e9;
+
+	for(lcv = 0; lcv < 10; lcv++)
+	{
+		fill_loops(loops1, LOOP_BANKS);
+		memcpy(loops2, loops1, sizeof(loops1));
+		memcpy(loops3, loops1, sizeof(loops1));
+
+		gettimeofday(&tv, NULL);
+		for(lcv2 = 0; lcv2 < 1000; lcv2++)
+			dbl_track(loops1, LOOP_BANKS);
+		t_run = elapsed(&tv);
+		if(t_run < t_dbl)
+			t_dbl = t_run;
+
+		gettimeofday(&tv, NULL);
+		for(lcv2 = 0; lcv2 < 1000; lcv2++)
+			x86_track(loops2, LOOP_BANKS);
+		t_run = elapsed(&tv);
+		if(t_run < t_x86)
+			t_x86 = t_run;
+
+		gettimeofday(&tv, NULL);
+		for(lcv2 = 0; lcv2 < 1000; lcv2++)
+			sse_track(loops3, LOOP_BANKS);
+		t_run = elapsed(&tv);
+		if(t_run < t_sse)
+			t_sse = t_run;
+	}
+
+	fprintf(stdout,"TRACK ns/sweep 			dbl %.1f, x86 %.1f, sse %.1f\n", 1e6*t_dbl, 1e6*t_x86, 1e6*t_sse);
+	/*----------------------------------------------------------------------------------------------*/
+
+
+	/* Constellation prediction, double as SV_Select did it one SV at a time vs x86 vs sse */
+	/*----------------------------------------------------------------------------------------------*/
+	err = 0;
+	max1[0] = max1[1] = max2[0] = max2[1] = 0;
+
+	for(lcv = 0; lcv < 10000; lcv++)
+	{
+		fill_predict(preds1, &frame, PREDICT_BANKS);
+		memcpy(preds2, preds1, sizeof(preds1));
+		memcpy(preds3, preds1, sizeof(preds1));
+
+		dbl_predict(preds1, &frame, PREDICT_BANKS);
+		x86_predict(preds2, &frame, PREDICT_BANKS);
+		sse_predict(preds3, &frame, PREDICT_BANKS);
+
+		err += predict_check(preds2, preds3, &frame, PREDICT_BANKS, max1);
+		err += predict_check(preds1, preds2, &frame, PREDICT_BANKS, max2);
+	}
+	if(err)
+		fprintf(stdout,"PREDICT 			FAILED: %d\n",err);
+	else
+		fprintf(stdout,"PREDICT 			PASSED: %.2e Hz, %.2e rad\n", max2[0], max2[1]);
+	/*----------------------------------------------------------------------------------------------*/
+
+
+	/* Prediction cost, one sweep of every SV */
+	/*----------------------------------------------------------------------------------------------*/
+	t_dbl = t_x86 = t_sse = 1e9;
+
+	for(lcv = 0; lcv < 10; lcv++)
+	{
+		fill_predict(preds1, &frame, PREDICT_BANKS);
+		memcpy(preds2, preds1, sizeof(preds1));
+		memcpy(preds3, preds1, sizeof(preds1));
+
+		gettimeofday(&tv, NULL);
+		for(lcv2 = 0; lcv2 < 1000; lcv2++)
+			dbl_predict(preds1, &frame, PREDICT_BANKS);
+		t_run = elapsed(&tv);
+		if(t_run < t_dbl)
+			t_dbl = t_run;
+
+		gettimeofday(&tv, NULL);
+		for(lcv2 = 0; lcv2 < 1000; lcv2++)
+			x86_predict(preds2, &frame, PREDICT_BANKS);
+		t_run = elapsed(&tv);
+		if(t_run < t_x86)
+			t_x86 = t_run;
+
+		gettimeofday(&tv, NULL);
+		for(lcv2 = 0; lcv2 < 1000; lcv2++)
+			sse_predict(preds3, &frame, PREDICT_BANKS);
+		t_run = elapsed(&tv);
+		if(t_run < t_sse)
+			t_sse = t_run;
+	}
+
+	fprintf(stdout,"PREDICT ns/sweep 		dbl %.1f, x86 %.1f, sse %.1f\n", 1e6*t_dbl, 1e6*t_x86, 1e6*t_sse);
+	/*----------------------------------------------------------------------------------------------*/
+
 	delete [] testvecta;
 	delete [] testvectb;
 	delete [] testvectc;
@@ -557,6 +1311,8 @@ int main(int32 argc, char* argv[])
 	delete [] testvectf;
 	delete [] testvectg;
 	delete [] testvecth;
+	delete [] testbytes;
+	free(testtaps);
 
 	return(1);
 
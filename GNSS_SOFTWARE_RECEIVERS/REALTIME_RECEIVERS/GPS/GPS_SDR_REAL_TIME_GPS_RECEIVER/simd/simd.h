@@ -60,6 +60,13 @@ void  sse_cmulsc(CPX *A, CPX *B, CPX *C, int32 cnt, int32 shift) __attribute__ (
 void  sse_prn_accum(CPX *A, CPX *E, CPX *P, CPX *L, int32 cnt, CPX *accum) __attribute__ ((noinline));  //!< This is a long story
 void  sse_prn_accum_new(CPX *A, MIX *E, MIX *P, MIX *L, int32 cnt, CPX_ACCUM *accum) __attribute__ ((noinline));  //!< This is a long story
 void  sse_max(int32 *_A, int32 *_index, int32 *_magt, int32 _cnt) __attribute__ ((noinline));
+void  sse_mix_2bit(int8 *A, CPX *B, int32 cnt, uint32 *phase, uint32 dphase) __attribute__ ((noinline));	//!< Mix 2 bit samples to baseband (SSSE3)
+void  sse_deinterleave(CPX *A, int16 *I, int16 *Q, int32 cnt) __attribute__ ((noinline));	//!< Split CPX into I and Q planes
+void  sse_polyphase(int16 *AI, int16 *AQ, CPX *B, int32 cnt, int16 *H, int32 *off, int32 taps, int32 shift) __attribute__ ((noinline));	//!< Polyphase FIR bank
+void  sse_agc(int16 *A, int32 cnt, int32 shift, int32 bits, int32 *stats) __attribute__ ((noinline));	//!< Requantize and gather AGC statistics
+void  sse_track(Loop_Bank_S *A, int32 cnt) __attribute__ ((noinline));	//!< Close the PLL, DLL and CN0 of cnt banks of 4 channels
+uint32 sse_parity(uint32 *A, int32 cnt) __attribute__ ((noinline));	//!< Mask of the GPS words failing parity, 4 per pass, cnt <= 32
+void  sse_predict(Predict_Bank_S *A, Predict_Frame_S *F, int32 cnt) __attribute__ ((noinline));	//!< Delay, Doppler, elevation/azimuth and visibility of cnt banks of 4 SVs
 /*----------------------------------------------------------------------------------------------*/
 
 /* Found in x86.cpp */
@@ -79,6 +86,18 @@ void  x86_cmag(CPX *A, int32 cnt);											//!< Convert from complex to a powe
 void  x86_prn_accum(CPX *A, CPX *E, CPX *P, CPX *L, int32 cnt, CPX *accum);  //!< This is a long story
 void  x86_prn_accum_new(CPX *A, MIX *E, MIX *P, MIX *L, int32 cnt, CPX_ACCUM *accum);  //!< This is a long story
 void  x86_max(int32 *_A, int32 *_index, int32 *_magt, int32 _cnt);
+void  x86_mix_2bit(int8 *_A, CPX *_B, int32 _cnt, uint32 *_phase, uint32 _dphase);	//!< Mix 2 bit samples to baseband with an integer NCO
+void  x86_deinterleave(CPX *_A, int16 *_I, int16 *_Q, int32 _cnt);	//!< Split CPX into I and Q planes
+void  x86_polyphase(int16 *_AI, int16 *_AQ, CPX *_B, int32 _cnt, int16 *_H, int32 *_off, int32 _taps, int32 _shift);	//!< Polyphase FIR bank
+void  x86_agc(int16 *_A, int32 _cnt, int32 _shift, int32 _bits, int32 *_stats);	//!< Requantize and gather AGC statistics
+void  x86_track(Loop_Bank_S *_A, int32 _cnt);	//!< Close the PLL, DLL and CN0 of _cnt banks of 4 channels
+float x86_atan2_approx(float _y, float _x);	//!< atan(_y/_x) to 1e-5 rad, the one sse_track uses
+float x86_log10_approx(float _x);			//!< log10(_x) to 1e-5, the one sse_track uses
+uint32 x86_parity(uint32 *_A, int32 _cnt);	//!< Mask of the GPS words failing parity, _cnt <= 32
+void  x86_predict(Predict_Bank_S *_A, Predict_Frame_S *_F, int32 _cnt);	//!< Delay, Doppler, elevation/azimuth and visibility of _cnt banks of 4 SVs
+float x86_atan2_full(float _y, float _x);	//!< atan2(_y, _x) to 1e-5 rad, all four quadrants, the one sse_predict uses
+extern const int8 x86_mix_cos[16];											//!< 16 bin carrier table used by the 2 bit mixers
+extern const uint32 x86_parity_mask[6];		//!< Word bits each of the 6 GPS parity bits covers
 /*----------------------------------------------------------------------------------------------*/
 
 
@@ -1033,3 +1033,876 @@ void sse_prn_accum_new(CPX *A, MIX *E, MIX *P, MIX *L, int32 cnt, CPX_ACCUM *acc
 
 
 
+
+
+//!< Mix 2 bit sampler codes to baseband with an integer NCO, 16 samples per pass (needs SSSE3 for pshufb/psignb)
+void sse_mix_2bit(int8 *A, CPX *B, int32 cnt, uint32 *phase, uint32 dphase)
+{
+
+	int8 *a = A;
+	CPX *b = B;
+	int32 blocks;
+	int32 lcv;
+	uint8 tab[208] __attribute__ ((aligned (16)));
+	uint32 *offset = (uint32 *)&tab[0];		//!< Phase offset of each of the 16 lanes, plus half a bin
+	uint32 *step = (uint32 *)&tab[64];		//!< NCO advance per pass
+	uint32 *base = (uint32 *)&tab[80];		//!< NCO phase at the start
+	int8 *mask = (int8 *)&tab[96];			//!< Mask off the 2 bit code
+	int8 *sign = (int8 *)&tab[112];			//!< Sign of each code
+	int8 *mag3 = (int8 *)&tab[128];			//!< Codes with a magnitude of 3
+	int8 *cos1 = (int8 *)&tab[144];
+	int8 *cos3 = (int8 *)&tab[160];
+	int8 *sin1 = (int8 *)&tab[176];
+	int8 *sin3 = (int8 *)&tab[192];
+
+	blocks = cnt >> 4;
+
+	for(lcv = 0; lcv < 16; lcv++)
+	{
+		offset[lcv] = lcv*dphase + 0x08000000;
+		mask[lcv] = 0x3;
+		sign[lcv] = ((lcv & 0x3) < 2) ? -1 : 1;
+		mag3[lcv] = (((lcv & 0x3) == 0) || ((lcv & 0x3) == 3)) ? -1 : 0;
+		cos1[lcv] = x86_mix_cos[lcv];
+		cos3[lcv] = 3*x86_mix_cos[lcv];
+		sin1[lcv] = x86_mix_cos[(lcv + 4) & 0xf];
+		sin3[lcv] = 3*x86_mix_cos[(lcv + 4) & 0xf];
+	}
+
+	for(lcv = 0; lcv < 4; lcv++)
+	{
+		step[lcv] = 16*dphase;
+		base[lcv] = *phase;
+	}
+
+	if(blocks)
+	{
+		__asm volatile
+		(
+			".intel_syntax noprefix			\n\t"
+			"movdqa		xmm0, [%3+80]		\n\t" //NCO phase, broadcast
+			"L%=:							\n\t"
+				"movdqa		xmm1, xmm0			\n\t" //Carrier bins of samples 0-3
+				"paddd		xmm1, [%3]			\n\t"
+				"psrld		xmm1, 28			\n\t"
+				"movdqa		xmm2, xmm0			\n\t" //Samples 4-7
+				"paddd		xmm2, [%3+16]		\n\t"
+				"psrld		xmm2, 28			\n\t"
+				"packssdw	xmm1, xmm2			\n\t"
+				"movdqa		xmm2, xmm0			\n\t" //Samples 8-11
+				"paddd		xmm2, [%3+32]		\n\t"
+				"psrld		xmm2, 28			\n\t"
+				"movdqa		xmm3, xmm0			\n\t" //Samples 12-15
+				"paddd		xmm3, [%3+48]		\n\t"
+				"psrld		xmm3, 28			\n\t"
+				"packssdw	xmm2, xmm3			\n\t"
+				"packuswb	xmm1, xmm2			\n\t" //16 carrier bins, 1 per byte
+				"paddd		xmm0, [%3+64]		\n\t" //Advance the NCO
+				"movdqu		xmm2, [%0]			\n\t" //Load 16 samples
+				"pand		xmm2, [%3+96]		\n\t" //Keep the 2 bit code
+				"movdqa		xmm3, [%3+112]		\n\t"
+				"pshufb		xmm3, xmm2			\n\t" //Sign of the samples
+				"movdqa		xmm4, [%3+128]		\n\t"
+				"pshufb		xmm4, xmm2			\n\t" //Select the magnitude 3 samples
+				"movdqa		xmm5, [%3+160]		\n\t" //I = sign*|samp|*cos
+				"pshufb		xmm5, xmm1			\n\t"
+				"pand		xmm5, xmm4			\n\t"
+				"movdqa		xmm7, [%3+144]		\n\t"
+				"pshufb		xmm7, xmm1			\n\t"
+				"movdqa		xmm6, xmm4			\n\t"
+				"pandn		xmm6, xmm7			\n\t"
+				"por		xmm5, xmm6			\n\t"
+				"psignb		xmm5, xmm3			\n\t"
+				"movdqa		xmm2, [%3+192]		\n\t" //Q = sign*|samp|*-sin
+				"pshufb		xmm2, xmm1			\n\t"
+				"pand		xmm2, xmm4			\n\t"
+				"movdqa		xmm7, [%3+176]		\n\t"
+				"pshufb		xmm7, xmm1			\n\t"
+				"movdqa		xmm6, xmm4			\n\t"
+				"pandn		xmm6, xmm7			\n\t"
+				"por		xmm2, xmm6			\n\t"
+				"psignb		xmm2, xmm3			\n\t"
+				"movdqa		xmm1, xmm5			\n\t" //Interleave I and Q
+				"punpcklbw	xmm1, xmm2			\n\t"
+				"punpckhbw	xmm5, xmm2			\n\t"
+				"movdqa		xmm2, xmm1			\n\t" //Sign extend to CPX and store
+				"punpcklbw	xmm2, xmm2			\n\t"
+				"psraw		xmm2, 8				\n\t"
+				"movdqu		[%1], xmm2			\n\t"
+				"punpckhbw	xmm1, xmm1			\n\t"
+				"psraw		xmm1, 8				\n\t"
+				"movdqu		[%1+16], xmm1		\n\t"
+				"movdqa		xmm2, xmm5			\n\t"
+				"punpcklbw	xmm2, xmm2			\n\t"
+				"psraw		xmm2, 8				\n\t"
+				"movdqu		[%1+32], xmm2		\n\t"
+				"punpckhbw	xmm5, xmm5			\n\t"
+				"psraw		xmm5, 8				\n\t"
+				"movdqu		[%1+48], xmm5		\n\t"
+				"add		%0, 16				\n\t"
+				"add		%1, 64				\n\t"
+				"dec		%2					\n\t"
+			"jnz L%=						\n\t"
+			".att_syntax					\n\t"
+			: "+r" (a), "+r" (b), "+r" (blocks)
+			: "r" (&tab[0])
+			: "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "xmm7", "memory", "cc"
+		);//end __asm
+
+		*phase += (cnt & ~0xf)*dphase;
+	}
+
+	/* Finish off the tail */
+	x86_mix_2bit(a, b, cnt & 0xf, phase, dphase);
+
+}
+
+
+//!< Split CPX into I and Q planes, 8 samples per pass
+void sse_deinterleave(CPX *A, int16 *I, int16 *Q, int32 cnt)
+{
+
+	CPX *a = A;
+	int16 *pi = I;
+	int16 *pq = Q;
+	int32 blocks;
+
+	blocks = cnt >> 3;
+
+	if(blocks)
+	{
+		__asm volatile
+		(
+			".intel_syntax noprefix			\n\t"
+			"L%=:							\n\t"
+				"movdqu		xmm0, [%0]			\n\t" //I0 Q0 I1 Q1 I2 Q2 I3 Q3
+				"movdqu		xmm1, [%0+16]		\n\t" //I4 Q4 I5 Q5 I6 Q6 I7 Q7
+				"pshuflw	xmm0, xmm0, 0xD8	\n\t" //I0 I1 Q0 Q1 I2 Q2 I3 Q3
+				"pshufhw	xmm0, xmm0, 0xD8	\n\t" //I0 I1 Q0 Q1 I2 I3 Q2 Q3
+				"pshufd		xmm0, xmm0, 0xD8	\n\t" //I0 I1 I2 I3 Q0 Q1 Q2 Q3
+				"pshuflw	xmm1, xmm1, 0xD8	\n\t"
+				"pshufhw	xmm1, xmm1, 0xD8	\n\t"
+				"pshufd		xmm1, xmm1, 0xD8	\n\t" //I4 I5 I6 I7 Q4 Q5 Q6 Q7
+				"movdqa		xmm2, xmm0			\n\t"
+				"punpcklqdq	xmm0, xmm1			\n\t" //I0-I7
+				"punpckhqdq	xmm2, xmm1			\n\t" //Q0-Q7
+				"movdqu		[%1], xmm0			\n\t"
+				"movdqu		[%2], xmm2			\n\t"
+				"add		%0, 32				\n\t"
+				"add		%1, 16				\n\t"
+				"add		%2, 16				\n\t"
+				"dec		%3					\n\t"
+			"jnz L%=						\n\t"
+			".att_syntax					\n\t"
+			: "+r" (a), "+r" (pi), "+r" (pq), "+r" (blocks)
+			:
+			: "xmm0", "xmm1", "xmm2", "memory", "cc"
+		);//end __asm
+	}
+
+	/* Finish off the tail */
+	x86_deinterleave(a, pi, pq, cnt & 0x7);
+
+}
+
+
+//!< Polyphase FIR on split I/Q planes, see x86_polyphase for the paired row layout of H. Two outputs per pass
+//!< share the fold and the loop overhead, taps a multiple of 8 and H 16 byte aligned
+void sse_polyphase(int16 *AI, int16 *AQ, CPX *B, int32 cnt, int16 *H, int32 *off, int32 taps, int32 shift)
+{
+
+	int16 *ai;
+	int16 *aq;
+	int16 *h;
+	int32 lcv;
+	int32 inner;
+	intptr_t next;
+	int32 scale[8] __attribute__ ((aligned (16)));
+
+	/* Rounding term, shift count and the two outputs */
+	scale[0] = scale[1] = scale[2] = scale[3] = 1 << (shift - 1);
+	scale[4] = shift;
+	scale[5] = scale[6] = scale[7] = 0;
+
+	for(lcv = 0; lcv < cnt; lcv += 2)
+	{
+		ai = &AI[off[lcv]];
+		aq = &AQ[off[lcv]];
+		h = &H[lcv*taps];
+		inner = taps >> 3;
+
+		/* Byte step to the second output's input, a lone last output is run twice and one copy dropped */
+		next = (lcv + 1 < cnt) ? (off[lcv+1] - off[lcv])*(intptr_t)sizeof(int16) : 0;
+
+		__asm volatile
+		(
+			".intel_syntax noprefix			\n\t"
+			"pxor		xmm0, xmm0			\n\t" //Clear the I and Q accumulators of output k
+			"pxor		xmm1, xmm1			\n\t"
+			"pxor		xmm4, xmm4			\n\t" //And of output k+1
+			"pxor		xmm5, xmm5			\n\t"
+			"L%=:							\n\t"
+				"movdqu		xmm2, [%0]			\n\t" //Load 8 I samples
+				"pmaddwd	xmm2, [%2]			\n\t" //Against 8 taps of row k
+				"paddd		xmm0, xmm2			\n\t"
+				"movdqu		xmm3, [%1]			\n\t" //Load 8 Q samples
+				"pmaddwd	xmm3, [%2]			\n\t"
+				"paddd		xmm1, xmm3			\n\t"
+				"movdqu		xmm2, [%0+%4]		\n\t" //Same for output k+1
+				"pmaddwd	xmm2, [%2+16]		\n\t" //Against 8 taps of row k+1
+				"paddd		xmm4, xmm2			\n\t"
+				"movdqu		xmm3, [%1+%4]		\n\t"
+				"pmaddwd	xmm3, [%2+16]		\n\t"
+				"paddd		xmm5, xmm3			\n\t"
+				"add		%0, 16				\n\t"
+				"add		%1, 16				\n\t"
+				"add		%2, 32				\n\t"
+				"dec		%3					\n\t"
+			"jnz L%=						\n\t"
+			"movdqa		xmm2, xmm0			\n\t" //Fold output k to I Q I Q
+			"punpckldq	xmm0, xmm1			\n\t"
+			"punpckhdq	xmm2, xmm1			\n\t"
+			"paddd		xmm0, xmm2			\n\t"
+			"movdqa		xmm3, xmm4			\n\t" //And output k+1
+			"punpckldq	xmm4, xmm5			\n\t"
+			"punpckhdq	xmm3, xmm5			\n\t"
+			"paddd		xmm4, xmm3			\n\t"
+			"movdqa		xmm2, xmm0			\n\t" //Ik Qk Ik+1 Qk+1
+			"punpcklqdq	xmm0, xmm4			\n\t"
+			"punpckhqdq	xmm2, xmm4			\n\t"
+			"paddd		xmm0, xmm2			\n\t"
+			"paddd		xmm0, [%5]			\n\t" //Round
+			"movq		xmm2, [%5+16]		\n\t" //Scale
+			"psrad		xmm0, xmm2			\n\t"
+			"packssdw	xmm0, xmm0			\n\t" //Saturate back to 2 CPX
+			"movq		[%5+24], xmm0		\n\t"
+			".att_syntax					\n\t"
+			: "+r" (ai), "+r" (aq), "+r" (h), "+r" (inner)
+			: "r" (next), "r" (&scale[0])
+			: "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "memory", "cc"
+		);//end __asm
+
+		if(lcv + 1 < cnt)
+			memcpy(&B[lcv], &scale[6], 2*sizeof(CPX));
+		else
+			memcpy(&B[lcv], &scale[6], sizeof(CPX));
+	}
+
+}
+
+
+//!< Requantize in place and gather the AGC statistics in the same pass, see x86_agc. _cnt < 8*32768
+void sse_agc(int16 *A, int32 cnt, int32 shift, int32 bits, int32 *stats)
+{
+
+	int16 *a = A;
+	int16 *p;
+	int32 blocks;
+	int32 tail[2];
+	int32 lcv;
+	int16 table[32] __attribute__ ((aligned (16)));
+
+	blocks = cnt >> 3;
+
+	for(lcv = 0; lcv < 8; lcv++)
+	{
+		table[lcv]    = shift ? (1 << (shift - 1)) : 0;	//!< Rounding
+		table[lcv+8]  = 1 << bits;						//!< Overflow threshold
+		table[lcv+16] = 1 << (bits - 1);				//!< Upper half threshold
+		table[lcv+24] = 0;								//!< Shift count goes here
+	}
+	table[24] = shift;
+
+	if(blocks)
+	{
+		p = &table[0];
+
+		__asm volatile
+		(
+			".intel_syntax noprefix			\n\t"
+			"pxor		xmm6, xmm6			\n\t" //Overflow counts
+			"pxor		xmm7, xmm7			\n\t" //Upper half counts
+			"L%=:							\n\t"
+				"movdqu		xmm0, [%0]			\n\t" //Load 8 values
+				"paddsw		xmm0, [%2]			\n\t" //Round
+				"psraw		xmm0, [%2+48]		\n\t" //Shift
+				"movdqu		[%0], xmm0			\n\t"
+				"pxor		xmm1, xmm1			\n\t" //|y|, saturated
+				"psubsw		xmm1, xmm0			\n\t"
+				"pmaxsw		xmm1, xmm0			\n\t"
+				"movdqa		xmm2, xmm1			\n\t"
+				"pcmpgtw	xmm1, [%2+16]		\n\t" //|y| > max
+				"pcmpgtw	xmm2, [%2+32]		\n\t" //|y| > max/2
+				"psubw		xmm6, xmm1			\n\t" //Masks are -1, so subtract
+				"psubw		xmm7, xmm2			\n\t"
+				"add		%0, 16				\n\t"
+				"dec		%1					\n\t"
+			"jnz L%=						\n\t"
+			"movdqa		[%2], xmm6			\n\t" //Hand the lanes back through the table
+			"movdqa		[%2+16], xmm7		\n\t"
+			".att_syntax					\n\t"
+			: "+r" (a), "+r" (blocks), "+r" (p)
+			:
+			: "xmm0", "xmm1", "xmm2", "xmm6", "xmm7", "memory", "cc"
+		);//end __asm
+
+		stats[0] = stats[1] = 0;
+		for(lcv = 0; lcv < 8; lcv++)
+		{
+			stats[0] += (uint16)table[lcv];
+			stats[1] += (uint16)table[lcv+8];
+		}
+	}
+	else
+	{
+		stats[0] = stats[1] = 0;
+	}
+
+	/* Finish off the tail */
+	if(cnt & 0x7)
+	{
+		x86_agc(a, cnt & 0x7, shift, bits, tail);
+		stats[0] += tail[0];
+		stats[1] += tail[1];
+	}
+
+}
+
+
+//!< Close the loops of 4 channels per pass, see x86_track. The offsets are the rows of Loop_Bank_S
+void sse_track(Loop_Bank_S *A, int32 cnt)
+{
+
+	Loop_Bank_S *a = A;
+	int32 blocks = cnt;
+	uint32 *p;
+	uint32 table[96] __attribute__ ((aligned (16)));
+	float *f = (float *)&table[0];
+	int32 lcv;
+
+	if(blocks < 1)
+		return;
+
+	for(lcv = 0; lcv < 4; lcv++)
+	{
+		table[lcv]    = 0x7fffffff;		//!< |x|
+		table[lcv+4]  = 0x80000000;		//!< Sign
+		f[lcv+8]      = 0.9998660f;		//!< atan, Abramowitz & Stegun 4.4.49
+		f[lcv+12]     = -0.3302995f;
+		f[lcv+16]     = 0.1801410f;
+		f[lcv+20]     = -0.0851330f;
+		f[lcv+24]     = 0.0208351f;
+		f[lcv+28]     = 1.5707963f;		//!< pi/2
+		f[lcv+32]     = 0.1591549f;		//!< 1/(2*pi)
+		f[lcv+36]     = 0.5f;
+		f[lcv+40]     = 1.0f;
+		f[lcv+44]     = 20.0f;
+		f[lcv+48]     = 0.02f;			//!< CN0 filter
+		f[lcv+52]     = 15.0f;			//!< CN0 floor
+		f[lcv+56]     = 30.25f;
+		table[lcv+60] = 0x007fffff;		//!< Mantissa
+		table[lcv+64] = 127;			//!< Exponent bias
+		f[lcv+68]     = 0.6666667f;		//!< ln, 2*atanh(s)
+		f[lcv+72]     = 0.4f;
+		f[lcv+76]     = 0.2857143f;
+		f[lcv+80]     = 2.0f;
+		f[lcv+84]     = 0.4342945f;		//!< log10(e)
+		f[lcv+88]     = 0.3010300f;		//!< log10(2)
+		f[lcv+92]     = 10.0f;
+	}
+
+	p = &table[0];
+
+	__asm volatile
+	(
+		".intel_syntax noprefix			\n\t"
+		"L%=:							\n\t"
+			/* PLL discriminator, atan(Q/I) folded into [0, 1] */
+			"movaps		xmm0, [%0+16]		\n\t" //Q
+			"movaps		xmm1, [%0]			\n\t" //I
+			"movaps		xmm7, xmm0			\n\t" //Sign of Q/I
+			"xorps		xmm7, xmm1			\n\t"
+			"andps		xmm7, [%2+16]		\n\t"
+			"andps		xmm0, [%2]			\n\t" //|Q|
+			"andps		xmm1, [%2]			\n\t" //|I|
+			"movaps		xmm2, xmm0			\n\t"
+			"minps		xmm2, xmm1			\n\t"
+			"movaps		xmm3, xmm0			\n\t"
+			"maxps		xmm3, xmm1			\n\t"
+			"cmpltps	xmm1, xmm0			\n\t" //|I| < |Q|, take pi/2 - atan
+			"divps		xmm2, xmm3			\n\t" //t = min/max
+			"movaps		xmm3, xmm2			\n\t"
+			"mulps		xmm3, xmm3			\n\t" //t^2
+			"movaps		xmm4, [%2+96]		\n\t"
+			"mulps		xmm4, xmm3			\n\t"
+			"addps		xmm4, [%2+80]		\n\t"
+			"mulps		xmm4, xmm3			\n\t"
+			"addps		xmm4, [%2+64]		\n\t"
+			"mulps		xmm4, xmm3			\n\t"
+			"addps		xmm4, [%2+48]		\n\t"
+			"mulps		xmm4, xmm3			\n\t"
+			"addps		xmm4, [%2+32]		\n\t"
+			"mulps		xmm4, xmm2			\n\t"
+			"movaps		xmm5, [%2+112]		\n\t"
+			"subps		xmm5, xmm4			\n\t"
+			"andps		xmm5, xmm1			\n\t"
+			"andnps		xmm1, xmm4			\n\t"
+			"orps		xmm1, xmm5			\n\t"
+			"orps		xmm1, xmm7			\n\t" //Put the sign back
+			"xorps		xmm6, xmm6			\n\t" //Nothing where I == 0
+			"cmpneqps	xmm6, [%0]			\n\t"
+			"andps		xmm1, xmm6			\n\t"
+			"mulps		xmm1, [%2+128]		\n\t" //In cycles
+			"andps		xmm1, [%0+224]		\n\t"
+			"movaps		[%0+256], xmm1		\n\t"
+			/* 3rd order loop filter */
+			"movaps		xmm2, [%0+96]		\n\t" //w += kw*dp
+			"mulps		xmm2, xmm1			\n\t"
+			"addps		xmm2, [%0+160]		\n\t"
+			"movaps		xmm3, [%0+128]		\n\t" //x += kh*w + kx*dp
+			"mulps		xmm3, xmm2			\n\t"
+			"movaps		xmm4, [%0+112]		\n\t"
+			"mulps		xmm4, xmm1			\n\t"
+			"addps		xmm3, xmm4			\n\t"
+			"addps		xmm3, [%0+176]		\n\t"
+			"movaps		xmm5, [%0+144]		\n\t" //z = x/2 + kz*dp
+			"mulps		xmm5, xmm1			\n\t"
+			"movaps		xmm4, xmm3			\n\t"
+			"mulps		xmm4, [%2+144]		\n\t"
+			"addps		xmm4, xmm5			\n\t"
+			"movaps		xmm0, [%0+224]		\n\t" //Only the lanes with the PLL closed
+			"movaps		xmm6, xmm0			\n\t"
+			"andps		xmm2, xmm0			\n\t"
+			"andnps		xmm6, [%0+160]		\n\t"
+			"orps		xmm2, xmm6			\n\t"
+			"movaps		[%0+160], xmm2		\n\t"
+			"movaps		xmm6, xmm0			\n\t"
+			"andps		xmm3, xmm0			\n\t"
+			"andnps		xmm6, [%0+176]		\n\t"
+			"orps		xmm3, xmm6			\n\t"
+			"movaps		[%0+176], xmm3		\n\t"
+			"andps		xmm4, xmm0			\n\t"
+			"andnps		xmm0, [%0+192]		\n\t"
+			"orps		xmm4, xmm0			\n\t"
+			"movaps		[%0+192], xmm4		\n\t"
+			/* DLL discriminator */
+			"movaps		xmm0, [%0+32]		\n\t" //(sqrt(E) - sqrt(L))/sqrt(E + L)
+			"movaps		xmm1, [%0+48]		\n\t"
+			"movaps		xmm2, xmm0			\n\t"
+			"addps		xmm2, xmm1			\n\t"
+			"sqrtps		xmm0, xmm0			\n\t"
+			"sqrtps		xmm1, xmm1			\n\t"
+			"sqrtps		xmm2, xmm2			\n\t"
+			"subps		xmm0, xmm1			\n\t"
+			"divps		xmm0, xmm2			\n\t"
+			"movaps		[%0+272], xmm0		\n\t"
+			/* CN0, r = (NP - 1)/(20 - NP) = (NBP - WBP)/(20*WBP - NBP) */
+			"movaps		xmm0, [%0+64]		\n\t"
+			"movaps		xmm6, [%0+80]		\n\t"
+			"xorps		xmm7, xmm7			\n\t" //WBP > 0
+			"cmpltps	xmm7, xmm6			\n\t"
+			"movaps		xmm1, xmm0			\n\t"
+			"subps		xmm1, xmm6			\n\t"
+			"mulps		xmm6, [%2+176]		\n\t"
+			"subps		xmm6, xmm0			\n\t"
+			"divps		xmm1, xmm6			\n\t"
+			"xorps		xmm6, xmm6			\n\t" //r > 0
+			"cmpltps	xmm6, xmm1			\n\t"
+			"andps		xmm7, xmm6			\n\t"
+			"movaps		xmm2, xmm1			\n\t" //r = m*2^e
+			"psrld		xmm2, 23			\n\t"
+			"psubd		xmm2, [%2+256]		\n\t"
+			"cvtdq2ps	xmm2, xmm2			\n\t"
+			"andps		xmm1, [%2+240]		\n\t"
+			"orps		xmm1, [%2+160]		\n\t"
+			"movaps		xmm3, xmm1			\n\t" //s = (m - 1)/(m + 1)
+			"subps		xmm1, [%2+160]		\n\t"
+			"addps		xmm3, [%2+160]		\n\t"
+			"divps		xmm1, xmm3			\n\t"
+			"movaps		xmm3, xmm1			\n\t"
+			"mulps		xmm3, xmm3			\n\t"
+			"movaps		xmm4, [%2+304]		\n\t" //ln(m)
+			"mulps		xmm4, xmm3			\n\t"
+			"addps		xmm4, [%2+288]		\n\t"
+			"mulps		xmm4, xmm3			\n\t"
+			"addps		xmm4, [%2+272]		\n\t"
+			"mulps		xmm4, xmm3			\n\t"
+			"addps		xmm4, [%2+320]		\n\t"
+			"mulps		xmm4, xmm1			\n\t"
+			"mulps		xmm4, [%2+336]		\n\t" //log10(r)
+			"mulps		xmm2, [%2+352]		\n\t"
+			"addps		xmm4, xmm2			\n\t"
+			"mulps		xmm4, [%2+368]		\n\t"
+			"addps		xmm4, [%2+224]		\n\t"
+			"movaps		xmm5, [%0+208]		\n\t" //cn0 += (ncn0 - cn0)*.02
+			"subps		xmm4, xmm5			\n\t"
+			"mulps		xmm4, [%2+192]		\n\t"
+			"andps		xmm4, xmm7			\n\t"
+			"addps		xmm4, xmm5			\n\t"
+			"maxps		xmm4, [%2+208]		\n\t" //Floor
+			"movaps		xmm0, [%0+240]		\n\t" //Only the lanes estimating
+			"andps		xmm4, xmm0			\n\t"
+			"andnps		xmm0, xmm5			\n\t"
+			"orps		xmm4, xmm0			\n\t"
+			"movaps		[%0+208], xmm4		\n\t"
+			"add		%0, 288				\n\t"
+			"dec		%1					\n\t"
+		"jnz L%=						\n\t"
+		".att_syntax					\n\t"
+		: "+r" (a), "+r" (blocks), "+r" (p)
+		:
+		: "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "xmm7", "memory", "cc"
+	);//end __asm
+
+}
+
+
+//!< Check the parity of 4 GPS words per pass, see x86_parity. The rotate and mask XOR form of the ICD check, 4 lanes wide
+uint32 sse_parity(uint32 *A, int32 cnt)
+{
+
+	uint32 *a = A;
+	const uint32 *p;
+	int32 *o;
+	int32 blocks;
+	uint32 fail;
+	int32 lcv;
+	int32 ok[32] __attribute__ ((aligned (16)));
+
+	/* Constant, so built once rather than every call, the subframe check is only 3 passes */
+	static const uint32 table[32] __attribute__ ((aligned (16))) =
+	{
+		0xFBFFBF00, 0xFBFFBF00, 0xFBFFBF00, 0xFBFFBF00,		//!< Word rotated left by 0 to 6 bits
+		0x07FFBF01, 0x07FFBF01, 0x07FFBF01, 0x07FFBF01,
+		0xFC0F8100, 0xFC0F8100, 0xFC0F8100, 0xFC0F8100,
+		0xF81FFE02, 0xF81FFE02, 0xF81FFE02, 0xF81FFE02,
+		0xFC00000E, 0xFC00000E, 0xFC00000E, 0xFC00000E,
+		0x07F00001, 0x07F00001, 0x07F00001, 0x07F00001,
+		0x00003000, 0x00003000, 0x00003000, 0x00003000,
+		0x0000003F, 0x0000003F, 0x0000003F, 0x0000003F		//!< Parity bits
+	};
+
+	blocks = cnt >> 2;
+	fail = 0;
+
+	if(blocks)
+	{
+		o = &ok[0];
+		p = &table[0];
+
+		__asm volatile
+		(
+			".intel_syntax noprefix			\n\t"
+			"L%=:							\n\t"
+				"movdqu		xmm0, [%0]			\n\t" //Load 4 words
+				"movdqa		xmm7, xmm0			\n\t" //t = d1
+				"pand		xmm7, [%2]			\n\t"
+				"movdqa		xmm1, xmm0			\n\t" //t ^= rotl(word, 1) & mask
+				"movdqa		xmm2, xmm0			\n\t"
+				"pslld		xmm1, 1				\n\t"
+				"psrld		xmm2, 31			\n\t"
+				"por		xmm1, xmm2			\n\t"
+				"pand		xmm1, [%2+16]		\n\t"
+				"pxor		xmm7, xmm1			\n\t"
+				"movdqa		xmm1, xmm0			\n\t" //t ^= rotl(word, 2) & mask
+				"movdqa		xmm2, xmm0			\n\t"
+				"pslld		xmm1, 2				\n\t"
+				"psrld		xmm2, 30			\n\t"
+				"por		xmm1, xmm2			\n\t"
+				"pand		xmm1, [%2+32]		\n\t"
+				"pxor		xmm7, xmm1			\n\t"
+				"movdqa		xmm1, xmm0			\n\t" //t ^= rotl(word, 3) & mask
+				"movdqa		xmm2, xmm0			\n\t"
+				"pslld		xmm1, 3				\n\t"
+				"psrld		xmm2, 29			\n\t"
+				"por		xmm1, xmm2			\n\t"
+				"pand		xmm1, [%2+48]		\n\t"
+				"pxor		xmm7, xmm1			\n\t"
+				"movdqa		xmm1, xmm0			\n\t" //t ^= rotl(word, 4) & mask
+				"movdqa		xmm2, xmm0			\n\t"
+				"pslld		xmm1, 4				\n\t"
+				"psrld		xmm2, 28			\n\t"
+				"por		xmm1, xmm2			\n\t"
+				"pand		xmm1, [%2+64]		\n\t"
+				"pxor		xmm7, xmm1			\n\t"
+				"movdqa		xmm1, xmm0			\n\t" //t ^= rotl(word, 5) & mask
+				"movdqa		xmm2, xmm0			\n\t"
+				"pslld		xmm1, 5				\n\t"
+				"psrld		xmm2, 27			\n\t"
+				"por		xmm1, xmm2			\n\t"
+				"pand		xmm1, [%2+80]		\n\t"
+				"pxor		xmm7, xmm1			\n\t"
+				"movdqa		xmm1, xmm0			\n\t" //t ^= rotl(word, 6) & mask
+				"movdqa		xmm2, xmm0			\n\t"
+				"pslld		xmm1, 6				\n\t"
+				"psrld		xmm2, 26			\n\t"
+				"por		xmm1, xmm2			\n\t"
+				"pand		xmm1, [%2+96]		\n\t"
+				"pxor		xmm7, xmm1			\n\t"
+				"movdqa		xmm3, xmm7			\n\t" //Fold the 5 6 bit fields, the low 6 bits of the rotations of t
+				"movdqa		xmm1, xmm3			\n\t"
+				"psrld		xmm1, 26			\n\t"
+				"pxor		xmm7, xmm1			\n\t"
+				"movdqa		xmm1, xmm3			\n\t"
+				"psrld		xmm1, 20			\n\t"
+				"pxor		xmm7, xmm1			\n\t"
+				"movdqa		xmm1, xmm3			\n\t"
+				"psrld		xmm1, 14			\n\t"
+				"pxor		xmm7, xmm1			\n\t"
+				"movdqa		xmm1, xmm3			\n\t"
+				"psrld		xmm1, 8				\n\t"
+				"pxor		xmm7, xmm1			\n\t"
+				"pand		xmm7, [%2+112]		\n\t"
+				"movdqa		xmm1, xmm0			\n\t" //Against the parity bits received
+				"pand		xmm1, [%2+112]		\n\t"
+				"pcmpeqd	xmm7, xmm1			\n\t"
+				"movdqu		[%3], xmm7			\n\t"
+				"add		%0, 16				\n\t"
+				"add		%3, 16				\n\t"
+				"dec		%1					\n\t"
+			"jnz L%=						\n\t"
+			".att_syntax					\n\t"
+			: "+r" (a), "+r" (blocks), "+r" (p), "+r" (o)
+			:
+			: "xmm0", "xmm1", "xmm2", "xmm3", "xmm7", "memory", "cc"
+		);//end __asm
+
+		for(lcv = 0; lcv < (cnt & ~0x3); lcv++)
+			if(!ok[lcv])
+				fail |= 1 << lcv;
+	}
+
+	/* Finish off the tail */
+	if(cnt & 0x3)
+		fail |= x86_parity(a, cnt & 0x3) << (cnt & ~0x3);
+
+	return(fail);
+
+}
+
+
+//!< Line of sight of 4 SVs per pass, see x86_predict. The offsets are the rows of Predict_Bank_S and Predict_Frame_S
+void sse_predict(Predict_Bank_S *A, Predict_Frame_S *F, int32 cnt)
+{
+
+	Predict_Bank_S *a = A;
+	Predict_Frame_S *f = F;
+	int32 blocks = cnt;
+	uint32 *p;
+	uint32 table[48] __attribute__ ((aligned (16)));
+	float *t = (float *)&table[0];
+	int32 lcv;
+
+	if(blocks < 1)
+		return;
+
+	for(lcv = 0; lcv < 4; lcv++)
+	{
+		table[lcv]    = 0x7fffffff;		//!< |x|
+		table[lcv+4]  = 0x80000000;		//!< Sign
+		t[lcv+8]      = 0.9998660f;		//!< atan, Abramowitz & Stegun 4.4.49
+		t[lcv+12]     = -0.3302995f;
+		t[lcv+16]     = 0.1801410f;
+		t[lcv+20]     = -0.0851330f;
+		t[lcv+24]     = 0.0208351f;
+		t[lcv+28]     = 1.5707963f;		//!< pi/2
+		t[lcv+32]     = 3.1415927f;		//!< pi
+		t[lcv+36]     = 1.0f;
+		t[lcv+40]     = (float)INVERSE_SPEED_OF_LIGHT;
+		t[lcv+44]     = -(float)L1_OVER_C;
+	}
+
+	p = &table[0];
+
+	__asm volatile
+	(
+		".intel_syntax noprefix			\n\t"
+		"L%=:							\n\t"
+			/* Range, and the delay off it */
+			"movaps		xmm0, [%0]			\n\t" //d
+			"movaps		xmm1, [%0+16]		\n\t"
+			"movaps		xmm2, [%0+32]		\n\t"
+			"movaps		xmm3, xmm0			\n\t" //|d|
+			"mulps		xmm3, xmm3			\n\t"
+			"movaps		xmm4, xmm1			\n\t"
+			"mulps		xmm4, xmm4			\n\t"
+			"addps		xmm3, xmm4			\n\t"
+			"movaps		xmm4, xmm2			\n\t"
+			"mulps		xmm4, xmm4			\n\t"
+			"addps		xmm3, xmm4			\n\t"
+			"sqrtps		xmm3, xmm3			\n\t"
+			"movaps		xmm4, xmm3			\n\t" //delay = |d|/C - clock
+			"mulps		xmm4, [%2+160]		\n\t"
+			"subps		xmm4, [%0+144]		\n\t"
+			"movaps		[%0+176], xmm4		\n\t"
+			"movaps		xmm7, [%2+144]		\n\t" //1/|d|
+			"divps		xmm7, xmm3			\n\t"
+			/* Range rate, dv.d/|d| */
+			"movaps		xmm3, [%0+48]		\n\t"
+			"mulps		xmm3, xmm0			\n\t"
+			"movaps		xmm4, [%0+64]		\n\t"
+			"mulps		xmm4, xmm1			\n\t"
+			"addps		xmm3, xmm4			\n\t"
+			"movaps		xmm4, [%0+80]		\n\t"
+			"mulps		xmm4, xmm2			\n\t"
+			"addps		xmm3, xmm4			\n\t"
+			"mulps		xmm3, xmm7			\n\t"
+			"movaps		xmm4, xmm3			\n\t" //doppler = -(rv + drift)*L1/C
+			"addps		xmm4, [%0+160]		\n\t"
+			"mulps		xmm4, [%2+176]		\n\t"
+			"movaps		[%0+192], xmm4		\n\t"
+			/* Range acceleration, (da.d + dv.dv - rv^2)/|d| */
+			"movaps		xmm4, [%0+96]		\n\t"
+			"mulps		xmm4, xmm0			\n\t"
+			"movaps		xmm5, [%0+112]		\n\t"
+			"mulps		xmm5, xmm1			\n\t"
+			"addps		xmm4, xmm5			\n\t"
+			"movaps		xmm5, [%0+128]		\n\t"
+			"mulps		xmm5, xmm2			\n\t"
+			"addps		xmm4, xmm5			\n\t"
+			"movaps		xmm5, [%0+48]		\n\t"
+			"mulps		xmm5, xmm5			\n\t"
+			"movaps		xmm6, [%0+64]		\n\t"
+			"mulps		xmm6, xmm6			\n\t"
+			"addps		xmm5, xmm6			\n\t"
+			"movaps		xmm6, [%0+80]		\n\t"
+			"mulps		xmm6, xmm6			\n\t"
+			"addps		xmm5, xmm6			\n\t"
+			"addps		xmm4, xmm5			\n\t"
+			"mulps		xmm3, xmm3			\n\t"
+			"subps		xmm4, xmm3			\n\t"
+			"mulps		xmm4, xmm7			\n\t"
+			"mulps		xmm4, [%2+176]		\n\t"
+			"movaps		[%0+208], xmm4		\n\t"
+			/* East and north */
+			"movaps		xmm3, [%3]			\n\t"
+			"mulps		xmm3, xmm0			\n\t"
+			"movaps		xmm4, [%3+16]		\n\t"
+			"mulps		xmm4, xmm1			\n\t"
+			"addps		xmm3, xmm4			\n\t"
+			"movaps		xmm4, [%3+32]		\n\t"
+			"mulps		xmm4, xmm2			\n\t"
+			"addps		xmm3, xmm4			\n\t"
+			"mulps		xmm3, xmm7			\n\t"
+			"movaps		xmm4, [%3+48]		\n\t"
+			"mulps		xmm4, xmm0			\n\t"
+			"movaps		xmm5, [%3+64]		\n\t"
+			"mulps		xmm5, xmm1			\n\t"
+			"addps		xmm4, xmm5			\n\t"
+			"movaps		xmm5, [%3+80]		\n\t"
+			"mulps		xmm5, xmm2			\n\t"
+			"addps		xmm4, xmm5			\n\t"
+			"mulps		xmm4, xmm7			\n\t"
+			/* Geocentric up against the mask */
+			"movaps		xmm5, [%3+144]		\n\t"
+			"mulps		xmm5, xmm0			\n\t"
+			"movaps		xmm6, [%3+160]		\n\t"
+			"mulps		xmm6, xmm1			\n\t"
+			"addps		xmm5, xmm6			\n\t"
+			"movaps		xmm6, [%3+176]		\n\t"
+			"mulps		xmm6, xmm2			\n\t"
+			"addps		xmm5, xmm6			\n\t"
+			"mulps		xmm5, xmm7			\n\t"
+			"movaps		xmm6, [%3+192]		\n\t"
+			"cmpltps	xmm6, xmm5			\n\t"
+			"movaps		[%0+256], xmm6		\n\t"
+			/* Up */
+			"movaps		xmm5, [%3+96]		\n\t"
+			"mulps		xmm5, xmm0			\n\t"
+			"movaps		xmm6, [%3+112]		\n\t"
+			"mulps		xmm6, xmm1			\n\t"
+			"addps		xmm5, xmm6			\n\t"
+			"movaps		xmm6, [%3+128]		\n\t"
+			"mulps		xmm6, xmm2			\n\t"
+			"addps		xmm5, xmm6			\n\t"
+			"mulps		xmm5, xmm7			\n\t"
+			"movaps		xmm0, xmm3			\n\t" //Horizontal, sqrt(e^2 + n^2)
+			"mulps		xmm0, xmm0			\n\t"
+			"movaps		xmm1, xmm4			\n\t"
+			"mulps		xmm1, xmm1			\n\t"
+			"addps		xmm0, xmm1			\n\t"
+			"sqrtps		xmm0, xmm0			\n\t"
+			/* Elevation, atan2(u, h) folded into [0, 1], h >= 0 so no quadrant to put back */
+			"movaps		xmm7, xmm5			\n\t" //Sign of u
+			"andps		xmm7, [%2+16]		\n\t"
+			"andps		xmm5, [%2]			\n\t"
+			"movaps		xmm1, xmm5			\n\t"
+			"minps		xmm1, xmm0			\n\t"
+			"movaps		xmm2, xmm5			\n\t"
+			"maxps		xmm2, xmm0			\n\t"
+			"movaps		xmm6, xmm0			\n\t" //h < |u|, take pi/2 - atan
+			"cmpltps	xmm6, xmm5			\n\t"
+			"divps		xmm1, xmm2			\n\t" //t = min/max
+			"xorps		xmm0, xmm0			\n\t" //Nothing where both are 0
+			"cmpneqps	xmm0, xmm2			\n\t"
+			"movaps		xmm2, xmm1			\n\t"
+			"mulps		xmm2, xmm2			\n\t" //t^2
+			"movaps		xmm5, [%2+96]		\n\t"
+			"mulps		xmm5, xmm2			\n\t"
+			"addps		xmm5, [%2+80]		\n\t"
+			"mulps		xmm5, xmm2			\n\t"
+			"addps		xmm5, [%2+64]		\n\t"
+			"mulps		xmm5, xmm2			\n\t"
+			"addps		xmm5, [%2+48]		\n\t"
+			"mulps		xmm5, xmm2			\n\t"
+			"addps		xmm5, [%2+32]		\n\t"
+			"mulps		xmm5, xmm1			\n\t"
+			"movaps		xmm2, [%2+112]		\n\t"
+			"subps		xmm2, xmm5			\n\t"
+			"andps		xmm2, xmm6			\n\t"
+			"andnps		xmm6, xmm5			\n\t"
+			"orps		xmm6, xmm2			\n\t"
+			"orps		xmm6, xmm7			\n\t" //Put the sign back
+			"andps		xmm6, xmm0			\n\t"
+			"movaps		[%0+224], xmm6		\n\t"
+			/* Azimuth, atan2(e, n) over all four quadrants */
+			"movaps		xmm7, xmm3			\n\t" //Sign of e
+			"andps		xmm7, [%2+16]		\n\t"
+			"movaps		xmm6, xmm4			\n\t" //n < 0, take pi - atan
+			"xorps		xmm0, xmm0			\n\t"
+			"cmpltps	xmm6, xmm0			\n\t"
+			"andps		xmm3, [%2]			\n\t"
+			"andps		xmm4, [%2]			\n\t"
+			"movaps		xmm1, xmm3			\n\t"
+			"minps		xmm1, xmm4			\n\t"
+			"movaps		xmm2, xmm3			\n\t"
+			"maxps		xmm2, xmm4			\n\t"
+			"cmpltps	xmm4, xmm3			\n\t" //|n| < |e|, take pi/2 - atan
+			"divps		xmm1, xmm2			\n\t"
+			"xorps		xmm3, xmm3			\n\t"
+			"cmpneqps	xmm3, xmm2			\n\t"
+			"movaps		xmm2, xmm1			\n\t"
+			"mulps		xmm2, xmm2			\n\t"
+			"movaps		xmm5, [%2+96]		\n\t"
+			"mulps		xmm5, xmm2			\n\t"
+			"addps		xmm5, [%2+80]		\n\t"
+			"mulps		xmm5, xmm2			\n\t"
+			"addps		xmm5, [%2+64]		\n\t"
+			"mulps		xmm5, xmm2			\n\t"
+			"addps		xmm5, [%2+48]		\n\t"
+			"mulps		xmm5, xmm2			\n\t"
+			"addps		xmm5, [%2+32]		\n\t"
+			"mulps		xmm5, xmm1			\n\t"
+			"movaps		xmm0, [%2+112]		\n\t"
+			"subps		xmm0, xmm5			\n\t"
+			"andps		xmm0, xmm4			\n\t"
+			"andnps		xmm4, xmm5			\n\t"
+			"orps		xmm4, xmm0			\n\t"
+			"movaps		xmm0, [%2+128]		\n\t"
+			"subps		xmm0, xmm4			\n\t"
+			"andps		xmm0, xmm6			\n\t"
+			"andnps		xmm6, xmm4			\n\t"
+			"orps		xmm6, xmm0			\n\t"
+			"orps		xmm6, xmm7			\n\t"
+			"andps		xmm6, xmm3			\n\t"
+			"movaps		[%0+240], xmm6		\n\t"
+			"add		%0, 272				\n\t"
+			"dec		%1					\n\t"
+		"jnz L%=						\n\t"
+		".att_syntax					\n\t"
+		: "+r" (a), "+r" (blocks), "+r" (p), "+r" (f)
+		:
+		: "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "xmm7", "memory", "cc"
+	);//end __asm
+
+}
@@ -387,6 +387,424 @@ void x86_prn_accum_new(CPX *A, MIX *E, MIX *P, MIX *L, int32 cnt, CPX_ACCUM *acc
 /*----------------------------------------------------------------------------------------------*/
 
 
+/*----------------------------------------------------------------------------------------------*/
+//!< 8*cos() of the 16 carrier bins, -8*sin() is the same table advanced by a quarter turn
+const int8 x86_mix_cos[16] = {8, 7, 6, 3, 0, -3, -6, -7, -8, -7, -6, -3, 0, 3, 6, 7};
+
+//!< Mix 2 bit sampler codes (in the low bits of A) to baseband with an integer NCO, B must hold cnt CPX
+void x86_mix_2bit(int8 *_A, CPX *_B, int32 _cnt, uint32 *_phase, uint32 _dphase)
+{
+
+	const int32 lut[4] = {-3, -1, 1, 3};
+	int32 lcv, samp, bin;
+	uint32 phase;
+
+	/* Offset by half a bin so the top 4 bits round to the nearest bin */
+	phase = *_phase + 0x08000000;
+
+	for(lcv = 0; lcv < _cnt; lcv++)
+	{
+		bin = phase >> 28;
+		samp = lut[_A[lcv] & 0x3];
+		_B[lcv].i = samp * x86_mix_cos[bin];
+		_B[lcv].q = samp * x86_mix_cos[(bin + 4) & 0xf];
+		phase += _dphase;
+	}
+
+	*_phase = phase - 0x08000000;
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void x86_deinterleave(CPX *_A, int16 *_I, int16 *_Q, int32 _cnt)
+{
+
+	int32 lcv;
+
+	for(lcv = 0; lcv < _cnt; lcv++)
+	{
+		_I[lcv] = _A[lcv].i;
+		_Q[lcv] = _A[lcv].q;
+	}
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+/*!
+ * Polyphase FIR on split I/Q planes, _B[k] = sum(h[k][j]*_A[_off[k]+j]) >> _shift, saturated to int16.
+ * The rows of _H are stored in pairs, 8 taps of row 2m then 8 taps of row 2m+1, so tap j of row k sits at
+ * _H[(k & ~1)*_taps + (j >> 3)*16 + (k & 1)*8 + (j & 7)]. _H is sized for an even number of rows
+ * */
+void x86_polyphase(int16 *_AI, int16 *_AQ, CPX *_B, int32 _cnt, int16 *_H, int32 *_off, int32 _taps, int32 _shift)
+{
+
+	int16 *ai, *aq, *h;
+	int32 lcv, lcv2;
+	int32 si, sq, tap;
+
+	for(lcv = 0; lcv < _cnt; lcv++)
+	{
+		ai = &_AI[_off[lcv]];
+		aq = &_AQ[_off[lcv]];
+		h = &_H[(lcv & ~1)*_taps + (lcv & 1)*8];
+		si = sq = 0;
+
+		for(lcv2 = 0; lcv2 < _taps; lcv2++)
+		{
+			tap = h[(lcv2 >> 3)*16 + (lcv2 & 7)];
+			si += ai[lcv2]*tap;
+			sq += aq[lcv2]*tap;
+		}
+
+		si = (si + (1 << (_shift - 1))) >> _shift;
+		sq = (sq + (1 << (_shift - 1))) >> _shift;
+
+		_B[lcv].i = (si > 32767) ? 32767 : ((si < -32768) ? -32768 : si);
+		_B[lcv].q = (sq > 32767) ? 32767 : ((sq < -32768) ? -32768 : sq);
+	}
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+/*!
+ * Requantize in place, _A = (_A + round) >> _shift with a saturating add, and gather the block
+ * statistics the AGC runs on: _stats = {count |out| > 1<<_bits, count |out| > 1<<(_bits-1)}
+ * */
+void x86_agc(int16 *_A, int32 _cnt, int32 _shift, int32 _bits, int32 *_stats)
+{
+
+	int32 lcv, val, round, max, half;
+	int32 over, high;
+
+	round = _shift ? (1 << (_shift - 1)) : 0;
+	max = 1 << _bits;
+	half = max >> 1;
+	over = high = 0;
+
+	for(lcv = 0; lcv < _cnt; lcv++)
+	{
+		val = _A[lcv] + round;
+		if(val > 32767)
+			val = 32767;
+		val >>= _shift;
+		_A[lcv] = val;
+
+		val = abs(val);
+		if(val > 32767)
+			val = 32767;
+		if(val > max)
+			over++;
+		if(val > half)
+			high++;
+	}
+
+	_stats[0] = over;
+	_stats[1] = high;
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+float x86_atan2_approx(float _y, float _x)
+{
+
+	float ay, ax, t, t2, p;
+
+	if(_x == 0)
+		return(0);
+
+	/* Fold into [0, 1], Abramowitz & Stegun 4.4.49, |error| < 1e-5 rad */
+	ay = fabsf(_y);
+	ax = fabsf(_x);
+	t = (ay < ax ? ay : ax)/(ay > ax ? ay : ax);
+	t2 = t*t;
+	p = t*(0.9998660f + t2*(-0.3302995f + t2*(0.1801410f + t2*(-0.0851330f + t2*0.0208351f))));
+
+	if(ax < ay)
+		p = 1.5707963f - p;
+
+	/* Quadrants 1 and 4 only, like atan(y/x) */
+	return(((_y < 0) != (_x < 0)) ? -p : p);
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+float x86_log10_approx(float _x)
+{
+
+	union {float f; int32 i;} u;
+	float e, s, s2, ln;
+
+	/* _x = m*2^e, m in [1, 2) */
+	u.f = _x;
+	e = (float)((u.i >> 23) - 127);
+	u.i = (u.i & 0x007fffff) | 0x3f800000;
+
+	/* ln(m) = 2*atanh((m-1)/(m+1)), |error| < 1.2e-5 */
+	s = (u.f - 1.0f)/(u.f + 1.0f);
+	s2 = s*s;
+	ln = s*(2.0f + s2*(0.6666667f + s2*(0.4f + s2*0.2857143f)));
+
+	return(0.4342945f*ln + 0.3010300f*e);
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+void x86_track(Loop_Bank_S *_A, int32 _cnt)
+{
+
+	Loop_Bank_S *a;
+	float dp, w, x, z, r, cn0;
+	int32 lcv, lane;
+
+	for(lcv = 0; lcv < _cnt; lcv++)
+	{
+		a = &_A[lcv];
+
+		for(lane = 0; lane < 4; lane++)
+		{
+			/* Costas PLL, 3rd order */
+			if(a->pll[lane])
+			{
+				dp = x86_atan2_approx(a->qp[lane], a->ip[lane])*0.1591549f;
+				w = a->w[lane] + a->kw[lane]*dp;
+				x = a->x[lane] + (a->kh[lane]*w + a->kx[lane]*dp);
+				z = 0.5f*x + a->kz[lane]*dp;
+				a->w[lane] = w;
+				a->x[lane] = x;
+				a->z[lane] = z;
+				a->dp[lane] = dp;
+			}
+			else
+				a->dp[lane] = 0;
+
+			/* Normalized early minus late power */
+			a->code_err[lane] = (sqrtf(a->pe[lane]) - sqrtf(a->pl[lane]))/sqrtf(a->pe[lane] + a->pl[lane]);
+
+			/* CN0 from the narrow to wide band power ratio */
+			if(a->est[lane])
+			{
+				cn0 = a->cn0[lane];
+				if(a->wbp[lane] > 0)
+				{
+					/* (NP - 1)/(20 - NP) without the cancellation in NP - 1 */
+					r = (a->nbp[lane] - a->wbp[lane])/(20.0f*a->wbp[lane] - a->nbp[lane]);
+					if(r > 0)
+						cn0 += ((10.0f*x86_log10_approx(r) + 30.25f) - cn0)*0.02f;
+				}
+				if(cn0 < 15.0f)
+					cn0 = 15.0f;
+				a->cn0[lane] = cn0;
+			}
+		}
+	}
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+//!< Bits of a GPS word, D29* D30* d1...d24 in bits 31 to 6, each of D25...D30 is the parity of, ICD-GPS-200 table 20-XIV
+const uint32 x86_parity_mask[6] = {0x8B7A89C0, 0x6BB1F340, 0x5763E680, 0xAEC7CD00, 0x5D8F9A40, 0xBB1F3480};
+
+//!< D25...D30 (bits 0 to 5) each byte of a word contributes, byte 0 the low one, generated from x86_parity_mask
+const uint8 x86_parity_lut[4][256] =
+{
+	{
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x13, 0x13, 0x13, 0x13, 0x13, 0x13, 0x13, 0x13, 0x13, 0x13, 0x13, 0x13, 0x13, 0x13, 0x13, 0x13,
+		0x13, 0x13, 0x13, 0x13, 0x13, 0x13, 0x13, 0x13, 0x13, 0x13, 0x13, 0x13, 0x13, 0x13, 0x13, 0x13,
+		0x13, 0x13, 0x13, 0x13, 0x13, 0x13, 0x13, 0x13, 0x13, 0x13, 0x13, 0x13, 0x13, 0x13, 0x13, 0x13,
+		0x13, 0x13, 0x13, 0x13, 0x13, 0x13, 0x13, 0x13, 0x13, 0x13, 0x13, 0x13, 0x13, 0x13, 0x13, 0x13,
+		0x25, 0x25, 0x25, 0x25, 0x25, 0x25, 0x25, 0x25, 0x25, 0x25, 0x25, 0x25, 0x25, 0x25, 0x25, 0x25,
+		0x25, 0x25, 0x25, 0x25, 0x25, 0x25, 0x25, 0x25, 0x25, 0x25, 0x25, 0x25, 0x25, 0x25, 0x25, 0x25,
+		0x25, 0x25, 0x25, 0x25, 0x25, 0x25, 0x25, 0x25, 0x25, 0x25, 0x25, 0x25, 0x25, 0x25, 0x25, 0x25,
+		0x25, 0x25, 0x25, 0x25, 0x25, 0x25, 0x25, 0x25, 0x25, 0x25, 0x25, 0x25, 0x25, 0x25, 0x25, 0x25,
+		0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36,
+		0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36,
+		0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36,
+		0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36, 0x36
+	},
+	{
+		0x00, 0x0B, 0x16, 0x1D, 0x2C, 0x27, 0x3A, 0x31, 0x19, 0x12, 0x0F, 0x04, 0x35, 0x3E, 0x23, 0x28,
+		0x32, 0x39, 0x24, 0x2F, 0x1E, 0x15, 0x08, 0x03, 0x2B, 0x20, 0x3D, 0x36, 0x07, 0x0C, 0x11, 0x1A,
+		0x26, 0x2D, 0x30, 0x3B, 0x0A, 0x01, 0x1C, 0x17, 0x3F, 0x34, 0x29, 0x22, 0x13, 0x18, 0x05, 0x0E,
+		0x14, 0x1F, 0x02, 0x09, 0x38, 0x33, 0x2E, 0x25, 0x0D, 0x06, 0x1B, 0x10, 0x21, 0x2A, 0x37, 0x3C,
+		0x0E, 0x05, 0x18, 0x13, 0x22, 0x29, 0x34, 0x3F, 0x17, 0x1C, 0x01, 0x0A, 0x3B, 0x30, 0x2D, 0x26,
+		0x3C, 0x37, 0x2A, 0x21, 0x10, 0x1B, 0x06, 0x0D, 0x25, 0x2E, 0x33, 0x38, 0x09, 0x02, 0x1F, 0x14,
+		0x28, 0x23, 0x3E, 0x35, 0x04, 0x0F, 0x12, 0x19, 0x31, 0x3A, 0x27, 0x2C, 0x1D, 0x16, 0x0B, 0x00,
+		0x1A, 0x11, 0x0C, 0x07, 0x36, 0x3D, 0x20, 0x2B, 0x03, 0x08, 0x15, 0x1E, 0x2F, 0x24, 0x39, 0x32,
+		0x1F, 0x14, 0x09, 0x02, 0x33, 0x38, 0x25, 0x2E, 0x06, 0x0D, 0x10, 0x1B, 0x2A, 0x21, 0x3C, 0x37,
+		0x2D, 0x26, 0x3B, 0x30, 0x01, 0x0A, 0x17, 0x1C, 0x34, 0x3F, 0x22, 0x29, 0x18, 0x13, 0x0E, 0x05,
+		0x39, 0x32, 0x2F, 0x24, 0x15, 0x1E, 0x03, 0x08, 0x20, 0x2B, 0x36, 0x3D, 0x0C, 0x07, 0x1A, 0x11,
+		0x0B, 0x00, 0x1D, 0x16, 0x27, 0x2C, 0x31, 0x3A, 0x12, 0x19, 0x04, 0x0F, 0x3E, 0x35, 0x28, 0x23,
+		0x11, 0x1A, 0x07, 0x0C, 0x3D, 0x36, 0x2B, 0x20, 0x08, 0x03, 0x1E, 0x15, 0x24, 0x2F, 0x32, 0x39,
+		0x23, 0x28, 0x35, 0x3E, 0x0F, 0x04, 0x19, 0x12, 0x3A, 0x31, 0x2C, 0x27, 0x16, 0x1D, 0x00, 0x0B,
+		0x37, 0x3C, 0x21, 0x2A, 0x1B, 0x10, 0x0D, 0x06, 0x2E, 0x25, 0x38, 0x33, 0x02, 0x09, 0x14, 0x1F,
+		0x05, 0x0E, 0x13, 0x18, 0x29, 0x22, 0x3F, 0x34, 0x1C, 0x17, 0x0A, 0x01, 0x30, 0x3B, 0x26, 0x2D
+	},
+	{
+		0x00, 0x3E, 0x3D, 0x03, 0x38, 0x06, 0x05, 0x3B, 0x31, 0x0F, 0x0C, 0x32, 0x09, 0x37, 0x34, 0x0A,
+		0x23, 0x1D, 0x1E, 0x20, 0x1B, 0x25, 0x26, 0x18, 0x12, 0x2C, 0x2F, 0x11, 0x2A, 0x14, 0x17, 0x29,
+		0x07, 0x39, 0x3A, 0x04, 0x3F, 0x01, 0x02, 0x3C, 0x36, 0x08, 0x0B, 0x35, 0x0E, 0x30, 0x33, 0x0D,
+		0x24, 0x1A, 0x19, 0x27, 0x1C, 0x22, 0x21, 0x1F, 0x15, 0x2B, 0x28, 0x16, 0x2D, 0x13, 0x10, 0x2E,
+		0x0D, 0x33, 0x30, 0x0E, 0x35, 0x0B, 0x08, 0x36, 0x3C, 0x02, 0x01, 0x3F, 0x04, 0x3A, 0x39, 0x07,
+		0x2E, 0x10, 0x13, 0x2D, 0x16, 0x28, 0x2B, 0x15, 0x1F, 0x21, 0x22, 0x1C, 0x27, 0x19, 0x1A, 0x24,
+		0x0A, 0x34, 0x37, 0x09, 0x32, 0x0C, 0x0F, 0x31, 0x3B, 0x05, 0x06, 0x38, 0x03, 0x3D, 0x3E, 0x00,
+		0x29, 0x17, 0x14, 0x2A, 0x11, 0x2F, 0x2C, 0x12, 0x18, 0x26, 0x25, 0x1B, 0x20, 0x1E, 0x1D, 0x23,
+		0x1A, 0x24, 0x27, 0x19, 0x22, 0x1C, 0x1F, 0x21, 0x2B, 0x15, 0x16, 0x28, 0x13, 0x2D, 0x2E, 0x10,
+		0x39, 0x07, 0x04, 0x3A, 0x01, 0x3F, 0x3C, 0x02, 0x08, 0x36, 0x35, 0x0B, 0x30, 0x0E, 0x0D, 0x33,
+		0x1D, 0x23, 0x20, 0x1E, 0x25, 0x1B, 0x18, 0x26, 0x2C, 0x12, 0x11, 0x2F, 0x14, 0x2A, 0x29, 0x17,
+		0x3E, 0x00, 0x03, 0x3D, 0x06, 0x38, 0x3B, 0x05, 0x0F, 0x31, 0x32, 0x0C, 0x37, 0x09, 0x0A, 0x34,
+		0x17, 0x29, 0x2A, 0x14, 0x2F, 0x11, 0x12, 0x2C, 0x26, 0x18, 0x1B, 0x25, 0x1E, 0x20, 0x23, 0x1D,
+		0x34, 0x0A, 0x09, 0x37, 0x0C, 0x32, 0x31, 0x0F, 0x05, 0x3B, 0x38, 0x06, 0x3D, 0x03, 0x00, 0x3E,
+		0x10, 0x2E, 0x2D, 0x13, 0x28, 0x16, 0x15, 0x2B, 0x21, 0x1F, 0x1C, 0x22, 0x19, 0x27, 0x24, 0x1A,
+		0x33, 0x0D, 0x0E, 0x30, 0x0B, 0x35, 0x36, 0x08, 0x02, 0x3C, 0x3F, 0x01, 0x3A, 0x04, 0x07, 0x39
+	},
+	{
+		0x00, 0x37, 0x2F, 0x18, 0x1C, 0x2B, 0x33, 0x04, 0x3B, 0x0C, 0x14, 0x23, 0x27, 0x10, 0x08, 0x3F,
+		0x34, 0x03, 0x1B, 0x2C, 0x28, 0x1F, 0x07, 0x30, 0x0F, 0x38, 0x20, 0x17, 0x13, 0x24, 0x3C, 0x0B,
+		0x2A, 0x1D, 0x05, 0x32, 0x36, 0x01, 0x19, 0x2E, 0x11, 0x26, 0x3E, 0x09, 0x0D, 0x3A, 0x22, 0x15,
+		0x1E, 0x29, 0x31, 0x06, 0x02, 0x35, 0x2D, 0x1A, 0x25, 0x12, 0x0A, 0x3D, 0x39, 0x0E, 0x16, 0x21,
+		0x16, 0x21, 0x39, 0x0E, 0x0A, 0x3D, 0x25, 0x12, 0x2D, 0x1A, 0x02, 0x35, 0x31, 0x06, 0x1E, 0x29,
+		0x22, 0x15, 0x0D, 0x3A, 0x3E, 0x09, 0x11, 0x26, 0x19, 0x2E, 0x36, 0x01, 0x05, 0x32, 0x2A, 0x1D,
+		0x3C, 0x0B, 0x13, 0x24, 0x20, 0x17, 0x0F, 0x38, 0x07, 0x30, 0x28, 0x1F, 0x1B, 0x2C, 0x34, 0x03,
+		0x08, 0x3F, 0x27, 0x10, 0x14, 0x23, 0x3B, 0x0C, 0x33, 0x04, 0x1C, 0x2B, 0x2F, 0x18, 0x00, 0x37,
+		0x29, 0x1E, 0x06, 0x31, 0x35, 0x02, 0x1A, 0x2D, 0x12, 0x25, 0x3D, 0x0A, 0x0E, 0x39, 0x21, 0x16,
+		0x1D, 0x2A, 0x32, 0x05, 0x01, 0x36, 0x2E, 0x19, 0x26, 0x11, 0x09, 0x3E, 0x3A, 0x0D, 0x15, 0x22,
+		0x03, 0x34, 0x2C, 0x1B, 0x1F, 0x28, 0x30, 0x07, 0x38, 0x0F, 0x17, 0x20, 0x24, 0x13, 0x0B, 0x3C,
+		0x37, 0x00, 0x18, 0x2F, 0x2B, 0x1C, 0x04, 0x33, 0x0C, 0x3B, 0x23, 0x14, 0x10, 0x27, 0x3F, 0x08,
+		0x3F, 0x08, 0x10, 0x27, 0x23, 0x14, 0x0C, 0x3B, 0x04, 0x33, 0x2B, 0x1C, 0x18, 0x2F, 0x37, 0x00,
+		0x0B, 0x3C, 0x24, 0x13, 0x17, 0x20, 0x38, 0x0F, 0x30, 0x07, 0x1F, 0x28, 0x2C, 0x1B, 0x03, 0x34,
+		0x15, 0x22, 0x3A, 0x0D, 0x09, 0x3E, 0x26, 0x11, 0x2E, 0x19, 0x01, 0x36, 0x32, 0x05, 0x1D, 0x2A,
+		0x21, 0x16, 0x0E, 0x39, 0x3D, 0x0A, 0x12, 0x25, 0x1A, 0x2D, 0x35, 0x02, 0x06, 0x31, 0x29, 0x1E
+	}
+};
+
+/*!
+ * Check the parity of _cnt <= 32 GPS words, four byte lookups a word, the data
+ * bits already inverted by D30*. Returns a mask with bit lcv set when _A[lcv] fails
+ * */
+uint32 x86_parity(uint32 *_A, int32 _cnt)
+{
+
+	uint32 word, parity, fail;
+	int32 lcv;
+
+	fail = 0;
+	for(lcv = 0; lcv < _cnt; lcv++)
+	{
+		word = _A[lcv];
+		parity = x86_parity_lut[0][word & 0xFF] ^ x86_parity_lut[1][(word >> 8) & 0xFF] ^
+				 x86_parity_lut[2][(word >> 16) & 0xFF] ^ x86_parity_lut[3][word >> 24];
+
+		if(parity != (word & 0x3F))
+			fail |= 1 << lcv;
+	}
+
+	return(fail);
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+float x86_atan2_full(float _y, float _x)
+{
+
+	float ay, ax, mx, t, t2, p;
+
+	ay = fabsf(_y);
+	ax = fabsf(_x);
+	mx = ay > ax ? ay : ax;
+
+	if(mx == 0)
+		return(0);
+
+	/* Fold into [0, 1] as x86_atan2_approx() does */
+	t = (ay < ax ? ay : ax)/mx;
+	t2 = t*t;
+	p = t*(0.9998660f + t2*(-0.3302995f + t2*(0.1801410f + t2*(-0.0851330f + t2*0.0208351f))));
+
+	if(ax < ay)
+		p = 1.5707963f - p;
+
+	/* Then back out over all four quadrants */
+	if(_x < 0)
+		p = 3.1415927f - p;
+
+	return((_y < 0) ? -p : p);
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
+/*----------------------------------------------------------------------------------------------*/
+/*!
+ * The line of sight of _cnt banks of 4 SVs. Range rate is the relative velocity along the unit
+ * vector u = d/|d|, and its rate d/dt(dv.u) = da.u + dv.du/dt = (da.d + dv.dv - (dv.u)^2)/|d|,
+ * the same thing SV_Select::SV_Predict() used to build out of du/dt. Visible is the geocentric
+ * elevation against the mask, as the law of cosines test it replaces.
+ * */
+void x86_predict(Predict_Bank_S *_A, Predict_Frame_S *_F, int32 _cnt)
+{
+
+	Predict_Bank_S *a;
+	float dx, dy, dz, c, ic, rv, ra, e, n, u, g;
+	int32 lcv, lane;
+
+	for(lcv = 0; lcv < _cnt; lcv++)
+	{
+		a = &_A[lcv];
+
+		for(lane = 0; lane < 4; lane++)
+		{
+			dx = a->dx[lane];
+			dy = a->dy[lane];
+			dz = a->dz[lane];
+
+			/* Range, range rate and range acceleration */
+			c = sqrtf(dx*dx + dy*dy + dz*dz);
+			ic = 1.0f/c;
+			rv = (a->dvx[lane]*dx + a->dvy[lane]*dy + a->dvz[lane]*dz)*ic;
+			ra = (a->dax[lane]*dx + a->day[lane]*dy + a->daz[lane]*dz) +
+				 (a->dvx[lane]*a->dvx[lane] + a->dvy[lane]*a->dvy[lane] + a->dvz[lane]*a->dvz[lane]) - rv*rv;
+			ra *= ic;
+
+			a->delay[lane] = c*(float)INVERSE_SPEED_OF_LIGHT - a->clock[lane];
+			a->doppler[lane] = (-rv - a->drift[lane])*(float)L1_OVER_C;
+			a->doppler_rate[lane] = -ra*(float)L1_OVER_C;
+
+			/* Into the local level frame */
+			e = (_F->ex[0]*dx + _F->ey[0]*dy + _F->ez[0]*dz)*ic;
+			n = (_F->nx[0]*dx + _F->ny[0]*dy + _F->nz[0]*dz)*ic;
+			u = (_F->ux[0]*dx + _F->uy[0]*dy + _F->uz[0]*dz)*ic;
+			g = (_F->gx[0]*dx + _F->gy[0]*dy + _F->gz[0]*dz)*ic;
+
+			a->elev[lane] = x86_atan2_full(u, sqrtf(e*e + n*n));
+			a->azim[lane] = x86_atan2_full(e, n);
+			a->visible[lane] = (g > _F->mask[0]) ? 0xffffffff : 0x0;
+		}
+	}
+
+}
+/*----------------------------------------------------------------------------------------------*/
+
+
 //int32 x86_acc(int16 *_A, int32 _cnt)
 //{
 //